@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
 using System.Reflection;
@@ -26,50 +27,99 @@ namespace UnityReflectionMod
         }
 
         public static AssemblyData ReflectAssembly(Assembly assembly)
+        {
+            return Reflect(assembly, true, null);
+        }
+
+        // The MVID of the loaded Assembly-CSharp, which identifies its build
+        // without reflecting it; empty if it cannot be loaded
+        public static string GetModuleVersionIdCSharp()
+        {
+            try
+            {
+                return Assembly.Load("Assembly-CSharp").ManifestModule.ModuleVersionId.ToString();
+            }
+            catch (Exception ex)
+            {
+                MelonLoader.MelonLogger.Error($"Failed to load Assembly-CSharp: {ex.Message}");
+                return string.Empty;
+            }
+        }
+
+        // Starts reflecting Assembly-CSharp on worker threads within budget; the
+        // caller drains the types from the pipeline as they are done
+        public static ReflectionPipeline StartReflectingCSharp(ReflectionBudget budget)
+        {
+            try
+            {
+                var assembly = Assembly.Load("Assembly-CSharp");
+                return new ReflectionPipeline(assembly.GetName().Name ?? "Unknown", GetLoadableTypes(assembly), budget);
+            }
+            catch (Exception ex)
+            {
+                MelonLoader.MelonLogger.Error($"Failed to load Assembly-CSharp: {ex.Message}");
+                return new ReflectionPipeline("Assembly-CSharp (Failed to load)", Array.Empty<Type>(), budget);
+            }
+        }
+
+        // Query mode: Assembly-CSharp's types with only their headers filled in.
+        // types[i] is the type behind data.Types[i], for ReflectMembers.
+        public static AssemblyData ReflectTypeHeadersCSharp(List<Type> types)
+        {
+            try
+            {
+                var assembly = Assembly.Load("Assembly-CSharp");
+                return Reflect(assembly, false, types);
+            }
+            catch (Exception ex)
+            {
+                MelonLoader.MelonLogger.Error($"Failed to load Assembly-CSharp: {ex.Message}");
+                return new AssemblyData { AssemblyName = "Assembly-CSharp (Failed to load)" };
+            }
+        }
+
+        private static AssemblyData Reflect(Assembly assembly, bool withMembers, List<Type>? reflected)
         {
             var data = new AssemblyData
             {
                 AssemblyName = assembly.GetName().Name ?? "Unknown",
+                ModuleVersionId = assembly.ManifestModule.ModuleVersionId.ToString(),
                 Timestamp = DateTime.Now
             };
 
-            try
+            var typeNames = new TypeNameCache();
+            foreach (var type in GetLoadableTypes(assembly))
             {
-                var types = assembly.GetTypes();
-                foreach (var type in types)
+                try
                 {
-                    try
-                    {
-                        var typeInfo = ExtractTypeInfo(type);
-                        data.Types.Add(typeInfo);
-                    }
-                    catch (Exception ex)
-                    {
-                        MelonLoader.MelonLogger.Warning($"Failed to reflect type {type.FullName}: {ex.Message}");
-                    }
+                    var typeInfo = ExtractTypeInfo(type, withMembers, typeNames);
+                    data.Types.Add(typeInfo);
+                    reflected?.Add(type);
                 }
-            }
-            catch (ReflectionTypeLoadException ex)
-            {
-                MelonLoader.MelonLogger.Error($"ReflectionTypeLoadException: {ex.Message}");
-                if (ex.Types != null)
+                catch (Exception ex)
                 {
-                    foreach (var type in ex.Types.Where(t => t != null))
-                    {
-                        try
-                        {
-                            var typeInfo = ExtractTypeInfo(type!);
-                            data.Types.Add(typeInfo);
-                        }
-                        catch { }
-                    }
+                    MelonLoader.MelonLogger.Warning($"Failed to reflect type {type.FullName}: {ex.Message}");
                 }
             }
 
             return data;
         }
 
-        private static TypeInfo ExtractTypeInfo(Type type)
+        // The assembly's types, or the ones that loaded if some did not
+        private static Type[] GetLoadableTypes(Assembly assembly)
+        {
+            try
+            {
+                return assembly.GetTypes();
+            }
+            catch (ReflectionTypeLoadException ex)
+            {
+                MelonLoader.MelonLogger.Error($"ReflectionTypeLoadException: {ex.Message}");
+                return ex.Types?.Where(t => t != null).Select(t => t!).ToArray() ?? Array.Empty<Type>();
+            }
+        }
+
+        internal static TypeInfo ExtractTypeInfo(Type type, bool withMembers, TypeNameCache? typeNames = null)
         {
             var typeInfo = new TypeInfo
             {
@@ -83,6 +133,15 @@ namespace UnityReflectionMod
                 IsInterface = type.IsInterface
             };
 
+            if (withMembers) ReflectMembers(type, typeInfo, typeNames);
+            return typeInfo;
+        }
+
+        // Adds the fields, methods and properties of type to its header
+        public static void ReflectMembers(Type type, TypeInfo typeInfo, TypeNameCache? typeNames = null)
+        {
+            typeNames ??= new TypeNameCache();
+
             // Extract fields
             var fields = type.GetFields(DefaultFlags);
             foreach (var field in fields)
@@ -90,7 +149,7 @@ namespace UnityReflectionMod
                 typeInfo.Fields.Add(new FieldInfo
                 {
                     Name = field.Name,
-                    FieldType = GetTypeName(field.FieldType),
+                    FieldType = typeNames.Get(field.FieldType),
                     IsPublic = field.IsPublic,
                     IsStatic = field.IsStatic,
                     IsReadOnly = field.IsInitOnly
@@ -107,7 +166,7 @@ namespace UnityReflectionMod
                 var methodInfo = new MethodInfo
                 {
                     Name = method.Name,
-                    ReturnType = GetTypeName(method.ReturnType),
+                    ReturnType = typeNames.Get(method.ReturnType),
                     IsPublic = method.IsPublic,
                     IsStatic = method.IsStatic
                 };
@@ -118,7 +177,7 @@ namespace UnityReflectionMod
                     methodInfo.Parameters.Add(new ParameterInfo
                     {
                         Name = param.Name ?? "param",
-                        ParameterType = GetTypeName(param.ParameterType)
+                        ParameterType = typeNames.Get(param.ParameterType)
                     });
                 }
 
@@ -132,16 +191,14 @@ namespace UnityReflectionMod
                 typeInfo.Properties.Add(new PropertyInfo
                 {
                     Name = property.Name,
-                    PropertyType = GetTypeName(property.PropertyType),
+                    PropertyType = typeNames.Get(property.PropertyType),
                     CanRead = property.CanRead,
                     CanWrite = property.CanWrite
                 });
             }
-
-            return typeInfo;
         }
 
-        private static string GetTypeName(Type type)
+        internal static string GetTypeName(Type type)
         {
             if (type == null) return "void";
 
@@ -160,4 +217,18 @@ namespace UnityReflectionMod
             return type.FullName ?? type.Name;
         }
     }
+
+    // Display names of member types, built once per type: the same few types
+    // recur across most members, and generic names take several allocations
+    // each. Safe to share between worker threads.
+    public class TypeNameCache
+    {
+        private readonly ConcurrentDictionary<Type, string> names = new ConcurrentDictionary<Type, string>();
+
+        public string Get(Type type)
+        {
+            if (type == null) return "void";
+            return names.GetOrAdd(type, AssemblyReflector.GetTypeName);
+        }
+    }
 }
@@ -0,0 +1,88 @@
+using System;
+using System.Buffers.Binary;
+using System.IO;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace UnityReflectionMod
+{
+    // Reads the small messages the viewer sends back (its hello and member
+    // requests). Unlike the
+    // viewer's decoder it does not resync: a bad frame ends the read.
+    public static class FrameReader
+    {
+        public const int MaxMessageSize = 64 * 1024;
+
+        // Returns the payload of the next complete message of the given kind,
+        // skipping others, or null if the stream ends first
+        public static async Task<byte[]?> ReadMessageAsync(Stream input, MessageKind kind, CancellationToken token)
+        {
+            var header = new byte[FrameWriter.HeaderSize];
+            MemoryStream? message = null;
+            uint messageId = 0;
+
+            while (true)
+            {
+                if (!await ReadExactAsync(input, header, token)) return null;
+
+                if (BinaryPrimitives.ReadUInt32LittleEndian(header) != FrameWriter.Magic ||
+                    header[4] != FrameWriter.Version ||
+                    BinaryPrimitives.ReadUInt32LittleEndian(header.AsSpan(28)) != Crc32C.Compute(header.AsSpan(0, 28)))
+                {
+                    throw new InvalidDataException("Corrupt frame header from viewer");
+                }
+
+                var type = (FrameType)header[5];
+                var frameKind = (MessageKind)BinaryPrimitives.ReadUInt16LittleEndian(header.AsSpan(6));
+                uint id = BinaryPrimitives.ReadUInt32LittleEndian(header.AsSpan(8));
+                int size = (int)Math.Min(BinaryPrimitives.ReadUInt32LittleEndian(header.AsSpan(12)), int.MaxValue);
+                ulong offset = BinaryPrimitives.ReadUInt64LittleEndian(header.AsSpan(16));
+                if (size > MaxMessageSize) throw new InvalidDataException("Oversized frame from viewer");
+
+                var payload = new byte[size];
+                if (!await ReadExactAsync(input, payload, token)) return null;
+                if (Crc32C.Compute(payload) != BinaryPrimitives.ReadUInt32LittleEndian(header.AsSpan(24)))
+                {
+                    throw new InvalidDataException("Corrupt frame payload from viewer");
+                }
+                if (frameKind != kind) continue;
+
+                switch (type)
+                {
+                    case FrameType.Begin:
+                        message = new MemoryStream();
+                        messageId = id;
+                        break;
+
+                    case FrameType.Chunk:
+                        if (message == null || id != messageId || offset != (ulong)message.Length ||
+                            message.Length + size > MaxMessageSize)
+                        {
+                            throw new InvalidDataException("Out of order frame from viewer");
+                        }
+                        message.Write(payload, 0, size);
+                        break;
+
+                    case FrameType.End:
+                        if (message == null || id != messageId || offset != (ulong)message.Length)
+                        {
+                            throw new InvalidDataException("Incomplete message from viewer");
+                        }
+                        return message.ToArray();
+                }
+            }
+        }
+
+        private static async Task<bool> ReadExactAsync(Stream input, byte[] buffer, CancellationToken token)
+        {
+            int filled = 0;
+            while (filled < buffer.Length)
+            {
+                int n = await input.ReadAsync(buffer.AsMemory(filled), token);
+                if (n == 0) return false;
+                filled += n;
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,232 @@
+using System;
+using System.Buffers.Binary;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Runtime.Intrinsics.X86;
+using ArmCrc32 = System.Runtime.Intrinsics.Arm.Crc32;
+
+namespace UnityReflectionMod
+{
+    // Frame layout shared with the viewer's frame_protocol.h. Every frame is a
+    // 32-byte little-endian header followed by its payload; a message is a Begin
+    // frame, Chunk frames of at most ChunkSize bytes and an End frame. A
+    // CompressedChunk carries the chunk's size (4 bytes) and the chunk as an
+    // LZ4 block.
+    public enum FrameType : byte
+    {
+        Begin = 1,
+        Chunk = 2,
+        End = 3,
+        CompressedChunk = 5
+    }
+
+    public enum MessageKind : ushort
+    {
+        AssemblyJson = 1,   // full snapshot
+        AssemblyDelta = 2,  // changes against the snapshot the viewer holds
+        Hello = 3,          // viewer to mod on connect
+        TypeHeaders = 4,    // query mode: the types without their members
+        MemberRequest = 5,  // query mode, viewer to mod: {"requestId":N,"types":[{"index":N},...]}
+        MemberResponse = 6, // query mode: {"requestId":N,"types":[...]}, the requested types in order
+        AssemblyBinary = 7, // full snapshot in the viewer's snapshot file format (SnapshotEncoder)
+        Progress = 8,       // reflection progress before a snapshot: {"typesDone":N,"typesTotal":N}
+        NotModified = 9     // instead of a snapshot, to a viewer holding this build's: {"moduleVersionId":"..."}
+    }
+
+    // Stream that cuts everything written to it into checksummed chunk frames,
+    // so a message of any size is sent with one chunk buffer. Dispose (or
+    // Complete) writes the End frame with the total size. With compress, each
+    // chunk that shrinks is sent LZ4 compressed.
+    public class FrameWriter : Stream
+    {
+        public const uint Magic = 0x46565255; // "URVF" little-endian
+        public const byte Version = 1;
+        public const int HeaderSize = 32;
+        public const int ChunkSize = 256 * 1024;
+
+        private readonly Stream output;
+        private readonly MessageKind kind;
+        private readonly uint messageId;
+        private readonly byte[] buffer = new byte[HeaderSize + ChunkSize];
+        private readonly Lz4Block? encoder;
+        private readonly byte[]? compressed;
+        private int buffered;
+        private ulong offset;
+        private ulong wireBytes;
+        private bool completed;
+
+        public FrameWriter(Stream output, MessageKind kind, uint messageId, bool compress = false)
+        {
+            this.output = output;
+            this.kind = kind;
+            this.messageId = messageId;
+            if (compress)
+            {
+                encoder = new Lz4Block();
+                compressed = new byte[HeaderSize + 4 + Lz4Block.MaxCompressedSize(ChunkSize)];
+            }
+
+            // The size is only known once serialization ends; it goes in the End frame
+            WriteFrame(buffer, FrameType.Begin, 0, 0);
+        }
+
+        public ulong BytesWritten => offset + (ulong)buffered;
+
+        // Also receives the message as it is written, uncompressed
+        public Stream? Copy { get; set; }
+
+        // Chunk payload bytes sent so far; fewer than BytesWritten when compressed
+        public ulong WireBytesWritten => wireBytes;
+
+        public override void Write(byte[] data, int index, int count)
+        {
+            Write(new ReadOnlySpan<byte>(data, index, count));
+        }
+
+        public override void Write(ReadOnlySpan<byte> data)
+        {
+            Copy?.Write(data);
+            while (!data.IsEmpty)
+            {
+                int n = Math.Min(ChunkSize - buffered, data.Length);
+                data.Slice(0, n).CopyTo(buffer.AsSpan(HeaderSize + buffered));
+                buffered += n;
+                data = data.Slice(n);
+
+                if (buffered == ChunkSize) WriteChunk();
+            }
+        }
+
+        public void Complete()
+        {
+            if (completed) return;
+            completed = true;
+
+            if (buffered > 0) WriteChunk();
+            WriteFrame(buffer, FrameType.End, offset, 0);
+            output.Flush();
+        }
+
+        protected override void Dispose(bool disposing)
+        {
+            if (disposing) Complete();
+            base.Dispose(disposing);
+        }
+
+        private void WriteChunk()
+        {
+            if (encoder != null && compressed != null)
+            {
+                int packed = 4 + encoder.Compress(buffer.AsSpan(HeaderSize, buffered), compressed.AsSpan(HeaderSize + 4));
+                if (packed < buffered)
+                {
+                    BinaryPrimitives.WriteUInt32LittleEndian(compressed.AsSpan(HeaderSize), (uint)buffered);
+                    WriteFrame(compressed, FrameType.CompressedChunk, offset, packed);
+                    wireBytes += (ulong)packed;
+                    offset += (ulong)buffered;
+                    buffered = 0;
+                    return;
+                }
+            }
+
+            WriteFrame(buffer, FrameType.Chunk, offset, buffered);
+            wireBytes += (ulong)buffered;
+            offset += (ulong)buffered;
+            buffered = 0;
+        }
+
+        // The payload, if any, is already in frame after the header space
+        private void WriteFrame(byte[] frame, FrameType type, ulong frameOffset, int payloadSize)
+        {
+            var header = frame.AsSpan(0, HeaderSize);
+            BinaryPrimitives.WriteUInt32LittleEndian(header, Magic);
+            header[4] = Version;
+            header[5] = (byte)type;
+            BinaryPrimitives.WriteUInt16LittleEndian(header.Slice(6), (ushort)kind);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(8), messageId);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(12), (uint)payloadSize);
+            BinaryPrimitives.WriteUInt64LittleEndian(header.Slice(16), frameOffset);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(24), Crc32C.Compute(frame.AsSpan(HeaderSize, payloadSize)));
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(28), Crc32C.Compute(header.Slice(0, 28)));
+
+            output.Write(frame, 0, HeaderSize + payloadSize);
+        }
+
+        public override void Flush() { }
+
+        public override bool CanRead => false;
+        public override bool CanSeek => false;
+        public override bool CanWrite => true;
+        public override long Length => (long)BytesWritten;
+        public override long Position
+        {
+            get => (long)BytesWritten;
+            set => throw new NotSupportedException();
+        }
+
+        public override int Read(byte[] data, int index, int count) => throw new NotSupportedException();
+        public override long Seek(long position, SeekOrigin origin) => throw new NotSupportedException();
+        public override void SetLength(long length) => throw new NotSupportedException();
+    }
+
+    // CRC32C (Castagnoli), matching Crc32c in the viewer. Uses the SSE4.2 or
+    // ARMv8 CRC instructions when the CPU has them.
+    public static class Crc32C
+    {
+        private const uint Polynomial = 0x82F63B78;
+        private static readonly uint[] Table = BuildTable();
+
+        public static uint Compute(ReadOnlySpan<byte> data, uint crc = 0)
+        {
+            crc = ~crc;
+
+            if (Sse42.X64.IsSupported)
+            {
+                ulong crc64 = crc;
+                while (data.Length >= 8)
+                {
+                    crc64 = Sse42.X64.Crc32(crc64, MemoryMarshal.Read<ulong>(data));
+                    data = data.Slice(8);
+                }
+                crc = (uint)crc64;
+            }
+            else if (Sse42.IsSupported)
+            {
+                while (data.Length >= 4)
+                {
+                    crc = Sse42.Crc32(crc, MemoryMarshal.Read<uint>(data));
+                    data = data.Slice(4);
+                }
+            }
+            else if (ArmCrc32.Arm64.IsSupported)
+            {
+                while (data.Length >= 8)
+                {
+                    crc = ArmCrc32.Arm64.ComputeCrc32C(crc, MemoryMarshal.Read<ulong>(data));
+                    data = data.Slice(8);
+                }
+            }
+
+            foreach (byte b in data)
+            {
+                crc = Table[(crc ^ b) & 0xFF] ^ (crc >> 8);
+            }
+            return ~crc;
+        }
+
+        private static uint[] BuildTable()
+        {
+            var table = new uint[256];
+            for (uint i = 0; i < 256; i++)
+            {
+                uint crc = i;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc & 1) != 0 ? (crc >> 1) ^ Polynomial : crc >> 1;
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+    }
+}
@@ -1,7 +1,9 @@
 using System;
+using System.Collections.Generic;
 using System.IO;
 using System.IO.Pipes;
 using System.Text;
+using System.Text.Json;
 using System.Threading;
 using System.Threading.Tasks;
 
@@ -10,9 +12,17 @@ namespace UnityReflectionMod
     public class IPCServer
     {
         private const string PipeName = "UnityReflectionPipe";
+        private const int HelloTimeoutMs = 250;
+        private const bool EnableCompression = true; // LZ4 chunks, for viewers that offer them
         private NamedPipeServerStream? pipeServer;
         private bool isRunning;
         private Thread? serverThread;
+        private uint messageId;
+        private readonly SnapshotHistory history = new SnapshotHistory();
+        private readonly SnapshotCache snapshotCache = new SnapshotCache();
+
+        // CPU the reflection pass may take from the game; set before Start
+        public ReflectionBudget ReflectionBudget { get; } = new ReflectionBudget();
 
         public event Action<string>? OnLog;
         public event Action<string>? OnError;
@@ -57,7 +67,7 @@ namespace UnityReflectionMod
                 {
                     using (pipeServer = new NamedPipeServerStream(
                         PipeName,
-                        PipeDirection.Out,
+                        PipeDirection.InOut,
                         1,
                         PipeTransmissionMode.Byte,
                         PipeOptions.Asynchronous))
@@ -70,21 +80,30 @@ namespace UnityReflectionMod
 
                         Log("Client connected!");
 
-                        // Get reflection data
-                        var data = AssemblyReflector.ReflectAssemblyCSharp();
-
-                        // Serialize to JSON
-                        string json = SerializeToJson(data);
-
-                        // Send data
-                        byte[] buffer = Encoding.UTF8.GetBytes(json);
-                        byte[] lengthPrefix = BitConverter.GetBytes(buffer.Length);
-
-                        pipeServer.Write(lengthPrefix, 0, lengthPrefix.Length);
-                        pipeServer.Write(buffer, 0, buffer.Length);
-                        pipeServer.Flush();
+                        // A viewer in query mode gets the type headers and asks
+                        // for members as it needs them
+                        var hello = ReadHello(pipeServer);
+                        bool compress = EnableCompression && hello.Compress;
+                        if (hello.Query)
+                        {
+                            ServeQueries(pipeServer, compress);
+                            continue;
+                        }
 
-                        Log($"Sent {buffer.Length} bytes to client");
+                        // A viewer holding a snapshot of the build the game
+                        // runs needs nothing, as the assembly cannot change
+                        // while it does
+                        string moduleVersionId = AssemblyReflector.GetModuleVersionIdCSharp();
+                        if (moduleVersionId.Length > 0 && (hello.ModuleVersionId == moduleVersionId ||
+                                                           snapshotCache.Contains(moduleVersionId, hello.SnapshotId)))
+                        {
+                            SendNotModified(pipeServer, moduleVersionId);
+                            Log($"Client already holds the snapshot of module version {moduleVersionId}");
+                        }
+                        else
+                        {
+                            SendSnapshot(pipeServer, hello, compress, moduleVersionId);
+                        }
 
                         Thread.Sleep(500); // Give client time to read
                     }
@@ -100,94 +119,426 @@ namespace UnityReflectionMod
             }
         }
 
-        private string SerializeToJson(AssemblyData data)
+        // A full snapshot, from the cache if this build's was sent before, or
+        // a delta against the snapshot the viewer holds
+        private void SendSnapshot(Stream pipe, ViewerHello hello, bool compress, string moduleVersionId)
         {
-            // Simple JSON serialization without dependencies
-            var sb = new StringBuilder();
-            sb.Append("{");
-            sb.Append($"\"assemblyName\":\"{EscapeJson(data.AssemblyName)}\",");
-            sb.Append($"\"timestamp\":\"{data.Timestamp:O}\",");
-            sb.Append("\"types\":[");
+            // A viewer still holding the snapshot sent last gets only what
+            // changed since; a full snapshot goes in the binary format to
+            // viewers that read it
+            var kind = history.CanDeltaFrom(hello.SnapshotId) ? MessageKind.AssemblyDelta
+                : hello.Binary ? MessageKind.AssemblyBinary
+                : MessageKind.AssemblyJson;
+
+            var cached = kind == MessageKind.AssemblyDelta ? null : snapshotCache.Find(moduleVersionId, kind);
+            if (cached != null)
+            {
+                if (hello.Progress) SendProgress(pipe, cached.TypeCount, cached.TypeCount);
+                using (var frames = new FrameWriter(pipe, kind, ++messageId, compress))
+                {
+                    frames.Write(cached.Payload, 0, cached.Length);
+                    frames.Complete();
+                    Log($"Sent cached snapshot ({Describe(frames)}) to client");
+                }
+                return;
+            }
+
+            // Types are reflected on worker threads within the budget. JSON is
+            // serialized into checksummed frames as they come, so the viewer
+            // shows the first types while the rest are reflected and the
+            // payload is never held whole. A delta and the binary image need
+            // every type first; the viewer gets progress reports meanwhile.
+            var snapshot = history.Begin();
+            var copy = kind == MessageKind.AssemblyDelta || moduleVersionId.Length == 0 ? null : new MemoryStream();
+            string size;
+            int typeCount;
+            using (var pipeline = AssemblyReflector.StartReflectingCSharp(ReflectionBudget))
+            {
+                typeCount = pipeline.TypeCount;
+                var data = new AssemblyData
+                {
+                    AssemblyName = pipeline.AssemblyName,
+                    ModuleVersionId = moduleVersionId,
+                    Timestamp = DateTime.Now
+                };
+                Action<int, int>? progress = null;
+                if (hello.Progress)
+                {
+                    progress = (done, total) => SendProgress(pipe, done, total);
+                    progress(0, pipeline.TypeCount);
+                }
+                if (kind != MessageKind.AssemblyJson)
+                {
+                    pipeline.Drain(data.Types.Add, progress);
+                }
+
+                using (var frames = new FrameWriter(pipe, kind, ++messageId, compress) { Copy = copy })
+                {
+                    if (kind == MessageKind.AssemblyBinary)
+                    {
+                        SerializeToBinary(data, snapshot, frames);
+                    }
+                    else
+                    {
+                        using (var writer = new StreamWriter(frames, new UTF8Encoding(false), 64 * 1024, leaveOpen: true))
+                        {
+                            if (kind == MessageKind.AssemblyDelta)
+                            {
+                                SerializeDelta(data, hello.SnapshotId, snapshot, writer);
+                            }
+                            else
+                            {
+                                SerializeToJson(data, pipeline, snapshot, writer);
+                            }
+                        }
+                    }
+                    frames.Complete();
+                    size = Describe(frames);
+                }
+            }
+            history.Commit(snapshot);
+            if (copy != null) snapshotCache.Add(moduleVersionId, kind, copy, snapshot.Id, typeCount);
+
+            Log(kind == MessageKind.AssemblyDelta
+                ? $"Sent delta against snapshot {hello.SnapshotId} ({size}) to client"
+                : $"Sent {size} to client");
+        }
+
+        private static string Describe(FrameWriter frames)
+        {
+            ulong sent = frames.BytesWritten;
+            ulong wire = frames.WireBytesWritten;
+            return wire < sent ? $"{sent} bytes, {wire} compressed" : $"{sent} bytes";
+        }
+
+        // What a viewer's hello asked for; everything is off for viewers that
+        // predate the hello
+        private class ViewerHello
+        {
+            public string SnapshotId { get; set; } = string.Empty; // the snapshot it holds
+            public string ModuleVersionId { get; set; } = string.Empty; // the build that snapshot is of
+            public bool Compress { get; set; }                     // accepts LZ4 chunks
+            public bool Query { get; set; }                        // wants query mode
+            public bool Binary { get; set; }                       // reads the binary snapshot format
+            public bool Progress { get; set; }                     // reads progress reports
+        }
+
+        // Viewers that predate the hello never send one, so it is only waited
+        // for briefly
+        private ViewerHello ReadHello(Stream pipe)
+        {
+            var result = new ViewerHello();
+            try
+            {
+                using (var timeout = new CancellationTokenSource(HelloTimeoutMs))
+                {
+                    var hello = FrameReader.ReadMessageAsync(pipe, MessageKind.Hello, timeout.Token).GetAwaiter().GetResult();
+                    if (hello == null) return result;
+
+                    using (var json = JsonDocument.Parse(hello))
+                    {
+                        var root = json.RootElement;
+                        if (root.TryGetProperty("compression", out var codecs) && codecs.ValueKind == JsonValueKind.Array)
+                        {
+                            foreach (var codec in codecs.EnumerateArray())
+                            {
+                                if (codec.ValueKind == JsonValueKind.String && codec.GetString() == "lz4") result.Compress = true;
+                            }
+                        }
+                        result.Query = root.TryGetProperty("query", out var mode) && mode.ValueKind == JsonValueKind.True;
+                        result.Binary = root.TryGetProperty("binary", out var format) && format.ValueKind == JsonValueKind.True;
+                        result.Progress = root.TryGetProperty("progress", out var progress) && progress.ValueKind == JsonValueKind.True;
+                        result.SnapshotId = root.TryGetProperty("snapshotId", out var id) ? id.GetString() ?? string.Empty : string.Empty;
+                        result.ModuleVersionId = root.TryGetProperty("moduleVersionId", out var build) && build.ValueKind == JsonValueKind.String
+                            ? build.GetString() ?? string.Empty
+                            : string.Empty;
+                    }
+                }
+            }
+            catch (OperationCanceledException)
+            {
+            }
+            catch (Exception ex) when (ex is InvalidDataException || ex is JsonException)
+            {
+                LogError($"Ignoring bad hello from client: {ex.Message}");
+                return new ViewerHello();
+            }
+            return result;
+        }
+
+        // {"typesDone":N,"typesTotal":N}, between messages of the snapshot's
+        // connection; too small to be worth compressing
+        private void SendProgress(Stream pipe, int done, int total)
+        {
+            using (var frames = new FrameWriter(pipe, MessageKind.Progress, ++messageId))
+            {
+                var json = Encoding.UTF8.GetBytes($"{{\"typesDone\":{done},\"typesTotal\":{total}}}");
+                frames.Write(json, 0, json.Length);
+                frames.Complete();
+            }
+        }
+
+        // {"moduleVersionId":"..."}, instead of a snapshot
+        private void SendNotModified(Stream pipe, string moduleVersionId)
+        {
+            using (var frames = new FrameWriter(pipe, MessageKind.NotModified, ++messageId))
+            {
+                var json = Encoding.UTF8.GetBytes($"{{\"moduleVersionId\":\"{EscapeJson(moduleVersionId)}\"}}");
+                frames.Write(json, 0, json.Length);
+                frames.Complete();
+            }
+        }
+
+        // Query mode: the type headers, then the members of whichever types the
+        // viewer asks for, until it disconnects. A type's members are reflected
+        // the first time they are asked for and kept for the connection.
+        private void ServeQueries(Stream pipe, bool compress)
+        {
+            var types = new List<Type>();
+            var headers = AssemblyReflector.ReflectTypeHeadersCSharp(types);
+            var reflected = new bool[headers.Types.Count];
+            var typeNames = new TypeNameCache();
+
+            using (var frames = new FrameWriter(pipe, MessageKind.TypeHeaders, ++messageId, compress))
+            {
+                using (var writer = new StreamWriter(frames, new UTF8Encoding(false), 64 * 1024, leaveOpen: true))
+                {
+                    SerializeHeaders(headers, writer);
+                }
+                frames.Complete();
+            }
+            Log($"Sent {headers.Types.Count} type headers to client");
+
+            int requests = 0;
+            while (isRunning)
+            {
+                var request = FrameReader.ReadMessageAsync(pipe, MessageKind.MemberRequest, CancellationToken.None).GetAwaiter().GetResult();
+                if (request == null) break; // the viewer disconnected
+
+                uint requestId;
+                var indices = new List<int>();
+                try
+                {
+                    using (var json = JsonDocument.Parse(request))
+                    {
+                        requestId = json.RootElement.GetProperty("requestId").GetUInt32();
+                        foreach (var entry in json.RootElement.GetProperty("types").EnumerateArray())
+                        {
+                            indices.Add(entry.TryGetProperty("index", out var index) && index.TryGetInt32(out int i) ? i : -1);
+                        }
+                    }
+                }
+                catch (Exception ex) when (ex is JsonException || ex is KeyNotFoundException ||
+                                           ex is InvalidOperationException || ex is FormatException)
+                {
+                    LogError($"Ignoring bad member request from client: {ex.Message}");
+                    continue;
+                }
+
+                // The requested types in order; an index out of range gets {}
+                using (var frames = new FrameWriter(pipe, MessageKind.MemberResponse, ++messageId, compress))
+                {
+                    using (var writer = new StreamWriter(frames, new UTF8Encoding(false), 64 * 1024, leaveOpen: true))
+                    {
+                        writer.Write($"{{\"requestId\":{requestId},\"types\":[");
+                        for (int i = 0; i < indices.Count; i++)
+                        {
+                            if (i > 0) writer.Write(",");
+                            int index = indices[i];
+                            if (index < 0 || index >= headers.Types.Count)
+                            {
+                                writer.Write("{}");
+                                continue;
+                            }
+                            if (!reflected[index])
+                            {
+                                try
+                                {
+                                    AssemblyReflector.ReflectMembers(types[index], headers.Types[index], typeNames);
+                                }
+                                catch (Exception ex)
+                                {
+                                    LogError($"Failed to reflect members of {headers.Types[index].FullName}: {ex.Message}");
+                                }
+                                reflected[index] = true;
+                            }
+                            SerializeType(writer, headers.Types[index]);
+                        }
+                        writer.Write("]}");
+                    }
+                    frames.Complete();
+                }
+                requests++;
+            }
+            Log($"Served {requests} member requests");
+        }
+
+        // The full snapshot's format without member arrays, and without a
+        // snapshotId since the members are not hashed
+        private void SerializeHeaders(AssemblyData data, TextWriter writer)
+        {
+            writer.Write("{");
+            writer.Write($"\"assemblyName\":\"{EscapeJson(data.AssemblyName)}\",");
+            writer.Write($"\"timestamp\":\"{data.Timestamp:O}\",");
+            writer.Write("\"types\":[");
 
             for (int i = 0; i < data.Types.Count; i++)
             {
-                if (i > 0) sb.Append(",");
-                SerializeType(sb, data.Types[i]);
+                if (i > 0) writer.Write(",");
+                SerializeTypeHeader(writer, data.Types[i]);
+                writer.Write("}");
             }
 
-            sb.Append("]}");
-            return sb.ToString();
+            writer.Write("]}");
         }
 
-        private void SerializeType(StringBuilder sb, TypeInfo type)
+        // The header comes from data, the types from pipeline as they are reflected
+        private void SerializeToJson(AssemblyData data, ReflectionPipeline pipeline, SnapshotBuilder snapshot, TextWriter writer)
         {
-            sb.Append("{");
-            sb.Append($"\"name\":\"{EscapeJson(type.Name)}\",");
-            sb.Append($"\"fullName\":\"{EscapeJson(type.FullName)}\",");
-            sb.Append($"\"namespace\":\"{EscapeJson(type.Namespace)}\",");
-            sb.Append($"\"baseType\":\"{EscapeJson(type.BaseType)}\",");
-            sb.Append($"\"isClass\":{(type.IsClass ? "true" : "false")},");
-            sb.Append($"\"isStruct\":{(type.IsStruct ? "true" : "false")},");
-            sb.Append($"\"isEnum\":{(type.IsEnum ? "true" : "false")},");
-            sb.Append($"\"isInterface\":{(type.IsInterface ? "true" : "false")},");
+            // Simple JSON serialization without dependencies
+            writer.Write("{");
+            writer.Write($"\"assemblyName\":\"{EscapeJson(data.AssemblyName)}\",");
+            writer.Write($"\"timestamp\":\"{data.Timestamp:O}\",");
+            writer.Write($"\"moduleVersionId\":\"{EscapeJson(data.ModuleVersionId)}\",");
+            writer.Write("\"types\":[");
+
+            bool first = true;
+            pipeline.Drain(type =>
+            {
+                if (!first) writer.Write(",");
+                first = false;
+                snapshot.Add(type);
+                SerializeType(writer, type);
+            });
+
+            // Last, since it hashes every type
+            writer.Write($"],\"snapshotId\":\"{snapshot.Id}\"}}");
+        }
+
+        // Same keys as the full snapshot, plus the base it applies to and the
+        // full names of removed types; "types" holds added and modified types
+        private void SerializeDelta(AssemblyData data, string baseSnapshotId, SnapshotBuilder snapshot, TextWriter writer)
+        {
+            var changed = new List<TypeInfo>();
+            foreach (var type in data.Types)
+            {
+                if (snapshot.Add(type)) changed.Add(type);
+            }
+
+            writer.Write("{");
+            writer.Write($"\"assemblyName\":\"{EscapeJson(data.AssemblyName)}\",");
+            writer.Write($"\"timestamp\":\"{data.Timestamp:O}\",");
+            writer.Write($"\"moduleVersionId\":\"{EscapeJson(data.ModuleVersionId)}\",");
+            writer.Write($"\"baseSnapshotId\":\"{EscapeJson(baseSnapshotId)}\",");
+
+            writer.Write("\"removed\":[");
+            var removed = history.RemovedIn(snapshot);
+            for (int i = 0; i < removed.Count; i++)
+            {
+                if (i > 0) writer.Write(",");
+                writer.Write($"{{\"fullName\":\"{EscapeJson(removed[i])}\"}}");
+            }
+
+            writer.Write("],\"types\":[");
+            for (int i = 0; i < changed.Count; i++)
+            {
+                if (i > 0) writer.Write(",");
+                SerializeType(writer, changed[i]);
+            }
+            writer.Write($"],\"snapshotId\":\"{snapshot.Id}\"}}");
+        }
+
+        // The same snapshot in the viewer's snapshot file format. Strings are
+        // written once and unescaped, and nothing goes through a TextWriter.
+        private void SerializeToBinary(AssemblyData data, SnapshotBuilder snapshot, Stream output)
+        {
+            var encoder = new SnapshotEncoder();
+            foreach (var type in data.Types)
+            {
+                snapshot.Add(type);
+                encoder.AddType(type);
+            }
+
+            var image = encoder.Finish(data.AssemblyName, data.Timestamp.ToString("O"), snapshot.Id, data.ModuleVersionId);
+            output.Write(image, 0, image.Length);
+        }
+
+        private void SerializeType(TextWriter writer, TypeInfo type)
+        {
+            SerializeTypeHeader(writer, type);
+            writer.Write(",");
 
             // Fields
-            sb.Append("\"fields\":[");
+            writer.Write("\"fields\":[");
             for (int i = 0; i < type.Fields.Count; i++)
             {
-                if (i > 0) sb.Append(",");
+                if (i > 0) writer.Write(",");
                 var field = type.Fields[i];
-                sb.Append("{");
-                sb.Append($"\"name\":\"{EscapeJson(field.Name)}\",");
-                sb.Append($"\"fieldType\":\"{EscapeJson(field.FieldType)}\",");
-                sb.Append($"\"isPublic\":{(field.IsPublic ? "true" : "false")},");
-                sb.Append($"\"isStatic\":{(field.IsStatic ? "true" : "false")},");
-                sb.Append($"\"isReadOnly\":{(field.IsReadOnly ? "true" : "false")}");
-                sb.Append("}");
+                writer.Write("{");
+                writer.Write($"\"name\":\"{EscapeJson(field.Name)}\",");
+                writer.Write($"\"fieldType\":\"{EscapeJson(field.FieldType)}\",");
+                writer.Write($"\"isPublic\":{(field.IsPublic ? "true" : "false")},");
+                writer.Write($"\"isStatic\":{(field.IsStatic ? "true" : "false")},");
+                writer.Write($"\"isReadOnly\":{(field.IsReadOnly ? "true" : "false")}");
+                writer.Write("}");
             }
-            sb.Append("],");
+            writer.Write("],");
 
             // Methods
-            sb.Append("\"methods\":[");
+            writer.Write("\"methods\":[");
             for (int i = 0; i < type.Methods.Count; i++)
             {
-                if (i > 0) sb.Append(",");
+                if (i > 0) writer.Write(",");
                 var method = type.Methods[i];
-                sb.Append("{");
-                sb.Append($"\"name\":\"{EscapeJson(method.Name)}\",");
-                sb.Append($"\"returnType\":\"{EscapeJson(method.ReturnType)}\",");
-                sb.Append($"\"isPublic\":{(method.IsPublic ? "true" : "false")},");
-                sb.Append($"\"isStatic\":{(method.IsStatic ? "true" : "false")},");
-                sb.Append("\"parameters\":[");
+                writer.Write("{");
+                writer.Write($"\"name\":\"{EscapeJson(method.Name)}\",");
+                writer.Write($"\"returnType\":\"{EscapeJson(method.ReturnType)}\",");
+                writer.Write($"\"isPublic\":{(method.IsPublic ? "true" : "false")},");
+                writer.Write($"\"isStatic\":{(method.IsStatic ? "true" : "false")},");
+                writer.Write("\"parameters\":[");
                 for (int j = 0; j < method.Parameters.Count; j++)
                 {
-                    if (j > 0) sb.Append(",");
+                    if (j > 0) writer.Write(",");
                     var param = method.Parameters[j];
-                    sb.Append("{");
-                    sb.Append($"\"name\":\"{EscapeJson(param.Name)}\",");
-                    sb.Append($"\"parameterType\":\"{EscapeJson(param.ParameterType)}\"");
-                    sb.Append("}");
+                    writer.Write("{");
+                    writer.Write($"\"name\":\"{EscapeJson(param.Name)}\",");
+                    writer.Write($"\"parameterType\":\"{EscapeJson(param.ParameterType)}\"");
+                    writer.Write("}");
                 }
-                sb.Append("]}");
+                writer.Write("]}");
             }
-            sb.Append("],");
+            writer.Write("],");
 
             // Properties
-            sb.Append("\"properties\":[");
+            writer.Write("\"properties\":[");
             for (int i = 0; i < type.Properties.Count; i++)
             {
-                if (i > 0) sb.Append(",");
+                if (i > 0) writer.Write(",");
                 var prop = type.Properties[i];
-                sb.Append("{");
-                sb.Append($"\"name\":\"{EscapeJson(prop.Name)}\",");
-                sb.Append($"\"propertyType\":\"{EscapeJson(prop.PropertyType)}\",");
-                sb.Append($"\"canRead\":{(prop.CanRead ? "true" : "false")},");
-                sb.Append($"\"canWrite\":{(prop.CanWrite ? "true" : "false")}");
-                sb.Append("}");
+                writer.Write("{");
+                writer.Write($"\"name\":\"{EscapeJson(prop.Name)}\",");
+                writer.Write($"\"propertyType\":\"{EscapeJson(prop.PropertyType)}\",");
+                writer.Write($"\"canRead\":{(prop.CanRead ? "true" : "false")},");
+                writer.Write($"\"canWrite\":{(prop.CanWrite ? "true" : "false")}");
+                writer.Write("}");
             }
-            sb.Append("]");
+            writer.Write("]");
 
-            sb.Append("}");
+            writer.Write("}");
+        }
+
+        // The keys before the member arrays, leaving the object open
+        private void SerializeTypeHeader(TextWriter writer, TypeInfo type)
+        {
+            writer.Write("{");
+            writer.Write($"\"name\":\"{EscapeJson(type.Name)}\",");
+            writer.Write($"\"fullName\":\"{EscapeJson(type.FullName)}\",");
+            writer.Write($"\"namespace\":\"{EscapeJson(type.Namespace)}\",");
+            writer.Write($"\"baseType\":\"{EscapeJson(type.BaseType)}\",");
+            writer.Write($"\"isClass\":{(type.IsClass ? "true" : "false")},");
+            writer.Write($"\"isStruct\":{(type.IsStruct ? "true" : "false")},");
+            writer.Write($"\"isEnum\":{(type.IsEnum ? "true" : "false")},");
+            writer.Write($"\"isInterface\":{(type.IsInterface ? "true" : "false")}");
         }
 
         private string EscapeJson(string str)
@@ -0,0 +1,123 @@
+using System;
+using System.Numerics;
+using System.Runtime.InteropServices;
+
+namespace UnityReflectionMod
+{
+    // LZ4 block encoder, the format the viewer's Lz4Decompress reads (described
+    // in its lz4_block.h). FrameWriter compresses each chunk as one block. Not
+    // thread safe: the hash table is reused from block to block.
+    public class Lz4Block
+    {
+        private const int MinMatch = 4;
+        private const int LastLiterals = 5; // the block ends with at least this many literals
+        private const int MfLimit = 12;     // no match starts in the last 12 bytes
+        private const int MaxOffset = 65535;
+        private const int HashLog = 14;
+        private const int SkipShift = 6;    // the step grows by one every 64 bytes without a match
+
+        // Position + 1 of the last 4-byte sequence with each hash; 0 is empty
+        private readonly int[] table = new int[1 << HashLog];
+
+        public static int MaxCompressedSize(int size) => size + size / 255 + 16;
+
+        // dst must hold MaxCompressedSize(src.Length) bytes; returns the compressed size
+        public int Compress(ReadOnlySpan<byte> src, Span<byte> dst)
+        {
+            int op = 0;
+            int anchor = 0;
+
+            if (src.Length >= MfLimit + 1)
+            {
+                Array.Clear(table, 0, table.Length);
+                int mfLimit = src.Length - MfLimit;
+                int matchLimit = src.Length - LastLiterals;
+
+                int pos = 0;
+                while (pos < mfLimit)
+                {
+                    uint sequence = Read32(src, pos);
+                    int hash = Hash(sequence);
+                    int candidate = table[hash];
+                    table[hash] = pos + 1;
+                    if (candidate == 0 || pos + 1 - candidate > MaxOffset || Read32(src, candidate - 1) != sequence)
+                    {
+                        pos += 1 + ((pos - anchor) >> SkipShift);
+                        continue;
+                    }
+
+                    int match = candidate - 1;
+                    while (pos > anchor && match > 0 && src[pos - 1] == src[match - 1])
+                    {
+                        pos--;
+                        match--;
+                    }
+                    int length = MinMatch + MatchLength(src, pos + MinMatch, match + MinMatch, matchLimit);
+                    op = WriteSequence(src.Slice(anchor, pos - anchor), pos - match, length, dst, op);
+                    pos += length;
+                    anchor = pos;
+
+                    // Also index a position inside the match, which finds more of
+                    // the repeats that follow one another in JSON
+                    if (pos - 2 < mfLimit) table[Hash(Read32(src, pos - 2))] = pos - 1;
+                }
+            }
+
+            return WriteSequence(src.Slice(anchor), 0, 0, dst, op);
+        }
+
+        private static uint Read32(ReadOnlySpan<byte> data, int pos) => MemoryMarshal.Read<uint>(data.Slice(pos));
+
+        private static int Hash(uint sequence) => (int)((sequence * 2654435761u) >> (32 - HashLog));
+
+        // Number of equal bytes at pos and match, stopping at limit
+        private static int MatchLength(ReadOnlySpan<byte> src, int pos, int match, int limit)
+        {
+            int start = pos;
+            while (pos + 8 <= limit)
+            {
+                ulong diff = MemoryMarshal.Read<ulong>(src.Slice(pos)) ^ MemoryMarshal.Read<ulong>(src.Slice(match));
+                if (diff != 0) return pos - start + BitOperations.TrailingZeroCount(diff) / 8;
+                pos += 8;
+                match += 8;
+            }
+            while (pos < limit && src[pos] == src[match])
+            {
+                pos++;
+                match++;
+            }
+            return pos - start;
+        }
+
+        // Writes the literals and, when matchLength > 0, the match after them
+        private static int WriteSequence(ReadOnlySpan<byte> literals, int offset, int matchLength, Span<byte> dst, int op)
+        {
+            int token = op++;
+            dst[token] = (byte)(Math.Min(literals.Length, 15) << 4);
+            if (literals.Length >= 15) op = WriteLength(dst, op, literals.Length);
+            literals.CopyTo(dst.Slice(op));
+            op += literals.Length;
+            if (matchLength == 0) return op;
+
+            dst[op++] = (byte)offset;
+            dst[op++] = (byte)(offset >> 8);
+            int extra = matchLength - MinMatch;
+            dst[token] |= (byte)Math.Min(extra, 15);
+            if (extra >= 15) op = WriteLength(dst, op, extra);
+            return op;
+        }
+
+        // The bytes after a nibble of 15
+        private static int WriteLength(Span<byte> dst, int op, int length)
+        {
+            length -= 15;
+            while (length >= 255)
+            {
+                dst[op++] = 255;
+                length -= 255;
+            }
+            dst[op++] = (byte)length;
+            return op;
+        }
+    }
+}
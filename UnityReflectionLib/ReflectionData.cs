@@ -59,6 +59,7 @@ namespace UnityReflectionMod
     public class AssemblyData
     {
         public string AssemblyName { get; set; } = string.Empty;
+        public string ModuleVersionId { get; set; } = string.Empty; // MVID, new with every build
         public List<TypeInfo> Types { get; set; } = new List<TypeInfo>();
         public DateTime Timestamp { get; set; }
     }
@@ -0,0 +1,137 @@
+using System;
+using System.Buffers;
+using System.Diagnostics;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace UnityReflectionMod
+{
+    // Limits on a reflection pass, so a connected viewer does not cost the game
+    // frames. Each worker reflects for SliceMs, then sleeps for PauseMs, which
+    // caps it at SliceMs / (SliceMs + PauseMs) of a core.
+    public class ReflectionBudget
+    {
+        public int MaxWorkers { get; set; } = Math.Max(1, Environment.ProcessorCount / 2);
+        public int BatchSize { get; set; } = 128;         // types per work item
+        public int SliceMs { get; set; } = 4;
+        public int PauseMs { get; set; } = 2;
+        public int ProgressIntervalMs { get; set; } = 100; // between progress reports
+    }
+
+    // Reflects a list of types on worker threads, a batch at a time, and hands
+    // the results to the calling thread in the original order as each batch
+    // completes. The workers start in the constructor; Dispose stops them.
+    public sealed class ReflectionPipeline : IDisposable
+    {
+        private readonly Type[] types;
+        private readonly ReflectionBudget budget;
+        private readonly TypeInfo?[] results; // pooled; entries are cleared as they are handed out
+        private readonly bool[] batchDone;
+        private readonly object gate = new object();
+        private readonly CancellationTokenSource cancel = new CancellationTokenSource();
+        private readonly TypeNameCache typeNames = new TypeNameCache();
+        private readonly Task workers;
+        private int typesDone;
+        private bool disposed;
+
+        public ReflectionPipeline(string assemblyName, Type[] types, ReflectionBudget budget)
+        {
+            AssemblyName = assemblyName;
+            this.types = types;
+            this.budget = budget;
+            results = ArrayPool<TypeInfo?>.Shared.Rent(types.Length);
+            batchDone = new bool[(types.Length + budget.BatchSize - 1) / budget.BatchSize];
+
+            var options = new ParallelOptions
+            {
+                MaxDegreeOfParallelism = Math.Max(1, budget.MaxWorkers),
+                CancellationToken = cancel.Token
+            };
+            workers = Task.Run(() =>
+            {
+                try
+                {
+                    Parallel.For(0, batchDone.Length, options, Stopwatch.StartNew, ReflectBatch, _ => { });
+                }
+                catch (OperationCanceledException)
+                {
+                }
+            });
+        }
+
+        public string AssemblyName { get; }
+        public int TypeCount => types.Length;
+        public int TypesDone => Volatile.Read(ref typesDone);
+
+        // Calls onType for every type reflected, in type order, as soon as its
+        // batch is done; types that failed to reflect are skipped. While waiting
+        // for a batch, calls onWaiting(typesDone, TypeCount) every
+        // ProgressIntervalMs. Both run on the calling thread.
+        public void Drain(Action<TypeInfo> onType, Action<int, int>? onWaiting = null)
+        {
+            for (int batch = 0; batch < batchDone.Length; batch++)
+            {
+                lock (gate)
+                {
+                    while (!batchDone[batch])
+                    {
+                        if (workers.IsCompleted)
+                        {
+                            throw new InvalidOperationException("Reflection stopped before every type was done");
+                        }
+                        if (!Monitor.Wait(gate, budget.ProgressIntervalMs)) onWaiting?.Invoke(TypesDone, TypeCount);
+                    }
+                }
+
+                int end = Math.Min(types.Length, (batch + 1) * budget.BatchSize);
+                for (int i = batch * budget.BatchSize; i < end; i++)
+                {
+                    var type = results[i];
+                    results[i] = null;
+                    if (type != null) onType(type);
+                }
+            }
+        }
+
+        public void Dispose()
+        {
+            if (disposed) return;
+            disposed = true;
+
+            cancel.Cancel();
+            workers.Wait();
+            cancel.Dispose();
+            ArrayPool<TypeInfo?>.Shared.Return(results, clearArray: true);
+        }
+
+        private Stopwatch ReflectBatch(int batch, ParallelLoopState loop, Stopwatch slice)
+        {
+            int end = Math.Min(types.Length, (batch + 1) * budget.BatchSize);
+            for (int i = batch * budget.BatchSize; i < end && !cancel.IsCancellationRequested; i++)
+            {
+                try
+                {
+                    results[i] = AssemblyReflector.ExtractTypeInfo(types[i], true, typeNames);
+                }
+                catch (Exception ex)
+                {
+                    MelonLoader.MelonLogger.Warning($"Failed to reflect type {types[i].FullName}: {ex.Message}");
+                }
+
+                if (slice.ElapsedMilliseconds >= budget.SliceMs)
+                {
+                    Thread.Sleep(budget.PauseMs);
+                    slice.Restart();
+                }
+            }
+
+            lock (gate)
+            {
+                batchDone[batch] = true;
+                typesDone += end - batch * budget.BatchSize;
+                Monitor.PulseAll(gate);
+            }
+            return slice;
+        }
+    }
+}
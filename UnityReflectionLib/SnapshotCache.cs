@@ -0,0 +1,65 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+
+namespace UnityReflectionMod
+{
+    // Snapshots as serialized for the pipe, keyed by the module version id
+    // (MVID) of the Assembly-CSharp build they were reflected from and by
+    // format. The assembly cannot change while the game runs, so a viewer that
+    // connects again is sent these bytes instead of a new reflection pass.
+    public class SnapshotCache
+    {
+        private readonly Dictionary<MessageKind, CachedSnapshot> snapshots = new Dictionary<MessageKind, CachedSnapshot>();
+        private string moduleVersionId = string.Empty; // of every snapshot held
+
+        // Larger snapshots are not kept; the game holds every one that is
+        public long MaxBytes { get; set; } = 256L * 1024 * 1024;
+
+        public CachedSnapshot? Find(string moduleVersionId, MessageKind kind)
+        {
+            if (moduleVersionId.Length == 0 || moduleVersionId != this.moduleVersionId) return null;
+            return snapshots.TryGetValue(kind, out var snapshot) ? snapshot : null;
+        }
+
+        // True if a snapshot of this build had this id, in either format
+        public bool Contains(string moduleVersionId, string snapshotId)
+        {
+            if (moduleVersionId.Length == 0 || moduleVersionId != this.moduleVersionId) return false;
+            foreach (var snapshot in snapshots.Values)
+            {
+                if (snapshotId.Length > 0 && snapshot.SnapshotId == snapshotId) return true;
+            }
+            return false;
+        }
+
+        // Keeps payload's buffer, which must not be written to afterwards.
+        // Snapshots of another build are dropped.
+        public void Add(string moduleVersionId, MessageKind kind, MemoryStream payload, string snapshotId, int typeCount)
+        {
+            if (moduleVersionId.Length == 0 || payload.Length > MaxBytes) return;
+            if (moduleVersionId != this.moduleVersionId)
+            {
+                snapshots.Clear();
+                this.moduleVersionId = moduleVersionId;
+            }
+            snapshots[kind] = new CachedSnapshot(payload.GetBuffer(), (int)payload.Length, snapshotId, typeCount);
+        }
+    }
+
+    public class CachedSnapshot
+    {
+        public CachedSnapshot(byte[] payload, int length, string snapshotId, int typeCount)
+        {
+            Payload = payload;
+            Length = length;
+            SnapshotId = snapshotId;
+            TypeCount = typeCount;
+        }
+
+        public byte[] Payload { get; }   // the message as written to a FrameWriter, uncompressed
+        public int Length { get; }       // bytes of Payload in use
+        public string SnapshotId { get; }
+        public int TypeCount { get; }
+    }
+}
@@ -0,0 +1,235 @@
+using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.Text;
+
+namespace UnityReflectionMod
+{
+    // Builds an assembly in the viewer's snapshot file format (snapshot_file.h),
+    // which it reads in place and keeps as its cache: a header, a string table
+    // holding every name once, then arrays of fixed-size records of 4-byte
+    // little-endian fields. Records refer to strings by index and to their
+    // members by ranges in the member arrays. Sent as MessageKind.AssemblyBinary
+    // to viewers whose hello offers it.
+    public class SnapshotEncoder
+    {
+        private static readonly byte[] Magic = { (byte)'U', (byte)'R', (byte)'V', (byte)'S', (byte)'N', (byte)'A', (byte)'P', 0 };
+        private const uint Version = 3;
+        private const uint ByteOrderMark = 0x01020304;
+        private const int HeaderSize = 160;
+        private const int SectionAlignment = 8;
+
+        // Words per record: type, field, method, parameter, property
+        private const int TypeWords = 11;
+        private const int FieldWords = 3;
+        private const int MethodWords = 5;
+        private const int ParameterWords = 2;
+        private const int PropertyWords = 3;
+
+        // Bits of the records' flags words
+        private const uint Public = 1u << 0;
+        private const uint Static = 1u << 1;
+        private const uint ReadOnly = 1u << 2;
+        private const uint CanRead = 1u << 3;
+        private const uint CanWrite = 1u << 4;
+        private const uint Class = 1u << 5;
+        private const uint Struct = 1u << 6;
+        private const uint Enum = 1u << 7;
+        private const uint Interface = 1u << 8;
+
+        private readonly Dictionary<string, uint> stringIds = new Dictionary<string, uint>(StringComparer.Ordinal);
+        private readonly List<uint> stringOffsets = new List<uint>();
+        private byte[] chars = new byte[64 * 1024];
+        private int charCount;
+
+        private readonly List<uint> types = new List<uint>();
+        private readonly List<uint> fields = new List<uint>();
+        private readonly List<uint> methods = new List<uint>();
+        private readonly List<uint> parameters = new List<uint>();
+        private readonly List<uint> properties = new List<uint>();
+
+        public SnapshotEncoder()
+        {
+            Intern(string.Empty); // id 0, as in the viewer's SymbolTable
+        }
+
+        public int TypeCount => types.Count / TypeWords;
+
+        public void AddType(TypeInfo type)
+        {
+            types.Add(Intern(type.Name));
+            types.Add(Intern(type.FullName));
+            types.Add(Intern(type.Namespace));
+            types.Add(Intern(type.BaseType));
+            types.Add((type.IsClass ? Class : 0) | (type.IsStruct ? Struct : 0) |
+                      (type.IsEnum ? Enum : 0) | (type.IsInterface ? Interface : 0));
+
+            types.Add((uint)(fields.Count / FieldWords));
+            types.Add((uint)type.Fields.Count);
+            foreach (var field in type.Fields)
+            {
+                fields.Add(Intern(field.Name));
+                fields.Add(Intern(field.FieldType));
+                fields.Add((field.IsPublic ? Public : 0) | (field.IsStatic ? Static : 0) | (field.IsReadOnly ? ReadOnly : 0));
+            }
+
+            types.Add((uint)(methods.Count / MethodWords));
+            types.Add((uint)type.Methods.Count);
+            foreach (var method in type.Methods)
+            {
+                methods.Add(Intern(method.Name));
+                methods.Add(Intern(method.ReturnType));
+                methods.Add((method.IsPublic ? Public : 0) | (method.IsStatic ? Static : 0));
+                methods.Add((uint)(parameters.Count / ParameterWords));
+                methods.Add((uint)method.Parameters.Count);
+                foreach (var param in method.Parameters)
+                {
+                    parameters.Add(Intern(param.Name));
+                    parameters.Add(Intern(param.ParameterType));
+                }
+            }
+
+            types.Add((uint)(properties.Count / PropertyWords));
+            types.Add((uint)type.Properties.Count);
+            foreach (var prop in type.Properties)
+            {
+                properties.Add(Intern(prop.Name));
+                properties.Add(Intern(prop.PropertyType));
+                properties.Add((prop.CanRead ? CanRead : 0) | (prop.CanWrite ? CanWrite : 0));
+            }
+        }
+
+        // The file image of the types added so far under this header. timestamp
+        // is formatted the way the JSON snapshot writes it.
+        public byte[] Finish(string assemblyName, string timestamp, string snapshotId, string moduleVersionId)
+        {
+            uint assemblyNameId = Intern(assemblyName);
+            uint timestampId = Intern(timestamp);
+            uint snapshotIdId = Intern(snapshotId);
+            uint moduleVersionIdId = Intern(moduleVersionId);
+            stringOffsets.Add((uint)charCount); // the end of the last string
+
+            long offset = HeaderSize;
+            long Place(long count, int elementSize)
+            {
+                offset = (offset + SectionAlignment - 1) & ~(long)(SectionAlignment - 1);
+                long start = offset;
+                offset += count * elementSize;
+                return start;
+            }
+            long offsetsAt = Place(stringOffsets.Count, 4);
+            long charsAt = Place(charCount, 1);
+            long typesAt = Place(types.Count, 4);
+            long fieldsAt = Place(fields.Count, 4);
+            long methodsAt = Place(methods.Count, 4);
+            long parametersAt = Place(parameters.Count, 4);
+            long propertiesAt = Place(properties.Count, 4);
+
+            var file = new byte[offset];
+            WriteWords(file, offsetsAt, stringOffsets);
+            Buffer.BlockCopy(chars, 0, file, (int)charsAt, charCount);
+            WriteWords(file, typesAt, types);
+            WriteWords(file, fieldsAt, fields);
+            WriteWords(file, methodsAt, methods);
+            WriteWords(file, parametersAt, parameters);
+            WriteWords(file, propertiesAt, properties);
+            stringOffsets.RemoveAt(stringOffsets.Count - 1);
+
+            // Header, field by field as SnapshotFileHeader lays it out
+            var header = file.AsSpan(0, HeaderSize);
+            Magic.CopyTo(header);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(8), Version);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(12), ByteOrderMark);
+            BinaryPrimitives.WriteUInt64LittleEndian(header.Slice(16), (ulong)file.Length);
+            BinaryPrimitives.WriteUInt64LittleEndian(header.Slice(24), Checksum(file.AsSpan(HeaderSize)));
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(32), assemblyNameId);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(36), timestampId);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(40), snapshotIdId);
+            BinaryPrimitives.WriteUInt32LittleEndian(header.Slice(44), moduleVersionIdId);
+            WriteSection(header.Slice(48), offsetsAt, stringOffsets.Count + 1);
+            WriteSection(header.Slice(64), charsAt, charCount);
+            WriteSection(header.Slice(80), typesAt, types.Count / TypeWords);
+            WriteSection(header.Slice(96), fieldsAt, fields.Count / FieldWords);
+            WriteSection(header.Slice(112), methodsAt, methods.Count / MethodWords);
+            WriteSection(header.Slice(128), parametersAt, parameters.Count / ParameterWords);
+            WriteSection(header.Slice(144), propertiesAt, properties.Count / PropertyWords);
+            return file;
+        }
+
+        // Each string is stored once as UTF-8 followed by a terminating zero
+        private uint Intern(string? s)
+        {
+            s ??= string.Empty;
+            if (stringIds.TryGetValue(s, out uint id)) return id;
+
+            id = (uint)stringOffsets.Count;
+            stringIds.Add(s, id);
+            stringOffsets.Add((uint)charCount);
+
+            int needed = charCount + Encoding.UTF8.GetMaxByteCount(s.Length) + 1;
+            if (needed > chars.Length) Array.Resize(ref chars, Math.Max(needed, chars.Length * 2));
+            charCount += Encoding.UTF8.GetBytes(s, 0, s.Length, chars, charCount);
+            chars[charCount++] = 0;
+            return id;
+        }
+
+        private static void WriteWords(byte[] file, long at, List<uint> words)
+        {
+            var span = file.AsSpan((int)at);
+            for (int i = 0; i < words.Count; i++)
+            {
+                BinaryPrimitives.WriteUInt32LittleEndian(span.Slice(i * 4), words[i]);
+            }
+        }
+
+        private static void WriteSection(Span<byte> at, long offset, long count)
+        {
+            BinaryPrimitives.WriteUInt64LittleEndian(at, (ulong)offset);
+            BinaryPrimitives.WriteUInt64LittleEndian(at.Slice(8), (ulong)count);
+        }
+
+        // SnapshotChecksum in snapshot_file.cpp: four lanes over 32-byte blocks,
+        // then the tail byte by byte
+        private static ulong Checksum(ReadOnlySpan<byte> data)
+        {
+            const ulong Prime1 = 0x9E3779B185EBCA87;
+            const ulong Prime2 = 0xC2B2AE3D27D4EB4F;
+
+            unchecked
+            {
+                ulong lane0 = Prime1 + Prime2;
+                ulong lane1 = Prime2;
+                ulong lane2 = 0;
+                ulong lane3 = 0 - Prime1;
+                int i = 0;
+                for (; i + 32 <= data.Length; i += 32)
+                {
+                    lane0 = RotateLeft(lane0 + BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(i)) * Prime2, 31) * Prime1;
+                    lane1 = RotateLeft(lane1 + BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(i + 8)) * Prime2, 31) * Prime1;
+                    lane2 = RotateLeft(lane2 + BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(i + 16)) * Prime2, 31) * Prime1;
+                    lane3 = RotateLeft(lane3 + BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(i + 24)) * Prime2, 31) * Prime1;
+                }
+
+                ulong hash = (ulong)data.Length;
+                hash = RotateLeft(hash ^ lane0, 27) * Prime1 + Prime2;
+                hash = RotateLeft(hash ^ lane1, 27) * Prime1 + Prime2;
+                hash = RotateLeft(hash ^ lane2, 27) * Prime1 + Prime2;
+                hash = RotateLeft(hash ^ lane3, 27) * Prime1 + Prime2;
+                for (; i < data.Length; i++)
+                {
+                    hash = RotateLeft(hash ^ data[i] * Prime1, 11) * Prime2;
+                }
+
+                hash ^= hash >> 33;
+                hash *= Prime2;
+                hash ^= hash >> 29;
+                return hash;
+            }
+        }
+
+        private static ulong RotateLeft(ulong x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+    }
+}
@@ -0,0 +1,139 @@
+using System;
+using System.Collections.Generic;
+
+namespace UnityReflectionMod
+{
+    // The last snapshot sent: its id and a hash of each type's contents, keyed by
+    // full name. A viewer whose hello names this id gets a delta with
+    // only the types whose hash changed and the names of those that went away.
+    public class SnapshotHistory
+    {
+        private Dictionary<string, ulong> typeHashes = new Dictionary<string, ulong>();
+
+        public string SnapshotId { get; private set; } = string.Empty;
+
+        public bool CanDeltaFrom(string baseSnapshotId)
+        {
+            return baseSnapshotId.Length > 0 && baseSnapshotId == SnapshotId;
+        }
+
+        public SnapshotBuilder Begin()
+        {
+            return new SnapshotBuilder(typeHashes);
+        }
+
+        // Call once the snapshot has been sent; it becomes the base for the next delta
+        public void Commit(SnapshotBuilder snapshot)
+        {
+            // Types are matched by full name, so with duplicates a delta could be
+            // applied to the wrong one; such an assembly always gets full snapshots
+            typeHashes = snapshot.HasUniqueNames ? snapshot.TypeHashes : new Dictionary<string, ulong>();
+            SnapshotId = snapshot.HasUniqueNames ? snapshot.Id : string.Empty;
+        }
+
+        // Names in the committed snapshot that snapshot no longer has
+        public List<string> RemovedIn(SnapshotBuilder snapshot)
+        {
+            var removed = new List<string>();
+            foreach (var name in typeHashes.Keys)
+            {
+                if (!snapshot.TypeHashes.ContainsKey(name)) removed.Add(name);
+            }
+            return removed;
+        }
+    }
+
+    // Collects the type hashes of a snapshot while it is serialized. The id is
+    // a sum of mixed type hashes, so it does not depend on type order.
+    public class SnapshotBuilder
+    {
+        private readonly Dictionary<string, ulong> previous;
+        private ulong sum;
+
+        public SnapshotBuilder(Dictionary<string, ulong> previous)
+        {
+            this.previous = previous;
+        }
+
+        public Dictionary<string, ulong> TypeHashes { get; } = new Dictionary<string, ulong>();
+        public bool HasUniqueNames { get; private set; } = true;
+        public string Id => sum.ToString("x16");
+
+        // Adds a type; true if it is new or differs from the previous snapshot.
+        // The hash covers what either wire format carries, so the id does not
+        // depend on which one the snapshot was sent in.
+        public bool Add(TypeInfo type)
+        {
+            ulong hash = Hash(type);
+            if (!TypeHashes.TryAdd(type.FullName, hash)) HasUniqueNames = false;
+            sum += Mix(hash);
+            return !previous.TryGetValue(type.FullName, out ulong old) || old != hash;
+        }
+
+        private static ulong Hash(TypeInfo type)
+        {
+            ulong hash = 0xCBF29CE484222325;
+            hash = Hash(hash, type.Name);
+            hash = Hash(hash, type.FullName);
+            hash = Hash(hash, type.Namespace);
+            hash = Hash(hash, type.BaseType);
+            hash = Hash(hash, type.IsClass, type.IsStruct, type.IsEnum, type.IsInterface);
+            foreach (var field in type.Fields)
+            {
+                hash = Hash(Hash(hash, field.Name), field.FieldType);
+                hash = Hash(hash, field.IsPublic, field.IsStatic, field.IsReadOnly, false);
+            }
+            // Each member list is ended by a marker, so moving a member from one
+            // list to the next changes the hash
+            hash = Hash(hash, '\u0001');
+            foreach (var method in type.Methods)
+            {
+                hash = Hash(Hash(hash, method.Name), method.ReturnType);
+                hash = Hash(hash, method.IsPublic, method.IsStatic, false, false);
+                foreach (var param in method.Parameters)
+                {
+                    hash = Hash(Hash(hash, param.Name), param.ParameterType);
+                }
+                hash = Hash(hash, '\u0002');
+            }
+            hash = Hash(hash, '\u0001');
+            foreach (var prop in type.Properties)
+            {
+                hash = Hash(Hash(hash, prop.Name), prop.PropertyType);
+                hash = Hash(hash, prop.CanRead, prop.CanWrite, false, false);
+            }
+            return hash;
+        }
+
+        // FNV-1a over the UTF-16 code units, each string ended by a zero
+        private static ulong Hash(ulong hash, string? s)
+        {
+            if (s != null)
+            {
+                foreach (char c in s)
+                {
+                    hash = (hash ^ c) * 0x100000001B3;
+                }
+            }
+            return Hash(hash, '\0');
+        }
+
+        private static ulong Hash(ulong hash, char c)
+        {
+            return (hash ^ c) * 0x100000001B3;
+        }
+
+        private static ulong Hash(ulong hash, bool a, bool b, bool c, bool d)
+        {
+            return Hash(hash, (char)((a ? 1 : 0) | (b ? 2 : 0) | (c ? 4 : 0) | (d ? 8 : 0)));
+        }
+
+        // splitmix64 finalizer, so that summing does not cancel similar hashes
+        private static ulong Mix(ulong x)
+        {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+            return x ^ (x >> 31);
+        }
+    }
+}
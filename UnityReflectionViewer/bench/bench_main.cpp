@@ -0,0 +1,1135 @@
+// Parser and IPC read-path benchmark. Needs no window or GL context.
+//
+//   urv_bench [--types 1000,10000,100000] [--reps 5] [--seed 1] [--generic-depth 3]
+//             [--escape-ratio 0.01] [--threads 0] [--link-mbps 0] [--filter name]
+//             [--json results.json]
+//
+// --link-mbps caps the rate the fifo_* writers send at, to model a pipe that is
+// slower than a local memory copy; 0 writes as fast as the FIFO takes it.
+//
+// Prints a table and, with --json, writes the same results in a stable format so
+// runs can be diffed or plotted.
+
+#include "assembly_delta.h"
+#include "assembly_snapshot.h"
+#include "frame_protocol.h"
+#include "fuzzy_matcher.h"
+#include "ipc_client.h"
+#include "json_scanner.h"
+#include "lazy_assembly.h"
+#include "lz4_block.h"
+#include "member_fetcher.h"
+#include "member_search_index.h"
+#include "member_store.h"
+#include "member_table.h"
+#include "payload_generator.h"
+#include "reflection_data.h"
+#include "schema_codec.h"
+#include "shared_ring.h"
+#include "snapshot_file.h"
+#include "stand_in_server.h"
+#include "streaming_parser.h"
+#include "thread_pool.h"
+#include "type_list_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <csignal>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define URV_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define URV_NOINLINE __declspec(noinline)
+#else
+#define URV_NOINLINE
+#endif
+
+// Every allocation in the process goes through these, so each case can report
+// how many allocations and bytes one run costs. All forms are replaced, nothrow
+// and over-aligned included, so nothing is left to a runtime allocator whose
+// blocks would then reach the wrong free.
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_allocatedBytes{0};
+
+void* Allocate(size_t size) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* AllocateAligned(size_t size, std::align_val_t alignment) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    const size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc takes only multiples of the alignment
+    return std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+#endif
+}
+
+// Not inlined into the operators, so the compiler does not pair the free
+// with the operator new it replaces
+URV_NOINLINE void Release(void* p) noexcept {
+    std::free(p);
+}
+
+URV_NOINLINE void ReleaseAligned(void* p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+} // namespace
+
+void* operator new(size_t size) {
+    if (void* p = Allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = Allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = AllocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* p = AllocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+    Release(p);
+}
+
+void operator delete[](void* p) noexcept {
+    Release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    Release(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    Release(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    Release(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    Release(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    ReleaseAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    ReleaseAligned(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    ReleaseAligned(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    ReleaseAligned(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    ReleaseAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    ReleaseAligned(p);
+}
+
+namespace UnityReflection {
+namespace Bench {
+
+namespace {
+
+struct Options {
+    std::vector<size_t> typeCounts = {1000, 10000, 100000};
+    int reps = 5;
+    uint64_t seed = 1;
+    int genericDepth = 3;
+    double escapeRatio = 0.01;
+    unsigned threads = 0;
+    double linkMbps = 0;
+    std::string filter;
+    std::string jsonPath;
+};
+
+struct Result {
+    std::string name;
+    size_t typeCount = 0;
+    size_t payloadBytes = 0;
+    int reps = 0;
+    double medianSeconds = 0;
+    double bestSeconds = 0;
+    double allocationsPerRun = 0;
+    double allocatedBytesPerRun = 0;
+    size_t peakRssKb = 0;
+    bool ok = true;
+};
+
+size_t PeakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss) / 1024; // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// Runs setup untimed, then run timed, once as warm-up and then reps times.
+// run returns false if the result was wrong.
+Result Measure(const std::string& name, size_t typeCount, size_t payloadBytes, int reps,
+               const std::function<void()>& setup, const std::function<bool()>& run) {
+    Result result;
+    result.name = name;
+    result.typeCount = typeCount;
+    result.payloadBytes = payloadBytes;
+    result.reps = reps;
+
+    setup();
+    result.ok = run();
+
+    std::vector<double> seconds;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    for (int i = 0; i < reps && result.ok; i++) {
+        setup();
+
+        const uint64_t allocationsBefore = g_allocations.load();
+        const uint64_t bytesBefore = g_allocatedBytes.load();
+        const auto start = std::chrono::steady_clock::now();
+        result.ok = run();
+        const auto end = std::chrono::steady_clock::now();
+        allocations += g_allocations.load() - allocationsBefore;
+        allocatedBytes += g_allocatedBytes.load() - bytesBefore;
+
+        seconds.push_back(std::chrono::duration<double>(end - start).count());
+    }
+
+    if (!seconds.empty()) {
+        std::sort(seconds.begin(), seconds.end());
+        result.medianSeconds = seconds[seconds.size() / 2];
+        result.bestSeconds = seconds.front();
+        result.allocationsPerRun = static_cast<double>(allocations) / seconds.size();
+        result.allocatedBytesPerRun = static_cast<double>(allocatedBytes) / seconds.size();
+    }
+    result.peakRssKb = PeakRssKb();
+    return result;
+}
+
+double MegabytesPerSecond(const Result& r) {
+    return r.medianSeconds > 0 ? r.payloadBytes / r.medianSeconds / (1024.0 * 1024.0) : 0;
+}
+
+double TypesPerSecond(const Result& r) {
+    return r.medianSeconds > 0 ? r.typeCount / r.medianSeconds : 0;
+}
+
+void PrintResult(const Result& r) {
+    if (!r.ok) {
+        printf("%-18s %9zu  FAILED\n", r.name.c_str(), r.typeCount);
+        return;
+    }
+    printf("%-18s %9zu %9.1f %10.2f %10.0f %12.0f %10.0f %10zu\n", r.name.c_str(), r.typeCount,
+           r.payloadBytes / (1024.0 * 1024.0), r.medianSeconds * 1000.0, MegabytesPerSecond(r), TypesPerSecond(r),
+           r.allocationsPerRun, r.peakRssKb);
+}
+
+void AppendJsonString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+bool WriteJson(const std::string& path, const Options& options, unsigned threadCount,
+               const std::vector<Result>& results) {
+    std::string out = "{\n  \"benchmark\": \"urv_bench\",\n  \"formatVersion\": 1,\n";
+    char line[512];
+    snprintf(line, sizeof(line),
+             "  \"environment\": {\"simd\": \"%s\", \"threads\": %u},\n"
+             "  \"options\": {\"reps\": %d, \"seed\": %llu, \"genericDepth\": %d, \"escapeRatio\": %g, "
+             "\"linkMbps\": %g},\n",
+             SimdLevelName(DetectSimdLevel()), threadCount, options.reps,
+             static_cast<unsigned long long>(options.seed), options.genericDepth, options.escapeRatio,
+             options.linkMbps);
+    out += line;
+    out += "  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out += "    {\"name\": ";
+        AppendJsonString(out, r.name);
+        snprintf(line, sizeof(line),
+                 ", \"types\": %zu, \"bytes\": %zu, \"ok\": %s, \"reps\": %d, \"medianSeconds\": %.6f, "
+                 "\"bestSeconds\": %.6f, \"mbPerSecond\": %.2f, \"typesPerSecond\": %.0f, "
+                 "\"allocationsPerRun\": %.0f, \"allocatedBytesPerRun\": %.0f, \"peakRssKb\": %zu}",
+                 r.typeCount, r.payloadBytes, r.ok ? "true" : "false", r.reps, r.medianSeconds, r.bestSeconds,
+                 MegabytesPerSecond(r), TypesPerSecond(r), r.allocationsPerRun, r.allocatedBytesPerRun,
+                 r.peakRssKb);
+        out += line;
+        out += i + 1 < results.size() ? ",\n" : "\n";
+    }
+    out += "  ]\n}\n";
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    const bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+    return fclose(file) == 0 && written;
+}
+
+#ifndef _WIN32
+// Feeds payload into a FIFO the way IPCServer writes it, as one framed message.
+// The frames are built before the reader starts timing. With linkMbps > 0 the
+// writes are paced to that rate.
+void WriteToFifo(const std::string& path, const std::string& frame, double linkMbps) {
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd < 0) return;
+
+    const auto start = std::chrono::steady_clock::now();
+    const size_t step = linkMbps > 0 ? 64 * 1024 : frame.size();
+    size_t written = 0;
+    while (written < frame.size()) {
+        ssize_t n = write(fd, frame.data() + written, std::min(step, frame.size() - written));
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+        if (linkMbps > 0) {
+            std::this_thread::sleep_until(start + std::chrono::duration<double>(written / (linkMbps * 1024 * 1024)));
+        }
+    }
+    close(fd);
+}
+#endif
+
+bool ParseArguments(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--types" && hasValue) {
+            options.typeCounts.clear();
+            std::string list = argv[++i];
+            size_t start = 0;
+            while (start < list.size()) {
+                size_t comma = list.find(',', start);
+                if (comma == std::string::npos) comma = list.size();
+                options.typeCounts.push_back(std::strtoull(list.substr(start, comma - start).c_str(), nullptr, 10));
+                start = comma + 1;
+            }
+        } else if (arg == "--reps" && hasValue) {
+            options.reps = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--generic-depth" && hasValue) {
+            options.genericDepth = std::atoi(argv[++i]);
+        } else if (arg == "--escape-ratio" && hasValue) {
+            options.escapeRatio = std::atof(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--link-mbps" && hasValue) {
+            options.linkMbps = std::atof(argv[++i]);
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            fprintf(stderr,
+                    "usage: urv_bench [--types 1000,10000,100000] [--reps N] [--seed N] [--generic-depth N]\n"
+                    "                 [--escape-ratio F] [--threads N] [--link-mbps F] [--filter name] [--json path]\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int Run(int argc, char** argv) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) return 2;
+
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN); // the reader may drop a payload it rejects
+#endif
+
+    ThreadPool pool(options.threads);
+    std::vector<Result> results;
+
+    auto wanted = [&options](const char* name) {
+        return options.filter.empty() || std::string(name).find(options.filter) != std::string::npos;
+    };
+    auto record = [&results](Result result) {
+        PrintResult(result);
+        results.push_back(std::move(result));
+    };
+
+    printf("SIMD: %s, threads: %u\n\n", SimdLevelName(DetectSimdLevel()), pool.ThreadCount());
+    printf("%-18s %9s %9s %10s %10s %12s %10s %10s\n", "case", "types", "MB", "median ms", "MB/s", "types/s",
+           "allocs", "peak RSS kB");
+
+    for (size_t typeCount : options.typeCounts) {
+        PayloadOptions payloadOptions;
+        payloadOptions.typeCount = typeCount;
+        payloadOptions.seed = options.seed;
+        payloadOptions.genericDepth = options.genericDepth;
+        payloadOptions.escapeRatio = options.escapeRatio;
+        const std::string payload = GeneratePayload(payloadOptions);
+        const size_t bytes = payload.size();
+        auto nothing = []() {};
+
+        if (wanted("stage1_index")) {
+            StructuralIndex index;
+            record(Measure("stage1_index", typeCount, bytes, options.reps, nothing, [&]() {
+                index.Build(payload.data(), payload.size());
+                return index.Size() == payload.size();
+            }));
+        }
+
+        if (wanted("parse_sequential")) {
+            record(Measure("parse_sequential", typeCount, bytes, options.reps, nothing, [&]() {
+                AssemblyData data;
+                return ParseAssemblyData(payload, data) && data.types.size() == typeCount;
+            }));
+        }
+
+        if (wanted("parse_parallel")) {
+            record(Measure("parse_parallel", typeCount, bytes, options.reps, nothing, [&]() {
+                AssemblyData data;
+                return ParseAssemblyDataParallel(payload, data, &pool) && data.types.size() == typeCount;
+            }));
+        }
+
+        if (wanted("parse_snapshot")) {
+            std::string copy;
+            record(Measure("parse_snapshot", typeCount, bytes, options.reps, [&]() { copy = payload; }, [&]() {
+                AssemblySnapshot snapshot;
+                return ParseAssemblySnapshot(std::move(copy), snapshot) && snapshot.types.size() == typeCount;
+            }));
+        }
+
+        if (wanted("parse_headers")) {
+            std::string copy;
+            record(Measure("parse_headers", typeCount, bytes, options.reps, [&]() { copy = payload; }, [&]() {
+                LazyAssembly lazy;
+                AssemblyData data;
+                return lazy.Load(std::move(copy), data) && data.types.size() == typeCount;
+            }));
+        }
+
+        if (wanted("parse_streaming")) {
+            record(Measure("parse_streaming", typeCount, bytes, options.reps, nothing, [&]() {
+                size_t delivered = 0;
+                StreamingParser parser([&delivered](TypeInfo&&) { delivered++; });
+                constexpr size_t CHUNK = 64 * 1024;
+                for (size_t pos = 0; pos < payload.size(); pos += CHUNK) {
+                    if (!parser.Feed(payload.data() + pos, std::min(CHUNK, payload.size() - pos))) return false;
+                }
+                AssemblyData header;
+                return parser.Finish(header) && delivered == typeCount;
+            }));
+        }
+
+        if (wanted("encode_json") || wanted("encode_binary") || wanted("decode_binary")) {
+            AssemblyData data;
+            ParseAssemblyData(payload, data);
+            std::string binary;
+            EncodeBinary(data, binary);
+
+            if (wanted("encode_json")) {
+                record(Measure("encode_json", typeCount, bytes, options.reps, nothing, [&]() {
+                    std::string out;
+                    EncodeJson(data, out);
+                    return out == payload;
+                }));
+            }
+
+            if (wanted("encode_binary")) {
+                record(Measure("encode_binary", typeCount, binary.size(), options.reps, nothing, [&]() {
+                    std::string out;
+                    EncodeBinary(data, out);
+                    return out.size() == binary.size();
+                }));
+            }
+
+            if (wanted("decode_binary")) {
+                record(Measure("decode_binary", typeCount, binary.size(), options.reps, nothing, [&]() {
+                    AssemblyData decoded;
+                    return DecodeBinary(binary.data(), binary.size(), decoded) && decoded.types.size() == typeCount;
+                }));
+            }
+        }
+
+        // The binary snapshot format the mod sends: encoding it, checking it in
+        // place as it arrives, and copying it into an AssemblyData, which must
+        // encode back to the JSON payload byte for byte
+        if (wanted("encode_snapshot") || wanted("load_snapshot") || wanted("decode_snapshot")) {
+            AssemblyData data;
+            ParseAssemblyData(payload, data);
+            SnapshotWriter writer;
+            writer.AddAssemblyData(data);
+            std::string image;
+            writer.Serialize(image);
+
+            if (wanted("encode_snapshot")) {
+                record(Measure("encode_snapshot", typeCount, image.size(), options.reps, nothing, [&]() {
+                    SnapshotWriter encoder;
+                    encoder.AddAssemblyData(data);
+                    std::string out;
+                    encoder.Serialize(out);
+                    return out == image;
+                }));
+            }
+
+            std::string copy;
+            if (wanted("load_snapshot")) {
+                record(Measure("load_snapshot", typeCount, image.size(), options.reps, [&]() { copy = image; }, [&]() {
+                    MappedSnapshot snapshot;
+                    return snapshot.Load(std::move(copy)) && snapshot.Types().size() == typeCount;
+                }));
+            }
+
+            if (wanted("decode_snapshot")) {
+                bool roundTrips = false;
+                {
+                    MappedSnapshot snapshot;
+                    AssemblyData decoded;
+                    if (snapshot.Load(image, true)) {
+                        snapshot.ToAssemblyData(decoded);
+                        std::string json;
+                        EncodeJson(decoded, json);
+                        roundTrips = json == payload;
+                    }
+                }
+                record(Measure("decode_snapshot", typeCount, image.size(), options.reps, [&]() { copy = image; }, [&]() {
+                    MappedSnapshot snapshot;
+                    AssemblyData decoded;
+                    if (!roundTrips || !snapshot.Load(std::move(copy), false)) return false;
+                    snapshot.ToAssemblyData(decoded);
+                    return decoded.types.size() == typeCount;
+                }));
+            }
+        }
+
+        if (wanted("crc32c")) {
+            uint32_t crc = 0;
+            record(Measure("crc32c", typeCount, bytes, options.reps, nothing, [&]() {
+                const uint32_t result = Crc32c(payload.data(), payload.size());
+                const bool stable = crc == 0 || result == crc;
+                crc = result;
+                return stable;
+            }));
+        }
+
+        if (wanted("lz4_compress") || wanted("lz4_decompress")) {
+            // Chunk by chunk, as the frames carry it
+            std::vector<std::string> blocks;
+            std::unique_ptr<char[]> buffer(new char[Lz4CompressBound(FRAME_CHUNK_SIZE)]);
+            for (size_t pos = 0; pos < payload.size(); pos += FRAME_CHUNK_SIZE) {
+                const size_t n = std::min(FRAME_CHUNK_SIZE, payload.size() - pos);
+                blocks.emplace_back(buffer.get(), Lz4Compress(payload.data() + pos, n, buffer.get()));
+            }
+
+            if (wanted("lz4_compress")) {
+                record(Measure("lz4_compress", typeCount, bytes, options.reps, nothing, [&]() {
+                    size_t packed = 0;
+                    for (size_t pos = 0; pos < payload.size(); pos += FRAME_CHUNK_SIZE) {
+                        const size_t n = std::min(FRAME_CHUNK_SIZE, payload.size() - pos);
+                        packed += Lz4Compress(payload.data() + pos, n, buffer.get());
+                    }
+                    return packed < payload.size();
+                }));
+            }
+
+            if (wanted("lz4_decompress")) {
+                record(Measure("lz4_decompress", typeCount, bytes, options.reps, nothing, [&]() {
+                    bool ok = true;
+                    for (size_t i = 0; i < blocks.size(); i++) {
+                        const size_t n = std::min(FRAME_CHUNK_SIZE, payload.size() - i * FRAME_CHUNK_SIZE);
+                        ok = ok && Lz4Decompress(blocks[i].data(), blocks[i].size(), buffer.get(), n);
+                    }
+                    // The last block is compared; each one checks it filled its exact size
+                    const size_t last = (blocks.size() - 1) * FRAME_CHUNK_SIZE;
+                    return ok && memcmp(buffer.get(), payload.data() + last, payload.size() - last) == 0;
+                }));
+            }
+        }
+
+        if (wanted("type_list_index") || wanted("filter_types") || wanted("filter_short") ||
+            wanted("filter_typing") || wanted("fuzzy_types")) {
+            // The type list's search: indexing every name once per snapshot,
+            // then searches for part of a name in the middle of the list. Before
+            // timing, each result is checked against lowercasing each name and
+            // searching it, as the window once did every frame.
+            AssemblyData data;
+            ParseAssemblyData(payload, data);
+            size_t nameBytes = 0;
+            for (const TypeInfo& type : data.types) nameBytes += type.fullName.size();
+
+            TypeListIndex index;
+            if (wanted("type_list_index")) {
+                record(Measure("type_list_index", typeCount, nameBytes, options.reps, nothing, [&]() {
+                    index.Build(data);
+                    return index.TypeCount() == data.types.size();
+                }));
+            }
+            index.Build(data);
+
+            const std::string& middle = data.types[data.types.size() / 2].fullName;
+            auto queryAt = [&](size_t length) {
+                std::string query;
+                TypeListIndex::Fold(std::string_view(middle).substr(middle.size() / 2, length), query);
+                return query;
+            };
+            auto reference = [&](const std::string& query) {
+                std::vector<uint32_t> expected;
+                for (size_t i = 0; i < data.types.size(); i++) {
+                    std::string name = data.types[i].fullName;
+                    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                    if (data.types[i].isClass && name.find(query) != std::string::npos) {
+                        expected.push_back(static_cast<uint32_t>(i));
+                    }
+                }
+                return expected;
+            };
+
+            // An empty query drops the index's last matches, so each timed
+            // search starts over instead of narrowing the previous one
+            std::vector<uint32_t> matches;
+            auto forget = [&]() { index.Filter({}, 0, matches); };
+
+            // Four characters go through the trigram lists, two through one
+            // pass over the names
+            for (const auto& [name, length] : {std::pair<const char*, size_t>{"filter_types", 4},
+                                               std::pair<const char*, size_t>{"filter_short", 2}}) {
+                if (!wanted(name)) continue;
+                const std::string query = queryAt(length);
+                const std::vector<uint32_t> expected = reference(query);
+                record(Measure(name, typeCount, nameBytes, options.reps, forget, [&]() {
+                    index.Filter(query, TYPE_KIND_CLASS, matches);
+                    return matches == expected && !matches.empty();
+                }));
+            }
+
+            if (wanted("filter_typing")) {
+                // Eight keystrokes, one search each, as the window runs them
+                const std::string query = queryAt(8);
+                std::vector<std::vector<uint32_t>> expected;
+                for (size_t i = 1; i <= query.size(); i++) expected.push_back(reference(query.substr(0, i)));
+                record(Measure("filter_typing", typeCount, nameBytes, options.reps, forget, [&]() {
+                    bool ok = true;
+                    for (size_t i = 1; i <= query.size(); i++) {
+                        index.Filter(std::string_view(query).substr(0, i), TYPE_KIND_CLASS, matches);
+                        ok = ok && matches == expected[i - 1];
+                    }
+                    return ok && !matches.empty();
+                }));
+            }
+
+            if (wanted("fuzzy_types")) {
+                // An abbreviation of the middle name as a user types one: each
+                // capital and the letter after it. Checked against scoring
+                // every class name and sorting all the matches.
+                const std::string_view shortName = std::string_view(middle).substr(middle.rfind('.') + 1);
+                std::string query;
+                for (size_t i = 0; i < shortName.size() && query.size() < 6; i++) {
+                    if (shortName[i] >= 'A' && shortName[i] <= 'Z') query += shortName.substr(i, 2);
+                }
+                if (query.size() < 3) query = std::string(shortName.substr(0, 3));
+
+                constexpr size_t LIMIT = 100;
+                const FuzzyMatcher matcher(query);
+                std::vector<FuzzyMatch> all;
+                for (size_t i = 0; i < data.types.size(); i++) {
+                    const int32_t score = matcher.Score(data.types[i].fullName);
+                    if (data.types[i].isClass && score != FuzzyMatcher::NO_MATCH) {
+                        all.push_back({static_cast<uint32_t>(i), score, static_cast<uint32_t>(data.types[i].fullName.size())});
+                    }
+                }
+                const size_t expectedCount = all.size();
+                FuzzyMatcher::KeepBest(all, LIMIT);
+                std::vector<uint32_t> expected;
+                for (const FuzzyMatch& match : all) expected.push_back(match.index);
+
+                record(Measure("fuzzy_types", typeCount, nameBytes, options.reps, nothing, [&]() {
+                    const size_t count = index.FilterFuzzy(query, TYPE_KIND_CLASS, LIMIT, matches, &pool);
+                    return count == expectedCount && matches == expected && !matches.empty();
+                }));
+            }
+        }
+
+        if (wanted("member_search_index") || wanted("member_search") || wanted("member_fuzzy")) {
+            // The member search panel: its index built from the member store as
+            // a worker does after a snapshot, then a search by the middle of a
+            // field's name and one by the end of a parameter's type, each
+            // reading the first page of hits. Before timing, the totals are
+            // checked against lowercasing and searching every member.
+            AssemblyData data;
+            ParseAssemblyData(payload, data);
+            MemberStore members;
+            members.Build(data);
+            const MemberSearchIndex::Source source = MemberSearchIndex::Capture(members, data.symbols);
+            const size_t stringBytes = members.names.Chars().size() + data.symbols.Chars().size();
+            size_t memberCount = 0;
+            for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) memberCount += members.Columns(static_cast<MemberKind>(k)).Size();
+
+            MemberSearchIndex index;
+            if (wanted("member_search_index")) {
+                record(Measure("member_search_index", typeCount, stringBytes, options.reps, nothing, [&]() {
+                    index.Build(source);
+                    return index.MemberCount() == memberCount;
+                }));
+            }
+
+            if (wanted("member_search") && members.fields.Size() > 0 && members.parameters.Size() > 0) {
+                index.Build(source);
+                auto lowered = [](std::string_view text) {
+                    std::string folded(text);
+                    std::transform(folded.begin(), folded.end(), folded.begin(), ::tolower);
+                    return folded;
+                };
+                const std::string field = lowered(members.names.Name(members.fields.name[members.fields.Size() / 2]));
+                const std::string nameQuery = field.substr(field.size() / 3, std::max<size_t>(field.size() / 2, 1));
+                const std::string type = lowered(data.symbols.Name(members.parameters.type[members.parameters.Size() / 2]));
+                const std::string typeQuery = type.substr(type.size() > 6 ? type.size() - 6 : 0);
+
+                uint64_t expectedNames = 0;
+                uint64_t expectedTypes = 0;
+                for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) {
+                    const MemberColumns& columns = members.Columns(static_cast<MemberKind>(k));
+                    for (size_t row = 0; row < columns.Size(); row++) {
+                        expectedNames += lowered(members.names.Name(columns.name[row])).find(nameQuery) != std::string::npos;
+                        expectedTypes += lowered(data.symbols.Name(columns.type[row])).find(typeQuery) != std::string::npos;
+                    }
+                }
+
+                MemberSearchResult result;
+                std::vector<MemberHit> page;
+                record(Measure("member_search", typeCount, stringBytes, options.reps, nothing, [&]() {
+                    index.Search(nameQuery, MemberSearchTarget::Name, MEMBER_KIND_ALL, MatchMode::Substring, result, nullptr);
+                    index.Fetch(result, 0, 100, page);
+                    bool ok = result.Total() == expectedNames && !page.empty();
+                    index.Search(typeQuery, MemberSearchTarget::Type, MEMBER_KIND_ALL, MatchMode::Substring, result, nullptr);
+                    index.Fetch(result, 0, 100, page);
+                    return ok && result.Total() == expectedTypes && !page.empty();
+                }));
+            }
+
+            if (wanted("member_fuzzy") && members.fields.Size() > 0) {
+                // A fuzzy search by every other letter of a field's name,
+                // checked against scoring each distinct member name
+                index.Build(source);
+                const std::string_view field = members.names.Name(members.fields.name[members.fields.Size() / 2]);
+                std::string query;
+                for (size_t i = 0; i < field.size() && query.size() < 6; i += 2) query += field[i];
+
+                const FuzzyMatcher matcher(query);
+                std::vector<bool> used(members.names.Size(), false);
+                for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) {
+                    for (SymbolId id : members.Columns(static_cast<MemberKind>(k)).name) used[id] = true;
+                }
+                size_t expectedMatched = 0;
+                for (SymbolId id = 0; id < members.names.Size(); id++) {
+                    expectedMatched += used[id] && matcher.Score(members.names.Name(id)) != FuzzyMatcher::NO_MATCH;
+                }
+
+                MemberSearchResult result;
+                std::vector<MemberHit> page;
+                record(Measure("member_fuzzy", typeCount, stringBytes, options.reps, nothing, [&]() {
+                    index.Search(query, MemberSearchTarget::Name, MEMBER_KIND_ALL, MatchMode::Fuzzy, result, &pool);
+                    index.Fetch(result, 0, 100, page);
+                    return result.matched == expectedMatched &&
+                           result.ids.size() == std::min(expectedMatched, MemberSearchIndex::MAX_FUZZY_STRINGS) &&
+                           !page.empty();
+                }));
+            }
+        }
+
+        if (wanted("member_table")) {
+            // The details pane showing a type with up to 10,000 methods (the
+            // first methods of the store, standing in for generated code): its
+            // table built as when the type is selected, then sorted by
+            // signature and filtered by part of one. Checked first against
+            // building each signature and searching it.
+            AssemblyData data;
+            ParseAssemblyData(payload, data);
+            MemberStore members;
+            members.Build(data);
+            const MemberRange range{0, static_cast<uint32_t>(std::min<size_t>(members.methods.Size(), 10000))};
+
+            std::vector<std::string> signatures;
+            for (uint32_t m = range.begin; m < range.end; m++) {
+                std::string signature = std::string(data.symbols.Name(members.methods.type[m])) + ' ' +
+                                        std::string(members.names.Name(members.methods.name[m])) + '(';
+                for (uint32_t p = members.methodParameters[m].begin; p < members.methodParameters[m].end; p++) {
+                    if (p > members.methodParameters[m].begin) signature += ", ";
+                    signature += std::string(data.symbols.Name(members.parameters.type[p])) + ' ' +
+                                 std::string(members.names.Name(members.parameters.name[p]));
+                }
+                signature += ')';
+                std::transform(signature.begin(), signature.end(), signature.begin(), ::tolower);
+                signatures.push_back(std::move(signature));
+            }
+            size_t bytes = 0;
+            for (const std::string& signature : signatures) bytes += signature.size();
+            const std::string middle = signatures.empty() ? std::string() : signatures[signatures.size() / 2];
+            const std::string query = middle.substr(middle.size() / 2, 4);
+            size_t expected = 0;
+            for (const std::string& signature : signatures) expected += signature.find(query) != std::string::npos;
+
+            MemberTable table;
+            table.Build(members, data.symbols, MemberKind::Method, range, 0);
+            const std::vector<uint32_t>& sorted = table.View({}, 0, MemberTable::COLUMN_TEXT, false);
+            bool sortedOk = sorted.size() == signatures.size();
+            for (size_t i = 1; sortedOk && i < sorted.size(); i++) {
+                sortedOk = signatures[sorted[i - 1]] <= signatures[sorted[i]];
+            }
+
+            record(Measure("member_table", typeCount, bytes, options.reps, nothing, [&]() {
+                table.Build(members, data.symbols, MemberKind::Method, range, 0);
+                const size_t rows = table.View({}, 0, MemberTable::COLUMN_TEXT, false).size();
+                const size_t matches = table.View(query, 0, MemberTable::COLUMN_TEXT, true).size();
+                return sortedOk && !query.empty() && rows == signatures.size() && matches == expected;
+            }));
+        }
+
+        if (wanted("apply_delta")) {
+            // 1% of the types change: a quarter removed, half modified, a quarter
+            // added. The index is built up front, as it is after a full snapshot.
+            AssemblyData base;
+            ParseAssemblyData(payload, base);
+            base.snapshotId = "base";
+            const size_t changed = std::max<size_t>(typeCount / 100, 4);
+            const size_t quarter = changed / 4;
+
+            // Deltas match types by full name, which the generator repeats (a real
+            // assembly does not), so only uniquely named types are picked
+            std::unordered_map<std::string_view, size_t> nameCounts;
+            for (const TypeInfo& type : base.types) nameCounts[type.fullName]++;
+            std::vector<size_t> picked;
+            const size_t step = std::max<size_t>(typeCount / changed / 2, 1);
+            for (size_t i = 0; i < typeCount && picked.size() < changed; i += step) {
+                if (nameCounts[base.types[i].fullName] == 1) picked.push_back(i);
+            }
+
+            AssemblyDelta source;
+            source.assemblyName = base.assemblyName;
+            source.baseSnapshotId = base.snapshotId;
+            source.snapshotId = "next";
+            source.symbols = base.symbols;
+            for (size_t i = 0; i < picked.size(); i++) {
+                const TypeInfo& type = base.types[picked[i]];
+                if (i < quarter) {
+                    source.removed.push_back({type.fullName});
+                    continue;
+                }
+                source.types.push_back(type);
+                if (i >= picked.size() - quarter) source.types.back().fullName += "Added";
+                source.types.back().fields.emplace_back().name = "deltaField";
+            }
+            std::string json;
+            EncodeJson(source, json);
+
+            DeltaApplier indexed;
+            indexed.Build(base);
+            AssemblyData data;
+            DeltaApplier applier;
+            AssemblyDelta delta;
+            std::vector<TypeChange> changes;
+            auto setup = [&]() {
+                data = base;
+                applier = indexed;
+                delta = AssemblyDelta();
+                ParseAssemblyDelta(json, delta);
+                changes.clear();
+            };
+            record(Measure("apply_delta", typeCount, json.size(), options.reps, setup, [&]() {
+                return applier.Apply(std::move(delta), data, changes) && changes.size() == picked.size() &&
+                       data.types.size() == typeCount;
+            }));
+        }
+
+        if (wanted("shm_read") || wanted("shm_stream")) {
+#ifdef _WIN32
+            const std::string ringName = "Local\\urv_bench_ring_" + std::to_string(GetCurrentProcessId());
+#else
+            const std::string ringName = "/urv_bench_ring_" + std::to_string(getpid());
+#endif
+            // The stand-in producer: creates the ring, writes one message, closes
+            SharedRingWriter ring;
+            std::thread writer;
+            auto startWriter = [&]() {
+                std::string error;
+                if (!ring.Create(ringName, SHARED_RING_DEFAULT_CAPACITY, error)) {
+                    fprintf(stderr, "%s\n", error.c_str());
+                    return;
+                }
+                writer = std::thread([&]() {
+                    ring.WriteMessage(MessageKind::AssemblyJson, 1, payload.data(), payload.size());
+                    ring.Close();
+                });
+            };
+            auto joinWriter = [&]() {
+                if (writer.joinable()) writer.join();
+            };
+
+            if (wanted("shm_read")) {
+                record(Measure("shm_read", typeCount, bytes, options.reps, startWriter, [&]() {
+                    IPCClient client(ringName, IPCClient::Transport::SharedMemory);
+                    const bool connected = client.Connect();
+                    const std::string data = connected ? client.ReadData() : std::string();
+                    client.Disconnect();
+                    joinWriter();
+                    return data.size() == payload.size();
+                }));
+            }
+
+            if (wanted("shm_stream")) {
+                record(Measure("shm_stream", typeCount, bytes, options.reps, startWriter, [&]() {
+                    size_t delivered = 0;
+                    bool parsed = false;
+                    StreamingParser parser([&delivered](TypeInfo&&) { delivered++; });
+                    IPCClient client(ringName, IPCClient::Transport::SharedMemory);
+                    client.SetStreamCallbacks(
+                        [](size_t) {}, [&parser](const char* data, size_t size) { return parser.Feed(data, size); },
+                        [&](bool complete) {
+                            AssemblyData header;
+                            parsed = complete && parser.Finish(header);
+                        });
+                    const bool connected = client.Connect();
+                    if (connected) client.ReadStream();
+                    client.Disconnect();
+                    joinWriter();
+                    return parsed && delivered == typeCount;
+                }));
+            }
+        }
+
+#ifndef _WIN32
+        const std::string fifoPath = "/tmp/urv_bench_fifo_" + std::to_string(getpid());
+
+        if (wanted("fifo_read") || wanted("fifo_stream") || wanted("fifo_read_lz4") || wanted("fifo_stream_lz4")) {
+            unlink(fifoPath.c_str());
+            if (mkfifo(fifoPath.c_str(), 0600) != 0) {
+                fprintf(stderr, "mkfifo %s failed: %s\n", fifoPath.c_str(), strerror(errno));
+            } else {
+                // Plain frames, and frames compressed the way IPCServer sends them to a
+                // viewer that offers LZ4; compression happens in the mod, before timing
+                std::string framed;
+                std::string compressed;
+                std::thread writer;
+                auto startWriter = [&](const std::string& frames) {
+                    return [&]() { writer = std::thread(WriteToFifo, fifoPath, std::cref(frames), options.linkMbps); };
+                };
+
+                auto fifoRead = [&](const char* name, const std::string& frames) {
+                    record(Measure(name, typeCount, bytes, options.reps, startWriter(frames), [&]() {
+                        IPCClient client(fifoPath);
+                        const bool connected = client.Connect();
+                        const std::string data = connected ? client.ReadData() : std::string();
+                        client.Disconnect();
+                        writer.join();
+                        return data.size() == payload.size();
+                    }));
+                };
+
+                auto fifoStream = [&](const char* name, const std::string& frames) {
+                    record(Measure(name, typeCount, bytes, options.reps, startWriter(frames), [&]() {
+                        size_t delivered = 0;
+                        bool parsed = false;
+                        StreamingParser parser([&delivered](TypeInfo&&) { delivered++; });
+                        IPCClient client(fifoPath);
+                        client.SetStreamCallbacks(
+                            [](size_t) {}, [&parser](const char* data, size_t size) { return parser.Feed(data, size); },
+                            [&](bool complete) {
+                                AssemblyData header;
+                                parsed = complete && parser.Finish(header);
+                            });
+                        const bool connected = client.Connect();
+                        if (connected) client.ReadStream();
+                        client.Disconnect();
+                        writer.join();
+                        return parsed && delivered == typeCount;
+                    }));
+                };
+
+                if (wanted("fifo_read") || wanted("fifo_stream")) {
+                    AppendMessage(framed, MessageKind::AssemblyJson, 1, payload.data(), payload.size());
+                }
+                if (wanted("fifo_read_lz4") || wanted("fifo_stream_lz4")) {
+                    AppendMessage(compressed, MessageKind::AssemblyJson, 1, payload.data(), payload.size(),
+                                  FRAME_CHUNK_SIZE, true);
+                }
+                if (wanted("fifo_read")) fifoRead("fifo_read", framed);
+                if (wanted("fifo_read_lz4")) fifoRead("fifo_read_lz4", compressed);
+                if (wanted("fifo_stream")) fifoStream("fifo_stream", framed);
+                if (wanted("fifo_stream_lz4")) fifoStream("fifo_stream_lz4", compressed);
+
+                unlink(fifoPath.c_str());
+            }
+        }
+
+        if (wanted("reconnect_current")) {
+            // A viewer reconnecting with the snapshot of the build the game
+            // still runs: the hello, then the NotModified reply and no payload
+            AssemblyData data;
+            ParseAssemblyData(payload, data);
+            StandInServer server(fifoPath, data);
+            std::string error;
+            if (!server.Create(error)) {
+                fprintf(stderr, "%s\n", error.c_str());
+            } else {
+                std::thread serving;
+                record(Measure("reconnect_current", typeCount, bytes, options.reps,
+                               [&]() { serving = std::thread([&server]() { server.ServeConnection(); }); },
+                               [&]() {
+                                   IPCClient client(fifoPath);
+                                   client.SetSnapshotId(data.snapshotId, data.moduleVersionId);
+                                   bool ok = client.Connect();
+                                   SnapshotNotModified reply;
+                                   ok = ok && ParseSnapshotNotModified(client.ReadData(), reply) &&
+                                        reply.moduleVersionId == data.moduleVersionId;
+                                   client.Disconnect();
+                                   serving.join();
+                                   return ok && server.LastWasNotModified();
+                               }));
+            }
+        }
+
+        if (wanted("query_headers") || wanted("query_fetch")) {
+            // Query mode against the stand-in server: the headers, then members
+            // of QUERY_TYPES types spread over the list, fetched the way the
+            // window does. Compare with fifo_read, which moves every member.
+            constexpr size_t QUERY_TYPES = 256;
+            AssemblyData data;
+            ParseAssemblyData(payload, data);
+            StandInServer server(fifoPath, data);
+            std::string error;
+            if (!server.Create(error)) {
+                fprintf(stderr, "%s\n", error.c_str());
+            } else {
+                std::thread serving;
+                auto startServer = [&]() { serving = std::thread([&server]() { server.ServeConnection(); }); };
+
+                auto query = [&](size_t fetchCount) {
+                    IPCClient client(fifoPath);
+                    client.SetQueryMode(true);
+                    if (!client.Connect()) return false;
+
+                    AssemblyData headers;
+                    bool ok = ParseAssemblyData(client.ReadData(), headers) && headers.types.size() == typeCount;
+
+                    MemberFetcher fetcher;
+                    fetcher.SetSender([&client](const std::string& request) {
+                        return client.Send(MessageKind::MemberRequest, request);
+                    });
+                    fetcher.Reset(headers.types.size());
+                    for (size_t i = 0; i < fetchCount; i++) fetcher.Request(i * typeCount / fetchCount);
+
+                    std::vector<uint32_t> fetched;
+                    while (ok && fetcher.FetchedCount() < fetchCount) {
+                        fetcher.Flush(MemberFetcher::Clock::now());
+                        MemberResponse response;
+                        ok = ParseMemberResponse(client.ReadData(), response);
+                        fetcher.Apply(response, headers, fetched);
+                    }
+                    client.Disconnect();
+                    serving.join();
+                    return ok && fetched.size() == fetchCount;
+                };
+
+                const size_t fetchCount = std::min(QUERY_TYPES, typeCount);
+                if (wanted("query_headers")) {
+                    record(Measure("query_headers", typeCount, bytes, options.reps, startServer,
+                                   [&]() { return query(0); }));
+                }
+                if (wanted("query_fetch")) {
+                    record(Measure("query_fetch", typeCount, bytes, options.reps, startServer,
+                                   [&]() { return query(fetchCount); }));
+                }
+            }
+        }
+#endif
+    }
+
+    if (!options.jsonPath.empty()) {
+        if (!WriteJson(options.jsonPath, options, pool.ThreadCount(), results)) {
+            fprintf(stderr, "Failed to write %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+        printf("\nResults written to %s\n", options.jsonPath.c_str());
+    }
+
+    for (const Result& r : results) {
+        if (!r.ok) return 1;
+    }
+    return 0;
+}
+
+} // namespace Bench
+} // namespace UnityReflection
+
+int main(int argc, char** argv) {
+    return UnityReflection::Bench::Run(argc, argv);
+}
@@ -0,0 +1,387 @@
+#include "payload_generator.h"
+#include <cstdio>
+#include <vector>
+
+namespace UnityReflection {
+namespace Bench {
+
+namespace {
+
+// SplitMix64: tiny, fast and identical everywhere, unlike the <random>
+// distributions whose output is implementation defined. Every draw is a separate
+// statement, since argument evaluation order is unspecified.
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state_(seed) {}
+
+    uint64_t Next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, n)
+    size_t Below(size_t n) { return static_cast<size_t>(Next() % n); }
+
+    // Uniform in [lo, hi]
+    size_t Between(size_t lo, size_t hi) { return lo + Below(hi - lo + 1); }
+
+    bool Chance(double p) { return (Next() >> 11) * (1.0 / 9007199254740992.0) < p; }
+
+    template <size_t N>
+    const char* Pick(const char* const (&items)[N]) { return items[Below(N)]; }
+
+private:
+    uint64_t state_;
+};
+
+const char* const NAMESPACES[] = {
+    "", "", "", "Game", "Game.UI", "Game.AI", "Game.Networking", "Game.Inventory",
+    "Game.Save", "Game.Audio", "Game.Utils", "Game.World", "ThirdParty.Json", "Plugins.Tweening",
+};
+
+const char* const WORDS[] = {
+    "Player", "Enemy", "Inventory", "Item", "Manager", "Controller", "State", "Spawner",
+    "Health", "Weapon", "Quest", "Dialog", "Camera", "Input", "Audio", "Data",
+    "Config", "Save", "Network", "Message", "Handler", "Pool", "Cache", "Event",
+    "View", "Panel", "Button", "Slot", "Effect", "Buff", "Ability", "Path",
+    "Node", "Grid", "Tile", "Chunk", "Loot", "Damage", "Projectile", "Animation",
+};
+
+const char* const VERBS[] = {
+    "Get", "Set", "Update", "Handle", "Try", "Create", "Destroy", "Apply",
+    "Remove", "Add", "Find", "Load", "Save", "Reset", "Refresh", "On",
+};
+
+const char* const UNITY_MESSAGES[] = {
+    "Awake", "Start", "Update", "FixedUpdate", "LateUpdate", "OnEnable", "OnDisable", "OnDestroy",
+};
+
+const char* const SIMPLE_TYPES[] = {
+    "System.Int32", "System.Int32", "System.Single", "System.Single", "System.String", "System.String",
+    "System.Boolean", "System.Boolean", "System.Double", "System.Int64", "System.Byte", "System.Object",
+    "UnityEngine.Vector3", "UnityEngine.Vector2", "UnityEngine.Quaternion", "UnityEngine.GameObject",
+    "UnityEngine.Transform", "UnityEngine.Color", "UnityEngine.Sprite", "UnityEngine.AudioClip",
+    "System.Int32[]", "UnityEngine.Vector3[]",
+};
+
+// Generic definitions as AssemblyReflector.GetTypeName prints them: bare name, arity
+struct GenericDefinition {
+    const char* name;
+    int arity;
+};
+
+const GenericDefinition GENERICS[] = {
+    {"List", 1}, {"List", 1}, {"Dictionary", 2}, {"HashSet", 1}, {"Queue", 1},
+    {"IEnumerable", 1}, {"Action", 1}, {"Action", 2}, {"Func", 2}, {"Func", 3},
+    {"Nullable", 1}, {"KeyValuePair", 2}, {"UnityEvent", 1},
+};
+
+const char* const GENERIC_BASE_TYPES[] = {
+    "System.Collections.Generic.List`1[[System.Int32, mscorlib, Version=4.0.0.0, Culture=neutral, "
+    "PublicKeyToken=b77a5c561934e089]]",
+    "Game.Utils.Singleton`1[[Game.GameManager, Assembly-CSharp, Version=0.0.0.0, Culture=neutral, "
+    "PublicKeyToken=null]]",
+};
+
+// Characters that make EscapeJson do work, as found in obfuscated assemblies
+const char* const ESCAPE_FRAGMENTS[] = {"\\", "\"", "\n", "\r", "\t", "\\\\", "\"\""};
+
+enum class Kind { Class, Struct, Enum, Interface };
+
+struct TypeHeader {
+    std::string name;
+    std::string fullName;
+    std::string namespaceName;
+    Kind kind;
+    bool compilerGenerated;
+};
+
+// Same replacements and order as IPCServer.EscapeJson
+void AppendEscaped(std::string& out, const std::string& s) {
+    for (char c : s) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: out += c; break;
+        }
+    }
+}
+
+void AppendString(std::string& out, const char* key, const std::string& value, bool comma = true) {
+    out += '"';
+    out += key;
+    out += "\":\"";
+    AppendEscaped(out, value);
+    out += comma ? "\"," : "\"";
+}
+
+void AppendBool(std::string& out, const char* key, bool value, bool comma = true) {
+    out += '"';
+    out += key;
+    out += "\":";
+    out += value ? "true" : "false";
+    if (comma) out += ',';
+}
+
+class Generator {
+public:
+    explicit Generator(const PayloadOptions& options) : options_(options), rng_(options.seed) {}
+
+    std::string Run() {
+        headers_.reserve(options_.typeCount);
+        for (size_t i = 0; i < options_.typeCount; i++) {
+            headers_.push_back(MakeHeader(i));
+        }
+
+        std::string out;
+        out.reserve(options_.typeCount * 1600 + 256);
+
+        out += '{';
+        AppendString(out, "assemblyName", "Assembly-CSharp");
+        out += "\"timestamp\":\"2024-05-17T12:34:56.1234567+00:00\",";
+
+        // A GUID as the mod formats the MVID, fixed by the seed like the types
+        char moduleVersionId[37];
+        uint64_t id = options_.seed * 0xD1B54A32D192ED03ull + 1;
+        snprintf(moduleVersionId, sizeof(moduleVersionId), "%08x-%04x-%04x-%04x-%012llx",
+                 static_cast<unsigned>(id >> 32), static_cast<unsigned>(id >> 16) & 0xFFFF,
+                 static_cast<unsigned>(id) & 0xFFFF, static_cast<unsigned>(options_.typeCount) & 0xFFFF,
+                 static_cast<unsigned long long>(id * 0x9E3779B97F4A7C15ull) & 0xFFFFFFFFFFFFull);
+        AppendString(out, "moduleVersionId", moduleVersionId);
+        out += "\"types\":[";
+        for (size_t i = 0; i < headers_.size(); i++) {
+            if (i > 0) out += ',';
+            AppendType(out, headers_[i]);
+        }
+        out += "],";
+
+        // The mod hashes the serialized types; any stable value will do here
+        char snapshotId[17];
+        snprintf(snapshotId, sizeof(snapshotId), "%016llx",
+                 static_cast<unsigned long long>(options_.seed * 0x9E3779B97F4A7C15ull ^ options_.typeCount));
+        AppendString(out, "snapshotId", snapshotId, false);
+        out += '}';
+        return out;
+    }
+
+private:
+    const PayloadOptions& options_;
+    Rng rng_;
+    std::vector<TypeHeader> headers_;
+
+    std::string Words(size_t minWords, size_t maxWords) {
+        std::string s;
+        const size_t count = rng_.Between(minWords, maxWords);
+        for (size_t i = 0; i < count; i++) s += rng_.Pick(WORDS);
+        return s;
+    }
+
+    // Adds escapable characters to a small fraction of names
+    std::string MaybeEscaped(std::string s) {
+        if (rng_.Chance(options_.escapeRatio)) {
+            const size_t at = rng_.Below(s.size() + 1);
+            s.insert(at, rng_.Pick(ESCAPE_FRAGMENTS));
+        }
+        return s;
+    }
+
+    static std::string Camel(std::string s) {
+        if (!s.empty() && s[0] >= 'A' && s[0] <= 'Z') s[0] = static_cast<char>(s[0] - 'A' + 'a');
+        return s;
+    }
+
+    TypeHeader MakeHeader(size_t index) {
+        TypeHeader header;
+        header.namespaceName = rng_.Pick(NAMESPACES);
+        header.compilerGenerated = index > 0 && rng_.Chance(0.15);
+
+        if (header.compilerGenerated) {
+            // Closures and iterators nested in an earlier type
+            const TypeHeader& outer = headers_[rng_.Below(index)];
+            switch (rng_.Below(3)) {
+                case 0: header.name = "<>c"; break;
+                case 1: header.name = "<>c__DisplayClass" + std::to_string(rng_.Below(20)) + "_0"; break;
+                default: {
+                    const std::string message = rng_.Pick(UNITY_MESSAGES);
+                    header.name = "<" + message + ">d__" + std::to_string(rng_.Below(40));
+                    break;
+                }
+            }
+            header.namespaceName = outer.namespaceName;
+            header.fullName = outer.fullName + "+" + header.name;
+            header.kind = Kind::Class;
+            return header;
+        }
+
+        const size_t roll = rng_.Below(100);
+        header.kind = roll < 70 ? Kind::Class : roll < 82 ? Kind::Struct : roll < 92 ? Kind::Enum : Kind::Interface;
+        header.name = (header.kind == Kind::Interface ? "I" : "") + Words(1, 3);
+        if (rng_.Chance(0.05)) header.name += "`" + std::to_string(rng_.Between(1, 2));
+        header.name = MaybeEscaped(header.name);
+        header.fullName = header.namespaceName.empty() ? header.name : header.namespaceName + "." + header.name;
+        return header;
+    }
+
+    // A member type name formatted like AssemblyReflector.GetTypeName
+    std::string MemberType(int depth) {
+        const size_t roll = rng_.Below(100);
+        if (roll < 20 && !headers_.empty()) return headers_[rng_.Below(headers_.size())].fullName;
+        if (roll < 35 && depth < options_.genericDepth) {
+            const GenericDefinition& generic = GENERICS[rng_.Below(sizeof(GENERICS) / sizeof(GENERICS[0]))];
+            std::string s = generic.name;
+            s += '<';
+            for (int i = 0; i < generic.arity; i++) {
+                if (i > 0) s += ", ";
+                s += MemberType(depth + 1);
+            }
+            s += '>';
+            return s;
+        }
+        return rng_.Pick(SIMPLE_TYPES);
+    }
+
+    std::string BaseType(const TypeHeader& header) {
+        switch (header.kind) {
+            case Kind::Struct: return "System.ValueType";
+            case Kind::Enum: return "System.Enum";
+            case Kind::Interface: return "";
+            case Kind::Class: break;
+        }
+        if (header.compilerGenerated) return "System.Object";
+
+        const size_t roll = rng_.Below(100);
+        if (roll < 40) return "UnityEngine.MonoBehaviour";
+        if (roll < 75) return "System.Object";
+        if (roll < 82) return "UnityEngine.ScriptableObject";
+        if (roll < 85) return rng_.Pick(GENERIC_BASE_TYPES);
+        return headers_[rng_.Below(headers_.size())].fullName;
+    }
+
+    void AppendField(std::string& out, const std::string& name, const std::string& type, bool isPublic, bool isStatic,
+                     bool isReadOnly) {
+        out += '{';
+        AppendString(out, "name", name);
+        AppendString(out, "fieldType", type);
+        AppendBool(out, "isPublic", isPublic);
+        AppendBool(out, "isStatic", isStatic);
+        AppendBool(out, "isReadOnly", isReadOnly, false);
+        out += '}';
+    }
+
+    void AppendFields(std::string& out, const TypeHeader& header) {
+        out += "\"fields\":[";
+
+        if (header.kind == Kind::Enum) {
+            // value__ plus one public static literal per member
+            AppendField(out, "value__", "System.Int32", true, false, false);
+            const size_t count = rng_.Between(2, 16);
+            for (size_t i = 0; i < count; i++) {
+                out += ',';
+                AppendField(out, MaybeEscaped(Words(1, 2)), header.fullName, true, true, false);
+            }
+        } else if (header.kind != Kind::Interface) {
+            const size_t count = header.compilerGenerated ? rng_.Between(0, 4) : rng_.Between(0, 12);
+            for (size_t i = 0; i < count; i++) {
+                if (i > 0) out += ',';
+                const bool isPublic = rng_.Chance(0.35);
+                std::string name;
+                switch (rng_.Below(4)) {
+                    case 0: name = "m_" + Words(1, 2); break;
+                    case 1: name = "_" + Camel(Words(1, 2)); break;
+                    case 2: name = "<" + Words(1, 2) + ">k__BackingField"; break;
+                    default: name = isPublic ? Words(1, 2) : Camel(Words(1, 2)); break;
+                }
+                name = MaybeEscaped(name);
+                const std::string type = MemberType(0);
+                const bool isStatic = rng_.Chance(0.1);
+                const bool isReadOnly = rng_.Chance(0.15);
+                AppendField(out, name, type, isPublic, isStatic, isReadOnly);
+            }
+        }
+
+        out += "],";
+    }
+
+    void AppendMethods(std::string& out, const TypeHeader& header) {
+        out += "\"methods\":[";
+
+        const size_t count = header.kind == Kind::Enum ? 0 : rng_.Between(0, header.compilerGenerated ? 4 : 15);
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) out += ',';
+
+            std::string name;
+            if (header.kind == Kind::Class && rng_.Chance(0.2)) {
+                name = rng_.Pick(UNITY_MESSAGES);
+            } else {
+                name = rng_.Pick(VERBS);
+                name += Words(1, 2);
+            }
+            const std::string returnType = rng_.Chance(0.45) ? "System.Void" : MemberType(0);
+
+            out += '{';
+            AppendString(out, "name", MaybeEscaped(name));
+            AppendString(out, "returnType", returnType);
+            AppendBool(out, "isPublic", header.kind == Kind::Interface || rng_.Chance(0.6));
+            AppendBool(out, "isStatic", header.kind != Kind::Interface && rng_.Chance(0.1));
+            out += "\"parameters\":[";
+            const size_t paramCount = rng_.Below(5);
+            for (size_t p = 0; p < paramCount; p++) {
+                if (p > 0) out += ',';
+                out += '{';
+                AppendString(out, "name", MaybeEscaped(Camel(Words(1, 2))));
+                AppendString(out, "parameterType", MemberType(0), false);
+                out += '}';
+            }
+            out += "]}";
+        }
+
+        out += "],";
+    }
+
+    void AppendProperties(std::string& out, const TypeHeader& header) {
+        out += "\"properties\":[";
+
+        const size_t count = (header.kind == Kind::Enum || header.compilerGenerated) ? 0 : rng_.Between(0, 6);
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) out += ',';
+            out += '{';
+            AppendString(out, "name", MaybeEscaped(Words(1, 2)));
+            AppendString(out, "propertyType", MemberType(0));
+            AppendBool(out, "canRead", rng_.Chance(0.95));
+            AppendBool(out, "canWrite", rng_.Chance(0.6), false);
+            out += '}';
+        }
+
+        out += ']';
+    }
+
+    void AppendType(std::string& out, const TypeHeader& header) {
+        out += '{';
+        AppendString(out, "name", header.name);
+        AppendString(out, "fullName", header.fullName);
+        AppendString(out, "namespace", header.namespaceName);
+        AppendString(out, "baseType", BaseType(header));
+        AppendBool(out, "isClass", header.kind == Kind::Class);
+        AppendBool(out, "isStruct", header.kind == Kind::Struct);
+        AppendBool(out, "isEnum", header.kind == Kind::Enum);
+        AppendBool(out, "isInterface", header.kind == Kind::Interface);
+        AppendFields(out, header);
+        AppendMethods(out, header);
+        AppendProperties(out, header);
+        out += '}';
+    }
+};
+
+} // namespace
+
+std::string GeneratePayload(const PayloadOptions& options) {
+    return Generator(options).Run();
+}
+
+} // namespace Bench
+} // namespace UnityReflection
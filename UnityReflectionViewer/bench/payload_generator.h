@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace UnityReflection {
+namespace Bench {
+
+struct PayloadOptions {
+    size_t typeCount = 10000;
+    uint64_t seed = 1;
+
+    // Nesting limit for generic member types such as Dictionary<String, List<Int32>>
+    int genericDepth = 3;
+
+    // Fraction of names that get characters EscapeJson has to escape
+    double escapeRatio = 0.01;
+};
+
+// Deterministic synthetic Assembly-CSharp payload, byte for byte in the format
+// IPCServer.SerializeToJson writes: same key order, no whitespace, same escaping
+// and type name formatting as AssemblyReflector. The same options give the same
+// bytes on every platform.
+std::string GeneratePayload(const PayloadOptions& options);
+
+} // namespace Bench
+} // namespace UnityReflection
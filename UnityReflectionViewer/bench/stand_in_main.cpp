@@ -0,0 +1,92 @@
+// Serves a synthetic assembly, or one read from a JSON file, on the viewer's
+// pipe the way the mod does, so the viewer can be run without Unity. POSIX only.
+//
+//   urv_stand_in [--pipe /tmp/UnityReflectionPipe] [--types 10000] [--seed 1] [--json assembly.json]
+
+#include "ipc_client.h"
+#include "payload_generator.h"
+#include "reflection_data.h"
+#include "stand_in_server.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+
+UnityReflection::Bench::StandInServer* g_server = nullptr;
+
+void HandleSignal(int) {
+    if (g_server) g_server->Stop();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace UnityReflection;
+
+    std::string pipe = IPCClient::DEFAULT_PIPE_NAME;
+    std::string jsonPath;
+    Bench::PayloadOptions payloadOptions;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--pipe" && hasValue) {
+            pipe = argv[++i];
+        } else if (arg == "--types" && hasValue) {
+            payloadOptions.typeCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && hasValue) {
+            payloadOptions.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: urv_stand_in [--pipe path] [--types N] [--seed N] [--json assembly.json]\n");
+            return 2;
+        }
+    }
+
+    std::string json;
+    if (jsonPath.empty()) {
+        json = Bench::GeneratePayload(payloadOptions);
+    } else {
+        std::ifstream file(jsonPath, std::ios::binary);
+        json.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    AssemblyData data;
+    if (!ParseAssemblyData(json, data)) {
+        fprintf(stderr, "Failed to parse the assembly\n");
+        return 1;
+    }
+
+    Bench::StandInServer server(pipe, data);
+    std::string error;
+    if (!server.Create(error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    g_server = &server;
+    signal(SIGINT, HandleSignal);
+    signal(SIGTERM, HandleSignal);
+    signal(SIGPIPE, SIG_IGN); // a viewer that leaves mid-write ends its connection, not the server
+
+    printf("Serving %zu types on %s\n", data.types.size(), pipe.c_str());
+    uint64_t requests = 0;
+    while (server.ServeConnection()) {
+        if (server.LastWasQuery()) {
+            printf("Served type headers and %llu member requests\n",
+                   static_cast<unsigned long long>(server.RequestsServed() - requests));
+            requests = server.RequestsServed();
+        } else if (server.LastWasNotModified()) {
+            printf("Told the viewer its snapshot is current\n");
+        } else {
+            printf("Served a full snapshot\n");
+        }
+        fflush(stdout);
+    }
+    return 0;
+}
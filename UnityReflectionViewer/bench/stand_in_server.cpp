@@ -0,0 +1,269 @@
+#include "stand_in_server.h"
+#include "ipc_client.h"
+#include "schema_codec.h"
+#include "snapshot_file.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace UnityReflection {
+namespace Bench {
+
+namespace {
+
+constexpr int HELLO_TIMEOUT_MS = 250; // as IPCServer waits
+constexpr int POLL_INTERVAL_MS = 100; // how often Stop is checked
+
+#ifndef _WIN32
+bool WriteAll(int fd, const std::string& bytes) {
+    size_t written = 0;
+    while (written < bytes.size()) {
+        const ssize_t n = write(fd, bytes.data() + written, bytes.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+StandInServer::StandInServer(std::string path, const AssemblyData& data) : path_(std::move(path)), data_(data) {
+    decoder_.SetCallbacks(
+        [this](MessageKind kind, uint64_t) {
+            incoming_.first = kind;
+            incoming_.second.clear();
+        },
+        [this](const char* bytes, size_t size) {
+            incoming_.second.append(bytes, size);
+            return true;
+        },
+        [this](bool complete) {
+            if (complete) messages_.push_back(std::move(incoming_));
+            incoming_ = Message();
+        });
+}
+
+StandInServer::~StandInServer() {
+#ifndef _WIN32
+    if (requestFd_ != -1) close(requestFd_);
+    unlink(path_.c_str());
+    unlink((path_ + IPCClient::REQUEST_PIPE_SUFFIX).c_str());
+#endif
+}
+
+bool StandInServer::Create(std::string& error) {
+#ifdef _WIN32
+    error = "The stand-in server needs POSIX FIFOs";
+    return false;
+#else
+    const std::string requestPath = path_ + IPCClient::REQUEST_PIPE_SUFFIX;
+    unlink(path_.c_str());
+    unlink(requestPath.c_str());
+    if (mkfifo(requestPath.c_str(), 0600) != 0 || mkfifo(path_.c_str(), 0600) != 0) {
+        error = "mkfifo " + path_ + " failed: " + strerror(errno);
+        return false;
+    }
+
+    // Read-write, so it never reads end-of-file between viewers
+    requestFd_ = open(requestPath.c_str(), O_RDWR | O_NONBLOCK);
+    if (requestFd_ == -1) {
+        error = "open " + requestPath + " failed: " + strerror(errno);
+        return false;
+    }
+    return true;
+#endif
+}
+
+void StandInServer::Stop() {
+    stopping_ = true;
+}
+
+bool StandInServer::ServeConnection() {
+#ifdef _WIN32
+    return false;
+#else
+    if (requestFd_ == -1) return false;
+
+    // Opening the write end without a reader fails, so this polls for a viewer
+    // instead of blocking where Stop cannot reach it
+    int fd = -1;
+    while (!stopping_) {
+        fd = open(path_.c_str(), O_WRONLY | O_NONBLOCK);
+        if (fd != -1) break;
+        if (errno != ENXIO && errno != EINTR) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (fd == -1) return false;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+    // Like IPCServer, a viewer that sends no hello gets a full snapshot. Only
+    // the fields the viewer's hello can contain are looked for.
+    bool query = false;
+    bool compress = false;
+    bool binary = false;
+    bool progress = false;
+    bool current = false;
+    Message message;
+    while (NextMessage(fd, HELLO_TIMEOUT_MS, message)) {
+        if (message.first != MessageKind::Hello) continue;
+        query = message.second.find("\"query\":true") != std::string::npos;
+        compress = message.second.find("\"lz4\"") != std::string::npos;
+        binary = message.second.find("\"binary\":true") != std::string::npos;
+        progress = message.second.find("\"progress\":true") != std::string::npos;
+        current = !data_.moduleVersionId.empty() &&
+                  message.second.find("\"moduleVersionId\":\"" + data_.moduleVersionId + '"') != std::string::npos;
+        break;
+    }
+    lastWasQuery_ = query;
+    lastWasNotModified_ = current && !query;
+
+    if (query) {
+        ServeQuery(fd, compress);
+    } else if (current) {
+        // The data never changes, so a viewer holding its build is always current
+        const std::string reply = "{\"moduleVersionId\":\"" + data_.moduleVersionId + "\"}";
+        std::string frames;
+        AppendMessage(frames, MessageKind::NotModified, ++messageId_, reply.data(), reply.size(), FRAME_CHUNK_SIZE,
+                      false);
+        WriteAll(fd, frames);
+    } else {
+        std::string payload;
+        if (binary) {
+            SnapshotWriter writer;
+            writer.AddAssemblyData(data_);
+            writer.Serialize(payload);
+        } else {
+            EncodeJson(data_, payload);
+        }
+        // Like IPCServer, the type count goes first to a viewer that asks for
+        // progress; there is nothing to report after it
+        std::string frames;
+        if (progress) {
+            const std::string report = "{\"typesDone\":0,\"typesTotal\":" + std::to_string(data_.types.size()) + "}";
+            AppendMessage(frames, MessageKind::Progress, ++messageId_, report.data(), report.size(), FRAME_CHUNK_SIZE,
+                          false);
+        }
+        AppendMessage(frames, binary ? MessageKind::AssemblyBinary : MessageKind::AssemblyJson, ++messageId_,
+                      payload.data(), payload.size(), FRAME_CHUNK_SIZE, compress);
+        WriteAll(fd, frames);
+    }
+    close(fd);
+    return true;
+#endif
+}
+
+void StandInServer::ServeQuery(int pipeFd, bool compress) {
+#ifdef _WIN32
+    (void)pipeFd;
+    (void)compress;
+#else
+    // The headers carry every type with empty member arrays (the mod leaves
+    // them out; the viewer reads either) and no snapshot id, as nothing is hashed
+    if (headersJson_.empty()) {
+        AssemblyData headers;
+        headers.assemblyName = data_.assemblyName;
+        headers.timestamp = data_.timestamp;
+        headers.symbols = data_.symbols;
+        headers.types.reserve(data_.types.size());
+        for (const TypeInfo& type : data_.types) {
+            TypeInfo& header = headers.types.emplace_back();
+            header.name = type.name;
+            header.fullName = type.fullName;
+            header.namespaceName = type.namespaceName;
+            header.baseType = type.baseType;
+            header.isClass = type.isClass;
+            header.isStruct = type.isStruct;
+            header.isEnum = type.isEnum;
+            header.isInterface = type.isInterface;
+        }
+        EncodeJson(headers, headersJson_);
+    }
+
+    std::string frames;
+    AppendMessage(frames, MessageKind::TypeHeaders, ++messageId_, headersJson_.data(), headersJson_.size(),
+                  FRAME_CHUNK_SIZE, compress);
+    if (!WriteAll(pipeFd, frames)) return;
+
+    // Same bytes as EncodeJson(MemberResponse), without copying the symbol
+    // table into each response
+    Message message;
+    MemberRequest request;
+    std::string response;
+    while (NextMessage(pipeFd, -1, message)) {
+        if (message.first != MessageKind::MemberRequest) continue;
+        request = MemberRequest();
+        if (!ParseMemberRequest(message.second, request)) continue;
+
+        response = "{\"requestId\":" + std::to_string(request.requestId) + ",\"types\":[";
+        for (size_t i = 0; i < request.types.size(); i++) {
+            if (i > 0) response += ',';
+            const uint32_t index = request.types[i].index;
+            if (index < data_.types.size()) {
+                EncodeJson(data_.types[index], data_.symbols, response);
+            } else {
+                response += "{}";
+            }
+        }
+        response += "]}";
+
+        frames.clear();
+        AppendMessage(frames, MessageKind::MemberResponse, ++messageId_, response.data(), response.size(),
+                      FRAME_CHUNK_SIZE, compress);
+        if (!WriteAll(pipeFd, frames)) return;
+        requestsServed_++;
+        typesServed_ += request.types.size();
+    }
+#endif
+}
+
+bool StandInServer::NextMessage(int pipeFd, int timeoutMs, Message& message) {
+#ifdef _WIN32
+    (void)pipeFd;
+    (void)timeoutMs;
+    (void)message;
+    return false;
+#else
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    char buffer[16 * 1024];
+    while (messages_.empty()) {
+        if (stopping_) return false;
+
+        int waitMs = POLL_INTERVAL_MS;
+        if (timeoutMs >= 0) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) return false;
+            waitMs = static_cast<int>(std::min<int64_t>(left.count(), POLL_INTERVAL_MS));
+        }
+
+        // The write end reports POLLERR once the viewer has closed its side
+        pollfd fds[2] = {{requestFd_, POLLIN, 0}, {pipeFd, 0, 0}};
+        if (poll(fds, 2, waitMs) < 0 && errno != EINTR) return false;
+        if (fds[1].revents & (POLLERR | POLLHUP)) return false;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        ssize_t n;
+        while ((n = read(requestFd_, buffer, sizeof(buffer))) > 0) {
+            decoder_.Feed(buffer, static_cast<size_t>(n));
+        }
+    }
+
+    message = std::move(messages_.front());
+    messages_.pop_front();
+    return true;
+#endif
+}
+
+} // namespace Bench
+} // namespace UnityReflection
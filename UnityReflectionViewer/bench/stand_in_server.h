@@ -0,0 +1,70 @@
+#pragma once
+
+#include "frame_protocol.h"
+#include "reflection_data.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+
+namespace UnityReflection {
+namespace Bench {
+
+// The game side of the pipe protocol over a POSIX FIFO pair (the pipe and
+// <pipe>.req), for the benchmark and for running the viewer without Unity.
+// It answers the way IPCServer does: a viewer whose hello asks for query mode
+// gets the type headers and then has its member requests served until it
+// disconnects; one whose hello names the data's module version id is told its
+// snapshot is current; any other viewer gets the full snapshot, binary if its
+// hello offers that. Then the pipe is closed.
+class StandInServer {
+public:
+    // data must outlive the server
+    StandInServer(std::string path, const AssemblyData& data);
+    ~StandInServer();
+
+    StandInServer(const StandInServer&) = delete;
+    StandInServer& operator=(const StandInServer&) = delete;
+
+    // Creates both FIFOs, replacing whatever is at their paths
+    bool Create(std::string& error);
+
+    // Waits for a viewer and serves it until it disconnects or Stop is called.
+    // False if the FIFOs could not be used or Stop came before a viewer did.
+    bool ServeConnection();
+
+    // From another thread: ServeConnection returns within about 100 ms
+    void Stop();
+
+    bool LastWasQuery() const { return lastWasQuery_; }
+    bool LastWasNotModified() const { return lastWasNotModified_; }
+    uint64_t RequestsServed() const { return requestsServed_; }
+    uint64_t TypesServed() const { return typesServed_; }
+
+private:
+    using Message = std::pair<MessageKind, std::string>;
+
+    // Waits up to timeoutMs (-1: no limit) for the next complete message on the
+    // request FIFO; false on timeout, on Stop or once the reader of pipeFd leaves
+    bool NextMessage(int pipeFd, int timeoutMs, Message& message);
+    void ServeQuery(int pipeFd, bool compress);
+
+    std::string path_;
+    const AssemblyData& data_;
+    std::string headersJson_; // built on the first query connection
+    int requestFd_ = -1;
+    uint32_t messageId_ = 0;
+    FrameDecoder decoder_;
+    std::deque<Message> messages_; // decoded, not yet handled
+    Message incoming_;             // being reassembled
+    std::atomic<bool> stopping_{false};
+    bool lastWasQuery_ = false;
+    bool lastWasNotModified_ = false;
+    uint64_t requestsServed_ = 0;
+    uint64_t typesServed_ = 0;
+};
+
+} // namespace Bench
+} // namespace UnityReflection
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace UnityReflection {
+
+// Bump allocator that frees everything at once. Sized up front with Reserve() so a
+// whole snapshot lives in a single block; further blocks are only added if the
+// reservation was too small.
+class MonotonicArena {
+public:
+    MonotonicArena() = default;
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    // Makes sure the next `bytes` bytes can be allocated without a new block
+    void Reserve(size_t bytes) {
+        if (static_cast<size_t>(end_ - cursor_) < bytes) AddBlock(bytes);
+    }
+
+    void* Allocate(size_t bytes, size_t alignment) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(cursor_);
+        size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+        if (static_cast<size_t>(end_ - cursor_) < bytes + padding) {
+            AddBlock(std::max(bytes + alignment, nextBlockSize_));
+            address = reinterpret_cast<uintptr_t>(cursor_);
+            padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+        }
+        char* result = cursor_ + padding;
+        cursor_ = result + bytes;
+        bytesUsed_ += bytes + padding;
+        return result;
+    }
+
+    // Only trivially destructible types: nothing is ever destroyed individually
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        if (count == 0) return nullptr;
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void Release() {
+        blocks_.clear();
+        cursor_ = end_ = nullptr;
+        bytesUsed_ = bytesReserved_ = 0;
+    }
+
+    size_t BytesUsed() const { return bytesUsed_; }
+    size_t BytesReserved() const { return bytesReserved_; }
+    size_t BlockCount() const { return blocks_.size(); }
+
+private:
+    void AddBlock(size_t bytes) {
+        blocks_.emplace_back(new char[bytes]);
+        cursor_ = blocks_.back().get();
+        end_ = cursor_ + bytes;
+        bytesReserved_ += bytes;
+        nextBlockSize_ = std::max(nextBlockSize_, bytes);
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t bytesUsed_ = 0;
+    size_t bytesReserved_ = 0;
+    size_t nextBlockSize_ = 64 * 1024;
+};
+
+// Fixed-size array living in a MonotonicArena
+template <typename T>
+class ArenaArray {
+public:
+    ArenaArray() = default;
+    ArenaArray(const T* data, uint32_t size) : data_(data), size_(size) {}
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    const T* data_ = nullptr;
+    uint32_t size_ = 0;
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,77 @@
+#include "assembly_delta.h"
+#include "schema.h"
+
+namespace UnityReflection {
+
+void DeltaApplier::Reset() {
+    index_.clear();
+    built_ = false;
+}
+
+void DeltaApplier::Build(const AssemblyData& data) {
+    index_.clear();
+    index_.reserve(data.types.size());
+    for (size_t i = 0; i < data.types.size(); i++) {
+        index_.emplace(data.types[i].fullName, static_cast<uint32_t>(i));
+    }
+    built_ = true;
+}
+
+bool DeltaApplier::Apply(AssemblyDelta&& delta, AssemblyData& data, std::vector<TypeChange>& changes) {
+    if (delta.baseSnapshotId.empty() || delta.baseSnapshotId != data.snapshotId) return false;
+    if (!built_) Build(data);
+
+    for (const TypeRef& ref : delta.removed) {
+        auto it = index_.find(ref.fullName);
+        if (it == index_.end()) continue;
+
+        TypeChange change;
+        change.kind = TypeChange::Kind::Removed;
+        change.index = it->second;
+        change.movedFrom = static_cast<uint32_t>(data.types.size() - 1);
+        change.previous = std::move(data.types[change.index]);
+        index_.erase(it);
+
+        if (change.movedFrom != change.index) {
+            data.types[change.index] = std::move(data.types[change.movedFrom]);
+            index_[data.types[change.index].fullName] = change.index;
+        }
+        data.types.pop_back();
+        changes.push_back(std::move(change));
+    }
+
+    // The delta's names go into the data's table; the table only grows, so ids
+    // already handed out stay valid
+    std::vector<SymbolId> remap(delta.symbols.Size());
+    for (SymbolId id = 0; id < remap.size(); id++) {
+        remap[id] = data.symbols.Intern(delta.symbols.Name(id));
+    }
+
+    for (TypeInfo& type : delta.types) {
+        RemapSymbols(type, remap);
+
+        TypeChange change;
+        auto it = index_.find(type.fullName);
+        if (it != index_.end()) {
+            change.kind = TypeChange::Kind::Replaced;
+            change.index = it->second;
+            change.previous = std::move(data.types[change.index]);
+            data.types[change.index] = std::move(type);
+        } else {
+            change.kind = TypeChange::Kind::Added;
+            change.index = static_cast<uint32_t>(data.types.size());
+            index_.emplace(type.fullName, change.index);
+            data.types.push_back(std::move(type));
+        }
+        change.movedFrom = change.index;
+        changes.push_back(std::move(change));
+    }
+
+    data.assemblyName = std::move(delta.assemblyName);
+    data.timestamp = std::move(delta.timestamp);
+    data.moduleVersionId = std::move(delta.moduleVersionId);
+    data.snapshotId = std::move(delta.snapshotId);
+    return true;
+}
+
+} // namespace UnityReflection
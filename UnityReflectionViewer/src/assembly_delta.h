@@ -0,0 +1,50 @@
+#pragma once
+
+#include "reflection_data.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace UnityReflection {
+
+// One step of applying a delta, for views indexed by position in
+// AssemblyData::types (member store, lazy spans, selection, stats)
+struct TypeChange {
+    enum class Kind {
+        Removed,  // types[index] was dropped and the last type moved into its place
+        Replaced, // types[index] has new contents
+        Added     // types[index] was appended
+    };
+
+    Kind kind = Kind::Added;
+    uint32_t index = 0;
+    uint32_t movedFrom = 0; // Removed: where the type now at index was; == index if it was the last
+    TypeInfo previous;      // Removed, Replaced: the old type
+};
+
+// Patches an AssemblyData in place with deltas from the mod. Types are found by
+// full name through a hash index kept next to the data, so a delta costs time
+// in the number of types it changes, not the size of the assembly. Removal swaps
+// the last type into the gap; type order is not preserved.
+class DeltaApplier {
+public:
+    // Forgets the index; call whenever the data is replaced by a full snapshot.
+    // It is rebuilt from the data on the next Apply.
+    void Reset();
+
+    // Indexes data now instead of on the first Apply
+    void Build(const AssemblyData& data);
+
+    // Applies delta to data if data is the snapshot it was made against and
+    // appends the steps taken to changes. Returns false, leaving data alone,
+    // if the base does not match.
+    bool Apply(AssemblyDelta&& delta, AssemblyData& data, std::vector<TypeChange>& changes);
+
+private:
+    // Full name -> position in AssemblyData::types
+    std::unordered_map<std::string, uint32_t> index_;
+    bool built_ = false;
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,228 @@
+#include "assembly_snapshot.h"
+#include "json_cursor.h"
+#include "schema.h"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace UnityReflection {
+
+// The grammar of JsonParser in reflection_data.cpp, generated from the view
+// entries in schema.h, producing views instead of owned strings. Member arrays
+// are gathered in reusable scratch vectors and copied into the arena once their
+// closing bracket is reached; like the vectors they replace, repeated keys append.
+class SnapshotParser : public JsonCursor {
+public:
+    SnapshotParser(AssemblySnapshot& snapshot, const StructuralIndex& index)
+        : JsonCursor(snapshot.buffer_.data(), snapshot.buffer_.size(), index),
+          buffer_(&snapshot.buffer_[0]), snapshot_(snapshot) {}
+
+    bool ParseAssemblyData() {
+        SkipWhitespace();
+        return ParseObject(snapshot_);
+    }
+
+private:
+    char* buffer_;
+    AssemblySnapshot& snapshot_;
+    // No array contains another of its own kind, so one scratch vector per kind
+    // is enough
+    std::tuple<std::vector<TypeView>, std::vector<FieldView>, std::vector<MethodView>,
+               std::vector<ParameterView>, std::vector<PropertyView>> scratch_;
+
+    // Strings with escapes are decoded over their own bytes in the buffer
+    std::string_view ParseStringView() {
+        if (!Expect('"')) return {};
+
+        const size_t begin = pos_;
+        const size_t end = index_.NextQuote(pos_);
+        size_t length = end - begin;
+        if (index_.HasBackslash(begin, end)) {
+            length = UnescapeTo(begin, end, buffer_ + begin);
+        }
+
+        pos_ = end;
+        Expect('"');
+        return std::string_view(buffer_ + begin, length);
+    }
+
+    // Decodes an object through Schema<T>; unknown keys are skipped
+    template <typename T>
+    bool ParseObject(T& object) {
+        if (!Expect('{')) return false;
+
+        while (pos_ < size_) {
+            SkipWhitespace();
+            if (Peek() == '}') {
+                pos_++;
+                return true;
+            }
+
+            std::string_view key = ParseKey();
+            SkipWhitespace();
+            if (!Expect(':')) return false;
+            SkipWhitespace();
+
+            bool ok = true;
+            if (!VisitField<T>(SchemaKeys<T>::Find(key), [&](const auto& field) { ok = ParseField(field, object); })) {
+                SkipValue();
+            }
+            if (!ok) return false;
+
+            SkipWhitespace();
+            if (Peek() == ',') pos_++;
+        }
+
+        return true;
+    }
+
+    template <typename Field>
+    bool ParseField(const Field& field, typename Field::OwnerType& object) {
+        auto& value = object.*field.member;
+        if constexpr (Field::KIND == FieldKind::String || Field::KIND == FieldKind::Symbol) {
+            value = ParseStringView();
+        } else if constexpr (Field::KIND == FieldKind::Bool) {
+            value = ParseBool();
+        } else if constexpr (Field::KIND == FieldKind::UInt) {
+            value = ParseUInt();
+        } else {
+            // As in ParseAssemblyData, a broken member array only cuts that
+            // array short; only a broken "types" array fails the parse
+            const bool ok = ParseArray(value);
+            return ok || !std::is_same_v<typename Field::ValueType, ArenaArray<TypeView>>;
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool ParseArray(ArenaArray<T>& out) {
+        std::vector<T>& scratch = std::get<std::vector<T>>(scratch_);
+        const bool ok = ParseElements(scratch);
+        Commit(scratch, out);
+        return ok;
+    }
+
+    template <typename T>
+    bool ParseElements(std::vector<T>& values) {
+        if (!Expect('[')) return false;
+
+        while (pos_ < size_) {
+            SkipWhitespace();
+            if (Peek() == ']') {
+                pos_++;
+                return true;
+            }
+
+            // Parse in place; a failed element is dropped again
+            if (!ParseObject(values.emplace_back())) {
+                values.pop_back();
+                return false;
+            }
+
+            SkipWhitespace();
+            if (Peek() == ',') pos_++;
+        }
+
+        return true;
+    }
+
+    template <typename T>
+    void Commit(std::vector<T>& scratch, ArenaArray<T>& out) {
+        if (scratch.empty()) return;
+
+        const size_t count = out.size() + scratch.size();
+        T* items = snapshot_.arena_.AllocateArray<T>(count);
+        std::copy(out.begin(), out.end(), items);
+        std::copy(scratch.begin(), scratch.end(), items + out.size());
+        out = ArenaArray<T>(items, static_cast<uint32_t>(count));
+        scratch.clear();
+    }
+};
+
+namespace {
+
+// Upper bound of the arena bytes a payload needs. Objects in the schema sit at
+// fixed depths (types at 3, fields/methods/properties at 5, parameters at 7), so
+// counting object openings per depth outside strings sizes every array.
+size_t EstimateArenaBytes(const char* data, const StructuralIndex& index) {
+    size_t objectsAtDepth[8] = {};
+    int depth = 0;
+    index.ForEachBracket(data, [&](size_t, char c) {
+        if (c == '{' || c == '[') {
+            depth++;
+            if (c == '{' && depth < 8) objectsAtDepth[depth]++;
+        } else if (depth > 0) {
+            depth--;
+        }
+    });
+
+    const size_t memberBytes = std::max({sizeof(FieldView), sizeof(MethodView), sizeof(PropertyView)});
+    return objectsAtDepth[3] * sizeof(TypeView) +
+           objectsAtDepth[5] * (memberBytes + alignof(MethodView)) +
+           objectsAtDepth[7] * sizeof(ParameterView) +
+           4096;
+}
+
+template <typename View, typename Owned>
+void CopyObject(const View& view, Owned& out, SymbolTable& symbols);
+
+// Field I of a view into field I of the struct it mirrors; arrays append
+template <size_t I, typename View, typename Owned>
+void CopyField(const View& view, Owned& out, SymbolTable& symbols) {
+    const auto& value = view.*std::get<I>(Schema<View>::FIELDS).member;
+    auto& target = out.*std::get<I>(Schema<Owned>::FIELDS).member;
+    using Field = std::decay_t<decltype(std::get<I>(Schema<Owned>::FIELDS))>;
+    if constexpr (Field::KIND == FieldKind::String) {
+        target.assign(value);
+    } else if constexpr (Field::KIND == FieldKind::Symbol) {
+        target = symbols.Intern(value);
+    } else if constexpr (Field::KIND == FieldKind::Array) {
+        target.reserve(target.size() + value.size());
+        for (const auto& element : value) CopyObject(element, target.emplace_back(), symbols);
+    } else {
+        target = value;
+    }
+}
+
+template <typename View, typename Owned, size_t... I>
+void CopyFields(const View& view, Owned& out, SymbolTable& symbols, std::index_sequence<I...>) {
+    (CopyField<I>(view, out, symbols), ...);
+}
+
+template <typename View, typename Owned>
+void CopyObject(const View& view, Owned& out, SymbolTable& symbols) {
+    CopyFields(view, out, symbols, std::make_index_sequence<SCHEMA_FIELD_COUNT<View>>());
+}
+
+} // namespace
+
+void AssemblySnapshot::Clear() {
+    assemblyName = {};
+    timestamp = {};
+    moduleVersionId = {};
+    types = {};
+    snapshotId = {};
+    arena_.Release();
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+void AssemblySnapshot::ToAssemblyData(AssemblyData& data) const {
+    CopyObject(*this, data, data.symbols);
+}
+
+bool ParseAssemblySnapshot(std::string json, AssemblySnapshot& snapshot) {
+    snapshot.Clear();
+    snapshot.buffer_ = std::move(json);
+
+    StructuralIndex index;
+    index.Build(snapshot.buffer_.data(), snapshot.buffer_.size());
+    snapshot.arena_.Reserve(EstimateArenaBytes(snapshot.buffer_.data(), index));
+
+    SnapshotParser parser(snapshot, index);
+    return parser.ParseAssemblyData();
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "arena.h"
+#include "reflection_data.h"
+#include <string>
+#include <string_view>
+
+namespace UnityReflection {
+
+// Zero-copy counterparts of the structs in reflection_data.h. Strings are views into
+// the snapshot's receive buffer and member arrays live in the snapshot's arena, so
+// all of these are trivially destructible.
+
+struct ParameterView {
+    std::string_view name;
+    std::string_view parameterType;
+};
+
+struct MethodView {
+    std::string_view name;
+    std::string_view returnType;
+    bool isPublic = false;
+    bool isStatic = false;
+    ArenaArray<ParameterView> parameters;
+};
+
+struct FieldView {
+    std::string_view name;
+    std::string_view fieldType;
+    bool isPublic = false;
+    bool isStatic = false;
+    bool isReadOnly = false;
+};
+
+struct PropertyView {
+    std::string_view name;
+    std::string_view propertyType;
+    bool canRead = false;
+    bool canWrite = false;
+};
+
+struct TypeView {
+    std::string_view name;
+    std::string_view fullName;
+    std::string_view namespaceName;
+    std::string_view baseType;
+    bool isClass = false;
+    bool isStruct = false;
+    bool isEnum = false;
+    bool isInterface = false;
+    ArenaArray<FieldView> fields;
+    ArenaArray<MethodView> methods;
+    ArenaArray<PropertyView> properties;
+};
+
+// Alternative to AssemblyData that borrows from the buffer returned by
+// IPCClient::ReadData. Strings are unescaped in place inside that buffer and every
+// array comes from one arena sized before parsing, so building and dropping a
+// snapshot are a handful of allocations regardless of the number of types.
+// Not copyable or movable: the views point into the snapshot itself.
+class AssemblySnapshot {
+public:
+    AssemblySnapshot() = default;
+    AssemblySnapshot(const AssemblySnapshot&) = delete;
+    AssemblySnapshot& operator=(const AssemblySnapshot&) = delete;
+
+    std::string_view assemblyName;
+    std::string_view timestamp;
+    std::string_view moduleVersionId;
+    ArenaArray<TypeView> types;
+    std::string_view snapshotId;
+
+    void Clear();
+
+    // Deep copy into the owning representation used by the UI
+    void ToAssemblyData(AssemblyData& data) const;
+
+    size_t BufferBytes() const { return buffer_.capacity(); }
+    const MonotonicArena& Arena() const { return arena_; }
+
+private:
+    friend class SnapshotParser;
+    friend bool ParseAssemblySnapshot(std::string json, AssemblySnapshot& snapshot);
+
+    std::string buffer_;
+    MonotonicArena arena_;
+};
+
+// Takes ownership of json. Accepts and rejects exactly what ParseAssemblyData does
+// and holds the same content.
+bool ParseAssemblySnapshot(std::string json, AssemblySnapshot& snapshot);
+
+} // namespace UnityReflection
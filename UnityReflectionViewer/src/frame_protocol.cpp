@@ -0,0 +1,490 @@
+#include "frame_protocol.h"
+#include "lz4_block.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define URV_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define URV_TARGET(isa) __attribute__((target(isa)))
+#else
+#define URV_TARGET(isa)
+#endif
+
+namespace UnityReflection {
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82F63B78; // reflected Castagnoli polynomial
+
+// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes
+struct Crc32cTables {
+    uint32_t table[8][256];
+
+    Crc32cTables() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+        }
+    }
+};
+
+uint32_t Crc32cScalar(const uint8_t* p, size_t size, uint32_t crc) {
+    static const Crc32cTables tables;
+    const auto& t = tables.table;
+
+    while (size >= 8) {
+        uint32_t lo;
+        uint32_t hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc; // the tables assume little-endian loads, as does the wire format
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#ifdef URV_X86
+URV_TARGET("sse4.2")
+uint32_t Crc32cSse42(const uint8_t* p, size_t size, uint32_t crc) {
+#if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    while (size >= 4) {
+        uint32_t word;
+        memcpy(&word, p, 4);
+        crc = _mm_crc32_u32(crc, word);
+        p += 4;
+        size -= 4;
+    }
+    while (size-- > 0) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+bool HasSse42() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+uint32_t Crc32cArm(const uint8_t* p, size_t size, uint32_t crc) {
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc = __crc32cd(crc, word);
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+#endif
+
+void StoreLE16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void StoreLE32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void StoreLE64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint16_t LoadLE16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t LoadLE32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) value = (value << 8) | in[i];
+    return value;
+}
+
+uint64_t LoadLE64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) value = (value << 8) | in[i];
+    return value;
+}
+
+} // namespace
+
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+#if defined(__ARM_FEATURE_CRC32)
+    crc = Crc32cArm(p, size, crc);
+#else
+#ifdef URV_X86
+    static const bool hasSse42 = HasSse42();
+    if (hasSse42) return ~Crc32cSse42(p, size, crc);
+#endif
+    crc = Crc32cScalar(p, size, crc);
+#endif
+    return ~crc;
+}
+
+void EncodeFrameHeader(const FrameHeader& header, uint8_t out[FRAME_HEADER_SIZE]) {
+    StoreLE32(out, FRAME_MAGIC);
+    out[4] = FRAME_VERSION;
+    out[5] = static_cast<uint8_t>(header.type);
+    StoreLE16(out + 6, static_cast<uint16_t>(header.kind));
+    StoreLE32(out + 8, header.messageId);
+    StoreLE32(out + 12, header.payloadSize);
+    StoreLE64(out + 16, header.offset);
+    StoreLE32(out + 24, header.payloadCrc);
+    StoreLE32(out + 28, Crc32c(out, 28));
+}
+
+FrameStatus DecodeFrameHeader(const uint8_t in[FRAME_HEADER_SIZE], FrameHeader& header) {
+    if (LoadLE32(in) != FRAME_MAGIC) return FrameStatus::BadMagic;
+    if (LoadLE32(in + 28) != Crc32c(in, 28)) return FrameStatus::BadChecksum;
+    // Checked after the checksum so a corrupt version byte is not reported as
+    // a newer protocol
+    if (in[4] != FRAME_VERSION) return FrameStatus::UnsupportedVersion;
+
+    header.type = static_cast<FrameType>(in[5]);
+    header.kind = static_cast<MessageKind>(LoadLE16(in + 6));
+    header.messageId = LoadLE32(in + 8);
+    header.payloadSize = LoadLE32(in + 12);
+    header.offset = LoadLE64(in + 16);
+    header.payloadCrc = LoadLE32(in + 24);
+    if (header.payloadSize > MAX_FRAME_PAYLOAD) return FrameStatus::TooLarge;
+    return FrameStatus::Ok;
+}
+
+void AppendFrame(std::string& out, FrameType type, MessageKind kind, uint32_t messageId, uint64_t offset,
+                 const char* payload, size_t size) {
+    FrameHeader header;
+    header.type = type;
+    header.kind = kind;
+    header.messageId = messageId;
+    header.payloadSize = static_cast<uint32_t>(size);
+    header.offset = offset;
+    header.payloadCrc = Crc32c(payload, size);
+
+    uint8_t raw[FRAME_HEADER_SIZE];
+    EncodeFrameHeader(header, raw);
+    out.append(reinterpret_cast<const char*>(raw), FRAME_HEADER_SIZE);
+    if (size > 0) out.append(payload, size);
+}
+
+void AppendMessage(std::string& out, MessageKind kind, uint32_t messageId, const char* data, size_t size,
+                   size_t chunkSize, bool compress) {
+    std::string block;
+    AppendFrame(out, FrameType::Begin, kind, messageId, size, nullptr, 0);
+    for (size_t pos = 0; pos < size; pos += chunkSize) {
+        const size_t n = size - pos < chunkSize ? size - pos : chunkSize;
+        if (compress) {
+            block.resize(4 + Lz4CompressBound(n));
+            StoreLE32(reinterpret_cast<uint8_t*>(&block[0]), static_cast<uint32_t>(n));
+            const size_t packed = 4 + Lz4Compress(data + pos, n, &block[4]);
+            if (packed < n) {
+                AppendFrame(out, FrameType::CompressedChunk, kind, messageId, pos, block.data(), packed);
+                continue;
+            }
+        }
+        AppendFrame(out, FrameType::Chunk, kind, messageId, pos, data + pos, n);
+    }
+    AppendFrame(out, FrameType::End, kind, messageId, size, nullptr, 0);
+}
+
+// FrameDecoder
+
+void FrameDecoder::SetCallbacks(BeginCallback onBegin, ChunkCallback onChunk, EndCallback onEnd) {
+    onBegin_ = std::move(onBegin);
+    onChunk_ = std::move(onChunk);
+    onEnd_ = std::move(onEnd);
+}
+
+void FrameDecoder::SetErrorCallback(ErrorCallback onError) {
+    onError_ = std::move(onError);
+}
+
+void FrameDecoder::Reset() {
+    state_ = State::Detect;
+    headerFill_ = 0;
+    payloadFill_ = 0;
+    skipped_ = 0;
+    legacyRemaining_ = 0;
+    inMessage_ = false;
+    lastComplete_ = false;
+    received_ = 0;
+    wireReceived_ = 0;
+}
+
+size_t FrameDecoder::Feed(const char* data, size_t size, bool stopAtMessageEnd) {
+    size_t pos = 0;
+    while (pos < size) {
+        switch (state_) {
+            case State::Detect: {
+                const size_t n = std::min(sizeof(uint32_t) - headerFill_, size - pos);
+                memcpy(header_ + headerFill_, data + pos, n);
+                headerFill_ += n;
+                pos += n;
+                if (headerFill_ < sizeof(uint32_t)) break;
+
+                // Anything else that is not a plausible length is resynced past
+                // like any other garbage in front of a frame
+                state_ = State::Header;
+                const int32_t length = static_cast<int32_t>(LoadLE32(header_));
+                if (LoadLE32(header_) != FRAME_MAGIC && length > 0 &&
+                    static_cast<size_t>(length) <= LEGACY_MAX_PAYLOAD) {
+                    headerFill_ = 0;
+                    state_ = State::Legacy;
+                    legacyRemaining_ = static_cast<uint64_t>(length);
+                    inMessage_ = true;
+                    received_ = 0;
+                    wireReceived_ = 0;
+                    if (onBegin_) onBegin_(MessageKind::AssemblyJson, legacyRemaining_);
+                }
+                break;
+            }
+
+            case State::Legacy: {
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(legacyRemaining_, size - pos));
+                received_ += n;
+                wireReceived_ += n;
+                if (inMessage_ && onChunk_ && !onChunk_(data + pos, n)) EndMessage(false);
+                pos += n;
+                legacyRemaining_ -= n;
+                if (legacyRemaining_ > 0) break;
+
+                state_ = State::Detect;
+                if (inMessage_) {
+                    EndMessage(true);
+                    if (stopAtMessageEnd) return pos;
+                }
+                break;
+            }
+
+            case State::Header: {
+                if (headerFill_ == 0 && size - pos >= FRAME_HEADER_SIZE) {
+                    // Whole header in the input: decode it where it is
+                    const uint8_t* raw = reinterpret_cast<const uint8_t*>(data + pos);
+                    const FrameStatus status = DecodeFrameHeader(raw, current_);
+                    if (status != FrameStatus::Ok) {
+                        if (status == FrameStatus::UnsupportedVersion) {
+                            ReportError("Unsupported frame version " + std::to_string(raw[4]));
+                        }
+                        const void* next = memchr(data + pos + 1, FRAME_MAGIC & 0xFF, size - pos - 1);
+                        const size_t advance = next ? static_cast<const char*>(next) - (data + pos) : size - pos;
+                        skipped_ += advance;
+                        pos += advance;
+                        break;
+                    }
+                    pos += FRAME_HEADER_SIZE;
+                    ReportSkipped();
+
+                    if (current_.payloadSize <= size - pos) {
+                        const bool ended = ProcessFrame(current_, data + pos);
+                        pos += current_.payloadSize;
+                        if (ended && stopAtMessageEnd) return pos;
+                    } else {
+                        state_ = State::Payload;
+                        payloadFill_ = 0;
+                    }
+                    break;
+                }
+
+                const size_t n = std::min(FRAME_HEADER_SIZE - headerFill_, size - pos);
+                memcpy(header_ + headerFill_, data + pos, n);
+                headerFill_ += n;
+                pos += n;
+                if (headerFill_ < FRAME_HEADER_SIZE || !HeaderReady()) break;
+
+                if (current_.payloadSize == 0) {
+                    if (ProcessFrame(current_, nullptr) && stopAtMessageEnd) return pos;
+                } else {
+                    state_ = State::Payload;
+                    payloadFill_ = 0;
+                }
+                break;
+            }
+
+            case State::Payload: {
+                if (!frame_) frame_.reset(new char[MAX_FRAME_PAYLOAD]);
+                const size_t n = std::min(current_.payloadSize - payloadFill_, size - pos);
+                memcpy(frame_.get() + payloadFill_, data + pos, n);
+                payloadFill_ += n;
+                pos += n;
+                if (payloadFill_ < current_.payloadSize) break;
+
+                state_ = State::Header;
+                if (ProcessFrame(current_, frame_.get()) && stopAtMessageEnd) return pos;
+                break;
+            }
+        }
+    }
+    return pos;
+}
+
+void FrameDecoder::FeedFrame(const FrameHeader& header, const char* payload) {
+    ProcessFrame(header, payload);
+}
+
+void FrameDecoder::Finish() {
+    ReportSkipped();
+    if (inMessage_) Abandon("Connection closed in the middle of a payload");
+
+    const bool lastComplete = lastComplete_;
+    Reset();
+    lastComplete_ = lastComplete;
+}
+
+// Decodes the buffered header. On failure the buffer is shifted to the next
+// byte that could start a magic, so a header split by garbage is still found.
+bool FrameDecoder::HeaderReady() {
+    const FrameStatus status = DecodeFrameHeader(header_, current_);
+    if (status == FrameStatus::Ok) {
+        headerFill_ = 0;
+        ReportSkipped();
+        return true;
+    }
+    if (status == FrameStatus::UnsupportedVersion) {
+        ReportError("Unsupported frame version " + std::to_string(header_[4]));
+    }
+
+    const void* next = memchr(header_ + 1, FRAME_MAGIC & 0xFF, FRAME_HEADER_SIZE - 1);
+    const size_t advance = next ? static_cast<const uint8_t*>(next) - header_ : FRAME_HEADER_SIZE;
+    memmove(header_, header_ + advance, FRAME_HEADER_SIZE - advance);
+    headerFill_ = FRAME_HEADER_SIZE - advance;
+    skipped_ += advance;
+    return false;
+}
+
+bool FrameDecoder::ProcessFrame(const FrameHeader& header, const char* payload) {
+    if (Crc32c(payload, header.payloadSize) != header.payloadCrc) {
+        if (inMessage_) {
+            Abandon("Corrupt chunk at offset " + std::to_string(received_));
+        } else {
+            ReportError("Skipped a corrupt frame");
+        }
+        return false;
+    }
+
+    switch (header.type) {
+        case FrameType::Begin:
+            if (inMessage_) Abandon("Payload cut off by the next one");
+            if (!IsKnownMessageKind(header.kind)) {
+                // Its chunks are skipped as strays below
+                ReportError("Ignoring message of unknown kind " + std::to_string(static_cast<unsigned>(header.kind)));
+                break;
+            }
+            inMessage_ = true;
+            messageId_ = header.messageId;
+            received_ = 0;
+            wireReceived_ = 0;
+            if (onBegin_) onBegin_(header.kind, header.offset);
+            break;
+
+        case FrameType::Chunk:
+        case FrameType::CompressedChunk: {
+            if (!inMessage_) break; // rest of an abandoned or ignored payload
+            if (header.messageId != messageId_ || header.offset != received_) {
+                Abandon("Missing data at offset " + std::to_string(received_));
+                break;
+            }
+            const char* data = payload;
+            size_t size = header.payloadSize;
+            if (header.type == FrameType::CompressedChunk && !Inflate(header, payload, data, size)) {
+                Abandon("Corrupt compressed chunk at offset " + std::to_string(received_));
+                break;
+            }
+            received_ += size;
+            wireReceived_ += header.payloadSize;
+            if (onChunk_ && !onChunk_(data, size)) EndMessage(false);
+            break;
+        }
+
+        case FrameType::End:
+            if (!inMessage_ || header.messageId != messageId_) break;
+            if (header.offset != received_) {
+                Abandon("Payload ended after " + std::to_string(received_) + " of " + std::to_string(header.offset) +
+                        " bytes");
+                break;
+            }
+            EndMessage(true);
+            return true;
+
+        case FrameType::Padding:
+            break;
+
+        default:
+            ReportError("Skipped a frame of unknown type " + std::to_string(static_cast<unsigned>(header.type)));
+            break;
+    }
+    return false;
+}
+
+// Decompresses a CompressedChunk payload into inflated_. The checksum has
+// passed, so a failure means the sender is broken rather than the transport.
+bool FrameDecoder::Inflate(const FrameHeader& header, const char* payload, const char*& data, size_t& size) {
+    if (header.payloadSize < 4) return false;
+    const uint32_t rawSize = LoadLE32(reinterpret_cast<const uint8_t*>(payload));
+    if (rawSize > MAX_FRAME_PAYLOAD) return false;
+
+    if (!inflated_) inflated_.reset(new char[MAX_FRAME_PAYLOAD]);
+    if (!Lz4Decompress(payload + 4, header.payloadSize - 4, inflated_.get(), rawSize)) return false;
+    data = inflated_.get();
+    size = rawSize;
+    return true;
+}
+
+void FrameDecoder::EndMessage(bool complete) {
+    inMessage_ = false;
+    lastComplete_ = complete;
+    if (onEnd_) onEnd_(complete);
+}
+
+void FrameDecoder::Abandon(const std::string& reason) {
+    ReportError(reason + "; payload dropped, waiting for the next one");
+    EndMessage(false);
+}
+
+void FrameDecoder::ReportSkipped() {
+    if (skipped_ == 0) return;
+    ReportError("Discarded " + std::to_string(skipped_) + " bytes of corrupt data");
+    skipped_ = 0;
+}
+
+void FrameDecoder::ReportError(const std::string& error) {
+    if (onError_) onError_(error);
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace UnityReflection {
+
+// Wire format of the pipe between IPCServer and IPCClient. A message is sent as
+// a Begin frame, any number of Chunk frames and an End frame; each frame is a
+// fixed 32-byte little-endian header followed by its payload:
+//
+//   offset  size  field
+//        0     4  magic "URVF"
+//        4     1  version
+//        5     1  frame type
+//        6     2  message kind
+//        8     4  message id (same for all frames of a message)
+//       12     4  payload size
+//       16     8  Begin: total message size, 0 if not known up front
+//                 Chunk: offset of the payload within the message
+//                 End:   total message size
+//       24     4  CRC32C of the payload
+//       28     4  CRC32C of bytes 0..27
+//
+// Chunks are bounded, so a reader only ever holds one frame no matter how large
+// the message is. A frame whose header checksum fails is skipped by scanning for
+// the next magic; a chunk whose payload checksum fails, or that arrives out of
+// order, abandons its message and the reader waits for the next Begin frame.
+//
+// When the viewer's hello offers it, chunks may instead be CompressedChunk
+// frames: the payload is the chunk's uncompressed size (4 bytes) followed by
+// the chunk as an LZ4 block (lz4_block.h). Offsets and the End frame's total
+// still count uncompressed bytes; the payload checksum covers what was sent.
+// Each chunk is compressed on its own, so it is decompressed and handed on
+// as soon as it arrives.
+constexpr uint32_t FRAME_MAGIC = 0x46565255; // "URVF" read as little-endian
+constexpr uint8_t FRAME_VERSION = 1;
+constexpr size_t FRAME_HEADER_SIZE = 32;
+
+// Chunk size IPCServer writes, and the largest payload a reader accepts
+constexpr size_t FRAME_CHUNK_SIZE = 256 * 1024;
+constexpr size_t MAX_FRAME_PAYLOAD = 4 * 1024 * 1024;
+
+enum class FrameType : uint8_t {
+    Begin = 1,
+    Chunk = 2,
+    End = 3,
+    Padding = 4, // shared-memory ring only (shared_ring.h): fills the end of the ring
+    CompressedChunk = 5
+};
+
+enum class MessageKind : uint16_t {
+    AssemblyJson = 1,   // full snapshot, AssemblyData as JSON
+    AssemblyDelta = 2,  // changes against an earlier snapshot, AssemblyDelta as JSON
+    Hello = 3,          // viewer to mod on connect:
+                        // {"snapshotId":"...","moduleVersionId":"...","compression":["lz4"],
+                        //  "query":true,"binary":true,"progress":true},
+                        // the snapshot it holds and the assembly build it is of, the
+                        // chunk compression it accepts, whether it wants query mode
+                        // and whether it reads AssemblyBinary and Progress
+    TypeHeaders = 4,    // query mode, mod to viewer: AssemblyData JSON whose types have no member arrays
+    MemberRequest = 5,  // query mode, viewer to mod: MemberRequest JSON
+    MemberResponse = 6, // query mode, mod to viewer: MemberResponse JSON
+    AssemblyBinary = 7, // full snapshot as a snapshot file image (snapshot_file.h)
+    Progress = 8,       // mod to viewer before a snapshot: ReflectionProgress JSON
+    NotModified = 9     // mod to viewer instead of a snapshot: SnapshotNotModified JSON
+};
+
+// Kinds a FrameDecoder reassembles; anything else is skipped
+inline bool IsKnownMessageKind(MessageKind kind) {
+    return kind >= MessageKind::AssemblyJson && kind <= MessageKind::NotModified;
+}
+
+struct FrameHeader {
+    FrameType type = FrameType::Chunk;
+    MessageKind kind = MessageKind::AssemblyJson;
+    uint32_t messageId = 0;
+    uint32_t payloadSize = 0;
+    uint64_t offset = 0;
+    uint32_t payloadCrc = 0;
+};
+
+enum class FrameStatus {
+    Ok,
+    BadMagic,
+    BadChecksum,
+    UnsupportedVersion,
+    TooLarge
+};
+
+// CRC32C (Castagnoli). crc is the result for the preceding bytes, so a long
+// buffer can be checksummed piecewise. Uses the SSE4.2 crc32 instruction when
+// the CPU has it.
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+// Writes the header with its checksum; payloadCrc must already be set
+void EncodeFrameHeader(const FrameHeader& header, uint8_t out[FRAME_HEADER_SIZE]);
+FrameStatus DecodeFrameHeader(const uint8_t in[FRAME_HEADER_SIZE], FrameHeader& header);
+
+// Appends one frame, or a whole message cut into chunkSize frames. Used by the
+// benchmark to produce what IPCServer writes. With compress, chunks that
+// shrink are sent as CompressedChunk frames.
+void AppendFrame(std::string& out, FrameType type, MessageKind kind, uint32_t messageId, uint64_t offset,
+                 const char* payload, size_t size);
+void AppendMessage(std::string& out, MessageKind kind, uint32_t messageId, const char* data, size_t size,
+                   size_t chunkSize = FRAME_CHUNK_SIZE, bool compress = false);
+
+// Reassembles messages from a byte stream however it is split, holding at most
+// one frame. A stream that does not start with a frame is taken as the old
+// unframed format (int32 length, then up to 100 MB of data), which older
+// builds of the mod send.
+//
+// A chunk whose payload lies whole inside the bytes passed to Feed is handed
+// on in place; only frames split across reads are copied.
+class FrameDecoder {
+public:
+    // totalBytes is 0 when the sender does not know the size up front
+    using BeginCallback = std::function<void(MessageKind kind, uint64_t totalBytes)>;
+    using ChunkCallback = std::function<bool(const char* data, size_t size)>;
+    using EndCallback = std::function<void(bool complete)>;
+    using ErrorCallback = std::function<void(const std::string& error)>;
+
+    static constexpr size_t LEGACY_MAX_PAYLOAD = 100 * 1024 * 1024;
+
+    // Returning false from onChunk abandons the message (onEnd(false), no error)
+    void SetCallbacks(BeginCallback onBegin, ChunkCallback onChunk, EndCallback onEnd);
+    void SetErrorCallback(ErrorCallback onError);
+
+    // Start of a new connection
+    void Reset();
+
+    // Consumes bytes and returns how many were used: all of them, unless
+    // stopAtMessageEnd is set and a message completed, in which case the rest
+    // is left for the next call.
+    size_t Feed(const char* data, size_t size, bool stopAtMessageEnd = false);
+
+    // A frame already delimited by the transport (the shared-memory ring)
+    void FeedFrame(const FrameHeader& header, const char* payload);
+
+    // The connection closed: a message in progress ends incomplete
+    void Finish();
+
+    bool InMessage() const { return inMessage_; }
+    bool LastComplete() const { return lastComplete_; }
+
+    // Size of the current (or last) message, and how many chunk payload bytes
+    // carried it; fewer when it came compressed
+    uint64_t MessageBytes() const { return received_; }
+    uint64_t WireBytes() const { return wireReceived_; }
+
+private:
+    enum class State {
+        Detect,  // first bytes of a connection: frame magic or a legacy length
+        Header,
+        Payload,
+        Legacy
+    };
+
+    // Returns true when the frame completed a message
+    bool ProcessFrame(const FrameHeader& header, const char* payload);
+    bool HeaderReady();
+    bool Inflate(const FrameHeader& header, const char* payload, const char*& data, size_t& size);
+    void EndMessage(bool complete);
+    void Abandon(const std::string& reason);
+    void ReportSkipped();
+    void ReportError(const std::string& error);
+
+    BeginCallback onBegin_;
+    ChunkCallback onChunk_;
+    EndCallback onEnd_;
+    ErrorCallback onError_;
+
+    State state_ = State::Detect;
+    uint8_t header_[FRAME_HEADER_SIZE];
+    size_t headerFill_ = 0;
+    FrameHeader current_;
+    std::unique_ptr<char[]> frame_;
+    std::unique_ptr<char[]> inflated_; // decompressed CompressedChunk payload
+    size_t payloadFill_ = 0;
+    size_t skipped_ = 0;
+    uint64_t legacyRemaining_ = 0;
+
+    bool inMessage_ = false;
+    bool lastComplete_ = false;
+    uint32_t messageId_ = 0;
+    uint64_t received_ = 0;
+    uint64_t wireReceived_ = 0;
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,205 @@
+#include "fuzzy_matcher.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define URV_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define URV_TARGET(isa) __attribute__((target(isa)))
+#else
+#define URV_TARGET(isa)
+#endif
+
+namespace UnityReflection {
+
+namespace {
+
+// Letters, digits and the punctuation of type names get their own classes,
+// a letter's shared by both cases. Trigrams of shared classes only cost an
+// index extra candidates, which it checks anyway.
+std::array<uint8_t, 256> BuildCharClasses() {
+    std::array<uint8_t, 256> classes{};
+    uint8_t next = 1;
+    for (char c = 'a'; c <= 'z'; c++) {
+        classes[static_cast<uint8_t>(c)] = next;
+        classes[static_cast<uint8_t>(c - 'a' + 'A')] = next++;
+    }
+    for (char c = '0'; c <= '9'; c++) classes[static_cast<uint8_t>(c)] = next++;
+    for (char c : std::string_view("_.<>,`+[]/ -")) classes[static_cast<uint8_t>(c)] = next++;
+    return classes;
+}
+
+// Scores as in fzf's v1 algorithm
+constexpr int32_t SCORE_MATCH = 16;
+constexpr int32_t GAP_START = -3;
+constexpr int32_t GAP_EXTENSION = -1;
+constexpr int32_t BONUS_BOUNDARY = SCORE_MATCH / 2;  // first character of a name or after a delimiter
+constexpr int32_t BONUS_CAMEL = BONUS_BOUNDARY - 1;  // aB or a1
+constexpr int32_t BONUS_CONSECUTIVE = -(GAP_START + GAP_EXTENSION);
+constexpr int32_t FIRST_CHAR_MULTIPLIER = 2;
+
+char FoldChar(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool IsLower(char c) { return c >= 'a' && c <= 'z'; }
+bool IsUpper(char c) { return c >= 'A' && c <= 'Z'; }
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Bonus for a query character matched at name[i]
+int32_t BonusAt(std::string_view name, size_t i) {
+    if (i == 0) return BONUS_BOUNDARY;
+    const char prev = name[i - 1];
+    const char c = name[i];
+    if (!IsLower(prev) && !IsUpper(prev) && !IsDigit(prev)) return BONUS_BOUNDARY;
+    if (IsLower(prev) && IsUpper(c)) return BONUS_CAMEL;
+    if (!IsDigit(prev) && IsDigit(c)) return BONUS_CAMEL;
+    return 0;
+}
+
+void PrefilterScalar(const uint64_t* masks, size_t begin, size_t end, uint64_t required,
+                     std::vector<uint32_t>& out) {
+    for (size_t i = begin; i < end; i++) {
+        if ((masks[i] & required) == required) out.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+#ifdef URV_X86
+
+// SSE2 has no 64-bit compare, so both 32-bit halves of a mask must hold
+URV_TARGET("sse2")
+void PrefilterSSE2(const uint64_t* masks, size_t begin, size_t end, uint64_t required,
+                   std::vector<uint32_t>& out) {
+    const __m128i query = _mm_set1_epi64x(static_cast<long long>(required));
+    size_t i = begin;
+    for (; i + 2 <= end; i += 2) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i));
+        const __m128i equal = _mm_cmpeq_epi32(_mm_and_si128(chunk, query), query);
+        const int halves = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        if ((halves & 0x3) == 0x3) out.push_back(static_cast<uint32_t>(i));
+        if ((halves & 0xC) == 0xC) out.push_back(static_cast<uint32_t>(i + 1));
+    }
+    PrefilterScalar(masks, i, end, required, out);
+}
+
+URV_TARGET("avx2")
+void PrefilterAVX2(const uint64_t* masks, size_t begin, size_t end, uint64_t required,
+                   std::vector<uint32_t>& out) {
+    const __m256i query = _mm256_set1_epi64x(static_cast<long long>(required));
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i + 4));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_pd(
+                            _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(low, query), query)))) |
+                        static_cast<unsigned>(_mm256_movemask_pd(
+                            _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(high, query), query))))
+                            << 4;
+        while (bits) {
+            out.push_back(static_cast<uint32_t>(i + CountTrailingZeros(bits)));
+            bits &= bits - 1;
+        }
+    }
+    PrefilterScalar(masks, i, end, required, out);
+}
+
+#endif // URV_X86
+
+using PrefilterFn = void (*)(const uint64_t*, size_t, size_t, uint64_t, std::vector<uint32_t>&);
+
+PrefilterFn SelectPrefilter() {
+#ifdef URV_X86
+    switch (DetectSimdLevel()) {
+        case SimdLevel::AVX2: return PrefilterAVX2;
+        case SimdLevel::SSE2: return PrefilterSSE2;
+        default: break;
+    }
+#endif
+    return PrefilterScalar;
+}
+
+bool Better(const FuzzyMatch& a, const FuzzyMatch& b) {
+    if (a.score != b.score) return a.score > b.score;
+    if (a.length != b.length) return a.length < b.length;
+    return a.index < b.index;
+}
+
+} // namespace
+
+const std::array<uint8_t, 256> CHAR_CLASSES = BuildCharClasses();
+
+uint64_t CharMask(std::string_view text) {
+    uint64_t mask = 0;
+    for (char c : text) mask |= uint64_t(1) << CharClass(c);
+    return mask;
+}
+
+FuzzyMatcher::FuzzyMatcher(std::string_view query) : query_(query.size(), '\0') {
+    std::transform(query.begin(), query.end(), query_.begin(), FoldChar);
+    mask_ = CharMask(query_);
+}
+
+int32_t FuzzyMatcher::Score(std::string_view name) const {
+    const size_t queryLength = query_.size();
+    if (queryLength == 0 || queryLength > name.size()) return NO_MATCH;
+
+    // Forward, the earliest place the query ends...
+    size_t q = 0;
+    size_t end = 0;
+    for (; end < name.size(); end++) {
+        if (FoldChar(name[end]) == query_[q] && ++q == queryLength) break;
+    }
+    if (q < queryLength) return NO_MATCH;
+
+    // ...and back from there, the latest place it starts
+    size_t start = end + 1;
+    for (q = queryLength; q > 0;) {
+        if (FoldChar(name[--start]) == query_[q - 1]) q--;
+    }
+
+    int32_t score = 0;
+    int32_t firstBonus = 0;
+    size_t consecutive = 0;
+    bool inGap = false;
+    q = 0;
+    for (size_t i = start; i <= end; i++) {
+        if (q < queryLength && FoldChar(name[i]) == query_[q]) {
+            int32_t bonus = BonusAt(name, i);
+            if (consecutive == 0) {
+                firstBonus = bonus;
+            } else {
+                // A run carries the bonus it started with
+                if (bonus >= BONUS_BOUNDARY && bonus > firstBonus) firstBonus = bonus;
+                bonus = std::max(std::max(bonus, firstBonus), BONUS_CONSECUTIVE);
+            }
+            score += SCORE_MATCH + (q == 0 ? bonus * FIRST_CHAR_MULTIPLIER : bonus);
+            inGap = false;
+            consecutive++;
+            q++;
+        } else {
+            score += inGap ? GAP_EXTENSION : GAP_START;
+            inGap = true;
+            consecutive = 0;
+            firstBonus = 0;
+        }
+    }
+    return score;
+}
+
+void FuzzyMatcher::Prefilter(const uint64_t* masks, size_t begin, size_t end, uint64_t required,
+                             std::vector<uint32_t>& out) {
+    static const PrefilterFn prefilter = SelectPrefilter();
+    prefilter(masks, begin, end, required, out);
+}
+
+void FuzzyMatcher::KeepBest(std::vector<FuzzyMatch>& matches, size_t limit) {
+    if (matches.size() > limit) {
+        std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(limit), matches.end(), Better);
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end(), Better);
+    }
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "json_scanner.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UnityReflection {
+
+// Characters in 6-bit classes, shared by the name indexes: each letter (either
+// case), digit and punctuation mark of type names has its own class, and
+// everything else shares class 0
+extern const std::array<uint8_t, 256> CHAR_CLASSES;
+
+inline uint8_t CharClass(char c) {
+    return CHAR_CLASSES[static_cast<uint8_t>(c)];
+}
+
+// A bit per class of the characters in text. A name can only contain a query
+// whose mask bits it has all of, whether in a row or spread out.
+uint64_t CharMask(std::string_view text);
+
+// How a search box matches names
+enum class MatchMode : uint8_t {
+    Substring, // the query appears as typed, ignoring case
+    Fuzzy      // its characters appear in order, ranked by FuzzyMatcher
+};
+
+struct FuzzyMatch {
+    uint32_t index = 0;  // of the candidate
+    int32_t score = 0;
+    uint32_t length = 0; // of its name, shorter ranking first on equal scores
+};
+
+// fzf-style fuzzy matching: a name matches if it holds the query's characters
+// in order, ignoring case, so `PlyrCtrlMgr` finds `PlayerControllerManager`.
+// The shortest stretch of the name holding them is scored: points per
+// character, more where one starts a word (after '.', '_' and the like, or
+// at a camelCase or digit change) or continues a run, less for every
+// character skipped in between.
+//
+// Rank scores a whole candidate set. Candidates whose CharMask lacks one of
+// the query's classes are rejected several at a time with SSE2/AVX2 before
+// any name is read; large sets are split across the thread pool, and only the
+// best few are fully sorted.
+class FuzzyMatcher {
+public:
+    static constexpr int32_t NO_MATCH = INT32_MIN;
+
+    explicit FuzzyMatcher(std::string_view query);
+
+    bool Empty() const { return query_.empty(); }
+    uint64_t Mask() const { return mask_; }
+
+    // Score of name against the query, or NO_MATCH
+    int32_t Score(std::string_view name) const;
+
+    // Appends the i in [begin, end) whose masks[i] has every bit of required
+    static void Prefilter(const uint64_t* masks, size_t begin, size_t end, uint64_t required,
+                          std::vector<uint32_t>& out);
+
+    // Orders matches best first and keeps the first limit of them
+    static void KeepBest(std::vector<FuzzyMatch>& matches, size_t limit);
+
+    // Replaces out with the best limit of the candidates [0, count), best
+    // first, and returns how many matched in all. accept(i) passes over
+    // candidates that are not to be shown; name(i) is the name to score. Both
+    // are called from pool threads when pool is given.
+    template <typename Accept, typename Name>
+    size_t Rank(const uint64_t* masks, size_t count, Accept&& accept, Name&& name, size_t limit,
+                std::vector<FuzzyMatch>& out, ThreadPool* pool) const;
+
+private:
+    static constexpr size_t RANK_CHUNK = 16384; // candidates per pool task
+
+    std::string query_; // folded
+    uint64_t mask_ = 0;
+};
+
+template <typename Accept, typename Name>
+size_t FuzzyMatcher::Rank(const uint64_t* masks, size_t count, Accept&& accept, Name&& name, size_t limit,
+                          std::vector<FuzzyMatch>& out, ThreadPool* pool) const {
+    out.clear();
+    if (Empty() || count == 0) return 0;
+
+    // Each chunk keeps its own best limit, so the merge sorts at most
+    // chunks * limit matches however many there were
+    const size_t chunks = (count + RANK_CHUNK - 1) / RANK_CHUNK;
+    std::vector<std::vector<FuzzyMatch>> best(chunks);
+    std::atomic<size_t> matched{0};
+    auto rankChunk = [&](size_t chunk) {
+        std::vector<uint32_t> candidates;
+        Prefilter(masks, chunk * RANK_CHUNK, std::min(count, (chunk + 1) * RANK_CHUNK), mask_, candidates);
+        std::vector<FuzzyMatch>& matches = best[chunk];
+        for (uint32_t i : candidates) {
+            if (!accept(i)) continue;
+            const std::string_view text = name(i);
+            const int32_t score = Score(text);
+            if (score != NO_MATCH) matches.push_back({i, score, static_cast<uint32_t>(text.size())});
+        }
+        matched.fetch_add(matches.size(), std::memory_order_relaxed);
+        KeepBest(matches, limit);
+    };
+    if (pool && chunks > 1) {
+        pool->ParallelFor(chunks, rankChunk);
+    } else {
+        for (size_t chunk = 0; chunk < chunks; chunk++) rankChunk(chunk);
+    }
+
+    for (const auto& matches : best) out.insert(out.end(), matches.begin(), matches.end());
+    KeepBest(out, limit);
+    return matched.load(std::memory_order_relaxed);
+}
+
+} // namespace UnityReflection
@@ -1,15 +1,38 @@
 #include "ipc_client.h"
+#include "schema_codec.h"
+#include <algorithm>
 #include <iostream>
+#include <cerrno>
 #include <cstring>
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
 namespace UnityReflection {
 
-IPCClient::IPCClient() {
+const char* ConnectionStateName(ConnectionState state) {
+    switch (state) {
+        case ConnectionState::Connecting: return "Connecting";
+        case ConnectionState::Streaming: return "Streaming";
+        default: return "Disconnected";
+    }
+}
+
+IPCClient::IPCClient(std::string pipeName, Transport transport)
+    : pipeName_(std::move(pipeName)), transport_(transport) {
+    decoder_.SetErrorCallback([this](const std::string& error) { ReportError(error); });
 }
 
 IPCClient::~IPCClient() {
     StopListening();
     Disconnect();
+#ifdef _WIN32
+    if (readEvent_) CloseHandle(readEvent_);
+    if (writeEvent_) CloseHandle(writeEvent_);
+#endif
 }
 
 void IPCClient::SetDataCallback(DataCallback callback) {
@@ -20,50 +43,140 @@ void IPCClient::SetErrorCallback(ErrorCallback callback) {
     errorCallback_ = callback;
 }
 
+void IPCClient::SetDeltaCallback(DataCallback callback) {
+    deltaCallback_ = callback;
+}
+
+void IPCClient::SetQueryMode(bool enabled) {
+    queryMode_ = enabled;
+}
+
+void IPCClient::SetQueryCallbacks(DataCallback onHeaders, DataCallback onMembers) {
+    headersCallback_ = onHeaders;
+    membersCallback_ = onMembers;
+}
+
+void IPCClient::SetBinarySnapshots(bool enabled) {
+    binarySnapshots_ = enabled;
+}
+
+void IPCClient::SetBinaryCallback(DataCallback callback) {
+    binaryCallback_ = callback;
+}
+
+void IPCClient::SetProgressCallback(DataCallback callback) {
+    progressCallback_ = callback;
+}
+
+void IPCClient::SetNotModifiedCallback(DataCallback callback) {
+    notModifiedCallback_ = callback;
+}
+
+void IPCClient::SetSnapshotId(std::string snapshotId, std::string moduleVersionId) {
+    std::lock_guard<std::mutex> lock(snapshotMutex_);
+    snapshotId_ = std::move(snapshotId);
+    moduleVersionId_ = std::move(moduleVersionId);
+}
+
+void IPCClient::SetCompression(bool enabled) {
+    compression_ = enabled;
+}
+
+void IPCClient::SetStreamCallbacks(StreamBeginCallback onBegin, StreamChunkCallback onChunk, StreamEndCallback onEnd) {
+    streamBeginCallback_ = onBegin;
+    streamChunkCallback_ = onChunk;
+    streamEndCallback_ = onEnd;
+}
+
 bool IPCClient::Connect() {
-#ifdef _WIN32
-    hPipe_ = CreateFileA(
-        PIPE_NAME,
-        GENERIC_READ,
-        0,
-        NULL,
-        OPEN_EXISTING,
-        0,
-        NULL
-    );
-
-    if (hPipe_ == INVALID_HANDLE_VALUE) {
-        DWORD error = GetLastError();
-        if (errorCallback_) {
-            errorCallback_("Failed to connect to pipe. Error: " + std::to_string(error));
-        }
+    std::string error;
+    if (!OpenConnection(false, error)) {
+        ReportError(error);
         return false;
     }
+    MarkConnected();
+    return true;
+}
+
+void IPCClient::Disconnect() {
+    CloseConnection();
+}
+
+bool IPCClient::IsConnected() const {
+    return isConnected_;
+}
+
+bool IPCClient::OpenConnection(bool nonBlocking, std::string& error) {
+    if (transport_ == Transport::SharedMemory) {
+        if (!ring_.Open(pipeName_, error)) return false;
+    } else {
+#ifdef _WIN32
+        (void)nonBlocking;
+        if (!readEvent_) readEvent_ = CreateEventA(NULL, TRUE, FALSE, NULL);
+        if (!writeEvent_) writeEvent_ = CreateEventA(NULL, TRUE, FALSE, NULL);
 
-    DWORD mode = PIPE_READMODE_BYTE;
-    if (!SetNamedPipeHandleState(hPipe_, &mode, NULL, NULL)) {
-        if (errorCallback_) {
-            errorCallback_("Failed to set pipe mode");
+        HANDLE pipe = CreateFileA(
+            pipeName_.c_str(),
+            GENERIC_READ | GENERIC_WRITE,
+            0,
+            NULL,
+            OPEN_EXISTING,
+            FILE_FLAG_OVERLAPPED,
+            NULL
+        );
+        if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_ACCESS_DENIED) {
+            // Older builds of the mod serve an outbound-only pipe
+            pipe = CreateFileA(pipeName_.c_str(), GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+        }
+
+        if (pipe == INVALID_HANDLE_VALUE) {
+            error = "Failed to connect to pipe. Error: " + std::to_string(GetLastError());
+            return false;
+        }
+
+        DWORD mode = PIPE_READMODE_BYTE;
+        if (!SetNamedPipeHandleState(pipe, &mode, NULL, NULL)) {
+            error = "Failed to set pipe mode";
+            CloseHandle(pipe);
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            hPipe_ = pipe;
         }
-        CloseHandle(hPipe_);
-        hPipe_ = INVALID_HANDLE_VALUE;
-        return false;
-    }
 #else
-    fd_ = open(PIPE_NAME, O_RDONLY);
-    if (fd_ == -1) {
-        if (errorCallback_) {
-            errorCallback_("Failed to open named pipe: " + std::string(strerror(errno)));
+        // Non-blocking, opening a FIFO succeeds before its writer shows up;
+        // epoll then reports the first byte
+        fd_ = open(pipeName_.c_str(), O_RDONLY | (nonBlocking ? O_NONBLOCK : 0));
+        if (fd_ == -1) {
+            error = "Failed to open named pipe: " + std::string(strerror(errno));
+            return false;
+        }
+
+        // Read-write so it never blocks or fails for want of a reader; the
+        // hello waits in it until the server looks
+        const int requestFd = open((pipeName_ + REQUEST_PIPE_SUFFIX).c_str(), O_RDWR | O_NONBLOCK);
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            requestFd_ = requestFd;
         }
-        return false;
-    }
 #endif
+        if (!readBuffer_) readBuffer_.reset(new char[READ_BUFFER_SIZE]);
+        SendHello();
+    }
 
+    readPos_ = 0;
+    readEnd_ = 0;
+    decoder_.Reset();
     isConnected_ = true;
+    state_ = ConnectionState::Connecting;
     return true;
 }
 
-void IPCClient::Disconnect() {
+void IPCClient::CloseConnection() {
+    ring_.Close();
+    std::lock_guard<std::mutex> lock(writeMutex_);
 #ifdef _WIN32
     if (hPipe_ != INVALID_HANDLE_VALUE) {
         CloseHandle(hPipe_);
@@ -74,120 +187,420 @@ void IPCClient::Disconnect() {
         close(fd_);
         fd_ = -1;
     }
+    if (requestFd_ != -1) {
+        close(requestFd_);
+        requestFd_ = -1;
+    }
 #endif
     isConnected_ = false;
-}
-
-bool IPCClient::IsConnected() const {
-    return isConnected_;
+    state_ = ConnectionState::Disconnected;
 }
 
 void IPCClient::StartListening() {
     if (isListening_) return;
 
+#ifdef __linux__
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    ring_.ClearInterrupt();
     isListening_ = true;
     listenThread_ = std::make_unique<std::thread>(&IPCClient::ListenThread, this);
 }
 
 void IPCClient::StopListening() {
     isListening_ = false;
+    ring_.Interrupt();
+#ifdef __linux__
+    if (wakeFd_ != -1) {
+        const uint64_t one = 1;
+        (void)!write(wakeFd_, &one, sizeof(one));
+    }
+#endif
     if (listenThread_ && listenThread_->joinable()) {
+#ifdef _WIN32
+        // Unblocks a read waiting on the pipe
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            if (hPipe_ != INVALID_HANDLE_VALUE) CancelIoEx(hPipe_, NULL);
+        }
+#endif
         listenThread_->join();
     }
+#ifdef __linux__
+    if (wakeFd_ != -1) {
+        close(wakeFd_);
+        wakeFd_ = -1;
+    }
+#endif
+}
+
+ConnectionState IPCClient::GetState() const {
+    return state_;
+}
+
+IPCMetrics IPCClient::GetMetrics() const {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    return metrics_;
 }
 
 void IPCClient::ListenThread() {
+#ifdef __linux__
+    if (transport_ == Transport::Pipe) {
+        EventLoop();
+        return;
+    }
+#endif
+
+    int backoffMs = 0;
+    bool reported = false;
     while (isListening_) {
         if (!IsConnected()) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            continue;
-        }
+            std::string error;
+            if (!OpenConnection(false, error)) {
+                // Reported once per outage rather than on every retry
+                if (!reported) ReportError(error + "; retrying");
+                reported = true;
 
-        std::string data = ReadData();
-        if (!data.empty() && dataCallback_) {
-            dataCallback_(data);
+                backoffMs = backoffMs ? std::min(backoffMs * 2, MAX_BACKOFF_MS) : INITIAL_BACKOFF_MS;
+                const auto retryAt = Clock::now() + std::chrono::milliseconds(backoffMs);
+                while (isListening_ && Clock::now() < retryAt) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                continue;
+            }
+            MarkConnected();
         }
+        backoffMs = 0;
+        reported = false;
 
-        Disconnect();
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        UseListenerCallbacks();
+        Pump(nullptr, false);
+        CloseConnection(); // and reconnect right away
     }
 }
 
-std::string IPCClient::ReadData() {
-#ifdef _WIN32
-    // Read length prefix (4 bytes)
-    DWORD bytesRead = 0;
-    int32_t dataLength = 0;
-
-    if (!ReadFile(hPipe_, &dataLength, sizeof(dataLength), &bytesRead, NULL) ||
-        bytesRead != sizeof(dataLength)) {
-        if (errorCallback_) {
-            errorCallback_("Failed to read data length");
-        }
-        return "";
+#ifdef __linux__
+void IPCClient::EventLoop() {
+    const int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        ReportError("epoll_create1 failed: " + std::string(strerror(errno)));
+        return;
     }
 
-    if (dataLength <= 0 || dataLength > 100 * 1024 * 1024) { // Max 100MB
-        if (errorCallback_) {
-            errorCallback_("Invalid data length: " + std::to_string(dataLength));
-        }
-        return "";
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeFd_;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd_, &event);
+
+    // The directory is watched rather than the pipe so its creation is seen
+    const size_t slash = pipeName_.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : pipeName_.substr(0, slash);
+    const std::string fileName = slash == std::string::npos ? pipeName_ : pipeName_.substr(slash + 1);
+    const int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd != -1 && inotify_add_watch(inotifyFd, directory.c_str(), IN_CREATE | IN_MOVED_TO | IN_ATTRIB) != -1) {
+        event.data.fd = inotifyFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, inotifyFd, &event);
     }
 
-    // Read data
-    std::string data;
-    data.resize(dataLength);
-
-    DWORD totalRead = 0;
-    while (totalRead < static_cast<DWORD>(dataLength)) {
-        DWORD toRead = dataLength - totalRead;
-        if (!ReadFile(hPipe_, &data[totalRead], toRead, &bytesRead, NULL)) {
-            if (errorCallback_) {
-                errorCallback_("Failed to read data");
+    int backoffMs = 0;
+    bool reported = false;
+    Clock::time_point retryAt = Clock::now();
+
+    while (isListening_) {
+        int timeoutMs = -1;
+        if (state_ == ConnectionState::Disconnected) {
+            std::string error;
+            if (Clock::now() < retryAt) {
+                // Waiting out the backoff
+            } else if (OpenConnection(true, error)) {
+                event.events = EPOLLIN | EPOLLRDHUP;
+                event.data.fd = fd_;
+                epoll_ctl(epollFd, EPOLL_CTL_ADD, fd_, &event);
+                MarkConnected();
+                UseListenerCallbacks();
+                backoffMs = 0;
+                reported = false;
+            } else {
+                if (!reported) ReportError(error + "; waiting for the server");
+                reported = true;
+                backoffMs = backoffMs ? std::min(backoffMs * 2, MAX_BACKOFF_MS) : INITIAL_BACKOFF_MS;
+                retryAt = Clock::now() + std::chrono::milliseconds(backoffMs);
+            }
+
+            if (state_ == ConnectionState::Disconnected) {
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(retryAt - Clock::now());
+                timeoutMs = static_cast<int>(std::max<int64_t>(wait.count(), 0));
             }
-            return "";
         }
-        totalRead += bytesRead;
-    }
 
-    return data;
-#else
-    // Read length prefix (4 bytes)
-    int32_t dataLength = 0;
-    ssize_t bytesRead = read(fd_, &dataLength, sizeof(dataLength));
+        epoll_event events[4];
+        const int count = epoll_wait(epollFd, events, 4, timeoutMs);
+        if (count < 0 && errno != EINTR) {
+            ReportError("epoll_wait failed: " + std::string(strerror(errno)));
+            break;
+        }
 
-    if (bytesRead != sizeof(dataLength)) {
-        if (errorCallback_) {
-            errorCallback_("Failed to read data length");
+        for (int i = 0; i < count; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                uint64_t value;
+                (void)!read(wakeFd_, &value, sizeof(value));
+            } else if (fd == inotifyFd) {
+                alignas(inotify_event) char buffer[4096];
+                bool pipeChanged = false;
+                ssize_t n;
+                while ((n = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                    for (ssize_t pos = 0; pos < n;) {
+                        const inotify_event* change = reinterpret_cast<const inotify_event*>(buffer + pos);
+                        if (change->len > 0 && fileName == change->name) pipeChanged = true;
+                        pos += sizeof(inotify_event) + change->len;
+                    }
+                }
+                // The server is (probably) back: retry now instead of after the backoff
+                if (pipeChanged && state_ == ConnectionState::Disconnected) {
+                    retryAt = Clock::now();
+                    backoffMs = 0;
+                }
+            } else if (fd == fd_ && fd_ != -1) {
+                if (!DrainConnection()) {
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd_, nullptr);
+                    decoder_.Finish();
+                    CloseConnection();
+                    retryAt = Clock::now(); // the writer left; reopen for the next one at once
+                }
+            }
         }
-        return "";
     }
 
-    if (dataLength <= 0 || dataLength > 100 * 1024 * 1024) { // Max 100MB
-        if (errorCallback_) {
-            errorCallback_("Invalid data length: " + std::to_string(dataLength));
+    if (IsConnected()) {
+        decoder_.Finish();
+        CloseConnection();
+    }
+    if (inotifyFd != -1) close(inotifyFd);
+    close(epollFd);
+}
+
+// Reads until the pipe would block. False once the writer has closed it.
+bool IPCClient::DrainConnection() {
+    while (isListening_) {
+        const ssize_t n = read(fd_, readBuffer_.get(), READ_BUFFER_SIZE);
+        if (n > 0) {
+            MarkFirstByte();
+            decoder_.Feed(readBuffer_.get(), static_cast<size_t>(n));
+            continue;
         }
-        return "";
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
     }
+    return true;
+}
+#endif
 
-    // Read data
+void IPCClient::UseListenerCallbacks() {
+    decoder_.SetCallbacks(
+        [this](MessageKind kind, uint64_t totalBytes) {
+            {
+                std::lock_guard<std::mutex> lock(metricsMutex_);
+                payloadStartedAt_ = Clock::now();
+            }
+            // Everything but snapshots is small and delivered whole
+            receivingKind_ = kind;
+            if (streamChunkCallback_ && kind == MessageKind::AssemblyJson) {
+                if (streamBeginCallback_) streamBeginCallback_(static_cast<size_t>(totalBytes));
+            } else {
+                pendingData_.clear();
+                pendingData_.reserve(static_cast<size_t>(totalBytes));
+            }
+        },
+        [this](const char* data, size_t size) {
+            if (streamChunkCallback_ && receivingKind_ == MessageKind::AssemblyJson) {
+                return streamChunkCallback_(data, size);
+            }
+            pendingData_.append(data, size);
+            return true;
+        },
+        [this](bool complete) {
+            if (receivingKind_ == MessageKind::AssemblyJson && streamChunkCallback_) {
+                if (streamEndCallback_) streamEndCallback_(complete);
+            } else {
+                const DataCallback* callback = nullptr;
+                switch (receivingKind_) {
+                    case MessageKind::AssemblyJson: callback = &dataCallback_; break;
+                    case MessageKind::AssemblyDelta: callback = &deltaCallback_; break;
+                    case MessageKind::TypeHeaders: callback = &headersCallback_; break;
+                    case MessageKind::MemberResponse: callback = &membersCallback_; break;
+                    case MessageKind::AssemblyBinary: callback = &binaryCallback_; break;
+                    case MessageKind::Progress: callback = &progressCallback_; break;
+                    case MessageKind::NotModified: callback = &notModifiedCallback_; break;
+                    default: break;
+                }
+                if (complete && callback && *callback) (*callback)(std::move(pendingData_));
+                pendingData_ = std::string();
+            }
+
+            std::lock_guard<std::mutex> lock(metricsMutex_);
+            if (complete) {
+                metrics_.payloads++;
+                metrics_.lastPayloadBytes = decoder_.MessageBytes();
+                metrics_.lastWireBytes = decoder_.WireBytes();
+                metrics_.firstByteToParsedMs =
+                    std::chrono::duration<double, std::milli>(Clock::now() - payloadStartedAt_).count();
+            } else {
+                metrics_.droppedPayloads++;
+            }
+        });
+}
+
+std::string IPCClient::ReadData() {
     std::string data;
-    data.resize(dataLength);
-
-    ssize_t totalRead = 0;
-    while (totalRead < dataLength) {
-        ssize_t n = read(fd_, &data[totalRead], dataLength - totalRead);
-        if (n <= 0) {
-            if (errorCallback_) {
-                errorCallback_("Failed to read data");
+    bool complete = false;
+    decoder_.SetCallbacks(
+        [&data](MessageKind, uint64_t totalBytes) {
+            data.clear();
+            data.reserve(static_cast<size_t>(totalBytes));
+        },
+        [&data](const char* chunk, size_t size) {
+            data.append(chunk, size);
+            return true;
+        },
+        [&complete](bool ok) { complete = ok; });
+
+    Pump([&complete]() { return complete; }, true);
+    decoder_.SetCallbacks(nullptr, nullptr, nullptr); // they refer to this frame
+    return complete ? data : std::string();
+}
+
+bool IPCClient::ReadStream() {
+    decoder_.SetCallbacks([this](MessageKind, uint64_t totalBytes) {
+                              if (streamBeginCallback_) streamBeginCallback_(static_cast<size_t>(totalBytes));
+                          },
+                          streamChunkCallback_, streamEndCallback_);
+    Pump(nullptr, false);
+    return decoder_.LastComplete();
+}
+
+bool IPCClient::Pump(const std::function<bool()>& done, bool stopAtMessageEnd) {
+    if (!IsConnected()) return false;
+
+    while (!done || !done()) {
+        if (transport_ == Transport::SharedMemory) {
+            // Frames are already delimited; payloads are read in place
+            FrameHeader header;
+            const char* payload = nullptr;
+            if (!ring_.NextFrame(header, payload)) {
+                decoder_.Finish();
+                return false;
+            }
+            MarkFirstByte();
+            decoder_.FeedFrame(header, payload);
+            continue;
+        }
+
+        if (readPos_ == readEnd_) {
+            const size_t n = ReadSome(readBuffer_.get(), READ_BUFFER_SIZE);
+            if (n == 0) {
+                decoder_.Finish();
+                return false;
             }
-            return "";
+            MarkFirstByte();
+            readPos_ = 0;
+            readEnd_ = n;
         }
-        totalRead += n;
+        readPos_ += decoder_.Feed(readBuffer_.get() + readPos_, readEnd_ - readPos_, stopAtMessageEnd);
     }
+    return true;
+}
 
-    return data;
+size_t IPCClient::ReadSome(char* out, size_t size) {
+#ifdef _WIN32
+    DWORD n = 0;
+    const DWORD toRead = size > MAXDWORD ? MAXDWORD : static_cast<DWORD>(size);
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = readEvent_;
+    if (!ReadFile(hPipe_, out, toRead, NULL, &overlapped) && GetLastError() != ERROR_IO_PENDING) return 0;
+    if (!GetOverlappedResult(hPipe_, &overlapped, &n, TRUE)) return 0;
+    return n;
+#else
+    while (true) {
+        ssize_t n = read(fd_, out, size);
+        if (n < 0 && errno == EINTR) continue;
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
 #endif
 }
 
+void IPCClient::MarkConnected() {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    metrics_.connections++;
+    connectedAt_ = Clock::now();
+}
+
+void IPCClient::MarkFirstByte() {
+    if (state_ != ConnectionState::Connecting) return;
+    state_ = ConnectionState::Streaming;
+
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    metrics_.connectToFirstByteMs = std::chrono::duration<double, std::milli>(Clock::now() - connectedAt_).count();
+}
+
+// Tells the server which snapshot the viewer holds, so it can answer that it is
+// current or send a delta. Best effort: without a back channel the server sends
+// a full snapshot. The ids come from payloads the mod sent, so they are escaped
+// like any other string.
+void IPCClient::SendHello() {
+    std::string hello = "{\"snapshotId\":\"";
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex_);
+        AppendJsonEscaped(hello, snapshotId_);
+        if (!moduleVersionId_.empty()) {
+            hello += "\",\"moduleVersionId\":\"";
+            AppendJsonEscaped(hello, moduleVersionId_);
+        }
+    }
+    hello += '"';
+    if (compression_) hello += ",\"compression\":[\"lz4\"]";
+    if (queryMode_) hello += ",\"query\":true";
+    if (binarySnapshots_) hello += ",\"binary\":true";
+    if (progressCallback_) hello += ",\"progress\":true";
+    hello += '}';
+    Send(MessageKind::Hello, hello);
+}
+
+bool IPCClient::Send(MessageKind kind, const std::string& payload) {
+    std::string frames;
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    AppendMessage(frames, kind, ++sentId_, payload.data(), payload.size());
+    return WriteBackChannel(frames);
+}
+
+// Called with writeMutex_ held. Requests are small, so over a FIFO one write
+// is atomic; it only fails when the server has stopped reading.
+bool IPCClient::WriteBackChannel(const std::string& frames) {
+#ifdef _WIN32
+    if (hPipe_ == INVALID_HANDLE_VALUE) return false;
+    DWORD written = 0;
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = writeEvent_;
+    if (!WriteFile(hPipe_, frames.data(), static_cast<DWORD>(frames.size()), NULL, &overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        return false;
+    }
+    return GetOverlappedResult(hPipe_, &overlapped, &written, TRUE) && written == frames.size();
+#else
+    if (requestFd_ == -1) return false;
+    while (true) {
+        const ssize_t n = write(requestFd_, frames.data(), frames.size());
+        if (n < 0 && errno == EINTR) continue;
+        return n == static_cast<ssize_t>(frames.size());
+    }
+#endif
+}
+
+void IPCClient::ReportError(const std::string& error) {
+    if (errorCallback_) {
+        errorCallback_(error);
+    }
+}
+
 } // namespace UnityReflection
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "frame_protocol.h"
+#include "shared_ring.h"
 #include <string>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,41 +21,227 @@
 
 namespace UnityReflection {
 
+// Disconnected: no server yet, retrying with backoff (on Linux also woken by
+// inotify when the pipe shows up). Connecting: the connection is open and no
+// byte has arrived yet. Streaming: data is flowing.
+enum class ConnectionState {
+    Disconnected,
+    Connecting,
+    Streaming
+};
+
+const char* ConnectionStateName(ConnectionState state);
+
+// Latency of the last connection and payload, in milliseconds; < 0 until the
+// first one is measured. A FIFO opened before its writer counts the wait for
+// the writer as connect-to-first-byte time.
+struct IPCMetrics {
+    uint64_t connections = 0;
+    uint64_t payloads = 0;
+    uint64_t droppedPayloads = 0;
+    double connectToFirstByteMs = -1.0;
+    double firstByteToParsedMs = -1.0; // until the end (or data) callback returned
+    uint64_t lastPayloadBytes = 0;
+    uint64_t lastWireBytes = 0; // chunk bytes that carried it; fewer when it came compressed
+};
+
 class IPCClient {
 public:
-    using DataCallback = std::function<void(const std::string& data)>;
+#ifdef _WIN32
+    static constexpr const char* DEFAULT_PIPE_NAME = "\\\\.\\pipe\\UnityReflectionPipe";
+    static constexpr const char* DEFAULT_RING_NAME = "Local\\UnityReflectionRing";
+#else
+    static constexpr const char* DEFAULT_PIPE_NAME = "/tmp/UnityReflectionPipe";
+    static constexpr const char* DEFAULT_RING_NAME = "/UnityReflectionRing";
+    static constexpr const char* REQUEST_PIPE_SUFFIX = ".req";
+#endif
+
+    // Pipe: the named pipe / FIFO the mod serves on. SharedMemory: the ring
+    // buffer in shared_ring.h, whose chunks reach the stream callbacks straight
+    // from the mapped pages; name is then the shared-memory object name.
+    enum class Transport {
+        Pipe,
+        SharedMemory
+    };
+
+    // The payload is handed over by value so consumers such as LazyAssembly and
+    // MappedSnapshot::Load can take ownership of the buffer without a copy
+    using DataCallback = std::function<void(std::string data)>;
     using ErrorCallback = std::function<void(const std::string& error)>;
 
-    IPCClient();
+    // Streaming delivery: the payload is passed on in chunks as it is read.
+    // totalBytes is 0 when the sender does not know the size up front.
+    using StreamBeginCallback = std::function<void(size_t totalBytes)>;
+    using StreamChunkCallback = std::function<bool(const char* data, size_t size)>;
+    using StreamEndCallback = std::function<void(bool complete)>;
+
+    // pipeName defaults to the pipe the Unity mod serves on
+    explicit IPCClient(std::string pipeName = DEFAULT_PIPE_NAME, Transport transport = Transport::Pipe);
     ~IPCClient();
 
     void SetDataCallback(DataCallback callback);
     void SetErrorCallback(ErrorCallback callback);
 
+    // When set, payloads go to these callbacks instead of the data callback, so
+    // parsing overlaps with the read and the full payload is never buffered.
+    // Returning false from the chunk callback abandons the payload. A payload
+    // cut short by a corrupt frame ends with complete == false.
+    void SetStreamCallbacks(StreamBeginCallback onBegin, StreamChunkCallback onChunk, StreamEndCallback onEnd);
+
+    // Delta payloads (MessageKind::AssemblyDelta) go here whole, whichever of
+    // the callbacks above is in use
+    void SetDeltaCallback(DataCallback callback);
+
+    // Query mode: the hello asks the server for type headers only
+    // (MessageKind::TypeHeaders) and the connection stays open for member
+    // requests sent with Send; headers and responses go to these callbacks
+    // whole. A server that predates query mode ignores the request and sends a
+    // full snapshot to the usual callbacks.
+    void SetQueryMode(bool enabled);
+    void SetQueryCallbacks(DataCallback onHeaders, DataCallback onMembers);
+
+    // Offers the server the binary snapshot format in the hello. A full snapshot
+    // then arrives as a snapshot file image (MessageKind::AssemblyBinary) and
+    // goes to the binary callback whole; deltas stay JSON. Off by default.
+    void SetBinarySnapshots(bool enabled);
+    void SetBinaryCallback(DataCallback callback);
+
+    // Setting this asks the server for progress reports (MessageKind::Progress)
+    // while it reflects: one before a JSON snapshot, whose types then stream
+    // in, and more while a binary snapshot or a delta is being built
+    void SetProgressCallback(DataCallback callback);
+
+    // Called instead of a snapshot when the hello named the assembly build the
+    // game still runs (see SetSnapshotId): the snapshot held is current
+    void SetNotModifiedCallback(DataCallback callback);
+
+    // Sends a message to the server over the back channel (see SetSnapshotId).
+    // May be called from any thread; false if there is no back channel or the
+    // write failed, in which case nothing was sent.
+    bool Send(MessageKind kind, const std::string& payload);
+
+    // The snapshot the viewer holds and the module version id of the assembly
+    // it was reflected from, sent to the server in a hello on every connection.
+    // If the game still runs that build the server replies NotModified, else
+    // it may send a delta against the snapshot. Empty asks for a full
+    // snapshot. Over a POSIX FIFO the hello goes to the pipe name plus
+    // REQUEST_PIPE_SUFFIX when the server has created it; the shared-memory
+    // ring has no back channel.
+    void SetSnapshotId(std::string snapshotId, std::string moduleVersionId = std::string());
+
+    // Whether the hello offers LZ4 chunk compression (on by default). The
+    // server decides per connection; compressed chunks are always accepted.
+    void SetCompression(bool enabled);
+
     bool Connect();
     void Disconnect();
     bool IsConnected() const;
 
+    // The listen thread connects by itself and reconnects as soon as the
+    // server comes back; callbacks run on it. On Linux it is event driven
+    // (epoll on the pipe, inotify on its directory); elsewhere it blocks on
+    // the read and retries failed connects with backoff.
     void StartListening();
     void StopListening();
 
+    ConnectionState GetState() const;
+    IPCMetrics GetMetrics() const;
+
+    // Blocking reads on a connection opened with Connect(), for the benchmark.
+    // ReadData returns the next complete payload, or an empty string once the
+    // connection closes. ReadStream delivers every payload to the stream
+    // callbacks until the connection closes and returns whether the last one
+    // was complete. Corrupt frames are reported to the error callback and
+    // skipped; the connection stays open.
+    std::string ReadData();
+    bool ReadStream();
+
 private:
     void ListenThread();
-    std::string ReadData();
+#ifdef __linux__
+    void EventLoop();
+    bool DrainConnection();
+#endif
+
+    bool OpenConnection(bool nonBlocking, std::string& error);
+    void CloseConnection();
+
+    // Routes decoded payloads to the data or stream callbacks and records metrics
+    void UseListenerCallbacks();
+
+    // Feeds the connection to decoder_ until done() holds or it closes; false
+    // once it has closed
+    bool Pump(const std::function<bool()>& done, bool stopAtMessageEnd);
+    size_t ReadSome(char* out, size_t size);
+
+    void SendHello();
+    bool WriteBackChannel(const std::string& frames);
+    void MarkConnected();
+    void MarkFirstByte();
+    void ReportError(const std::string& error);
 
     DataCallback dataCallback_;
+    DataCallback deltaCallback_;
+    DataCallback headersCallback_;
+    DataCallback membersCallback_;
+    DataCallback binaryCallback_;
+    DataCallback progressCallback_;
+    DataCallback notModifiedCallback_;
     ErrorCallback errorCallback_;
+    StreamBeginCallback streamBeginCallback_;
+    StreamChunkCallback streamChunkCallback_;
+    StreamEndCallback streamEndCallback_;
+
+    static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+    static constexpr int INITIAL_BACKOFF_MS = 50;
+    static constexpr int MAX_BACKOFF_MS = 2000;
+
+    // Constant-size regardless of payload size: one read buffer, plus the
+    // decoder's frame buffer
+    FrameDecoder decoder_;
+    std::unique_ptr<char[]> readBuffer_;
+    size_t readPos_ = 0;
+    size_t readEnd_ = 0;
+    std::string pendingData_; // payload being assembled for a callback that takes it whole
+    MessageKind receivingKind_ = MessageKind::AssemblyJson;
+
+    std::mutex snapshotMutex_;
+    std::string snapshotId_;
+    std::string moduleVersionId_;
+    std::atomic<bool> compression_{true};
+    std::atomic<bool> queryMode_{false};
+    std::atomic<bool> binarySnapshots_{false};
+
+    // Guards the back channel handle, which Send uses from other threads
+    std::mutex writeMutex_;
+    uint32_t sentId_ = 0;
 
     std::atomic<bool> isConnected_{false};
     std::atomic<bool> isListening_{false};
+    std::atomic<ConnectionState> state_{ConnectionState::Disconnected};
     std::unique_ptr<std::thread> listenThread_;
+    std::string pipeName_;
+    Transport transport_;
+    SharedRingReader ring_;
+
+    using Clock = std::chrono::steady_clock;
+    mutable std::mutex metricsMutex_;
+    IPCMetrics metrics_;
+    Clock::time_point connectedAt_;
+    Clock::time_point payloadStartedAt_;
 
 #ifdef _WIN32
+    // Opened for overlapped I/O: a synchronous handle would hold Send back
+    // until the listener's pending read completed
     HANDLE hPipe_ = INVALID_HANDLE_VALUE;
-    static constexpr const char* PIPE_NAME = "\\\\.\\pipe\\UnityReflectionPipe";
+    HANDLE readEvent_ = NULL;
+    HANDLE writeEvent_ = NULL;
 #else
     int fd_ = -1;
-    static constexpr const char* PIPE_NAME = "/tmp/UnityReflectionPipe";
+    int requestFd_ = -1; // back channel for the hello and member requests
+#endif
+#ifdef __linux__
+    int wakeFd_ = -1; // eventfd that StopListening signals
 #endif
 };
 
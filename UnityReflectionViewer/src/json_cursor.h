@@ -0,0 +1,211 @@
+#pragma once
+
+#include "json_scanner.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace UnityReflection {
+
+template <size_t N>
+inline bool KeyIs(std::string_view key, const char (&literal)[N]) {
+    return key.size() == N - 1 && memcmp(key.data(), literal, N - 1) == 0;
+}
+
+// Stage 2 primitives shared by the JSON parsers. The cursor walks the input like a
+// recursive-descent parser but uses the structural index to copy whole strings and
+// skip values in one step. Lenient in the same places the original scalar parser
+// was, so every parser built on it accepts exactly the same inputs.
+class JsonCursor {
+public:
+    JsonCursor(const char* data, size_t size, const StructuralIndex& index, size_t pos = 0)
+        : data_(data), size_(size), index_(index), pos_(pos) {}
+
+    size_t Position() const { return pos_; }
+
+protected:
+    const char* data_;
+    size_t size_;
+    const StructuralIndex& index_;
+    size_t pos_;
+    std::string keyScratch_;
+
+    char Peek() {
+        return pos_ < size_ ? data_[pos_] : '\0';
+    }
+
+    bool Expect(char c) {
+        if (Peek() == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    void SkipWhitespace() {
+        while (pos_ < size_ && (data_[pos_] == ' ' || data_[pos_] == '\n' ||
+               data_[pos_] == '\r' || data_[pos_] == '\t')) {
+            pos_++;
+        }
+    }
+
+    static char DecodeEscape(char c) {
+        switch (c) {
+            case 'n': return '\n';
+            case 'r': return '\r';
+            case 't': return '\t';
+            default: return c; // \\, \" and unknown escapes keep the character
+        }
+    }
+
+    // Unescapes [begin, end) into out. The closing quote at end is never part of an
+    // escape sequence, so only the characters in between need decoding.
+    void Unescape(size_t begin, size_t end, std::string& out) {
+        size_t pos = begin;
+        while (pos < end) {
+            const void* found = memchr(data_ + pos, '\\', end - pos);
+            const size_t run = found ? static_cast<const char*>(found) - (data_ + pos) : end - pos;
+            out.append(data_ + pos, run);
+            pos += run;
+            if (pos >= end) break;
+
+            if (pos + 1 < size_) {
+                pos++;
+                out += DecodeEscape(data_[pos]);
+            } else {
+                out += data_[pos];
+            }
+            pos++;
+        }
+    }
+
+    // Same as Unescape but writes to out, which may alias the input at begin (the
+    // decoded string is never longer). Returns the decoded length.
+    size_t UnescapeTo(size_t begin, size_t end, char* out) {
+        size_t pos = begin;
+        size_t written = 0;
+        while (pos < end) {
+            const void* found = memchr(data_ + pos, '\\', end - pos);
+            const size_t run = found ? static_cast<const char*>(found) - (data_ + pos) : end - pos;
+            memmove(out + written, data_ + pos, run);
+            written += run;
+            pos += run;
+            if (pos >= end) break;
+
+            if (pos + 1 < size_) {
+                pos++;
+                out[written++] = DecodeEscape(data_[pos]);
+            } else {
+                out[written++] = data_[pos];
+            }
+            pos++;
+        }
+        return written;
+    }
+
+    void ParseString(std::string& out) {
+        out.clear();
+        if (!Expect('"')) return;
+
+        const size_t end = index_.NextQuote(pos_);
+        if (index_.HasBackslash(pos_, end)) {
+            Unescape(pos_, end, out);
+        } else {
+            out.assign(data_ + pos_, end - pos_);
+        }
+
+        pos_ = end;
+        Expect('"');
+    }
+
+    // Like ParseString, but a string without escapes is returned as a view into
+    // the input; one with escapes is decoded into scratch
+    std::string_view ParseStringView(std::string& scratch) {
+        if (!Expect('"')) return {};
+
+        const size_t begin = pos_;
+        const size_t end = index_.NextQuote(pos_);
+        std::string_view value(data_ + begin, end - begin);
+        if (index_.HasBackslash(begin, end)) {
+            scratch.clear();
+            Unescape(begin, end, scratch);
+            value = scratch;
+        }
+
+        pos_ = end;
+        Expect('"');
+        return value;
+    }
+
+    std::string_view ParseKey() {
+        return ParseStringView(keyScratch_);
+    }
+
+    bool ParseBool() {
+        if (size_ - pos_ >= 4 && memcmp(data_ + pos_, "true", 4) == 0) {
+            pos_ += 4;
+            return true;
+        } else if (size_ - pos_ >= 5 && memcmp(data_ + pos_, "false", 5) == 0) {
+            pos_ += 5;
+            return false;
+        }
+        return false;
+    }
+
+    // Digits only, as the mod writes ids and indices; saturates rather than wraps
+    uint32_t ParseUInt() {
+        uint64_t value = 0;
+        while (pos_ < size_ && data_[pos_] >= '0' && data_[pos_] <= '9') {
+            value = std::min<uint64_t>(value * 10 + static_cast<uint64_t>(data_[pos_] - '0'), UINT32_MAX);
+            pos_++;
+        }
+        return static_cast<uint32_t>(value);
+    }
+
+    void SkipValue() {
+        SkipWhitespace();
+        char c = Peek();
+        if (c == '"') {
+            SkipString();
+        } else if (c == '{') {
+            SkipNested('{', '}');
+        } else if (c == '[') {
+            SkipNested('[', ']');
+        } else if (c == 't' || c == 'f') {
+            ParseBool();
+        } else {
+            // Numbers and literals run until the next , } or ]
+            while (pos_ < size_) {
+                pos_ = index_.NextStructural(pos_);
+                if (pos_ >= size_) break;
+                const char s = data_[pos_];
+                if (s == ',' || s == '}' || s == ']') break;
+                pos_++;
+            }
+        }
+    }
+
+    void SkipString() {
+        if (!Expect('"')) return;
+        pos_ = index_.NextQuote(pos_);
+        Expect('"');
+    }
+
+    // Skips a bracketed value by counting brackets of the same kind, like the
+    // scalar parser always has (brackets inside strings are counted too)
+    void SkipNested(char open, char close) {
+        if (!Expect(open)) return;
+        int depth = 1;
+        while (pos_ < size_ && depth > 0) {
+            pos_ = index_.NextStructural(pos_);
+            if (pos_ >= size_) break;
+            if (data_[pos_] == open) depth++;
+            else if (data_[pos_] == close) depth--;
+            pos_++;
+        }
+    }
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,307 @@
+#include "json_scanner.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define URV_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define URV_TARGET(isa) __attribute__((target(isa)))
+#else
+#define URV_TARGET(isa)
+#endif
+
+namespace UnityReflection {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 64;
+
+// Tracks backslash runs that continue across block boundaries
+struct EscapeScanner {
+    uint64_t prevEscaped = 0;
+
+    // Returns the bits of characters escaped by a backslash. A run of N backslashes
+    // escapes the character after it only when N is odd.
+    uint64_t Next(uint64_t backslash) {
+        if (!backslash) {
+            uint64_t escaped = prevEscaped;
+            prevEscaped = 0;
+            return escaped;
+        }
+
+        const uint64_t evenBits = 0x5555555555555555ULL;
+
+        backslash &= ~prevEscaped;
+        uint64_t followsEscape = (backslash << 1) | prevEscaped;
+
+        // Runs starting on an odd bit carry through the addition, runs starting on
+        // an even bit do not; the carry out of bit 63 continues into the next block
+        uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+        uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+        prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;
+
+        uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+        return (evenBits ^ invertMask) & followsEscape;
+    }
+};
+
+inline void FinishBlock(uint64_t quote, uint64_t backslash, uint64_t structural,
+                        EscapeScanner& escapes, StructuralIndex::BlockMasks& out) {
+    uint64_t escaped = escapes.Next(backslash);
+    out.quotes = quote & ~escaped;
+    out.backslashes = backslash;
+    out.structurals = structural;
+}
+
+// Bit i is the XOR of bits 0..i, so between an opening and a closing quote bit
+// the result is 1 (the opening quote included, the closing one not)
+inline uint64_t PrefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+inline bool IsStructural(char c) {
+    return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+void ClassifyScalar(const char* p, uint64_t& quote, uint64_t& backslash, uint64_t& structural) {
+    quote = 0;
+    backslash = 0;
+    structural = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        const uint64_t bit = 1ULL << i;
+        const char c = p[i];
+        if (c == '"') quote |= bit;
+        else if (c == '\\') backslash |= bit;
+        else if (IsStructural(c)) structural |= bit;
+    }
+}
+
+#ifdef URV_X86
+
+URV_TARGET("sse2")
+void ClassifySSE2(const char* p, uint64_t& quote, uint64_t& backslash, uint64_t& structural) {
+    const __m128i quoteChar = _mm_set1_epi8('"');
+    const __m128i backslashChar = _mm_set1_epi8('\\');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i openBracket = _mm_set1_epi8('{');
+    const __m128i closeBracket = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+
+    quote = 0;
+    backslash = 0;
+    structural = 0;
+    // '[' and '{' (and ']' and '}') differ only in bit 0x20, so OR-ing it in lets
+    // one compare match both brackets
+    for (int i = 0; i < 4; i++) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+        const __m128i folded = _mm_or_si128(chunk, caseBit);
+        const __m128i structuralMatch = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, openBracket), _mm_cmpeq_epi8(folded, closeBracket)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+
+        const int shift = i * 16;
+        quote |= static_cast<uint64_t>(static_cast<uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quoteChar)))) << shift;
+        backslash |= static_cast<uint64_t>(static_cast<uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslashChar)))) << shift;
+        structural |= static_cast<uint64_t>(static_cast<uint16_t>(
+            _mm_movemask_epi8(structuralMatch))) << shift;
+    }
+}
+
+URV_TARGET("avx2")
+void ClassifyAVX2(const char* p, uint64_t& quote, uint64_t& backslash, uint64_t& structural) {
+    const __m256i quoteChar = _mm256_set1_epi8('"');
+    const __m256i backslashChar = _mm256_set1_epi8('\\');
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i openBracket = _mm256_set1_epi8('{');
+    const __m256i closeBracket = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+
+    quote = 0;
+    backslash = 0;
+    structural = 0;
+    for (int i = 0; i < 2; i++) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i * 32));
+        const __m256i folded = _mm256_or_si256(chunk, caseBit);
+        const __m256i structuralMatch = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, openBracket), _mm256_cmpeq_epi8(folded, closeBracket)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+
+        const int shift = i * 32;
+        quote |= static_cast<uint64_t>(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quoteChar)))) << shift;
+        backslash |= static_cast<uint64_t>(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslashChar)))) << shift;
+        structural |= static_cast<uint64_t>(static_cast<uint32_t>(
+            _mm256_movemask_epi8(structuralMatch))) << shift;
+    }
+}
+
+#endif // URV_X86
+
+using ClassifyFn = void (*)(const char*, uint64_t&, uint64_t&, uint64_t&);
+
+ClassifyFn SelectClassifier(SimdLevel level) {
+#ifdef URV_X86
+    switch (level) {
+        case SimdLevel::AVX2: return ClassifyAVX2;
+        case SimdLevel::SSE2: return ClassifySSE2;
+        default: break;
+    }
+#else
+    (void)level;
+#endif
+    return ClassifyScalar;
+}
+
+SimdLevel DetectSimdLevelUncached() {
+#ifdef URV_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+    const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+    const bool hasAVX = (info[2] & (1 << 28)) != 0;
+
+    bool hasAVX2 = false;
+    if (maxLeaf >= 7 && hasOSXSave && hasAVX) {
+        // The OS must save the YMM registers on context switch
+        const bool ymmEnabled = (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        hasAVX2 = ymmEnabled && (info[1] & (1 << 5)) != 0;
+    }
+
+    if (hasAVX2) return SimdLevel::AVX2;
+    if (hasSSE2) return SimdLevel::SSE2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+#endif
+    return SimdLevel::Scalar;
+}
+
+} // namespace
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel level = DetectSimdLevelUncached();
+    return level;
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::SSE2: return "SSE2";
+        default: return "Scalar";
+    }
+}
+
+void StructuralIndex::Build(const char* data, size_t size) {
+    Build(data, size, DetectSimdLevel());
+}
+
+void StructuralIndex::Build(const char* data, size_t size, SimdLevel level) {
+    // Never run an instruction set the CPU does not have
+    if (level > DetectSimdLevel()) level = DetectSimdLevel();
+
+    size_ = size;
+    blocks_.resize((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    BuildBlocks(data, 0, blocks_.size(), level);
+}
+
+void StructuralIndex::Build(const char* data, size_t size, ThreadPool& pool) {
+    // Ranges of 1 MB; below that threads cost more than they save
+    constexpr size_t BLOCKS_PER_RANGE = (1 << 20) / BLOCK_SIZE;
+
+    size_ = size;
+    blocks_.resize((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    const SimdLevel level = DetectSimdLevel();
+    const size_t ranges = (blocks_.size() + BLOCKS_PER_RANGE - 1) / BLOCKS_PER_RANGE;
+    pool.ParallelFor(ranges, [&](size_t range) {
+        const size_t first = range * BLOCKS_PER_RANGE;
+        BuildBlocks(data, first, std::min(first + BLOCKS_PER_RANGE, blocks_.size()), level);
+    });
+}
+
+void StructuralIndex::BuildBlocks(const char* data, size_t firstBlock, size_t lastBlock, SimdLevel level) {
+    const ClassifyFn classify = SelectClassifier(level);
+
+    // A range starts escaped when it follows an odd run of backslashes; runs are
+    // delimited by any other character, so looking back is enough
+    EscapeScanner escapes;
+    size_t runStart = firstBlock * BLOCK_SIZE;
+    while (runStart > 0 && data[runStart - 1] == '\\') runStart--;
+    escapes.prevEscaped = ((firstBlock * BLOCK_SIZE - runStart) & 1) ? 1 : 0;
+
+    uint64_t quote, backslash, structural;
+    for (size_t block = firstBlock; block < lastBlock; block++) {
+        const size_t offset = block * BLOCK_SIZE;
+        if (offset + BLOCK_SIZE <= size_) {
+            classify(data + offset, quote, backslash, structural);
+        } else {
+            // Pad the last partial block with spaces so it classifies as nothing
+            char tail[BLOCK_SIZE];
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, data + offset, size_ - offset);
+            classify(tail, quote, backslash, structural);
+        }
+        FinishBlock(quote, backslash, structural, escapes, blocks_[block]);
+    }
+}
+
+size_t StructuralIndex::FindContainerEnd(const char* data, size_t open) const {
+    if (open >= size_) return size_;
+
+    // String contents are masked out a block at a time, so only structural
+    // characters outside strings are visited
+    const size_t firstBlock = open / BLOCK_SIZE;
+    uint64_t inString = 0; // all ones if the previous block ended inside a string
+    int depth = 0;
+    for (size_t block = firstBlock; block < blocks_.size(); block++) {
+        uint64_t quotes = blocks_[block].quotes;
+        uint64_t mask = blocks_[block].structurals;
+        if (block == firstBlock) {
+            quotes &= ~0ULL << (open % BLOCK_SIZE);
+            mask &= ~0ULL << (open % BLOCK_SIZE);
+        }
+
+        const uint64_t strings = PrefixXor(quotes) ^ inString;
+        inString = (strings >> 63) ? ~0ULL : 0;
+        mask &= ~strings;
+
+        while (mask) {
+            const size_t pos = block * BLOCK_SIZE + CountTrailingZeros(mask);
+            mask &= mask - 1;
+            const char c = data[pos];
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return pos + 1;
+            }
+        }
+    }
+    return size_;
+}
+
+} // namespace UnityReflection
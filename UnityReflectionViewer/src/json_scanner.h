@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace UnityReflection {
+
+class ThreadPool;
+
+inline unsigned CountTrailingZeros(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+// Instruction sets the structural scanner can run on
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Best instruction set supported by the running CPU (checked once)
+SimdLevel DetectSimdLevel();
+const char* SimdLevelName(SimdLevel level);
+
+// Stage 1 of the JSON parser: classifies the input in 64-byte blocks and keeps
+// one bit per byte for unescaped quotes, backslashes and structural characters
+// ({ } [ ] : ,). Stage 2 uses it to jump over string contents and skipped values
+// instead of walking them one character at a time.
+class StructuralIndex {
+public:
+    void Build(const char* data, size_t size);
+    void Build(const char* data, size_t size, SimdLevel level);
+    // Classifies 1 MB ranges on the pool; the result is identical to Build()
+    void Build(const char* data, size_t size, ThreadPool& pool);
+
+    size_t Size() const { return size_; }
+
+    // Position of the first unescaped quote at or after pos, or Size() if none.
+    // These three run once or twice per string in stage 2, so they are inline.
+    size_t NextQuote(size_t pos) const { return NextSet(&BlockMasks::quotes, pos); }
+
+    // Position of the first structural character at or after pos, or Size() if none
+    size_t NextStructural(size_t pos) const { return NextSet(&BlockMasks::structurals, pos); }
+
+    // True if any backslash lies in [begin, end)
+    bool HasBackslash(size_t begin, size_t end) const {
+        if (begin >= end) return false;
+
+        const size_t firstBlock = begin / 64;
+        const size_t lastBlock = (end - 1) / 64;
+        for (size_t block = firstBlock; block <= lastBlock; block++) {
+            uint64_t mask = blocks_[block].backslashes;
+            if (block == firstBlock) mask &= ~0ULL << (begin % 64);
+            if (block == lastBlock) {
+                const size_t endBit = (end - 1) % 64;
+                if (endBit < 63) mask &= (1ULL << (endBit + 1)) - 1;
+            }
+            if (mask) return true;
+        }
+        return false;
+    }
+
+    // Position just past the bracket that closes the object or array opened at
+    // open, ignoring brackets inside strings, or Size() if it is never closed.
+    // data must be the buffer the index was built from.
+    size_t FindContainerEnd(const char* data, size_t open) const;
+
+    // Calls visit(pos, c) for every quote and structural character in [begin, end),
+    // in order, until visit returns false. Returns false if it was stopped.
+    template <typename Visitor>
+    bool ForEachToken(const char* data, size_t begin, size_t end, Visitor&& visit) const {
+        if (end > size_) end = size_;
+        if (begin >= end) return true;
+
+        const size_t lastBlock = (end - 1) / 64;
+        for (size_t block = begin / 64; block <= lastBlock; block++) {
+            uint64_t mask = blocks_[block].quotes | blocks_[block].structurals;
+            if (block == begin / 64) mask &= ~0ULL << (begin % 64);
+            if (block == lastBlock && end % 64 != 0) mask &= (1ULL << (end % 64)) - 1;
+
+            while (mask) {
+                const size_t pos = block * 64 + CountTrailingZeros(mask);
+                mask &= mask - 1;
+                if (!visit(pos, data[pos])) return false;
+            }
+        }
+        return true;
+    }
+
+    // Calls visit(pos, c) for every bracket that lies outside a string, in order.
+    // data must be the buffer the index was built from.
+    template <typename Visitor>
+    void ForEachBracket(const char* data, Visitor&& visit) const {
+        bool inString = false;
+        ForEachToken(data, 0, size_, [&](size_t pos, char c) {
+            if (c == '"') {
+                inString = !inString;
+            } else if (!inString && c != ':' && c != ',') {
+                visit(pos, c);
+            }
+            return true;
+        });
+    }
+
+    struct BlockMasks {
+        uint64_t quotes = 0;
+        uint64_t backslashes = 0;
+        uint64_t structurals = 0;
+    };
+
+private:
+    void BuildBlocks(const char* data, size_t firstBlock, size_t lastBlock, SimdLevel level);
+
+    size_t NextSet(uint64_t BlockMasks::*bits, size_t pos) const {
+        if (pos >= size_) return size_;
+
+        size_t block = pos / 64;
+        uint64_t mask = blocks_[block].*bits & (~0ULL << (pos % 64));
+        while (!mask) {
+            if (++block == blocks_.size()) return size_;
+            mask = blocks_[block].*bits;
+        }
+        return block * 64 + CountTrailingZeros(mask);
+    }
+
+    size_t size_ = 0;
+    std::vector<BlockMasks> blocks_;
+};
+
+} // namespace UnityReflection
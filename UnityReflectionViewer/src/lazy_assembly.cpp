@@ -0,0 +1,79 @@
+#include "lazy_assembly.h"
+
+namespace UnityReflection {
+
+bool LazyAssembly::Load(std::string json, AssemblyData& data) {
+    return Load(std::make_shared<const std::string>(std::move(json)), data);
+}
+
+bool LazyAssembly::Load(std::shared_ptr<const std::string> json, AssemblyData& data) {
+    Clear();
+    json_ = std::move(json);
+
+    const bool ok = ParseAssemblyHeaders(*json_, data, spans_);
+    materialized_.assign(spans_.size(), 0);
+    return ok;
+}
+
+void LazyAssembly::Clear() {
+    json_.reset();
+    spans_ = std::vector<TypeMemberSpans>();
+    materialized_ = std::vector<uint8_t>();
+    materializedCount_ = 0;
+    malformedCount_ = 0;
+}
+
+bool LazyAssembly::Materialize(size_t typeIndex, AssemblyData& data) {
+    if (IsMaterialized(typeIndex) || typeIndex >= data.types.size()) return false;
+
+    // Malformed arrays keep what was read before the error, as in a full parse
+    if (!ParseTypeMembers(*json_, spans_[typeIndex], data.symbols, data.types[typeIndex])) malformedCount_++;
+    materialized_[typeIndex] = 1;
+    materializedCount_++;
+    ReleaseIfDone();
+    return true;
+}
+
+void LazyAssembly::MaterializeAll(AssemblyData& data) {
+    for (size_t i = 0; i < materialized_.size() && IsLoaded(); i++) {
+        Materialize(i, data);
+    }
+}
+
+// Types past the end of materialized_ were never lazy, so only entries below it
+// need updating
+void LazyAssembly::RemoveType(size_t typeIndex, size_t movedFrom) {
+    if (typeIndex >= materialized_.size()) return;
+
+    if (materialized_[typeIndex]) materializedCount_--;
+    if (movedFrom < materialized_.size()) {
+        spans_[typeIndex] = spans_[movedFrom];
+        materialized_[typeIndex] = materialized_[movedFrom];
+        spans_.pop_back();
+        materialized_.pop_back();
+    } else {
+        // A type added by an earlier delta, complete already
+        spans_[typeIndex] = TypeMemberSpans();
+        materialized_[typeIndex] = 1;
+        materializedCount_++;
+    }
+    ReleaseIfDone();
+}
+
+void LazyAssembly::MarkReplaced(size_t typeIndex) {
+    if (IsMaterialized(typeIndex)) return;
+
+    materialized_[typeIndex] = 1;
+    materializedCount_++;
+    ReleaseIfDone();
+}
+
+void LazyAssembly::ReleaseIfDone() {
+    if (materializedCount_ < spans_.size()) return;
+
+    json_.reset();
+    spans_ = std::vector<TypeMemberSpans>();
+    materialized_ = std::vector<uint8_t>();
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "reflection_data.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace UnityReflection {
+
+// Lazy load mode: the payload is parsed headers-only (names, base type, kind
+// flags) and kept, and a type's fields, methods and properties are decoded from
+// it the first time something asks for them. The member vectors of a type in
+// the AssemblyData stay empty until then.
+class LazyAssembly {
+public:
+    // Parses the type headers of json into data and keeps json for later decoding
+    bool Load(std::string json, AssemblyData& data);
+
+    // Same, for a payload shared with someone else, e.g. a worker writing the
+    // snapshot cache from it
+    bool Load(std::shared_ptr<const std::string> json, AssemblyData& data);
+
+    void Clear();
+
+    // True while some types still have undecoded members
+    bool IsLoaded() const { return !spans_.empty(); }
+
+    // True if the members of data.types[typeIndex] are present, either decoded
+    // already or because the type did not come from Load()
+    bool IsMaterialized(size_t typeIndex) const {
+        return typeIndex >= materialized_.size() || materialized_[typeIndex];
+    }
+
+    // Decodes the members of data.types[typeIndex] into it unless that happened
+    // already. Returns true if they were decoded by this call. A type whose
+    // member arrays are malformed keeps what was read and is counted in
+    // MalformedCount(): the headers pass only skipped those arrays, so the load
+    // may have accepted a payload the full parse rejects.
+    bool Materialize(size_t typeIndex, AssemblyData& data);
+
+    // Decodes every remaining type, e.g. before a search over all members
+    void MaterializeAll(AssemblyData& data);
+
+    // Keep the per-type state in step with a delta (DeltaApplier): a type
+    // removed by swapping the last one into its place, and a type whose
+    // members were replaced with decoded ones
+    void RemoveType(size_t typeIndex, size_t movedFrom);
+    void MarkReplaced(size_t typeIndex);
+
+    size_t MaterializedCount() const { return materializedCount_; }
+
+    // Types decoded so far whose members were malformed; kept after the payload
+    // is released
+    size_t MalformedCount() const { return malformedCount_; }
+
+    // The payload is released once every type has been decoded
+    size_t BytesRetained() const {
+        return (json_ ? json_->capacity() : 0) + spans_.capacity() * sizeof(TypeMemberSpans);
+    }
+
+private:
+    void ReleaseIfDone();
+
+    std::shared_ptr<const std::string> json_;
+    std::vector<TypeMemberSpans> spans_;
+    std::vector<uint8_t> materialized_;
+    size_t materializedCount_ = 0;
+    size_t malformedCount_ = 0;
+};
+
+} // namespace UnityReflection
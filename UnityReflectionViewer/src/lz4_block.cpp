@@ -0,0 +1,198 @@
+#include "lz4_block.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace UnityReflection {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5; // the block ends with at least this many literals
+constexpr size_t MF_LIMIT = 12;     // no match starts in the last 12 bytes
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_LOG = 14;
+constexpr int SKIP_SHIFT = 6; // the step grows by one every 64 bytes without a match
+
+uint32_t Load32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+uint64_t Load64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, 8);
+    return value;
+}
+
+uint32_t Hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+unsigned TrailingZeroBytes(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<unsigned>(index) / 8;
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x)) / 8;
+#endif
+}
+
+// Number of equal bytes at p and match, stopping at limit
+size_t MatchLength(const uint8_t* p, const uint8_t* match, const uint8_t* limit) {
+    const uint8_t* start = p;
+    while (p + 8 <= limit) {
+        const uint64_t diff = Load64(p) ^ Load64(match);
+        if (diff != 0) return static_cast<size_t>(p - start) + TrailingZeroBytes(diff);
+        p += 8;
+        match += 8;
+    }
+    while (p < limit && *p == *match) {
+        p++;
+        match++;
+    }
+    return static_cast<size_t>(p - start);
+}
+
+// The bytes after a nibble of 15
+uint8_t* WriteLength(uint8_t* op, size_t length) {
+    length -= 15;
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+bool ReadLength(const uint8_t*& ip, const uint8_t* iend, size_t& length) {
+    uint8_t b;
+    do {
+        if (ip >= iend) return false;
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+// Writes literalCount literals and, when matchLength > 0, the match after them
+uint8_t* WriteSequence(uint8_t* op, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4);
+    if (literalCount >= 15) op = WriteLength(op, literalCount);
+    memcpy(op, literals, literalCount);
+    op += literalCount;
+    if (matchLength == 0) return op;
+
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+    const size_t extra = matchLength - MIN_MATCH;
+    *token |= static_cast<uint8_t>(extra >= 15 ? 15 : extra);
+    if (extra >= 15) op = WriteLength(op, extra);
+    return op;
+}
+
+// Copies a match of length bytes from offset bytes back. Overlapping copies
+// (offset < length) repeat the pattern, as the format requires; a fixed-size
+// copy never reads bytes it has not written while its size is <= offset.
+void CopyMatch(uint8_t* op, size_t offset, size_t length, const uint8_t* oend) {
+    const uint8_t* match = op - offset;
+    const size_t room = static_cast<size_t>(oend - op);
+    if (offset >= 16 && room >= length + 16) {
+        for (size_t i = 0; i < length; i += 16) memcpy(op + i, match + i, 16);
+    } else if (offset >= 8 && room >= length + 8) {
+        for (size_t i = 0; i < length; i += 8) memcpy(op + i, match + i, 8);
+    } else {
+        for (size_t i = 0; i < length; i++) op[i] = match[i];
+    }
+}
+
+} // namespace
+
+size_t Lz4Compress(const char* source, size_t size, char* dest) {
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(source);
+    uint8_t* op = reinterpret_cast<uint8_t*>(dest);
+    size_t anchor = 0;
+
+    if (size >= MF_LIMIT + 1) {
+        // Position + 1 of the last 4-byte sequence with each hash; 0 is empty
+        std::vector<uint32_t> table(size_t(1) << HASH_LOG, 0);
+        const size_t mfLimit = size - MF_LIMIT;
+        const uint8_t* matchLimit = src + size - LAST_LITERALS;
+
+        size_t pos = 0;
+        while (pos < mfLimit) {
+            const uint32_t sequence = Load32(src + pos);
+            uint32_t& slot = table[Hash(sequence)];
+            const size_t candidate = slot;
+            slot = static_cast<uint32_t>(pos + 1);
+            if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET || Load32(src + candidate - 1) != sequence) {
+                pos += 1 + ((pos - anchor) >> SKIP_SHIFT);
+                continue;
+            }
+
+            size_t match = candidate - 1;
+            while (pos > anchor && match > 0 && src[pos - 1] == src[match - 1]) {
+                pos--;
+                match--;
+            }
+            const size_t length = MIN_MATCH + MatchLength(src + pos + MIN_MATCH, src + match + MIN_MATCH, matchLimit);
+            op = WriteSequence(op, src + anchor, pos - anchor, pos - match, length);
+            pos += length;
+            anchor = pos;
+
+            // Also index a position inside the match, which finds more of the
+            // repeats that follow one another in JSON
+            if (pos - 2 < mfLimit) table[Hash(Load32(src + pos - 2))] = static_cast<uint32_t>(pos - 1);
+        }
+    }
+
+    op = WriteSequence(op, src + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(dest));
+}
+
+bool Lz4Decompress(const char* source, size_t srcSize, char* dest, size_t dstSize) {
+    const uint8_t* ip = reinterpret_cast<const uint8_t*>(source);
+    const uint8_t* const iend = ip + srcSize;
+    uint8_t* op = reinterpret_cast<uint8_t*>(dest);
+    uint8_t* const ostart = op;
+    uint8_t* const oend = op + dstSize;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        // Short literal runs, the common case, are one fixed-size copy
+        size_t literals = token >> 4;
+        if (literals < 15 && iend - ip >= 16 && oend - op >= 16) {
+            memcpy(op, ip, 16);
+        } else {
+            if (literals == 15 && !ReadLength(ip, iend, literals)) return false;
+            if (literals > static_cast<size_t>(iend - ip) || literals > static_cast<size_t>(oend - op)) return false;
+            memcpy(op, ip, literals);
+        }
+        ip += literals;
+        op += literals;
+        if (ip == iend) return op == oend; // the last sequence has no match
+
+        if (iend - ip < 2) return false;
+        const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - ostart)) return false;
+
+        size_t length = token & 15;
+        if (length == 15 && !ReadLength(ip, iend, length)) return false;
+        length += MIN_MATCH;
+        if (length > static_cast<size_t>(oend - op)) return false;
+        CopyMatch(op, offset, length, oend);
+        op += length;
+    }
+    return false; // ran out of input before the literals-only sequence
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace UnityReflection {
+
+// LZ4 block format (no frame header, no checksum; the framing in
+// frame_protocol.h carries both), compatible with LZ4_compress_default and
+// LZ4_decompress_safe. A block is a run of sequences:
+//
+//   token        high nibble: literal count, low nibble: match length - 4,
+//                15 meaning more length bytes follow
+//   [length]     255-valued bytes, then one < 255, added to the literal count
+//   literals
+//   offset       2 bytes little-endian, distance back to the match (1..65535)
+//   [length]     same, added to the match length
+//
+// The last sequence is literals only and holds at least the last 5 bytes; the
+// last match starts at least 12 bytes before the end.
+
+// Largest compressed size of size input bytes
+constexpr size_t Lz4CompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// Compresses src into dst, which must hold Lz4CompressBound(size) bytes.
+// Returns the compressed size. Used by the benchmark and local tools; the mod
+// has its own encoder (Lz4Block.cs).
+size_t Lz4Compress(const char* src, size_t size, char* dst);
+
+// Decompresses a block that must expand to exactly dstSize bytes. Returns
+// false for a malformed block instead of reading or writing out of bounds.
+bool Lz4Decompress(const char* src, size_t srcSize, char* dst, size_t dstSize);
+
+} // namespace UnityReflection
@@ -2,18 +2,73 @@
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "ipc_client.h"
+#include "lazy_assembly.h"
 #include "reflection_data.h"
+#include "snapshot_file.h"
+#include "streaming_parser.h"
+#include "thread_pool.h"
 #include "ui/main_window.h"
 
+// Last snapshot received from the game, shown at startup until a new one arrives
+static const char* SNAPSHOT_CACHE_PATH = "last_snapshot.urvsnap";
+
+// Lazy mode keeps only the type headers, so the cache is written from a full
+// parse of the payload, started on a worker and split across the pool. Saves
+// share a temporary file and never overlap, and one whose payload has been
+// superseded is skipped.
+static std::atomic<uint64_t> cachePayloads{0};
+static std::mutex cacheMutex;
+
+static void SaveCacheInBackground(std::shared_ptr<const std::string> payload) {
+    const uint64_t payloadNumber = ++cachePayloads;
+    UnityReflection::ThreadPool::Shared().Submit([payload, payloadNumber]() {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (payloadNumber != cachePayloads.load()) return;
+
+        UnityReflection::AssemblyData full;
+        if (!UnityReflection::ParseAssemblyDataParallel(*payload, full, &UnityReflection::ThreadPool::Shared())) {
+            std::cerr << "Received data is malformed; the snapshot cache was not updated" << std::endl;
+            return;
+        }
+        UnityReflection::SnapshotWriter writer;
+        writer.AddAssemblyData(full);
+        if (!writer.Save(SNAPSHOT_CACHE_PATH)) {
+            std::cerr << "Failed to save snapshot cache" << std::endl;
+        }
+    });
+}
+
 static void glfw_error_callback(int error, const char* description) {
     std::cerr << "GLFW Error " << error << ": " << description << std::endl;
 }
 
 int main(int argc, char** argv) {
+    // --lazy: parse only the type headers of a payload and decode members on demand
+    // --shm: read from the shared-memory ring instead of the pipe
+    // --no-compression: do not offer LZ4 chunk compression to the mod
+    // --query: ask the mod for type headers only and fetch members as types are shown
+    // --json: ask for JSON snapshots rather than the binary snapshot format
+    bool lazyLoad = false;
+    bool sharedMemory = false;
+    bool compression = true;
+    bool queryMode = false;
+    bool binary = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lazy") == 0) lazyLoad = true;
+        if (strcmp(argv[i], "--shm") == 0) sharedMemory = true;
+        if (strcmp(argv[i], "--no-compression") == 0) compression = false;
+        if (strcmp(argv[i], "--query") == 0) queryMode = true;
+        if (strcmp(argv[i], "--json") == 0) binary = false;
+    }
+
     // Setup window
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit()) {
@@ -52,30 +107,231 @@ int main(int argc, char** argv) {
     // Create main window
     auto mainWindow = std::make_unique<UnityReflection::UI::MainWindow>();
 
+    // Show the cached snapshot right away. Its ids go in the hello, so a game
+    // still running the same build of the assembly does not send it again.
+    std::string snapshotId;      // of the snapshot the window holds, announced on reconnect
+    std::string moduleVersionId; // of the assembly it was reflected from
+    {
+        UnityReflection::MappedSnapshot cached;
+        if (cached.Open(SNAPSHOT_CACHE_PATH)) {
+            UnityReflection::AssemblyData assemblyData;
+            cached.ToAssemblyData(assemblyData);
+            std::cout << "Loaded cached snapshot: " << assemblyData.assemblyName << " ("
+                      << assemblyData.types.size() << " types)" << std::endl;
+            snapshotId = assemblyData.snapshotId;
+            moduleVersionId = assemblyData.moduleVersionId;
+            mainWindow->SetAssemblyData(std::move(assemblyData));
+        }
+    }
+
     // Create IPC client
-    auto ipcClient = std::make_unique<UnityReflection::IPCClient>();
+    auto ipcClient = sharedMemory
+        ? std::make_unique<UnityReflection::IPCClient>(UnityReflection::IPCClient::DEFAULT_RING_NAME,
+                                                       UnityReflection::IPCClient::Transport::SharedMemory)
+        : std::make_unique<UnityReflection::IPCClient>();
+    ipcClient->SetCompression(compression);
+    ipcClient->SetQueryMode(queryMode);
+    ipcClient->SetBinarySnapshots(binary && !lazyLoad); // lazy mode decodes members from the JSON
+    if (!queryMode) ipcClient->SetSnapshotId(snapshotId, moduleVersionId); // query mode replaces it
+
+    // Set up callbacks. Payloads are parsed while they are read, and each chunk's
+    // types are handed to the window as a batch
+    std::vector<UnityReflection::TypeInfo> typeBatch;
+    size_t symbolsSent = 0;
+    size_t expectedTypes = 0; // from the mod's last progress report, for the next load
+    UnityReflection::SnapshotWriter cacheWriter;
+    UnityReflection::StreamingParser streamParser([&typeBatch](UnityReflection::TypeInfo&& type) {
+        typeBatch.push_back(std::move(type));
+    });
 
-    // Set up callbacks
-    ipcClient->SetDataCallback([&mainWindow](const std::string& data) {
-        std::cout << "Received data: " << data.length() << " bytes" << std::endl;
+    if (lazyLoad) {
+        // The whole payload is read, its headers parsed and the window updated.
+        // The window and the worker writing the cache share the payload.
+        ipcClient->SetDataCallback([&](std::string data) {
+            std::cout << "Received data: " << data.size() << " bytes" << std::endl;
+
+            auto payload = std::make_shared<const std::string>(std::move(data));
+            UnityReflection::LazyAssembly lazy;
+            UnityReflection::AssemblyData headers;
+            if (!lazy.Load(payload, headers)) {
+                std::cerr << "Failed to parse assembly data" << std::endl;
+                return;
+            }
+            std::cout << "Loaded type headers: " << headers.assemblyName << " (" << headers.types.size()
+                      << " types)" << std::endl;
+            snapshotId = headers.snapshotId;
+            moduleVersionId = headers.moduleVersionId;
+            ipcClient->SetSnapshotId(snapshotId, moduleVersionId);
+            mainWindow->SetLazyAssembly(std::move(lazy), std::move(headers));
+            SaveCacheInBackground(std::move(payload));
+        });
+    } else {
+        ipcClient->SetStreamCallbacks(
+            [&](size_t totalBytes) {
+                if (totalBytes > 0) {
+                    std::cout << "Receiving data: " << totalBytes << " bytes" << std::endl;
+                } else {
+                    std::cout << "Receiving data..." << std::endl;
+                }
+                streamParser.Reset();
+                symbolsSent = 0;
+                cacheWriter.Clear();
+                mainWindow->BeginAssemblyData(expectedTypes);
+                expectedTypes = 0;
+            },
+            [&](const char* data, size_t size) {
+                bool ok = streamParser.Feed(data, size);
+                if (!typeBatch.empty()) {
+                    // Ship the type names first seen in this batch along with it
+                    const UnityReflection::SymbolTable& symbols = streamParser.Symbols();
+                    for (const auto& type : typeBatch) {
+                        cacheWriter.AddType(type, symbols);
+                    }
+                    std::vector<std::string> newSymbols;
+                    for (; symbolsSent < symbols.Size(); symbolsSent++) {
+                        newSymbols.emplace_back(symbols.Name(static_cast<UnityReflection::SymbolId>(symbolsSent)));
+                    }
+                    mainWindow->AppendTypes(std::move(typeBatch), std::move(newSymbols));
+                    typeBatch.clear();
+                }
+                return ok;
+            },
+            [&](bool complete) {
+                UnityReflection::AssemblyData header;
+                const bool parsed = complete && streamParser.Finish(header);
+                if (parsed) {
+                    std::cout << "Successfully parsed assembly: " << header.assemblyName << std::endl;
+                    std::cout << "Total types: " << streamParser.TypesParsed() << std::endl;
+
+                    cacheWriter.SetHeader(header);
+                    if (!cacheWriter.Save(SNAPSHOT_CACHE_PATH)) {
+                        std::cerr << "Failed to save snapshot cache" << std::endl;
+                    }
+                } else {
+                    std::cerr << "Failed to parse assembly data" << std::endl;
+                }
+                cacheWriter = UnityReflection::SnapshotWriter(); // release the records
+                if (parsed) {
+                    snapshotId = header.snapshotId;
+                    moduleVersionId = header.moduleVersionId;
+                    mainWindow->EndAssemblyData(header);
+                } else {
+                    // Finish may have filled in part of the header; the window
+                    // drops the partial types and holds no snapshot
+                    snapshotId.clear();
+                    moduleVersionId.clear();
+                    mainWindow->FailAssemblyData();
+                }
+                ipcClient->SetSnapshotId(snapshotId, moduleVersionId);
+            });
+    }
+
+    // The mod reports how far it is before a snapshot; a JSON snapshot streams
+    // in right after the first report, which gives the total to show
+    ipcClient->SetProgressCallback([&](std::string data) {
+        UnityReflection::ReflectionProgress progress;
+        if (!UnityReflection::ParseReflectionProgress(data, progress)) return;
+        expectedTypes = progress.typesTotal;
+        mainWindow->SetReflectionProgress(progress);
+    });
+
+    // A binary snapshot is already in the cache file's format: it is checked in
+    // place, checksum and all, saved as it is and copied into the window's data.
+    // The frames' checksums only cover the transport, and the legacy format has
+    // none, so the image is never trusted without the full check.
+    ipcClient->SetBinaryCallback([&](std::string data) {
+        std::cout << "Received binary snapshot: " << data.size() << " bytes" << std::endl;
+
+        UnityReflection::MappedSnapshot snapshot;
+        if (!snapshot.Load(std::move(data))) {
+            std::cerr << "Failed to read binary snapshot" << std::endl;
+            return;
+        }
+        if (!snapshot.Save(SNAPSHOT_CACHE_PATH)) {
+            std::cerr << "Failed to save snapshot cache" << std::endl;
+        }
 
         UnityReflection::AssemblyData assemblyData;
-        if (UnityReflection::ParseAssemblyData(data, assemblyData)) {
-            std::cout << "Successfully parsed assembly: " << assemblyData.assemblyName << std::endl;
-            std::cout << "Total types: " << assemblyData.types.size() << std::endl;
-            mainWindow->SetAssemblyData(assemblyData);
-        } else {
-            std::cerr << "Failed to parse assembly data" << std::endl;
+        snapshot.ToAssemblyData(assemblyData);
+        std::cout << "Loaded assembly: " << assemblyData.assemblyName << " (" << assemblyData.types.size()
+                  << " types)" << std::endl;
+        snapshotId = assemblyData.snapshotId;
+        moduleVersionId = assemblyData.moduleVersionId;
+        ipcClient->SetSnapshotId(snapshotId, moduleVersionId);
+        mainWindow->SetAssemblyData(std::move(assemblyData));
+    });
+
+    // Deltas are applied by the window in order after the snapshot before them,
+    // so the snapshot id tracked here is what the window will hold
+    ipcClient->SetDeltaCallback([&](std::string data) {
+        UnityReflection::AssemblyDelta delta;
+        if (!UnityReflection::ParseAssemblyDelta(data, delta) || delta.baseSnapshotId != snapshotId) {
+            std::cerr << "Dropped a delta that does not apply to the current snapshot" << std::endl;
+            snapshotId.clear(); // ask for a full snapshot next time
+            moduleVersionId.clear();
+            ipcClient->SetSnapshotId(snapshotId);
+            return;
         }
+        std::cout << "Received delta: " << delta.types.size() << " changed, " << delta.removed.size()
+                  << " removed" << std::endl;
+        snapshotId = delta.snapshotId;
+        moduleVersionId = delta.moduleVersionId;
+        ipcClient->SetSnapshotId(snapshotId, moduleVersionId);
+        mainWindow->ApplyDelta(std::move(delta));
     });
 
+    // The game runs the build of the assembly the hello named, or the mod
+    // recognised the snapshot id, so the snapshot the window holds is current
+    // and nothing more is sent
+    ipcClient->SetNotModifiedCallback([&](std::string data) {
+        UnityReflection::SnapshotNotModified notModified;
+        if (!UnityReflection::ParseSnapshotNotModified(data, notModified) ||
+            (!moduleVersionId.empty() && notModified.moduleVersionId != moduleVersionId)) {
+            std::cerr << "Ignored a not-modified reply for another build of the assembly" << std::endl;
+            snapshotId.clear(); // ask for a full snapshot next time
+            moduleVersionId.clear();
+            ipcClient->SetSnapshotId(snapshotId);
+            return;
+        }
+        moduleVersionId = notModified.moduleVersionId;
+        ipcClient->SetSnapshotId(snapshotId, moduleVersionId);
+        std::cout << "Snapshot is current (module version " << moduleVersionId << ")" << std::endl;
+    });
+
+    // Query mode: the headers replace the window's data and responses fill in
+    // members. Neither is complete enough for the snapshot cache. The headers
+    // of a large assembly are parsed across the pool.
+    ipcClient->SetQueryCallbacks(
+        [&](std::string data) {
+            UnityReflection::AssemblyData headers;
+            if (!UnityReflection::ParseAssemblyDataParallel(data, headers, &UnityReflection::ThreadPool::Shared())) {
+                std::cerr << "Failed to parse type headers" << std::endl;
+                return;
+            }
+            std::cout << "Received type headers: " << headers.assemblyName << " (" << headers.types.size()
+                      << " types)" << std::endl;
+            snapshotId.clear(); // headers are not a snapshot deltas can apply to
+            moduleVersionId.clear();
+            ipcClient->SetSnapshotId(snapshotId);
+            mainWindow->SetQueryHeaders(std::move(headers));
+        },
+        [&](std::string data) {
+            UnityReflection::MemberResponse response;
+            if (!UnityReflection::ParseMemberResponse(data, response)) {
+                std::cerr << "Failed to parse member response" << std::endl;
+                return;
+            }
+            mainWindow->ApplyMembers(std::move(response));
+        });
+
     ipcClient->SetErrorCallback([](const std::string& error) {
         std::cerr << "IPC Error: " << error << std::endl;
     });
 
-    // Start listening for connections
+    // The listener connects by itself and reconnects whenever the game restarts
     std::cout << "Starting IPC listener..." << std::endl;
     std::cout << "Waiting for Unity to connect..." << std::endl;
+    mainWindow->SetIPCClient(ipcClient.get());
     ipcClient->StartListening();
 
     // Main loop
@@ -0,0 +1,141 @@
+#include "member_fetcher.h"
+#include "schema.h"
+#include "schema_codec.h"
+#include <utility>
+
+namespace UnityReflection {
+
+void MemberFetcher::SetSender(SendFunction send) {
+    send_ = std::move(send);
+}
+
+void MemberFetcher::Reset(size_t typeCount) {
+    Clear();
+    active_ = true;
+    states_.assign(typeCount, State::Missing);
+}
+
+void MemberFetcher::Clear() {
+    active_ = false;
+    states_.clear();
+    queue_.clear();
+    inFlight_.clear();
+    fetchedCount_ = 0;
+    retryAt_ = Clock::time_point();
+}
+
+void MemberFetcher::Request(size_t typeIndex) {
+    if (!active_ || typeIndex >= states_.size()) return;
+    const uint32_t index = static_cast<uint32_t>(typeIndex);
+
+    // Called every frame for the selection; a type already first in line
+    // is not queued again
+    if (states_[index] == State::Queued && !queue_.empty() && queue_.front() == index) return;
+    if (states_[index] == State::Missing || states_[index] == State::Queued) Enqueue(index, true);
+}
+
+void MemberFetcher::Prefetch(const std::vector<uint32_t>& order, size_t position) {
+    if (!active_ || position >= order.size()) return;
+    Enqueue(order[position], false);
+    for (size_t distance = 1; distance <= PREFETCH_RADIUS; distance++) {
+        if (position + distance < order.size()) Enqueue(order[position + distance], false);
+        if (position >= distance) Enqueue(order[position - distance], false);
+    }
+}
+
+void MemberFetcher::Enqueue(uint32_t typeIndex, bool front) {
+    if (typeIndex >= states_.size()) return;
+    State& state = states_[typeIndex];
+    if (state == State::InFlight || state == State::Fetched) return;
+    if (state == State::Queued && !front) return;
+    state = State::Queued;
+    if (front) {
+        queue_.push_front(typeIndex);
+    } else {
+        queue_.push_back(typeIndex);
+    }
+}
+
+void MemberFetcher::Flush(Clock::time_point now) {
+    if (!active_) return;
+
+    // A request the mod never answered (it restarted, or dropped it) is sent again
+    const auto timeout = std::chrono::milliseconds(REQUEST_TIMEOUT_MS);
+    for (auto it = inFlight_.begin(); it != inFlight_.end();) {
+        if (now - it->second.sentAt < timeout) {
+            ++it;
+            continue;
+        }
+        for (uint32_t index : it->second.types) {
+            states_[index] = State::Missing;
+            Enqueue(index, false);
+        }
+        it = inFlight_.erase(it);
+    }
+
+    if (now < retryAt_) return;
+    while (!queue_.empty() && inFlight_.size() < MAX_IN_FLIGHT) {
+        MemberRequest request;
+        request.requestId = nextRequestId_++;
+        while (!queue_.empty() && request.types.size() < MAX_BATCH) {
+            const uint32_t index = queue_.front();
+            queue_.pop_front();
+            if (states_[index] != State::Queued) continue; // stale entry
+            states_[index] = State::InFlight;
+            request.types.push_back({index});
+        }
+        if (request.types.empty()) break;
+
+        payload_.clear();
+        EncodeJson(request, payload_);
+        if (!send_ || !send_(payload_)) {
+            // Back to the front in the same order, and try again shortly
+            for (size_t i = request.types.size(); i-- > 0;) {
+                states_[request.types[i].index] = State::Queued;
+                queue_.push_front(request.types[i].index);
+            }
+            retryAt_ = now + std::chrono::milliseconds(SEND_RETRY_MS);
+            return;
+        }
+
+        InFlight& entry = inFlight_[request.requestId];
+        entry.sentAt = now;
+        entry.types.reserve(request.types.size());
+        for (const TypeIndex& type : request.types) entry.types.push_back(type.index);
+    }
+}
+
+void MemberFetcher::Apply(MemberResponse& response, AssemblyData& data, std::vector<uint32_t>& fetched) {
+    auto it = inFlight_.find(response.requestId);
+    if (!active_ || it == inFlight_.end()) return;
+    const InFlight entry = std::move(it->second);
+    inFlight_.erase(it);
+
+    remap_.resize(response.symbols.Size());
+    for (SymbolId id = 0; id < remap_.size(); id++) {
+        remap_[id] = data.symbols.Intern(response.symbols.Name(id));
+    }
+
+    for (size_t i = 0; i < entry.types.size(); i++) {
+        const uint32_t index = entry.types[i];
+        if (index >= data.types.size() || states_[index] != State::InFlight) continue;
+        if (i >= response.types.size()) {
+            states_[index] = State::Missing; // cut short; asked for again when next needed
+            continue;
+        }
+
+        states_[index] = State::Fetched;
+        fetchedCount_++;
+        TypeInfo& answer = response.types[i];
+        TypeInfo& type = data.types[index];
+        if (answer.fullName != type.fullName) continue;
+
+        RemapSymbols(answer, remap_);
+        type.fields = std::move(answer.fields);
+        type.methods = std::move(answer.methods);
+        type.properties = std::move(answer.properties);
+        fetched.push_back(index);
+    }
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "reflection_data.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace UnityReflection {
+
+// Query mode, viewer side. The mod sends only type headers; this tracks which
+// types' members have been fetched since, batches the types the UI asks for
+// into MemberRequest messages and matches the responses to them. Fetched
+// members go into the AssemblyData itself, which is the cache: a type is asked
+// for once per set of headers unless its request times out.
+//
+// Not thread safe; the render thread owns it.
+class MemberFetcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Sends one MemberRequest payload; false if it could not be sent
+    using SendFunction = std::function<bool(const std::string& payload)>;
+
+    static constexpr size_t MAX_BATCH = 64;      // types per request
+    static constexpr size_t MAX_IN_FLIGHT = 4;   // requests awaiting a response
+    static constexpr size_t PREFETCH_RADIUS = 8; // neighbours fetched on each side
+    static constexpr int REQUEST_TIMEOUT_MS = 3000;
+    static constexpr int SEND_RETRY_MS = 250;
+
+    void SetSender(SendFunction send);
+
+    // New headers with typeCount types, none fetched. Requests in flight are
+    // forgotten and their responses ignored.
+    void Reset(size_t typeCount);
+
+    // Leaves query mode; the data no longer comes from headers
+    void Clear();
+
+    bool IsActive() const { return active_; }
+
+    // True outside query mode, where every type comes with its members
+    bool IsFetched(size_t typeIndex) const {
+        return !active_ || typeIndex >= states_.size() || states_[typeIndex] == State::Fetched;
+    }
+
+    // Queues typeIndex ahead of everything else unless it is fetched or on its way
+    void Request(size_t typeIndex);
+
+    // Queues order[position] and the types around it behind explicit requests,
+    // nearest first. order is the type list as shown (indices into the data's types).
+    void Prefetch(const std::vector<uint32_t>& order, size_t position);
+
+    // Sends queued types in batches, up to MAX_IN_FLIGHT requests at a time, and
+    // queues again the types of requests that timed out. Call once per frame.
+    void Flush(Clock::time_point now);
+
+    // Moves the members of the answered types into data.types, interning their
+    // type names into data.symbols, and appends the indices filled to fetched.
+    // A response to a request that is not in flight is ignored; a type whose
+    // full name does not match its header is left without members.
+    void Apply(MemberResponse& response, AssemblyData& data, std::vector<uint32_t>& fetched);
+
+    size_t FetchedCount() const { return fetchedCount_; }
+    size_t InFlightCount() const { return inFlight_.size(); }
+
+private:
+    enum class State : uint8_t {
+        Missing,
+        Queued,
+        InFlight,
+        Fetched
+    };
+
+    struct InFlight {
+        std::vector<uint32_t> types;
+        Clock::time_point sentAt;
+    };
+
+    void Enqueue(uint32_t typeIndex, bool front);
+
+    SendFunction send_;
+    bool active_ = false;
+    std::vector<State> states_;
+    std::deque<uint32_t> queue_; // may hold stale entries; only Queued types are sent
+    std::unordered_map<uint32_t, InFlight> inFlight_;
+    uint32_t nextRequestId_ = 1;
+    size_t fetchedCount_ = 0;
+    Clock::time_point retryAt_;
+    std::string payload_;          // scratch for Flush
+    std::vector<SymbolId> remap_;  // scratch for Apply
+};
+
+} // namespace UnityReflection
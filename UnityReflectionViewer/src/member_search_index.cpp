@@ -0,0 +1,219 @@
+#include "member_search_index.h"
+#include <algorithm>
+
+namespace UnityReflection {
+
+namespace {
+
+char FoldChar(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool IsWordChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Rank of a string that contains query at pos: 0 whole, 1 at a word start
+// ('.', '<', ',' and the like before it), 2 inside a word
+uint32_t MatchRank(std::string_view folded, std::string_view query, size_t pos) {
+    if (folded.size() == query.size()) return 0;
+    for (; pos != std::string_view::npos; pos = folded.find(query, pos + 1)) {
+        if (pos == 0 || !IsWordChar(folded[pos - 1])) return 1;
+    }
+    return 2;
+}
+
+constexpr uint32_t RANK_COUNT = 3;
+constexpr uint32_t LENGTH_BUCKETS = 64; // strings this long or longer rank alike
+
+} // namespace
+
+MemberSearchIndex::Source MemberSearchIndex::Capture(const MemberStore& members, const SymbolTable& typeNames) {
+    Source source;
+    for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) {
+        const MemberColumns& columns = members.Columns(static_cast<MemberKind>(k));
+        source.names[k] = columns.name;
+        source.types[k] = columns.type;
+    }
+    source.memberNames = members.names;
+    source.typeNames = typeNames;
+    return source;
+}
+
+void MemberSearchIndex::Build(const Source& source) {
+    names_.Build(source.memberNames, source.names);
+    types_.Build(source.typeNames, source.types);
+}
+
+void MemberSearchIndex::Clear() {
+    names_.Clear();
+    types_.Clear();
+}
+
+void MemberSearchIndex::Search(std::string_view query, MemberSearchTarget target, uint8_t kinds, MatchMode mode,
+                               MemberSearchResult& result, ThreadPool* pool) const {
+    result.Clear();
+    result.target = target;
+    result.kinds = kinds;
+    result.mode = mode;
+
+    const Postings& postings = For(target);
+    if (query.empty() || query.find('\0') != std::string_view::npos || postings.offsets.size() < 2) return;
+    if (mode == MatchMode::Fuzzy) {
+        SearchFuzzy(query, postings, result, pool);
+    } else {
+        SearchSubstring(query, postings, result);
+    }
+}
+
+void MemberSearchIndex::SearchSubstring(std::string_view query, const Postings& postings,
+                                        MemberSearchResult& result) {
+    const uint8_t kinds = result.kinds;
+    std::string folded(query.size(), '\0');
+    std::transform(query.begin(), query.end(), folded.begin(), FoldChar);
+
+    // One pass over all the strings, back to back; a match cannot span two as
+    // none holds a '\0'. Each string found is keyed by rank and length.
+    struct Match {
+        SymbolId id;
+        uint32_t key;
+        uint32_t count;
+    };
+    std::vector<Match> matches;
+    const std::string_view chars(postings.chars);
+    const std::vector<uint32_t>& offsets = postings.offsets;
+    SymbolId id = 0;
+    size_t pos = 0;
+    while ((pos = chars.find(folded, pos)) != std::string_view::npos) {
+        while (offsets[id + 1] <= pos) id++;
+        const uint32_t count = postings.Count(id, kinds);
+        if (count > 0) {
+            const std::string_view string = chars.substr(offsets[id], offsets[id + 1] - offsets[id] - 1);
+            const uint32_t length = std::min<uint32_t>(static_cast<uint32_t>(string.size()), LENGTH_BUCKETS - 1);
+            matches.push_back({id, MatchRank(string, folded, pos - offsets[id]) * LENGTH_BUCKETS + length, count});
+        }
+        pos = offsets[id + 1]; // on to the next string
+    }
+
+    // Counting sort by key keeps ids ascending within a key
+    std::vector<uint32_t> keyStarts(RANK_COUNT * LENGTH_BUCKETS + 1, 0);
+    for (const Match& match : matches) keyStarts[match.key + 1]++;
+    for (size_t i = 1; i < keyStarts.size(); i++) keyStarts[i] += keyStarts[i - 1];
+    std::vector<Match> ranked(matches.size());
+    for (const Match& match : matches) ranked[keyStarts[match.key]++] = match;
+
+    result.matched = ranked.size();
+    result.ids.resize(ranked.size());
+    result.ends.resize(ranked.size());
+    uint64_t total = 0;
+    for (size_t i = 0; i < ranked.size(); i++) {
+        total += ranked[i].count;
+        result.ids[i] = ranked[i].id;
+        result.ends[i] = total;
+    }
+}
+
+void MemberSearchIndex::SearchFuzzy(std::string_view query, const Postings& postings, MemberSearchResult& result,
+                                    ThreadPool* pool) {
+    const uint8_t kinds = result.kinds;
+    const FuzzyMatcher matcher(query);
+    std::vector<FuzzyMatch> best;
+    result.matched = matcher.Rank(
+        postings.masks.data(), postings.masks.size(), [&](uint32_t id) { return postings.Count(id, kinds) > 0; },
+        [&](uint32_t id) { return postings.Cased(id); }, MAX_FUZZY_STRINGS, best, pool);
+
+    result.ids.resize(best.size());
+    result.ends.resize(best.size());
+    uint64_t total = 0;
+    for (size_t i = 0; i < best.size(); i++) {
+        total += postings.Count(best[i].index, kinds);
+        result.ids[i] = best[i].index;
+        result.ends[i] = total;
+    }
+}
+
+void MemberSearchIndex::Fetch(const MemberSearchResult& result, uint64_t first, size_t count,
+                              std::vector<MemberHit>& out) const {
+    out.clear();
+    const Postings& postings = For(result.target);
+    size_t i = static_cast<size_t>(std::upper_bound(result.ends.begin(), result.ends.end(), first) - result.ends.begin());
+    uint64_t skip = first - (i > 0 ? result.ends[i - 1] : 0);
+
+    for (; i < result.ids.size() && out.size() < count; i++) {
+        const size_t base = static_cast<size_t>(result.ids[i]) * MEMBER_KIND_COUNT;
+        for (size_t k = 0; k < MEMBER_KIND_COUNT && out.size() < count; k++) {
+            if (!(result.kinds & MemberKindBit(static_cast<MemberKind>(k)))) continue;
+            const uint32_t begin = postings.starts[base + k];
+            const uint32_t end = postings.starts[base + k + 1];
+            if (skip >= end - begin) {
+                skip -= end - begin;
+                continue;
+            }
+            for (uint32_t r = begin + static_cast<uint32_t>(skip); r < end && out.size() < count; r++) {
+                out.push_back({static_cast<MemberKind>(k), postings.rows[r]});
+            }
+            skip = 0;
+        }
+    }
+}
+
+size_t MemberSearchIndex::BytesUsed() const {
+    return names_.BytesUsed() + types_.BytesUsed();
+}
+
+void MemberSearchIndex::Postings::Build(const SymbolTable& strings,
+                                        const std::vector<SymbolId> (&columns)[MEMBER_KIND_COUNT]) {
+    const std::string_view source = strings.Chars();
+    cased.assign(source.data(), source.size());
+    chars.resize(source.size());
+    std::transform(source.begin(), source.end(), chars.begin(), FoldChar);
+    offsets = strings.Offsets();
+    masks.resize(strings.Size());
+    for (size_t i = 0; i < masks.size(); i++) {
+        masks[i] = CharMask(std::string_view(cased.data() + offsets[i], offsets[i + 1] - offsets[i] - 1));
+    }
+
+    // Counted, then placed: rows of one string and kind stay in row order
+    const size_t stringCount = strings.Size();
+    starts.assign(stringCount * MEMBER_KIND_COUNT + 1, 0);
+    for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) {
+        for (SymbolId id : columns[k]) {
+            if (id < stringCount) starts[id * MEMBER_KIND_COUNT + k + 1]++;
+        }
+    }
+    for (size_t i = 1; i < starts.size(); i++) starts[i] += starts[i - 1];
+
+    rows.resize(starts.back());
+    std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+    for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) {
+        for (size_t row = 0; row < columns[k].size(); row++) {
+            const SymbolId id = columns[k][row];
+            if (id < stringCount) rows[next[id * MEMBER_KIND_COUNT + k]++] = static_cast<uint32_t>(row);
+        }
+    }
+}
+
+void MemberSearchIndex::Postings::Clear() {
+    chars.clear();
+    cased.clear();
+    masks.clear();
+    offsets.clear();
+    starts.clear();
+    rows.clear();
+}
+
+size_t MemberSearchIndex::Postings::BytesUsed() const {
+    return chars.capacity() + cased.capacity() + masks.capacity() * sizeof(uint64_t) +
+           (offsets.capacity() + starts.capacity() + rows.capacity()) * sizeof(uint32_t);
+}
+
+uint32_t MemberSearchIndex::Postings::Count(SymbolId id, uint8_t kinds) const {
+    const size_t base = static_cast<size_t>(id) * MEMBER_KIND_COUNT;
+    uint32_t count = 0;
+    for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) {
+        if (kinds & MemberKindBit(static_cast<MemberKind>(k))) count += starts[base + k + 1] - starts[base + k];
+    }
+    return count;
+}
+
+} // namespace UnityReflection
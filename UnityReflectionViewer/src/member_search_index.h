@@ -0,0 +1,128 @@
+#pragma once
+
+#include "fuzzy_matcher.h"
+#include "member_store.h"
+#include "symbol_table.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UnityReflection {
+
+// Bit of a MemberKind, for MemberSearchIndex::Search
+constexpr uint8_t MemberKindBit(MemberKind kind) {
+    return static_cast<uint8_t>(1u << static_cast<uint8_t>(kind));
+}
+
+constexpr uint8_t MEMBER_KIND_ALL = (1u << MEMBER_KIND_COUNT) - 1;
+
+// What a member search matches the query against
+enum class MemberSearchTarget : uint8_t {
+    Name, // the member's own name
+    Type  // its field, return, property or parameter type
+};
+
+// A member a search found: row of the MemberStore columns of its kind
+struct MemberHit {
+    MemberKind kind = MemberKind::Field;
+    uint32_t row = 0;
+};
+
+// The strings a search matched, best first, and how many members lie up to
+// each; the members themselves are read through MemberSearchIndex::Fetch
+struct MemberSearchResult {
+    std::vector<SymbolId> ids; // member names or type symbols
+    std::vector<uint64_t> ends;
+    size_t matched = 0; // strings that matched, more than ids holds when a fuzzy search was cut short
+    MemberSearchTarget target = MemberSearchTarget::Name;
+    uint8_t kinds = 0;
+    MatchMode mode = MatchMode::Substring;
+
+    uint64_t Total() const { return ends.empty() ? 0 : ends.back(); }
+
+    void Clear() {
+        ids.clear();
+        ends.clear();
+        matched = 0;
+    }
+};
+
+// Inverted index over the members of a MemberStore: for every member name and
+// every type symbol, the rows of the members that have it, by kind. A query is
+// matched against the distinct strings, of which there are far fewer than
+// members, and a result is a ranked list of strings; the members behind them
+// are read a page at a time, so a search costs the same whether it finds ten
+// members or a million.
+//
+// The index is built on a worker thread from a Source copied off the store and
+// describes the store as it was then: rows the store gained since are missing
+// and rows it left behind are still listed, which MemberStore::OwnerType tells.
+class MemberSearchIndex {
+public:
+    static constexpr size_t MAX_FUZZY_STRINGS = 1000; // a fuzzy search keeps the best this many
+
+    // What the build reads, copied so the store can change meanwhile
+    struct Source {
+        std::vector<SymbolId> names[MEMBER_KIND_COUNT]; // by row, ids in memberNames
+        std::vector<SymbolId> types[MEMBER_KIND_COUNT]; // by row, ids in typeNames
+        SymbolTable memberNames;
+        SymbolTable typeNames;
+    };
+
+    static Source Capture(const MemberStore& members, const SymbolTable& typeNames);
+
+    void Build(const Source& source);
+    void Clear();
+
+    size_t MemberCount() const { return names_.rows.size(); }
+
+    // Replaces result with the strings of target that match query, ignoring
+    // case, that have members of the kinds in kinds (MemberKindBit).
+    // Substring: all that contain query. Ranked: whole matches, then those
+    // where query starts a word, then the rest; shorter strings first within
+    // each. Fuzzy: the MAX_FUZZY_STRINGS best by FuzzyMatcher, ranked on pool
+    // when one is given.
+    void Search(std::string_view query, MemberSearchTarget target, uint8_t kinds, MatchMode mode,
+                MemberSearchResult& result, ThreadPool* pool) const;
+
+    // Replaces out with members [first, first + count) of result, in rank order
+    void Fetch(const MemberSearchResult& result, uint64_t first, size_t count, std::vector<MemberHit>& out) const;
+
+    size_t BytesUsed() const;
+
+private:
+    // One target's strings and, per string and kind, the rows that have it
+    struct Postings {
+        std::string chars;             // folded strings, each followed by '\0'
+        std::string cased;             // the same strings as written, for fuzzy scoring
+        std::vector<uint64_t> masks;   // CharMask of string i
+        std::vector<uint32_t> offsets; // string i is [offsets[i], offsets[i + 1] - 1), as in SymbolTable
+        std::vector<uint32_t> starts;  // rows of string i, kind k from starts[i * MEMBER_KIND_COUNT + k]
+        std::vector<uint32_t> rows;
+
+        void Build(const SymbolTable& strings, const std::vector<SymbolId> (&columns)[MEMBER_KIND_COUNT]);
+        void Clear();
+        size_t BytesUsed() const;
+
+        uint32_t Count(SymbolId id, uint8_t kinds) const;
+
+        std::string_view Cased(SymbolId id) const {
+            return std::string_view(cased.data() + offsets[id], offsets[id + 1] - offsets[id] - 1);
+        }
+    };
+
+    static void SearchSubstring(std::string_view query, const Postings& postings, MemberSearchResult& result);
+    static void SearchFuzzy(std::string_view query, const Postings& postings, MemberSearchResult& result,
+                            ThreadPool* pool);
+
+    const Postings& For(MemberSearchTarget target) const {
+        return target == MemberSearchTarget::Name ? names_ : types_;
+    }
+
+    Postings names_;
+    Postings types_;
+};
+
+} // namespace UnityReflection
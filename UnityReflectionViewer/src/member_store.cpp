@@ -0,0 +1,161 @@
+#include "member_store.h"
+
+namespace UnityReflection {
+
+namespace {
+
+size_t ColumnBytes(const MemberColumns& columns) {
+    return columns.owner.capacity() * sizeof(uint32_t) + columns.name.capacity() * sizeof(SymbolId) +
+           columns.type.capacity() * sizeof(SymbolId) + columns.flags.capacity();
+}
+
+} // namespace
+
+void MemberStore::Clear() {
+    fields.Clear();
+    methods.Clear();
+    properties.Clear();
+    parameters.Clear();
+    typeFields.clear();
+    typeMethods.clear();
+    typeProperties.clear();
+    methodParameters.clear();
+    names.Clear();
+}
+
+void MemberStore::AppendTypes(const AssemblyData& data, size_t firstType) {
+    const size_t count = data.types.size();
+    typeFields.resize(count);
+    typeMethods.resize(count);
+    typeProperties.resize(count);
+    for (size_t t = firstType; t < count; t++) {
+        AddMembers(data, t);
+    }
+}
+
+void MemberStore::UpdateType(const AssemblyData& data, size_t typeIndex) {
+    if (typeIndex < typeFields.size()) AddMembers(data, typeIndex);
+}
+
+void MemberStore::RemoveType(size_t typeIndex, size_t movedFrom) {
+    if (movedFrom >= typeFields.size() || typeIndex > movedFrom) return;
+
+    if (typeIndex != movedFrom) {
+        const uint32_t owner = static_cast<uint32_t>(typeIndex);
+        typeFields[typeIndex] = typeFields[movedFrom];
+        typeMethods[typeIndex] = typeMethods[movedFrom];
+        typeProperties[typeIndex] = typeProperties[movedFrom];
+        for (uint32_t i = typeFields[typeIndex].begin; i < typeFields[typeIndex].end; i++) fields.owner[i] = owner;
+        for (uint32_t i = typeMethods[typeIndex].begin; i < typeMethods[typeIndex].end; i++) methods.owner[i] = owner;
+        for (uint32_t i = typeProperties[typeIndex].begin; i < typeProperties[typeIndex].end; i++) {
+            properties.owner[i] = owner;
+        }
+    }
+
+    typeFields.pop_back();
+    typeMethods.pop_back();
+    typeProperties.pop_back();
+}
+
+void MemberStore::AddMembers(const AssemblyData& data, size_t typeIndex) {
+    const TypeInfo& type = data.types[typeIndex];
+    const uint32_t owner = static_cast<uint32_t>(typeIndex);
+
+    MemberRange range;
+    range.begin = static_cast<uint32_t>(fields.Size());
+    for (const FieldInfo& field : type.fields) {
+        fields.Append(owner, names.Intern(field.name), field.fieldType,
+                      (field.isPublic ? MEMBER_PUBLIC : 0) | (field.isStatic ? MEMBER_STATIC : 0) |
+                          (field.isReadOnly ? MEMBER_READ_ONLY : 0));
+    }
+    range.end = static_cast<uint32_t>(fields.Size());
+    typeFields[typeIndex] = range;
+
+    range.begin = static_cast<uint32_t>(methods.Size());
+    for (const MethodInfo& method : type.methods) {
+        const uint32_t methodIndex = static_cast<uint32_t>(methods.Size());
+        methods.Append(owner, names.Intern(method.name), method.returnType,
+                       (method.isPublic ? MEMBER_PUBLIC : 0) | (method.isStatic ? MEMBER_STATIC : 0));
+
+        MemberRange params;
+        params.begin = static_cast<uint32_t>(parameters.Size());
+        for (const ParameterInfo& param : method.parameters) {
+            parameters.Append(methodIndex, names.Intern(param.name), param.parameterType, 0);
+        }
+        params.end = static_cast<uint32_t>(parameters.Size());
+        methodParameters.push_back(params);
+    }
+    range.end = static_cast<uint32_t>(methods.Size());
+    typeMethods[typeIndex] = range;
+
+    range.begin = static_cast<uint32_t>(properties.Size());
+    for (const PropertyInfo& prop : type.properties) {
+        properties.Append(owner, names.Intern(prop.name), prop.propertyType,
+                          (prop.canRead ? MEMBER_CAN_READ : 0) | (prop.canWrite ? MEMBER_CAN_WRITE : 0));
+    }
+    range.end = static_cast<uint32_t>(properties.Size());
+    typeProperties[typeIndex] = range;
+}
+
+void MemberStore::Select(const MemberColumns& columns, MemberRange range, uint8_t requiredFlags, SymbolId typeId,
+                         std::vector<uint32_t>& out) {
+    const uint8_t* flags = columns.flags.data();
+    const SymbolId* types = columns.type.data();
+
+    // Branch-free compaction: every index is written and kept only if it
+    // matches, so the loop has no data-dependent branches
+    size_t count = out.size();
+    out.resize(count + range.Size());
+    uint32_t* result = out.data();
+
+    if (typeId == SymbolTable::NOT_FOUND) {
+        for (uint32_t i = range.begin; i < range.end; i++) {
+            result[count] = i;
+            count += (flags[i] & requiredFlags) == requiredFlags;
+        }
+    } else {
+        for (uint32_t i = range.begin; i < range.end; i++) {
+            result[count] = i;
+            count += ((flags[i] & requiredFlags) == requiredFlags) & (types[i] == typeId);
+        }
+    }
+
+    out.resize(count);
+}
+
+const MemberColumns& MemberStore::Columns(MemberKind kind) const {
+    switch (kind) {
+        case MemberKind::Field: return fields;
+        case MemberKind::Method: return methods;
+        case MemberKind::Property: return properties;
+        case MemberKind::Parameter: break;
+    }
+    return parameters;
+}
+
+uint32_t MemberStore::OwnerType(MemberKind kind, uint32_t row) const {
+    auto contains = [](MemberRange range, uint32_t i) { return i >= range.begin && i < range.end; };
+    if (row >= Columns(kind).Size()) return NO_OWNER;
+
+    if (kind == MemberKind::Parameter) {
+        const uint32_t method = parameters.owner[row];
+        if (!contains(methodParameters[method], row)) return NO_OWNER;
+        return OwnerType(MemberKind::Method, method);
+    }
+
+    const uint32_t owner = Columns(kind).owner[row];
+    if (owner >= typeFields.size()) return NO_OWNER;
+    const MemberRange range = kind == MemberKind::Field    ? typeFields[owner]
+                              : kind == MemberKind::Method ? typeMethods[owner]
+                                                           : typeProperties[owner];
+    return contains(range, row) ? owner : NO_OWNER;
+}
+
+size_t MemberStore::BytesUsed() const {
+    return ColumnBytes(fields) + ColumnBytes(methods) + ColumnBytes(properties) + ColumnBytes(parameters) +
+           (typeFields.capacity() + typeMethods.capacity() + typeProperties.capacity() + methodParameters.capacity()) *
+               sizeof(MemberRange) +
+           names.BytesUsed();
+}
+
+} // namespace UnityReflection
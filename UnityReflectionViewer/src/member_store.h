@@ -0,0 +1,123 @@
+#pragma once
+
+#include "reflection_data.h"
+#include <cstdint>
+#include <vector>
+
+namespace UnityReflection {
+
+// Bits of MemberColumns::flags
+constexpr uint8_t MEMBER_PUBLIC = 1u << 0;
+constexpr uint8_t MEMBER_STATIC = 1u << 1;
+constexpr uint8_t MEMBER_READ_ONLY = 1u << 2;
+constexpr uint8_t MEMBER_CAN_READ = 1u << 3;
+constexpr uint8_t MEMBER_CAN_WRITE = 1u << 4;
+
+// The four column sets of a MemberStore
+enum class MemberKind : uint8_t {
+    Field,
+    Method,
+    Property,
+    Parameter
+};
+
+constexpr size_t MEMBER_KIND_COUNT = 4;
+
+// Half-open index range into one of the member column sets
+struct MemberRange {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+
+    uint32_t Size() const { return end - begin; }
+};
+
+// One kind of member stored column by column. Row i of every vector describes
+// the same member; owner is the type index (the method index for parameters),
+// name is an id in MemberStore::names and type an id in AssemblyData::symbols.
+struct MemberColumns {
+    std::vector<uint32_t> owner;
+    std::vector<SymbolId> name;
+    std::vector<SymbolId> type;
+    std::vector<uint8_t> flags;
+
+    size_t Size() const { return owner.size(); }
+
+    void Append(uint32_t ownerIndex, SymbolId nameId, SymbolId typeId, uint8_t flagBits) {
+        owner.push_back(ownerIndex);
+        name.push_back(nameId);
+        type.push_back(typeId);
+        flags.push_back(flagBits);
+    }
+
+    void Clear() {
+        owner.clear();
+        name.clear();
+        type.clear();
+        flags.clear();
+    }
+};
+
+// Structure-of-arrays copy of every member in an AssemblyData. Members of one
+// type are contiguous, so per-type lists are ranges and whole-snapshot queries
+// are linear scans over a few narrow columns.
+class MemberStore {
+public:
+    void Clear();
+
+    void Build(const AssemblyData& data) {
+        Clear();
+        AppendTypes(data, 0);
+    }
+
+    // Adds data.types[firstType..], which must directly follow the types added so far
+    void AppendTypes(const AssemblyData& data, size_t firstType);
+
+    // Re-adds the members of a type already in the store whose member lists have
+    // changed (filled in by LazyAssembly). Its rows go to the end of the columns;
+    // the old rows stay behind unreferenced.
+    void UpdateType(const AssemblyData& data, size_t typeIndex);
+
+    // Follows a swap-and-pop removal from AssemblyData::types: the ranges of
+    // type movedFrom (the last one) replace those of typeIndex and its rows are
+    // given the new owner. The removed type's rows stay behind unreferenced.
+    void RemoveType(size_t typeIndex, size_t movedFrom);
+
+    // Appends to out the indices in range whose flags have all bits of
+    // requiredFlags set and whose type is typeId (any type for NOT_FOUND)
+    static void Select(const MemberColumns& columns, MemberRange range, uint8_t requiredFlags, SymbolId typeId,
+                       std::vector<uint32_t>& out);
+
+    const MemberColumns& Columns(MemberKind kind) const;
+
+    // The type that row of kind's columns currently belongs to, or NO_OWNER if
+    // the row was left behind by UpdateType or RemoveType. A parameter belongs
+    // to the type of its method.
+    uint32_t OwnerType(MemberKind kind, uint32_t row) const;
+
+    static constexpr uint32_t NO_OWNER = UINT32_MAX;
+
+    static MemberRange All(const MemberColumns& columns) {
+        return {0, static_cast<uint32_t>(columns.Size())};
+    }
+
+    size_t TypeCount() const { return typeFields.size(); }
+    size_t BytesUsed() const;
+
+    MemberColumns fields;
+    MemberColumns methods;    // type is the return type
+    MemberColumns properties;
+    MemberColumns parameters; // owner is the method index
+
+    std::vector<MemberRange> typeFields;
+    std::vector<MemberRange> typeMethods;
+    std::vector<MemberRange> typeProperties;
+    std::vector<MemberRange> methodParameters;
+
+    SymbolTable names;
+
+private:
+    // Appends the members of data.types[typeIndex] and points its ranges at them
+    void AddMembers(const AssemblyData& data, size_t typeIndex);
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,162 @@
+#include "member_table.h"
+#include <algorithm>
+#include <iterator>
+
+namespace UnityReflection {
+
+namespace {
+
+char FoldChar(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Flag columns of each kind, as the details pane shows them
+constexpr uint8_t FIELD_FLAGS[] = {MEMBER_PUBLIC, MEMBER_STATIC, MEMBER_READ_ONLY};
+constexpr uint8_t METHOD_FLAGS[] = {MEMBER_PUBLIC, MEMBER_STATIC};
+constexpr uint8_t PROPERTY_FLAGS[] = {MEMBER_CAN_READ, MEMBER_CAN_WRITE};
+
+} // namespace
+
+void MemberTable::Build(const MemberStore& members, const SymbolTable& symbols, MemberKind kind, MemberRange range,
+                        uint64_t generation) {
+    Clear();
+    kind_ = kind;
+    range_ = range;
+    generation_ = generation;
+    built_ = true;
+
+    const uint8_t* flags = nullptr;
+    switch (kind) {
+        case MemberKind::Field: flags = FIELD_FLAGS; flagCount_ = std::size(FIELD_FLAGS); break;
+        case MemberKind::Method: flags = METHOD_FLAGS; flagCount_ = std::size(METHOD_FLAGS); break;
+        case MemberKind::Property: flags = PROPERTY_FLAGS; flagCount_ = std::size(PROPERTY_FLAGS); break;
+        case MemberKind::Parameter: break;
+    }
+    std::copy(flags, flags + flagCount_, flagColumns_);
+    orders_.resize(static_cast<size_t>(ColumnCount()));
+
+    const MemberColumns& columns = members.Columns(kind);
+    rows_.reserve(range.Size());
+    std::string signature;
+    for (uint32_t i = range.begin; i < range.end; i++) {
+        const std::string_view name = members.names.Name(columns.name[i]);
+        std::string_view text = symbols.Name(columns.type[i]);
+        if (kind == MemberKind::Method) {
+            // Return type, name and parameters, as C# declares them
+            signature.assign(text);
+            signature += ' ';
+            signature += name;
+            signature += '(';
+            const MemberRange params = members.methodParameters[i];
+            for (uint32_t p = params.begin; p < params.end; p++) {
+                if (p > params.begin) signature += ", ";
+                signature += symbols.Name(members.parameters.type[p]);
+                signature += ' ';
+                signature += members.names.Name(members.parameters.name[p]);
+            }
+            signature += ')';
+            text = signature;
+        }
+
+        Row row;
+        row.name = AddString(name, false);
+        row.text = AddString(text, false);
+        row.foldedName = AddString(name, true);
+        row.foldedText = AddString(text, true);
+        row.nameLength = static_cast<uint32_t>(name.size());
+        row.textLength = static_cast<uint32_t>(text.size());
+        row.flags = columns.flags[i];
+        rows_.push_back(row);
+    }
+}
+
+void MemberTable::Clear() {
+    chars_.clear();
+    rows_.clear();
+    orders_.clear();
+    flagCount_ = 0;
+    built_ = false;
+    viewValid_ = false;
+}
+
+const std::vector<uint32_t>& MemberTable::View(std::string_view query, uint8_t requiredFlags, int column,
+                                               bool descending) {
+    folded_.resize(query.size());
+    std::transform(query.begin(), query.end(), folded_.begin(), FoldChar);
+    if (column < NO_SORT || column >= ColumnCount()) column = NO_SORT;
+    if (column == NO_SORT) descending = false;
+    if (viewValid_ && folded_ == viewQuery_ && requiredFlags == viewFlags_ && column == viewColumn_ &&
+        descending == viewDescending_) {
+        return view_;
+    }
+
+    view_.clear();
+    auto keep = [&](uint32_t row) {
+        const Row& r = rows_[row];
+        if ((r.flags & requiredFlags) != requiredFlags) return;
+        if (!folded_.empty() && FoldedName(r).find(folded_) == std::string_view::npos &&
+            FoldedText(r).find(folded_) == std::string_view::npos) {
+            return;
+        }
+        view_.push_back(row);
+    };
+    if (column == NO_SORT) {
+        for (uint32_t row = 0; row < rows_.size(); row++) keep(row);
+    } else {
+        const std::vector<uint32_t>& order = Order(column);
+        if (descending) {
+            std::for_each(order.rbegin(), order.rend(), keep);
+        } else {
+            std::for_each(order.begin(), order.end(), keep);
+        }
+    }
+
+    viewQuery_ = folded_;
+    viewFlags_ = requiredFlags;
+    viewColumn_ = column;
+    viewDescending_ = descending;
+    viewValid_ = true;
+    return view_;
+}
+
+size_t MemberTable::BytesUsed() const {
+    size_t bytes = chars_.capacity() + rows_.capacity() * sizeof(Row) + view_.capacity() * sizeof(uint32_t);
+    for (const auto& order : orders_) bytes += order.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+uint32_t MemberTable::AddString(std::string_view text, bool fold) {
+    const uint32_t offset = static_cast<uint32_t>(chars_.size());
+    chars_ += text;
+    if (fold) std::transform(chars_.begin() + offset, chars_.end(), chars_.begin() + offset, FoldChar);
+    chars_ += '\0';
+    return offset;
+}
+
+const std::vector<uint32_t>& MemberTable::Order(int column) {
+    std::vector<uint32_t>& order = orders_[static_cast<size_t>(column)];
+    if (!order.empty() || rows_.empty()) return order;
+
+    order.resize(rows_.size());
+    for (uint32_t row = 0; row < rows_.size(); row++) order[row] = row;
+    auto byName = [this](uint32_t a, uint32_t b) { return FoldedName(rows_[a]) < FoldedName(rows_[b]); };
+    if (column == COLUMN_NAME) {
+        std::stable_sort(order.begin(), order.end(), byName);
+    } else if (column == COLUMN_TEXT) {
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const int c = FoldedText(rows_[a]).compare(FoldedText(rows_[b]));
+            return c != 0 ? c < 0 : byName(a, b);
+        });
+    } else {
+        // "No" before "Yes", as the column reads
+        const uint8_t flag = ColumnFlag(column);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const bool hasA = (rows_[a].flags & flag) != 0;
+            const bool hasB = (rows_[b].flags & flag) != 0;
+            return hasA != hasB ? hasB : byName(a, b);
+        });
+    }
+    return order;
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "member_store.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UnityReflection {
+
+// One member table of the details pane, the fields, methods or properties of
+// a type, formatted once when the type is shown: each row's name and type (a
+// method's whole signature) as text, and lowercased copies to sort and filter
+// by. A column's sort order is worked out the first time it is sorted on and
+// kept, so sorting and filtering a type with thousands of members does not
+// build a string, and drawing reads the text as it is.
+class MemberTable {
+public:
+    // Columns: the name, the type or signature, then one per flag of the kind
+    // (ColumnFlag)
+    static constexpr int COLUMN_NAME = 0;
+    static constexpr int COLUMN_TEXT = 1;
+    static constexpr int NO_SORT = -1; // declaration order
+
+    // Whether the table holds these rows of members_ as of generation, so it
+    // need not be built again
+    bool Shows(MemberKind kind, MemberRange range, uint64_t generation) const {
+        return built_ && kind == kind_ && range.begin == range_.begin && range.end == range_.end &&
+               generation == generation_;
+    }
+
+    // The rows in range of kind's columns (fields, methods or properties);
+    // names are read from members.names and types from symbols
+    void Build(const MemberStore& members, const SymbolTable& symbols, MemberKind kind, MemberRange range,
+               uint64_t generation);
+    void Clear();
+
+    size_t RowCount() const { return rows_.size(); }
+    int ColumnCount() const { return COLUMN_TEXT + 1 + static_cast<int>(flagCount_); }
+
+    // Flag bit a column from COLUMN_TEXT + 1 on shows
+    uint8_t ColumnFlag(int column) const { return flagColumns_[column - COLUMN_TEXT - 1]; }
+
+    // The rows to show, in order: those with every flag in requiredFlags whose
+    // name or text contains query, ignoring case, sorted by column (NO_SORT
+    // for declaration order). Worked out again only when an argument changes.
+    const std::vector<uint32_t>& View(std::string_view query, uint8_t requiredFlags, int column, bool descending);
+
+    const char* Name(uint32_t row) const { return chars_.data() + rows_[row].name; }
+    const char* Text(uint32_t row) const { return chars_.data() + rows_[row].text; }
+    uint8_t Flags(uint32_t row) const { return rows_[row].flags; }
+
+    size_t BytesUsed() const;
+
+private:
+    static constexpr size_t MAX_FLAG_COLUMNS = 3;
+
+    // Offsets into chars_ of '\0'-terminated strings; the folded copies are
+    // as long as the originals
+    struct Row {
+        uint32_t name = 0;
+        uint32_t text = 0;
+        uint32_t foldedName = 0;
+        uint32_t foldedText = 0;
+        uint32_t nameLength = 0;
+        uint32_t textLength = 0;
+        uint8_t flags = 0;
+    };
+
+    uint32_t AddString(std::string_view text, bool fold);
+    std::string_view FoldedName(const Row& row) const {
+        return std::string_view(chars_.data() + row.foldedName, row.nameLength);
+    }
+    std::string_view FoldedText(const Row& row) const {
+        return std::string_view(chars_.data() + row.foldedText, row.textLength);
+    }
+
+    // Rows ascending by column; ties go by name, then declaration order
+    const std::vector<uint32_t>& Order(int column);
+
+    std::string chars_;
+    std::vector<Row> rows_;
+    std::vector<std::vector<uint32_t>> orders_; // by column, empty until sorted on
+    uint8_t flagColumns_[MAX_FLAG_COLUMNS] = {};
+    size_t flagCount_ = 0;
+
+    MemberKind kind_ = MemberKind::Field;
+    MemberRange range_;
+    uint64_t generation_ = 0;
+    bool built_ = false;
+
+    // What View last returned
+    std::vector<uint32_t> view_;
+    std::string viewQuery_; // folded
+    uint8_t viewFlags_ = 0;
+    int viewColumn_ = NO_SORT;
+    bool viewDescending_ = false;
+    bool viewValid_ = false;
+    std::string folded_; // scratch
+};
+
+} // namespace UnityReflection
@@ -1,392 +1,499 @@
 #include "reflection_data.h"
-#include <sstream>
+#include "json_cursor.h"
+#include "schema.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
 
 namespace UnityReflection {
 
-// Simple JSON parser (basic implementation, consider using a library like nlohmann/json for production)
-class SimpleJsonParser {
+// Two-stage JSON parser. Stage 1 (StructuralIndex) marks quotes, backslashes and
+// structural characters with SIMD; stage 2 is a recursive-descent pass on top of
+// JsonCursor whose object decoders are generated from the descriptors in schema.h.
+// Keys go through each struct's compile-time perfect hash and are compared without
+// allocating. Member type names are interned into the given symbol table.
+class JsonParser : public JsonCursor {
 public:
-    SimpleJsonParser(const std::string& json) : json_(json), pos_(0) {}
+    // With a pool, the "types" array is split between its threads
+    JsonParser(const char* data, size_t size, const StructuralIndex& index, SymbolTable& symbols,
+               ThreadPool* pool = nullptr, size_t pos = 0)
+        : JsonCursor(data, size, index, pos), symbols_(symbols), pool_(pool) {}
 
     bool ParseAssemblyData(AssemblyData& data) {
         SkipWhitespace();
-        if (!Expect('{')) return false;
-
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == '}') {
-                pos_++;
-                return true;
-            }
-
-            std::string key = ParseString();
-            SkipWhitespace();
-            if (!Expect(':')) return false;
-            SkipWhitespace();
-
-            if (key == "assemblyName") {
-                data.assemblyName = ParseString();
-            } else if (key == "timestamp") {
-                data.timestamp = ParseString();
-            } else if (key == "types") {
-                if (!ParseTypesArray(data.types)) return false;
-            } else {
-                SkipValue();
-            }
-
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
-        }
-
-        return true;
-    }
-
-private:
-    const std::string& json_;
-    size_t pos_;
-
-    char Peek() {
-        return pos_ < json_.size() ? json_[pos_] : '\0';
+        return ParseObject(data);
     }
 
-    bool Expect(char c) {
-        if (Peek() == c) {
-            pos_++;
-            return true;
-        }
-        return false;
+    bool ParseAssemblyDelta(AssemblyDelta& delta) {
+        SkipWhitespace();
+        return ParseObject(delta);
     }
 
-    void SkipWhitespace() {
-        while (pos_ < json_.size() && (json_[pos_] == ' ' || json_[pos_] == '\n' ||
-               json_[pos_] == '\r' || json_[pos_] == '\t')) {
-            pos_++;
-        }
+    // Small messages with no symbols of their own, or their own table
+    // (MemberRequest, MemberResponse, ReflectionProgress, SnapshotNotModified)
+    template <typename T>
+    bool ParseMessage(T& message) {
+        SkipWhitespace();
+        return ParseObject(message);
     }
 
-    std::string ParseString() {
-        if (!Expect('"')) return "";
-
-        std::string result;
-        while (pos_ < json_.size() && json_[pos_] != '"') {
-            if (json_[pos_] == '\\' && pos_ + 1 < json_.size()) {
-                pos_++;
-                switch (json_[pos_]) {
-                    case 'n': result += '\n'; break;
-                    case 'r': result += '\r'; break;
-                    case 't': result += '\t'; break;
-                    case '\\': result += '\\'; break;
-                    case '"': result += '"'; break;
-                    default: result += json_[pos_]; break;
-                }
-            } else {
-                result += json_[pos_];
-            }
-            pos_++;
-        }
-
-        Expect('"');
-        return result;
+    // A single element of the types array, for callers that split the array themselves
+    bool ParseSingleType(TypeInfo& type) {
+        return ParseObject(type);
     }
 
-    bool ParseBool() {
-        if (json_.compare(pos_, 4, "true") == 0) {
-            pos_ += 4;
-            return true;
-        } else if (json_.compare(pos_, 5, "false") == 0) {
-            pos_ += 5;
-            return false;
-        }
-        return false;
-    }
+    // True if an object or array ran into the end of the input before its
+    // closing bracket. Parsing accepts that, like the original parser did, but
+    // it means the result depends on where the input was cut.
+    bool RanOffEnd() const { return ranOffEnd_; }
 
-    void SkipValue() {
+    // Parses the top-level object but only skips over each type's member arrays,
+    // recording where they are
+    bool ParseAssemblyHeaders(AssemblyData& data, std::vector<TypeMemberSpans>& spans) {
+        typeSpans_ = &spans;
         SkipWhitespace();
-        char c = Peek();
-        if (c == '"') {
-            ParseString();
-        } else if (c == '{') {
-            SkipObject();
-        } else if (c == '[') {
-            SkipArray();
-        } else if (c == 't' || c == 'f') {
-            ParseBool();
-        } else {
-            while (pos_ < json_.size() && json_[pos_] != ',' && json_[pos_] != '}' && json_[pos_] != ']') {
-                pos_++;
-            }
-        }
+        const bool ok = ParseObject(data);
+        typeSpans_ = nullptr;
+        return ok;
     }
 
-    void SkipObject() {
-        if (!Expect('{')) return;
-        int depth = 1;
-        while (pos_ < json_.size() && depth > 0) {
-            if (json_[pos_] == '{') depth++;
-            else if (json_[pos_] == '}') depth--;
-            pos_++;
-        }
+    // One member array starting at the cursor
+    template <typename T>
+    bool ParseMemberArray(std::vector<T>& values) {
+        return ParseMembers(values);
     }
 
-    void SkipArray() {
-        if (!Expect('[')) return;
-        int depth = 1;
-        while (pos_ < json_.size() && depth > 0) {
-            if (json_[pos_] == '[') depth++;
-            else if (json_[pos_] == ']') depth--;
-            pos_++;
-        }
+private:
+    SymbolTable& symbols_;
+    ThreadPool* pool_;
+    std::string symbolScratch_;
+    std::vector<TypeMemberSpans>* typeSpans_ = nullptr; // set during ParseAssemblyHeaders
+    bool ranOffEnd_ = false;
+    // Arrays other than "types" are parsed here first, so each is allocated once
+    // at its final size
+    std::tuple<std::vector<FieldInfo>, std::vector<MethodInfo>, std::vector<PropertyInfo>,
+               std::vector<ParameterInfo>, std::vector<TypeIndex>, std::vector<TypeRef>> arrayScratch_;
+
+    static JsonSpan& SpanOf(TypeMemberSpans& spans, const std::vector<FieldInfo>&) { return spans.fields; }
+    static JsonSpan& SpanOf(TypeMemberSpans& spans, const std::vector<MethodInfo>&) { return spans.methods; }
+    static JsonSpan& SpanOf(TypeMemberSpans& spans, const std::vector<PropertyInfo>&) { return spans.properties; }
+
+    // Skips the array at the cursor without decoding it. Unlike SkipNested this
+    // ignores brackets inside strings, so on valid input it ends exactly where
+    // ParseArray would.
+    void SkipArray(JsonSpan& span) {
+        span.begin = pos_;
+        if (Peek() == '[') pos_ = index_.FindContainerEnd(data_, pos_);
+        span.end = pos_;
     }
 
-    bool ParseTypesArray(std::vector<TypeInfo>& types) {
-        if (!Expect('[')) return false;
-
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == ']') {
-                pos_++;
-                return true;
-            }
-
-            TypeInfo type;
-            if (!ParseTypeInfo(type)) return false;
-            types.push_back(std::move(type));
-
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
-        }
-
-        return true;
+    // Same leniency as ParseString: whatever was read before an error is kept.
+    // Interned straight from the input unless it has escapes.
+    void ParseSymbol(SymbolId& id) {
+        id = symbols_.Intern(ParseStringView(symbolScratch_));
     }
 
-    bool ParseTypeInfo(TypeInfo& type) {
+    // Decodes an object through Schema<T>; unknown keys are skipped
+    template <typename T>
+    bool ParseObject(T& object) {
         if (!Expect('{')) return false;
 
-        while (pos_ < json_.size()) {
+        while (pos_ < size_) {
             SkipWhitespace();
             if (Peek() == '}') {
                 pos_++;
                 return true;
             }
 
-            std::string key = ParseString();
+            std::string_view key = ParseKey();
             SkipWhitespace();
             if (!Expect(':')) return false;
             SkipWhitespace();
 
-            if (key == "name") type.name = ParseString();
-            else if (key == "fullName") type.fullName = ParseString();
-            else if (key == "namespace") type.namespaceName = ParseString();
-            else if (key == "baseType") type.baseType = ParseString();
-            else if (key == "isClass") type.isClass = ParseBool();
-            else if (key == "isStruct") type.isStruct = ParseBool();
-            else if (key == "isEnum") type.isEnum = ParseBool();
-            else if (key == "isInterface") type.isInterface = ParseBool();
-            else if (key == "fields") ParseFieldsArray(type.fields);
-            else if (key == "methods") ParseMethodsArray(type.methods);
-            else if (key == "properties") ParsePropertiesArray(type.properties);
-            else SkipValue();
+            bool ok = true;
+            if (!VisitField<T>(SchemaKeys<T>::Find(key), [&](const auto& field) { ok = ParseField(field, object); })) {
+                SkipValue();
+            }
+            if (!ok) return false;
 
             SkipWhitespace();
             if (Peek() == ',') pos_++;
         }
 
+        ranOffEnd_ = true;
         return true;
     }
 
-    bool ParseFieldsArray(std::vector<FieldInfo>& fields) {
+    template <typename Field>
+    bool ParseField(const Field& field, typename Field::OwnerType& object) {
+        auto& value = object.*field.member;
+        if constexpr (Field::KIND == FieldKind::String) {
+            ParseString(value);
+        } else if constexpr (Field::KIND == FieldKind::Symbol) {
+            ParseSymbol(value);
+        } else if constexpr (Field::KIND == FieldKind::Bool) {
+            value = ParseBool();
+        } else if constexpr (Field::KIND == FieldKind::UInt) {
+            value = ParseUInt();
+        } else if constexpr (std::is_same_v<typename Field::ValueType, std::vector<TypeInfo>>) {
+            return pool_ ? ParseTypesArrayParallel(value) : ParseArray(value);
+        } else {
+            if constexpr (std::is_same_v<typename Field::OwnerType, TypeInfo>) {
+                if (typeSpans_) {
+                    SkipArray(SpanOf(typeSpans_->back(), value));
+                    return true;
+                }
+            }
+            // Like the original parser, a broken member array only cuts that
+            // array short; only a broken "types" array fails the parse
+            ParseMembers(value);
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool ParseArray(std::vector<T>& values) {
         if (!Expect('[')) return false;
+        return ParseElements(values);
+    }
+
+    // An array other than "types"; none contains another of its own kind, so
+    // one scratch vector per kind is enough
+    template <typename T>
+    bool ParseMembers(std::vector<T>& values) {
+        std::vector<T>& scratch = std::get<std::vector<T>>(arrayScratch_);
+        scratch.clear();
+        const bool ok = ParseArray(scratch);
+        values.insert(values.end(), std::make_move_iterator(scratch.begin()), std::make_move_iterator(scratch.end()));
+        return ok;
+    }
 
-        while (pos_ < json_.size()) {
+    template <typename T>
+    bool ParseElements(std::vector<T>& values) {
+        while (pos_ < size_) {
             SkipWhitespace();
             if (Peek() == ']') {
                 pos_++;
                 return true;
             }
 
-            FieldInfo field;
-            if (!ParseFieldInfo(field)) return false;
-            fields.push_back(std::move(field));
+            // Parse in place; a failed element is dropped again
+            if constexpr (std::is_same_v<T, TypeInfo>) {
+                if (typeSpans_) typeSpans_->emplace_back();
+            }
+            if (!ParseObject(values.emplace_back())) {
+                values.pop_back();
+                if constexpr (std::is_same_v<T, TypeInfo>) {
+                    if (typeSpans_) typeSpans_->pop_back();
+                }
+                return false;
+            }
 
             SkipWhitespace();
             if (Peek() == ',') pos_++;
         }
+
+        ranOffEnd_ = true;
         return true;
     }
 
-    bool ParseFieldInfo(FieldInfo& field) {
-        if (!Expect('{')) return false;
-
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == '}') {
-                pos_++;
-                return true;
-            }
-
-            std::string key = ParseString();
-            SkipWhitespace();
-            if (!Expect(':')) return false;
+    // Runs the ParseElements loop until it is about to parse an element at
+    // stopAt. Returns false if the sequential loop would never start one there.
+    bool ParseTypesUntil(std::vector<TypeInfo>& types, size_t stopAt) {
+        while (pos_ < size_) {
             SkipWhitespace();
+            if (pos_ == stopAt) return true;
+            if (pos_ > stopAt || Peek() == ']') return false;
 
-            if (key == "name") field.name = ParseString();
-            else if (key == "fieldType") field.fieldType = ParseString();
-            else if (key == "isPublic") field.isPublic = ParseBool();
-            else if (key == "isStatic") field.isStatic = ParseBool();
-            else if (key == "isReadOnly") field.isReadOnly = ParseBool();
-            else SkipValue();
+            if (!ParseObject(types.emplace_back())) {
+                types.pop_back();
+                return false;
+            }
 
             SkipWhitespace();
             if (Peek() == ',') pos_++;
         }
-        return true;
+        return false;
     }
 
-    bool ParseMethodsArray(std::vector<MethodInfo>& methods) {
-        if (!Expect('[')) return false;
+    // Splits the array at element starts found by a string-aware bracket scan and
+    // parses the pieces on the pool. Every piece but the last must end exactly
+    // where the next begins, which proves the split matches what the sequential
+    // parser would do; otherwise the array is parsed again sequentially, so the
+    // result (including errors on malformed input) never differs.
+    bool ParseTypesArrayParallel(std::vector<TypeInfo>& types) {
+        const size_t arrayStart = pos_;
+        if (Peek() != '[') return ParseArray(types);
+
+        std::vector<size_t> splits = FindElementStarts(arrayStart + 1);
+        if (splits.empty()) return ParseArray(types);
+
+        // The first piece interns straight into symbols_; the others use their own
+        // tables and are renumbered when merged
+        struct Piece {
+            size_t begin;
+            size_t stopAt;
+            std::vector<TypeInfo> types;
+            SymbolTable symbols;
+            bool ok = false;
+            size_t end = 0;
+        };
+        std::vector<Piece> pieces(splits.size() + 1);
+        pieces[0].begin = arrayStart;
+        for (size_t i = 0; i < splits.size(); i++) {
+            pieces[i].stopAt = splits[i];
+            pieces[i + 1].begin = splits[i];
+        }
+        pieces.back().stopAt = size_;
+
+        pool_->ParallelFor(pieces.size(), [&](size_t i) {
+            Piece& piece = pieces[i];
+            JsonParser parser(data_, size_, index_, i == 0 ? symbols_ : piece.symbols, nullptr, piece.begin);
+            if (i == 0) parser.Expect('[');
+            piece.ok = i + 1 < pieces.size() ? parser.ParseTypesUntil(piece.types, piece.stopAt)
+                                            : parser.ParseElements(piece.types);
+            piece.end = parser.Position();
+        });
+
+        for (size_t i = 0; i + 1 < pieces.size(); i++) {
+            if (!pieces[i].ok) {
+                pos_ = arrayStart;
+                return ParseArray(types);
+            }
+        }
 
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == ']') {
-                pos_++;
-                return true;
+        size_t total = types.size();
+        for (const Piece& piece : pieces) total += piece.types.size();
+        types.reserve(total);
+        std::vector<SymbolId> remap;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            Piece& piece = pieces[i];
+            if (i > 0) {
+                remap.resize(piece.symbols.Size());
+                for (SymbolId id = 0; id < remap.size(); id++) {
+                    remap[id] = symbols_.Intern(piece.symbols.Name(id));
+                }
+                for (TypeInfo& type : piece.types) RemapSymbols(type, remap);
             }
+            std::move(piece.types.begin(), piece.types.end(), std::back_inserter(types));
+        }
 
-            MethodInfo method;
-            if (!ParseMethodInfo(method)) return false;
-            methods.push_back(std::move(method));
+        pos_ = pieces.back().end;
+        return pieces.back().ok;
+    }
 
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
+    // Start positions of array elements spread evenly over the array, at most a few
+    // per thread. Works on fixed byte ranges in parallel: first each range is
+    // summarised (quote parity, depth change and lowest depth for both possible
+    // string states at its start), then a prefix pass gives the exact state at each
+    // range start, then each range looks for its first element-level '{'.
+    std::vector<size_t> FindElementStarts(size_t begin) {
+        constexpr size_t MIN_RANGE_BYTES = 256 * 1024;
+
+        const size_t bytes = size_ - begin;
+        const size_t rangeCount = std::min<size_t>(pool_->ThreadCount() * 4, bytes / MIN_RANGE_BYTES);
+        if (rangeCount < 2) return {};
+        const size_t rangeBytes = (bytes + rangeCount - 1) / rangeCount;
+
+        struct Range {
+            size_t begin = 0;
+            size_t end = 0;
+            bool flipsString = false;
+            int delta[2] = {0, 0};
+            int lowest[2] = {0, 0};
+            bool startsInString = false;
+            int startDepth = 0;
+            size_t split = SIZE_MAX;
+        };
+        std::vector<Range> ranges(rangeCount);
+        for (size_t i = 0; i < rangeCount; i++) {
+            ranges[i].begin = begin + i * rangeBytes;
+            ranges[i].end = std::min(size_, ranges[i].begin + rangeBytes);
         }
-        return true;
-    }
 
-    bool ParseMethodInfo(MethodInfo& method) {
-        if (!Expect('{')) return false;
+        pool_->ParallelFor(rangeCount, [&](size_t i) {
+            Range& range = ranges[i];
+            bool inString[2] = {false, true};
+            int depth[2] = {0, 0};
+            index_.ForEachToken(data_, range.begin, range.end, [&](size_t, char c) {
+                if (c == '"') {
+                    range.flipsString = !range.flipsString;
+                    inString[0] = !inString[0];
+                    inString[1] = !inString[1];
+                    return true;
+                }
+                if (c == ':' || c == ',') return true;
 
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == '}') {
-                pos_++;
+                const int step = (c == '{' || c == '[') ? 1 : -1;
+                for (int s = 0; s < 2; s++) {
+                    if (inString[s]) continue;
+                    depth[s] += step;
+                    range.lowest[s] = std::min(range.lowest[s], depth[s]);
+                }
                 return true;
-            }
+            });
+            range.delta[0] = depth[0];
+            range.delta[1] = depth[1];
+        });
 
-            std::string key = ParseString();
-            SkipWhitespace();
-            if (!Expect(':')) return false;
-            SkipWhitespace();
+        // Depth 1 is inside the array; once it drops to 0 the array has ended
+        bool inString = false;
+        int depth = 1;
+        size_t usable = 0;
+        for (Range& range : ranges) {
+            range.startsInString = inString;
+            range.startDepth = depth;
+            usable++;
+
+            const int s = inString ? 1 : 0;
+            if (depth + range.lowest[s] <= 0) break;
+            depth += range.delta[s];
+            inString = inString != range.flipsString;
+        }
 
-            if (key == "name") method.name = ParseString();
-            else if (key == "returnType") method.returnType = ParseString();
-            else if (key == "isPublic") method.isPublic = ParseBool();
-            else if (key == "isStatic") method.isStatic = ParseBool();
-            else if (key == "parameters") ParseParametersArray(method.parameters);
-            else SkipValue();
+        pool_->ParallelFor(usable - 1, [&](size_t i) {
+            Range& range = ranges[i + 1];
+            bool inString = range.startsInString;
+            int depth = range.startDepth;
+            index_.ForEachToken(data_, range.begin, range.end, [&](size_t pos, char c) {
+                if (c == '"') {
+                    inString = !inString;
+                } else if (!inString && c != ':' && c != ',') {
+                    if (c == '{' && depth == 1) {
+                        range.split = pos;
+                        return false;
+                    }
+                    depth += (c == '{' || c == '[') ? 1 : -1;
+                    if (depth <= 0) return false;
+                }
+                return true;
+            });
+        });
 
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
+        std::vector<size_t> splits;
+        for (size_t i = 1; i < usable; i++) {
+            if (ranges[i].split != SIZE_MAX) splits.push_back(ranges[i].split);
         }
-        return true;
+        return splits;
     }
+};
 
-    bool ParseParametersArray(std::vector<ParameterInfo>& parameters) {
-        if (!Expect('[')) return false;
-
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == ']') {
-                pos_++;
-                return true;
-            }
+bool ParseAssemblyData(const std::string& json, AssemblyData& data) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
 
-            ParameterInfo param;
-            if (!ParseParameterInfo(param)) return false;
-            parameters.push_back(std::move(param));
+    JsonParser parser(json.data(), json.size(), index, data.symbols);
+    return parser.ParseAssemblyData(data);
+}
 
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
-        }
-        return true;
-    }
+bool ParseAssemblyDelta(const std::string& json, AssemblyDelta& delta) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
 
-    bool ParseParameterInfo(ParameterInfo& param) {
-        if (!Expect('{')) return false;
+    JsonParser parser(json.data(), json.size(), index, delta.symbols);
+    return parser.ParseAssemblyDelta(delta);
+}
 
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == '}') {
-                pos_++;
-                return true;
-            }
+bool ParseMemberRequest(const std::string& json, MemberRequest& request) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
 
-            std::string key = ParseString();
-            SkipWhitespace();
-            if (!Expect(':')) return false;
-            SkipWhitespace();
+    SymbolTable unused;
+    JsonParser parser(json.data(), json.size(), index, unused);
+    return parser.ParseMessage(request);
+}
 
-            if (key == "name") param.name = ParseString();
-            else if (key == "parameterType") param.parameterType = ParseString();
-            else SkipValue();
+bool ParseMemberResponse(const std::string& json, MemberResponse& response) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
 
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
-        }
-        return true;
-    }
+    JsonParser parser(json.data(), json.size(), index, response.symbols);
+    return parser.ParseMessage(response);
+}
 
-    bool ParsePropertiesArray(std::vector<PropertyInfo>& properties) {
-        if (!Expect('[')) return false;
+bool ParseReflectionProgress(const std::string& json, ReflectionProgress& progress) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
 
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == ']') {
-                pos_++;
-                return true;
-            }
+    SymbolTable unused;
+    JsonParser parser(json.data(), json.size(), index, unused);
+    return parser.ParseMessage(progress);
+}
 
-            PropertyInfo prop;
-            if (!ParsePropertyInfo(prop)) return false;
-            properties.push_back(std::move(prop));
+bool ParseSnapshotNotModified(const std::string& json, SnapshotNotModified& notModified) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
 
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
-        }
-        return true;
-    }
+    SymbolTable unused;
+    JsonParser parser(json.data(), json.size(), index, unused);
+    return parser.ParseMessage(notModified);
+}
 
-    bool ParsePropertyInfo(PropertyInfo& prop) {
-        if (!Expect('{')) return false;
+// Every lookahead the parser makes moves the cursor to what it found, so an
+// object that closes on the last byte without running off the end never looked
+// past it
+bool ParseTypeInfo(const std::string& json, const StructuralIndex& index, SymbolTable& symbols, TypeInfo& type) {
+    JsonParser parser(json.data(), json.size(), index, symbols);
+    return parser.ParseSingleType(type) && parser.Position() == json.size() && !parser.RanOffEnd();
+}
 
-        while (pos_ < json_.size()) {
-            SkipWhitespace();
-            if (Peek() == '}') {
-                pos_++;
-                return true;
-            }
+bool ParseAssemblyDataExact(const std::string& json, AssemblyData& data) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
 
-            std::string key = ParseString();
-            SkipWhitespace();
-            if (!Expect(':')) return false;
-            SkipWhitespace();
+    JsonParser parser(json.data(), json.size(), index, data.symbols);
+    return parser.ParseAssemblyData(data) && parser.Position() == json.size() && !parser.RanOffEnd();
+}
 
-            if (key == "name") prop.name = ParseString();
-            else if (key == "propertyType") prop.propertyType = ParseString();
-            else if (key == "canRead") prop.canRead = ParseBool();
-            else if (key == "canWrite") prop.canWrite = ParseBool();
-            else SkipValue();
+bool ParseAssemblyDataParallel(const std::string& json, AssemblyData& data, ThreadPool* pool) {
+    if (!pool) pool = &ThreadPool::Shared();
+    if (pool->ThreadCount() < 2) return ParseAssemblyData(json, data);
 
-            SkipWhitespace();
-            if (Peek() == ',') pos_++;
-        }
-        return true;
-    }
-};
+    StructuralIndex index;
+    index.Build(json.data(), json.size(), *pool);
 
-bool ParseAssemblyData(const std::string& json, AssemblyData& data) {
-    SimpleJsonParser parser(json);
+    JsonParser parser(json.data(), json.size(), index, data.symbols, pool);
     return parser.ParseAssemblyData(data);
 }
 
+bool ParseAssemblyHeaders(const std::string& json, AssemblyData& data, std::vector<TypeMemberSpans>& spans) {
+    StructuralIndex index;
+    index.Build(json.data(), json.size());
+
+    spans.clear();
+    JsonParser parser(json.data(), json.size(), index, data.symbols);
+    return parser.ParseAssemblyHeaders(data, spans);
+}
+
+namespace {
+
+// The span is indexed on its own, so decoding a type never touches the rest
+// of the payload. An array that ends exactly at the end of its span made the
+// same lookaheads it would make in place; one that stops short or runs off the
+// end means the headers pass skipped it where the full parse would not have.
+template <typename T>
+bool ParseMemberSpan(const std::string& json, JsonSpan span, SymbolTable& symbols, std::vector<T>& values) {
+    values.clear();
+    if (span.Empty()) return true;
+
+    const char* data = json.data() + span.begin;
+    const size_t size = span.end - span.begin;
+    StructuralIndex index;
+    index.Build(data, size);
+
+    JsonParser parser(data, size, index, symbols);
+    return parser.ParseMemberArray(values) && parser.Position() == size && !parser.RanOffEnd();
+}
+
+} // namespace
+
+bool ParseTypeMembers(const std::string& json, const TypeMemberSpans& spans, SymbolTable& symbols, TypeInfo& type) {
+    const bool fields = ParseMemberSpan(json, spans.fields, symbols, type.fields);
+    const bool methods = ParseMemberSpan(json, spans.methods, symbols, type.methods);
+    const bool properties = ParseMemberSpan(json, spans.properties, symbols, type.properties);
+    return fields && methods && properties;
+}
+
 } // namespace UnityReflection
@@ -1,18 +1,26 @@
 #pragma once
 
+#include "symbol_table.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace UnityReflection {
 
+class StructuralIndex;
+class ThreadPool;
+
+// Type names repeat across thousands of members, so they are interned in the
+// owning AssemblyData's symbol table; look them up with symbols.Name()/CStr()
+
 struct ParameterInfo {
     std::string name;
-    std::string parameterType;
+    SymbolId parameterType = SymbolTable::EMPTY;
 };
 
 struct MethodInfo {
     std::string name;
-    std::string returnType;
+    SymbolId returnType = SymbolTable::EMPTY;
     bool isPublic = false;
     bool isStatic = false;
     std::vector<ParameterInfo> parameters;
@@ -20,7 +28,7 @@ struct MethodInfo {
 
 struct FieldInfo {
     std::string name;
-    std::string fieldType;
+    SymbolId fieldType = SymbolTable::EMPTY;
     bool isPublic = false;
     bool isStatic = false;
     bool isReadOnly = false;
@@ -28,7 +36,7 @@ struct FieldInfo {
 
 struct PropertyInfo {
     std::string name;
-    std::string propertyType;
+    SymbolId propertyType = SymbolTable::EMPTY;
     bool canRead = false;
     bool canWrite = false;
 };
@@ -37,7 +45,7 @@ struct TypeInfo {
     std::string name;
     std::string fullName;
     std::string namespaceName;
-    std::string baseType;
+    SymbolId baseType = SymbolTable::EMPTY;
     bool isClass = false;
     bool isStruct = false;
     bool isEnum = false;
@@ -50,16 +58,125 @@ struct TypeInfo {
 struct AssemblyData {
     std::string assemblyName;
     std::string timestamp;
+    // Module version id (MVID) of the assembly reflected, new with every build
+    // of it; empty when the mod did not send one
+    std::string moduleVersionId;
     std::vector<TypeInfo> types;
+    // Content hash the mod gives each snapshot, the base for later deltas; empty
+    // when the mod did not send one
+    std::string snapshotId;
+    SymbolTable symbols;
 
     void Clear() {
         assemblyName.clear();
         timestamp.clear();
+        moduleVersionId.clear();
         types.clear();
+        snapshotId.clear();
+        symbols.Clear();
     }
 };
 
+// A type named in AssemblyDelta::removed
+struct TypeRef {
+    std::string fullName;
+};
+
+// Changes from the snapshot baseSnapshotId to snapshotId (MessageKind::AssemblyDelta).
+// Types are matched by full name; types holds the added and modified ones whole,
+// with their type names interned into symbols.
+struct AssemblyDelta {
+    std::string assemblyName;
+    std::string timestamp;
+    std::string moduleVersionId;
+    std::string baseSnapshotId;
+    std::vector<TypeRef> removed;
+    std::vector<TypeInfo> types;
+    std::string snapshotId;
+    SymbolTable symbols;
+};
+
+// Query mode (MessageKind::MemberRequest): a position in the type headers the
+// mod sent
+struct TypeIndex {
+    uint32_t index = 0;
+};
+
+// Viewer to mod: send the members of these types. requestId is echoed back.
+struct MemberRequest {
+    uint32_t requestId = 0;
+    std::vector<TypeIndex> types;
+};
+
+// Mod to viewer (MessageKind::MemberResponse): types[i] is the whole type at
+// request.types[i], or an empty type (no fullName) if that index was out of range
+struct MemberResponse {
+    uint32_t requestId = 0;
+    std::vector<TypeInfo> types;
+    SymbolTable symbols;
+};
+
+// Mod to viewer (MessageKind::Progress), while a snapshot is being reflected:
+// typesDone of typesTotal types have been reflected so far
+struct ReflectionProgress {
+    uint32_t typesDone = 0;
+    uint32_t typesTotal = 0;
+};
+
+// Mod to viewer (MessageKind::NotModified) instead of a snapshot: the assembly
+// is still the build the viewer's hello named, so its snapshot is current
+struct SnapshotNotModified {
+    std::string moduleVersionId;
+};
+
+// Byte range [begin, end) of a JSON value in a payload
+struct JsonSpan {
+    size_t begin = 0;
+    size_t end = 0;
+
+    bool Empty() const { return begin == end; }
+};
+
+// Where one type's member arrays are in the payload; empty if the key was absent
+struct TypeMemberSpans {
+    JsonSpan fields;
+    JsonSpan methods;
+    JsonSpan properties;
+};
+
 // JSON parsing
 bool ParseAssemblyData(const std::string& json, AssemblyData& data);
 
+bool ParseAssemblyDelta(const std::string& json, AssemblyDelta& delta);
+
+bool ParseMemberRequest(const std::string& json, MemberRequest& request);
+bool ParseMemberResponse(const std::string& json, MemberResponse& response);
+bool ParseReflectionProgress(const std::string& json, ReflectionProgress& progress);
+bool ParseSnapshotNotModified(const std::string& json, SnapshotNotModified& notModified);
+
+// Same result as ParseAssemblyData, with stage 1 and the "types" array split
+// across the pool (ThreadPool::Shared() when null)
+bool ParseAssemblyDataParallel(const std::string& json, AssemblyData& data, ThreadPool* pool = nullptr);
+
+// Parses one element of the "types" array, interning its type names into symbols;
+// index must be built over json and the element must span all of it, ending in
+// its own closing brace. A piece cut out of a larger payload then parses exactly
+// as it does in place.
+bool ParseTypeInfo(const std::string& json, const StructuralIndex& index, SymbolTable& symbols, TypeInfo& type);
+
+// ParseAssemblyData held to the same rule: the top-level object must span all
+// of json and end in its own closing brace
+bool ParseAssemblyDataExact(const std::string& json, AssemblyData& data);
+
+// Headers-only pass for lazy loading: like ParseAssemblyData, but the member
+// arrays of each type are skipped and their positions stored in spans[i]
+bool ParseAssemblyHeaders(const std::string& json, AssemblyData& data, std::vector<TypeMemberSpans>& spans);
+
+// Decodes the member arrays recorded by ParseAssemblyHeaders for one type. A
+// broken array keeps the elements read before it, as in the full parse, but
+// fails the call: so does an array that does not end exactly where the headers
+// pass skipped to. While every call succeeds, the lazily decoded data is what
+// ParseAssemblyData would give.
+bool ParseTypeMembers(const std::string& json, const TypeMemberSpans& spans, SymbolTable& symbols, TypeInfo& type);
+
 } // namespace UnityReflection
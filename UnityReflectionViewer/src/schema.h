@@ -0,0 +1,413 @@
+#pragma once
+
+#include "assembly_snapshot.h"
+#include "reflection_data.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace UnityReflection {
+
+// Compile-time description of the reflection structs. Each Schema<T> lists the
+// serialized fields of T in wire order (the order IPCServer.SerializeToJson writes
+// them) as key, member pointer and kind. The JSON parsers, the JSON encoder and
+// the binary codec are all generated from these lists, so adding a field means
+// adding one line here (and to the C# serializer), plus one to the zero-copy
+// view of the struct if it has one.
+
+enum class FieldKind {
+    String, // std::string, or std::string_view in a view
+    Symbol, // SymbolId into the owning AssemblyData's symbol table, or the name in a view
+    Bool,
+    UInt,   // uint32_t, a JSON number
+    Array   // std::vector of another struct with a Schema, or ArenaArray in a view
+};
+
+template <FieldKind Kind, typename Owner, typename T>
+struct FieldDescriptor {
+    static constexpr FieldKind KIND = Kind;
+    using OwnerType = Owner;
+    using ValueType = T;
+
+    std::string_view key;
+    T Owner::*member;
+};
+
+template <typename Owner>
+constexpr FieldDescriptor<FieldKind::String, Owner, std::string> StringField(std::string_view key,
+                                                                            std::string Owner::*member) {
+    return {key, member};
+}
+
+template <typename Owner>
+constexpr FieldDescriptor<FieldKind::Symbol, Owner, SymbolId> SymbolField(std::string_view key,
+                                                                         SymbolId Owner::*member) {
+    return {key, member};
+}
+
+template <typename Owner>
+constexpr FieldDescriptor<FieldKind::Bool, Owner, bool> BoolField(std::string_view key, bool Owner::*member) {
+    return {key, member};
+}
+
+template <typename Owner>
+constexpr FieldDescriptor<FieldKind::UInt, Owner, uint32_t> UIntField(std::string_view key, uint32_t Owner::*member) {
+    return {key, member};
+}
+
+template <typename Owner, typename T>
+constexpr FieldDescriptor<FieldKind::Array, Owner, std::vector<T>> ArrayField(std::string_view key,
+                                                                             std::vector<T> Owner::*member) {
+    return {key, member};
+}
+
+// The same kinds for the views in assembly_snapshot.h
+template <typename Owner>
+constexpr FieldDescriptor<FieldKind::String, Owner, std::string_view> StringField(std::string_view key,
+                                                                                 std::string_view Owner::*member) {
+    return {key, member};
+}
+
+template <typename Owner>
+constexpr FieldDescriptor<FieldKind::Symbol, Owner, std::string_view> SymbolField(std::string_view key,
+                                                                                 std::string_view Owner::*member) {
+    return {key, member};
+}
+
+template <typename Owner, typename T>
+constexpr FieldDescriptor<FieldKind::Array, Owner, ArenaArray<T>> ArrayField(std::string_view key,
+                                                                            ArenaArray<T> Owner::*member) {
+    return {key, member};
+}
+
+template <typename T>
+struct Schema;
+
+template <>
+struct Schema<ParameterInfo> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &ParameterInfo::name),
+        SymbolField("parameterType", &ParameterInfo::parameterType));
+};
+
+template <>
+struct Schema<MethodInfo> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &MethodInfo::name),
+        SymbolField("returnType", &MethodInfo::returnType),
+        BoolField("isPublic", &MethodInfo::isPublic),
+        BoolField("isStatic", &MethodInfo::isStatic),
+        ArrayField("parameters", &MethodInfo::parameters));
+};
+
+template <>
+struct Schema<FieldInfo> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &FieldInfo::name),
+        SymbolField("fieldType", &FieldInfo::fieldType),
+        BoolField("isPublic", &FieldInfo::isPublic),
+        BoolField("isStatic", &FieldInfo::isStatic),
+        BoolField("isReadOnly", &FieldInfo::isReadOnly));
+};
+
+template <>
+struct Schema<PropertyInfo> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &PropertyInfo::name),
+        SymbolField("propertyType", &PropertyInfo::propertyType),
+        BoolField("canRead", &PropertyInfo::canRead),
+        BoolField("canWrite", &PropertyInfo::canWrite));
+};
+
+template <>
+struct Schema<TypeInfo> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &TypeInfo::name),
+        StringField("fullName", &TypeInfo::fullName),
+        StringField("namespace", &TypeInfo::namespaceName),
+        SymbolField("baseType", &TypeInfo::baseType),
+        BoolField("isClass", &TypeInfo::isClass),
+        BoolField("isStruct", &TypeInfo::isStruct),
+        BoolField("isEnum", &TypeInfo::isEnum),
+        BoolField("isInterface", &TypeInfo::isInterface),
+        ArrayField("fields", &TypeInfo::fields),
+        ArrayField("methods", &TypeInfo::methods),
+        ArrayField("properties", &TypeInfo::properties));
+};
+
+// symbols is not serialized as a field; codecs that need it write it separately
+template <>
+struct Schema<AssemblyData> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("assemblyName", &AssemblyData::assemblyName),
+        StringField("timestamp", &AssemblyData::timestamp),
+        StringField("moduleVersionId", &AssemblyData::moduleVersionId),
+        ArrayField("types", &AssemblyData::types),
+        StringField("snapshotId", &AssemblyData::snapshotId)); // last: it hashes the types
+};
+
+template <>
+struct Schema<TypeRef> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("fullName", &TypeRef::fullName));
+};
+
+template <>
+struct Schema<AssemblyDelta> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("assemblyName", &AssemblyDelta::assemblyName),
+        StringField("timestamp", &AssemblyDelta::timestamp),
+        StringField("moduleVersionId", &AssemblyDelta::moduleVersionId),
+        StringField("baseSnapshotId", &AssemblyDelta::baseSnapshotId),
+        ArrayField("removed", &AssemblyDelta::removed),
+        ArrayField("types", &AssemblyDelta::types),
+        StringField("snapshotId", &AssemblyDelta::snapshotId));
+};
+
+template <>
+struct Schema<TypeIndex> {
+    static constexpr auto FIELDS = std::make_tuple(
+        UIntField("index", &TypeIndex::index));
+};
+
+template <>
+struct Schema<MemberRequest> {
+    static constexpr auto FIELDS = std::make_tuple(
+        UIntField("requestId", &MemberRequest::requestId),
+        ArrayField("types", &MemberRequest::types));
+};
+
+template <>
+struct Schema<MemberResponse> {
+    static constexpr auto FIELDS = std::make_tuple(
+        UIntField("requestId", &MemberResponse::requestId),
+        ArrayField("types", &MemberResponse::types));
+};
+
+template <>
+struct Schema<ReflectionProgress> {
+    static constexpr auto FIELDS = std::make_tuple(
+        UIntField("typesDone", &ReflectionProgress::typesDone),
+        UIntField("typesTotal", &ReflectionProgress::typesTotal));
+};
+
+template <>
+struct Schema<SnapshotNotModified> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("moduleVersionId", &SnapshotNotModified::moduleVersionId));
+};
+
+// Views (assembly_snapshot.h): the fields of the struct each one mirrors, in
+// the same order and of the same kinds, which is checked below
+
+template <>
+struct Schema<ParameterView> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &ParameterView::name),
+        SymbolField("parameterType", &ParameterView::parameterType));
+};
+
+template <>
+struct Schema<MethodView> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &MethodView::name),
+        SymbolField("returnType", &MethodView::returnType),
+        BoolField("isPublic", &MethodView::isPublic),
+        BoolField("isStatic", &MethodView::isStatic),
+        ArrayField("parameters", &MethodView::parameters));
+};
+
+template <>
+struct Schema<FieldView> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &FieldView::name),
+        SymbolField("fieldType", &FieldView::fieldType),
+        BoolField("isPublic", &FieldView::isPublic),
+        BoolField("isStatic", &FieldView::isStatic),
+        BoolField("isReadOnly", &FieldView::isReadOnly));
+};
+
+template <>
+struct Schema<PropertyView> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &PropertyView::name),
+        SymbolField("propertyType", &PropertyView::propertyType),
+        BoolField("canRead", &PropertyView::canRead),
+        BoolField("canWrite", &PropertyView::canWrite));
+};
+
+template <>
+struct Schema<TypeView> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("name", &TypeView::name),
+        StringField("fullName", &TypeView::fullName),
+        StringField("namespace", &TypeView::namespaceName),
+        SymbolField("baseType", &TypeView::baseType),
+        BoolField("isClass", &TypeView::isClass),
+        BoolField("isStruct", &TypeView::isStruct),
+        BoolField("isEnum", &TypeView::isEnum),
+        BoolField("isInterface", &TypeView::isInterface),
+        ArrayField("fields", &TypeView::fields),
+        ArrayField("methods", &TypeView::methods),
+        ArrayField("properties", &TypeView::properties));
+};
+
+template <>
+struct Schema<AssemblySnapshot> {
+    static constexpr auto FIELDS = std::make_tuple(
+        StringField("assemblyName", &AssemblySnapshot::assemblyName),
+        StringField("timestamp", &AssemblySnapshot::timestamp),
+        StringField("moduleVersionId", &AssemblySnapshot::moduleVersionId),
+        ArrayField("types", &AssemblySnapshot::types),
+        StringField("snapshotId", &AssemblySnapshot::snapshotId));
+};
+
+template <typename T>
+constexpr size_t SCHEMA_FIELD_COUNT = std::tuple_size_v<std::decay_t<decltype(Schema<T>::FIELDS)>>;
+
+// Calls f(descriptor) for every field of T in wire order
+template <typename T, typename F>
+void ForEachField(F&& f) {
+    std::apply([&f](const auto&... field) { (f(field), ...); }, Schema<T>::FIELDS);
+}
+
+// Rewrites every symbol id in object (and the structs nested in it) through
+// remap, for moving data from one symbol table to another
+template <typename T>
+void RemapSymbols(T& object, const std::vector<SymbolId>& remap) {
+    ForEachField<T>([&](const auto& field) {
+        using Field = std::decay_t<decltype(field)>;
+        auto& value = object.*field.member;
+        if constexpr (Field::KIND == FieldKind::Symbol) {
+            value = remap[value];
+        } else if constexpr (Field::KIND == FieldKind::Array) {
+            for (auto& element : value) RemapSymbols(element, remap);
+        }
+    });
+}
+
+namespace SchemaDetail {
+
+template <typename T, typename F, size_t... I>
+bool VisitField(size_t index, F& f, std::index_sequence<I...>) {
+    return ((index == I ? (f(std::get<I>(Schema<T>::FIELDS)), true) : false) || ...);
+}
+
+// Mixes the length and three sampled characters; the samples are independent
+// multiplies, so this costs a few cycles however long the key is
+constexpr uint32_t SampleKey(std::string_view key) {
+    if (key.empty()) return 0;
+    const uint32_t first = static_cast<unsigned char>(key[0]);
+    const uint32_t middle = static_cast<unsigned char>(key[key.size() / 2]);
+    const uint32_t last = static_cast<unsigned char>(key[key.size() - 1]);
+    return static_cast<uint32_t>(key.size()) * 0x9E3779B1u ^ first * 0x85EBCA77u ^ middle * 0xC2B2AE3Du ^
+           last * 0x27D4EB2Fu;
+}
+
+constexpr size_t TableSize(size_t count) {
+    size_t size = 8;
+    while (size < count * 2) size *= 2;
+    return size;
+}
+
+constexpr uint32_t Slot(uint32_t sample, uint32_t seed, size_t tableSize) {
+    return ((sample * seed) >> 16) & static_cast<uint32_t>(tableSize - 1);
+}
+
+// First odd multiplier that puts every key in its own slot, or 0 if none below
+// the search limit does
+template <size_t N, size_t Size>
+constexpr uint32_t FindSeed(const std::array<std::string_view, N>& keys) {
+    for (uint32_t seed = 1; seed < 1u << 20; seed += 2) {
+        std::array<bool, Size> used{};
+        bool collides = false;
+        for (size_t i = 0; i < N && !collides; i++) {
+            const uint32_t slot = Slot(SampleKey(keys[i]), seed, Size);
+            collides = used[slot];
+            used[slot] = true;
+        }
+        if (!collides) return seed;
+    }
+    return 0;
+}
+
+template <typename T, size_t... I>
+constexpr std::array<std::string_view, sizeof...(I)> Keys(std::index_sequence<I...>) {
+    return {std::get<I>(Schema<T>::FIELDS).key...};
+}
+
+} // namespace SchemaDetail
+
+// Perfect hash from the keys of Schema<T> to field indices, built at compile time
+template <typename T>
+struct SchemaKeys {
+    static constexpr size_t COUNT = SCHEMA_FIELD_COUNT<T>;
+    static constexpr size_t TABLE_SIZE = SchemaDetail::TableSize(COUNT);
+    static constexpr uint8_t NO_FIELD = 0xFF;
+
+    static constexpr std::array<std::string_view, COUNT> KEYS =
+        SchemaDetail::Keys<T>(std::make_index_sequence<COUNT>());
+    static constexpr uint32_t SEED = SchemaDetail::FindSeed<COUNT, TABLE_SIZE>(KEYS);
+    static_assert(SEED != 0, "schema keys collide in SampleKey; sample more characters");
+
+    static constexpr std::array<uint8_t, TABLE_SIZE> BuildSlots() {
+        std::array<uint8_t, TABLE_SIZE> slots{};
+        for (uint8_t& slot : slots) slot = NO_FIELD;
+        for (size_t i = 0; i < COUNT; i++) {
+            slots[SchemaDetail::Slot(SchemaDetail::SampleKey(KEYS[i]), SEED, TABLE_SIZE)] = static_cast<uint8_t>(i);
+        }
+        return slots;
+    }
+    static constexpr std::array<uint8_t, TABLE_SIZE> SLOTS = BuildSlots();
+
+    // Field index of key, or COUNT if T has no such field
+    static size_t Find(std::string_view key) {
+        const uint8_t index = SLOTS[SchemaDetail::Slot(SchemaDetail::SampleKey(key), SEED, TABLE_SIZE)];
+        if (index == NO_FIELD) return COUNT;
+        const std::string_view candidate = KEYS[index];
+        if (candidate.size() != key.size() || memcmp(candidate.data(), key.data(), key.size()) != 0) return COUNT;
+        return index;
+    }
+};
+
+namespace SchemaDetail {
+
+template <typename View, typename Owned, size_t... I>
+constexpr bool Mirrors(std::index_sequence<I...>) {
+    return ((std::get<I>(Schema<View>::FIELDS).key == std::get<I>(Schema<Owned>::FIELDS).key &&
+             std::decay_t<decltype(std::get<I>(Schema<View>::FIELDS))>::KIND ==
+                 std::decay_t<decltype(std::get<I>(Schema<Owned>::FIELDS))>::KIND) &&
+            ...);
+}
+
+} // namespace SchemaDetail
+
+// True if View's schema lists Owned's keys in the same order with the same kinds
+template <typename View, typename Owned>
+constexpr bool SchemaMirrors() {
+    if constexpr (SCHEMA_FIELD_COUNT<View> != SCHEMA_FIELD_COUNT<Owned>) {
+        return false;
+    } else {
+        return SchemaDetail::Mirrors<View, Owned>(std::make_index_sequence<SCHEMA_FIELD_COUNT<View>>());
+    }
+}
+
+static_assert(SchemaMirrors<ParameterView, ParameterInfo>(), "ParameterView out of step with ParameterInfo");
+static_assert(SchemaMirrors<MethodView, MethodInfo>(), "MethodView out of step with MethodInfo");
+static_assert(SchemaMirrors<FieldView, FieldInfo>(), "FieldView out of step with FieldInfo");
+static_assert(SchemaMirrors<PropertyView, PropertyInfo>(), "PropertyView out of step with PropertyInfo");
+static_assert(SchemaMirrors<TypeView, TypeInfo>(), "TypeView out of step with TypeInfo");
+static_assert(SchemaMirrors<AssemblySnapshot, AssemblyData>(), "AssemblySnapshot out of step with AssemblyData");
+
+// Calls f(descriptor) for field number index of T; false if index is out of range
+template <typename T, typename F>
+bool VisitField(size_t index, F&& f) {
+    return SchemaDetail::VisitField<T>(index, f, std::make_index_sequence<SCHEMA_FIELD_COUNT<T>>());
+}
+
+} // namespace UnityReflection
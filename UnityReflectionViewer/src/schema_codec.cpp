@@ -0,0 +1,237 @@
+#include "schema_codec.h"
+#include "schema.h"
+#include <cstring>
+#include <type_traits>
+
+namespace UnityReflection {
+
+void AppendJsonEscaped(std::string& out, std::string_view s) {
+    size_t run = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        const char* escape = nullptr;
+        switch (s[i]) {
+            case '\\': escape = "\\\\"; break;
+            case '"': escape = "\\\""; break;
+            case '\n': escape = "\\n"; break;
+            case '\r': escape = "\\r"; break;
+            case '\t': escape = "\\t"; break;
+            default: continue;
+        }
+        out.append(s.data() + run, i - run);
+        out += escape;
+        run = i + 1;
+    }
+    out.append(s.data() + run, s.size() - run);
+}
+
+namespace {
+
+class JsonEncoder {
+public:
+    JsonEncoder(const SymbolTable& symbols, std::string& out) : symbols_(symbols), out_(out) {}
+
+    template <typename T>
+    void WriteObject(const T& object) {
+        out_ += '{';
+        bool first = true;
+        ForEachField<T>([&](const auto& field) {
+            if (!first) out_ += ',';
+            first = false;
+            out_ += '"';
+            out_ += field.key;
+            out_ += "\":";
+            WriteValue(field, object.*field.member);
+        });
+        out_ += '}';
+    }
+
+private:
+    const SymbolTable& symbols_;
+    std::string& out_;
+
+    template <typename Field, typename Value>
+    void WriteValue(const Field&, const Value& value) {
+        if constexpr (Field::KIND == FieldKind::String) {
+            out_ += '"';
+            AppendJsonEscaped(out_, value);
+            out_ += '"';
+        } else if constexpr (Field::KIND == FieldKind::Symbol) {
+            out_ += '"';
+            AppendJsonEscaped(out_, symbols_.Name(value));
+            out_ += '"';
+        } else if constexpr (Field::KIND == FieldKind::Bool) {
+            out_ += value ? "true" : "false";
+        } else if constexpr (Field::KIND == FieldKind::UInt) {
+            out_ += std::to_string(value);
+        } else {
+            out_ += '[';
+            for (size_t i = 0; i < value.size(); i++) {
+                if (i > 0) out_ += ',';
+                WriteObject(value[i]);
+            }
+            out_ += ']';
+        }
+    }
+};
+
+void AppendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void AppendBinaryString(std::string& out, std::string_view s) {
+    AppendVarint(out, s.size());
+    out.append(s.data(), s.size());
+}
+
+template <typename T>
+void WriteBinaryObject(const T& object, std::string& out) {
+    ForEachField<T>([&](const auto& field) {
+        using Field = std::decay_t<decltype(field)>;
+        const auto& value = object.*field.member;
+        if constexpr (Field::KIND == FieldKind::String) {
+            AppendBinaryString(out, value);
+        } else if constexpr (Field::KIND == FieldKind::Symbol) {
+            AppendVarint(out, value);
+        } else if constexpr (Field::KIND == FieldKind::Bool) {
+            out += value ? '\1' : '\0';
+        } else if constexpr (Field::KIND == FieldKind::UInt) {
+            AppendVarint(out, value);
+        } else {
+            AppendVarint(out, value.size());
+            for (const auto& element : value) WriteBinaryObject(element, out);
+        }
+    });
+}
+
+class BinaryDecoder {
+public:
+    BinaryDecoder(const char* data, size_t size) : data_(data), size_(size) {}
+
+    bool ReadHeader(SymbolTable& symbols) {
+        if (size_ < sizeof(SCHEMA_BINARY_MAGIC) ||
+            memcmp(data_, SCHEMA_BINARY_MAGIC, sizeof(SCHEMA_BINARY_MAGIC)) != 0) {
+            return false;
+        }
+        pos_ = sizeof(SCHEMA_BINARY_MAGIC);
+
+        uint64_t version = 0;
+        uint64_t count = 0;
+        if (!ReadVarint(version) || version != SCHEMA_BINARY_VERSION) return false;
+        if (!ReadVarint(count) || count > size_ - pos_) return false;
+
+        // Symbols are written in id order, so interning them reproduces the ids;
+        // id 0 is always the empty string
+        std::string_view name;
+        for (uint64_t i = 0; i < count; i++) {
+            if (!ReadBytes(name)) return false;
+            if (symbols.Intern(name) != i) return false;
+        }
+        symbolCount_ = symbols.Size();
+        return true;
+    }
+
+    template <typename T>
+    bool ReadObject(T& object) {
+        bool ok = true;
+        ForEachField<T>([&](const auto& field) {
+            using Field = std::decay_t<decltype(field)>;
+            if (!ok) return;
+            auto& value = object.*field.member;
+            if constexpr (Field::KIND == FieldKind::String) {
+                std::string_view bytes;
+                ok = ReadBytes(bytes);
+                value.assign(bytes.data(), bytes.size());
+            } else if constexpr (Field::KIND == FieldKind::Symbol) {
+                uint64_t id = 0;
+                ok = ReadVarint(id) && id < symbolCount_;
+                value = static_cast<SymbolId>(id);
+            } else if constexpr (Field::KIND == FieldKind::Bool) {
+                ok = pos_ < size_ && static_cast<unsigned char>(data_[pos_]) <= 1;
+                value = ok && data_[pos_++] != 0;
+            } else if constexpr (Field::KIND == FieldKind::UInt) {
+                uint64_t number = 0;
+                ok = ReadVarint(number) && number <= UINT32_MAX;
+                value = static_cast<uint32_t>(number);
+            } else {
+                // Every element takes at least one byte, which bounds the reserve
+                uint64_t count = 0;
+                ok = ReadVarint(count) && count <= size_ - pos_;
+                if (!ok) return;
+                value.clear();
+                value.reserve(static_cast<size_t>(count));
+                for (uint64_t i = 0; i < count && ok; i++) ok = ReadObject(value.emplace_back());
+            }
+        });
+        return ok;
+    }
+
+    bool AtEnd() const { return pos_ == size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    size_t symbolCount_ = 0;
+
+    bool ReadVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= size_) return false;
+            const uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool ReadBytes(std::string_view& bytes) {
+        uint64_t length = 0;
+        if (!ReadVarint(length) || length > size_ - pos_) return false;
+        bytes = std::string_view(data_ + pos_, static_cast<size_t>(length));
+        pos_ += static_cast<size_t>(length);
+        return true;
+    }
+};
+
+} // namespace
+
+void EncodeJson(const AssemblyData& data, std::string& out) {
+    JsonEncoder(data.symbols, out).WriteObject(data);
+}
+
+void EncodeJson(const TypeInfo& type, const SymbolTable& symbols, std::string& out) {
+    JsonEncoder(symbols, out).WriteObject(type);
+}
+
+void EncodeJson(const AssemblyDelta& delta, std::string& out) {
+    JsonEncoder(delta.symbols, out).WriteObject(delta);
+}
+
+void EncodeJson(const MemberRequest& request, std::string& out) {
+    JsonEncoder(SymbolTable(), out).WriteObject(request);
+}
+
+void EncodeBinary(const AssemblyData& data, std::string& out) {
+    out.append(SCHEMA_BINARY_MAGIC, sizeof(SCHEMA_BINARY_MAGIC));
+    AppendVarint(out, SCHEMA_BINARY_VERSION);
+
+    AppendVarint(out, data.symbols.Size());
+    for (SymbolId id = 0; id < data.symbols.Size(); id++) {
+        AppendBinaryString(out, data.symbols.Name(id));
+    }
+
+    WriteBinaryObject(data, out);
+}
+
+bool DecodeBinary(const char* bytes, size_t size, AssemblyData& data) {
+    data.Clear();
+
+    BinaryDecoder decoder(bytes, size);
+    return decoder.ReadHeader(data.symbols) && decoder.ReadObject(data) && decoder.AtEnd();
+}
+
+} // namespace UnityReflection
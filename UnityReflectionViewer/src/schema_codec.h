@@ -0,0 +1,41 @@
+#pragma once
+
+#include "reflection_data.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace UnityReflection {
+
+// Encoders and decoders generated from the descriptors in schema.h. The JSON
+// decoder lives in reflection_data.cpp (ParseAssemblyData) because it sits on
+// the SIMD structural index; these are the remaining formats.
+
+// Appends s escaped for use inside a JSON string, with the same replacements
+// as IPCServer.EscapeJson: backslash, quote, \n, \r and \t
+void AppendJsonEscaped(std::string& out, std::string_view s);
+
+// Appends data as JSON, byte for byte what IPCServer.SerializeToJson writes for
+// the same assembly: fields in schema order, no whitespace, same escaping.
+void EncodeJson(const AssemblyData& data, std::string& out);
+void EncodeJson(const TypeInfo& type, const SymbolTable& symbols, std::string& out);
+void EncodeJson(const AssemblyDelta& delta, std::string& out);
+void EncodeJson(const MemberRequest& request, std::string& out);
+
+// Compact binary form:
+//
+//   magic | version | symbol count | symbols | fields of AssemblyData
+//
+// Every field is written in schema order with no keys: strings as a LEB128
+// length and the bytes, symbols as a LEB128 id, bools as one byte, numbers as
+// LEB128, arrays as a LEB128 count followed by the elements.
+constexpr char SCHEMA_BINARY_MAGIC[4] = {'U', 'R', 'V', 'B'};
+constexpr uint32_t SCHEMA_BINARY_VERSION = 2; // 2: AssemblyData::snapshotId
+
+void EncodeBinary(const AssemblyData& data, std::string& out);
+
+// Fails on truncated input, a wrong magic or version, out-of-range symbol ids
+// or trailing bytes; data is cleared first and left partially filled on failure.
+bool DecodeBinary(const char* bytes, size_t size, AssemblyData& data);
+
+} // namespace UnityReflection
@@ -0,0 +1,406 @@
+#include "shared_ring.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+namespace UnityReflection {
+
+namespace {
+
+constexpr size_t RING_DATA_OFFSET = 4096;
+constexpr size_t MIN_RING_CAPACITY = 16 * 1024 * 1024; // four of the largest frames
+
+// How long a blocked side sleeps before checking that the other one is alive
+constexpr long WAIT_TIMEOUT_NS = 50 * 1000 * 1000;
+
+} // namespace
+
+struct SharedRingHeader {
+    std::atomic<uint32_t> magic; // written last by the creator
+    uint32_t version;
+    uint64_t capacity;
+    std::atomic<uint64_t> writerPid;
+    std::atomic<uint64_t> readerPid;
+    std::atomic<uint32_t> writerClosed;
+    std::atomic<uint32_t> readerClosed;
+
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+
+    // Bumped on every publish / release; the futex words a blocked side sleeps on
+    alignas(64) std::atomic<uint32_t> dataSeq;
+    std::atomic<uint32_t> readerWaiting;
+    alignas(64) std::atomic<uint32_t> spaceSeq;
+    std::atomic<uint32_t> writerWaiting;
+};
+
+static_assert(sizeof(SharedRingHeader) <= RING_DATA_OFFSET, "ring header must fit in the first page");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock free");
+
+namespace {
+
+void WaitOn(std::atomic<uint32_t>& word, uint32_t seen) {
+#ifdef __linux__
+    timespec timeout{0, WAIT_TIMEOUT_NS};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+    (void)word;
+    (void)seen;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+#endif
+}
+
+void Wake(std::atomic<uint32_t>& word) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+uint64_t CurrentProcessId() {
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+bool ProcessAlive(uint64_t pid) {
+#ifdef _WIN32
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+    if (process == NULL) return GetLastError() == ERROR_ACCESS_DENIED;
+    const bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return alive;
+#else
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif
+}
+
+size_t RoundUpCapacity(size_t capacity) {
+    size_t rounded = MIN_RING_CAPACITY;
+    while (rounded < capacity) rounded *= 2;
+    return rounded;
+}
+
+} // namespace
+
+// SharedRingMapping
+
+SharedRingMapping::~SharedRingMapping() {
+    Unmap();
+}
+
+bool SharedRingMapping::Map(const std::string& name, bool create, size_t capacity, std::string& error) {
+    Unmap();
+    size_t size = RING_DATA_OFFSET + capacity;
+
+#ifdef _WIN32
+    if (create) {
+        const uint64_t size64 = size;
+        mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                      static_cast<DWORD>(size64), name.c_str());
+    } else {
+        mapping_ = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+    }
+    if (mapping_ == NULL) {
+        error = "Failed to open shared memory " + name + ". Error: " + std::to_string(GetLastError());
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (view == NULL) {
+        error = "Failed to map shared memory. Error: " + std::to_string(GetLastError());
+        CloseHandle(mapping_);
+        mapping_ = NULL;
+        return false;
+    }
+    if (!create) {
+        MEMORY_BASIC_INFORMATION info;
+        size = VirtualQuery(view, &info, sizeof(info)) ? info.RegionSize : 0;
+    }
+#else
+    int fd = -1;
+    if (create) {
+        // A region left behind by a writer that crashed is replaced, not reused
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd >= 0 && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            error = "Failed to size shared memory: " + std::string(strerror(errno));
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+    } else {
+        fd = shm_open(name.c_str(), O_RDWR, 0);
+        struct stat info;
+        if (fd >= 0 && fstat(fd, &info) == 0) size = static_cast<size_t>(info.st_size);
+    }
+    if (fd < 0) {
+        error = "Failed to open shared memory " + name + ": " + std::string(strerror(errno));
+        return false;
+    }
+
+    void* view = size >= RING_DATA_OFFSET ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (view == MAP_FAILED) {
+        error = "Failed to map shared memory: " + std::string(strerror(errno));
+        if (create) shm_unlink(name.c_str());
+        return false;
+    }
+#endif
+
+    header_ = static_cast<SharedRingHeader*>(view);
+    ring_ = static_cast<char*>(view) + RING_DATA_OFFSET;
+    mappedSize_ = size;
+    name_ = name;
+    owner_ = create;
+
+    if (create) {
+        new (header_) SharedRingHeader();
+        header_->version = SHARED_RING_VERSION;
+        header_->capacity = capacity;
+        header_->writerPid.store(CurrentProcessId());
+        header_->magic.store(SHARED_RING_MAGIC, std::memory_order_release);
+    } else {
+        // The region may be larger than asked for (page rounding), never smaller
+        const uint64_t mappedCapacity = header_->capacity;
+        std::string problem;
+        if (header_->magic.load(std::memory_order_acquire) != SHARED_RING_MAGIC) {
+            problem = "Shared memory is not a ring buffer, or its writer is still starting";
+        } else if (header_->version != SHARED_RING_VERSION) {
+            problem = "Unsupported ring buffer version " + std::to_string(header_->version);
+        } else if (mappedCapacity == 0 || (mappedCapacity & (mappedCapacity - 1)) != 0 ||
+                   mappedCapacity > size - RING_DATA_OFFSET) {
+            problem = "Ring buffer has an invalid capacity";
+        }
+        if (!problem.empty()) {
+            error = problem;
+            Unmap();
+            return false;
+        }
+        capacity = static_cast<size_t>(mappedCapacity);
+    }
+
+    mask_ = capacity - 1;
+    return true;
+}
+
+void SharedRingMapping::Unmap() {
+    if (header_) {
+#ifdef _WIN32
+        UnmapViewOfFile(header_);
+        CloseHandle(mapping_);
+        mapping_ = NULL;
+#else
+        munmap(header_, mappedSize_);
+        // The reader keeps its mapping after the name is gone
+        if (owner_) shm_unlink(name_.c_str());
+#endif
+    }
+
+    header_ = nullptr;
+    ring_ = nullptr;
+    mask_ = 0;
+    mappedSize_ = 0;
+    owner_ = false;
+}
+
+// SharedRingWriter
+
+SharedRingWriter::~SharedRingWriter() {
+    Close();
+}
+
+bool SharedRingWriter::Create(const std::string& name, size_t capacity, std::string& error) {
+    return Map(name, true, RoundUpCapacity(capacity), error);
+}
+
+void SharedRingWriter::Close() {
+    if (!header_) return;
+
+    header_->writerClosed.store(1);
+    header_->dataSeq.fetch_add(1);
+    Wake(header_->dataSeq);
+    Unmap();
+}
+
+bool SharedRingWriter::WriteMessage(MessageKind kind, uint32_t messageId, const char* data, size_t size,
+                                    size_t chunkSize) {
+    if (!header_ || chunkSize == 0 || chunkSize > MAX_FRAME_PAYLOAD) return false;
+
+    if (!WriteFrame(FrameType::Begin, kind, messageId, size, nullptr, 0)) return false;
+    for (size_t pos = 0; pos < size; pos += chunkSize) {
+        const size_t n = size - pos < chunkSize ? size - pos : chunkSize;
+        if (!WriteFrame(FrameType::Chunk, kind, messageId, pos, data + pos, n)) return false;
+    }
+    return WriteFrame(FrameType::End, kind, messageId, size, nullptr, 0);
+}
+
+bool SharedRingWriter::WriteFrame(FrameType type, MessageKind kind, uint32_t messageId, uint64_t offset,
+                                  const char* payload, size_t size) {
+    const size_t frameSize = FRAME_HEADER_SIZE + size;
+    uint64_t head = header_->head.load(std::memory_order_relaxed); // only the writer moves it
+
+    // Frames never wrap; the end of the ring is padded instead
+    const size_t contiguous = static_cast<size_t>(mask_ + 1 - (head & mask_));
+    if (contiguous < frameSize) {
+        if (!WaitForSpace(contiguous)) return false;
+        if (contiguous >= FRAME_HEADER_SIZE) {
+            FrameHeader padding;
+            padding.type = FrameType::Padding;
+            padding.payloadSize = static_cast<uint32_t>(contiguous - FRAME_HEADER_SIZE);
+            EncodeFrameHeader(padding, reinterpret_cast<uint8_t*>(ring_ + (head & mask_)));
+        }
+        head += contiguous;
+        Publish(head);
+    }
+
+    if (!WaitForSpace(frameSize)) return false;
+
+    FrameHeader header;
+    header.type = type;
+    header.kind = kind;
+    header.messageId = messageId;
+    header.payloadSize = static_cast<uint32_t>(size);
+    header.offset = offset;
+    header.payloadCrc = Crc32c(payload, size);
+
+    char* out = ring_ + (head & mask_);
+    EncodeFrameHeader(header, reinterpret_cast<uint8_t*>(out));
+    if (size > 0) memcpy(out + FRAME_HEADER_SIZE, payload, size);
+    Publish(head + frameSize);
+    return true;
+}
+
+bool SharedRingWriter::WaitForSpace(size_t size) {
+    const uint64_t head = header_->head.load(std::memory_order_relaxed);
+    const uint64_t capacity = mask_ + 1;
+
+    while (capacity - (head - header_->tail.load(std::memory_order_acquire)) < size) {
+        header_->writerWaiting.store(1);
+        const uint32_t seen = header_->spaceSeq.load();
+        if (capacity - (head - header_->tail.load()) < size) {
+            WaitOn(header_->spaceSeq, seen);
+        }
+        header_->writerWaiting.store(0);
+
+        const uint64_t readerPid = header_->readerPid.load();
+        if (header_->readerClosed.load() || (readerPid != 0 && !ProcessAlive(readerPid))) return false;
+    }
+    return true;
+}
+
+void SharedRingWriter::Publish(uint64_t head) {
+    header_->head.store(head);
+    header_->dataSeq.fetch_add(1);
+    if (header_->readerWaiting.load()) Wake(header_->dataSeq);
+}
+
+// SharedRingReader
+
+bool SharedRingReader::Open(const std::string& name, std::string& error) {
+    holding_ = false;
+    if (!Map(name, false, 0, error)) return false;
+
+    header_->readerPid.store(CurrentProcessId());
+    header_->readerClosed.store(0);
+    return true;
+}
+
+void SharedRingReader::Close() {
+    if (!header_) return;
+
+    if (holding_) Release(pendingTail_);
+    holding_ = false;
+    header_->readerClosed.store(1);
+    header_->spaceSeq.fetch_add(1);
+    Wake(header_->spaceSeq);
+    Unmap();
+}
+
+bool SharedRingReader::NextFrame(FrameHeader& header, const char*& payload) {
+    if (!header_) return false;
+
+    if (holding_) {
+        Release(pendingTail_);
+        holding_ = false;
+    }
+
+    while (true) {
+        const uint64_t tail = header_->tail.load(std::memory_order_relaxed); // only the reader moves it
+        if (!WaitForData(tail)) return false;
+
+        // Less than a header before the end: the writer skipped it
+        const size_t contiguous = static_cast<size_t>(mask_ + 1 - (tail & mask_));
+        if (contiguous < FRAME_HEADER_SIZE) {
+            Release(tail + contiguous);
+            continue;
+        }
+
+        const char* frame = ring_ + (tail & mask_);
+        if (DecodeFrameHeader(reinterpret_cast<const uint8_t*>(frame), header) != FrameStatus::Ok ||
+            FRAME_HEADER_SIZE + header.payloadSize > contiguous) {
+            return false;
+        }
+
+        const uint64_t next = tail + FRAME_HEADER_SIZE + header.payloadSize;
+        if (header.type == FrameType::Padding) {
+            Release(next);
+            continue;
+        }
+
+        payload = frame + FRAME_HEADER_SIZE;
+        pendingTail_ = next;
+        holding_ = true;
+        return true;
+    }
+}
+
+bool SharedRingReader::WaitForData(uint64_t tail) {
+    while (header_->head.load(std::memory_order_acquire) == tail) {
+        if (interrupted_) return false;
+
+        // Checked before waiting so frames published just before the close are
+        // still read
+        if (header_->writerClosed.load()) return header_->head.load() != tail;
+
+        header_->readerWaiting.store(1);
+        const uint32_t seen = header_->dataSeq.load();
+        if (header_->head.load() == tail) {
+            WaitOn(header_->dataSeq, seen);
+        }
+        header_->readerWaiting.store(0);
+
+        const uint64_t writerPid = header_->writerPid.load();
+        if (header_->head.load() == tail && !ProcessAlive(writerPid)) return false;
+    }
+    return true;
+}
+
+void SharedRingReader::Release(uint64_t tail) {
+    header_->tail.store(tail);
+    header_->spaceSeq.fetch_add(1);
+    if (header_->writerWaiting.load()) Wake(header_->spaceSeq);
+}
+
+} // namespace UnityReflection
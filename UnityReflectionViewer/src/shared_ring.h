@@ -0,0 +1,113 @@
+#pragma once
+
+#include "frame_protocol.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace UnityReflection {
+
+// Single-producer/single-consumer ring buffer in a named shared-memory region,
+// carrying the same frames as the pipe (frame_protocol.h). The writer copies
+// each frame into the mapped pages once; the reader hands chunk payloads to
+// the parser in place, so nothing is copied on the viewer side.
+//
+//   page 0: header (magic, version, capacity, head and tail on their own cache
+//           lines, wakeup words)
+//   page 1..: capacity bytes of ring data
+//
+// head and tail are byte counts that only grow; the writer publishes whole
+// frames by advancing head, the reader frees them by advancing tail. A frame
+// never wraps: when it does not fit before the end of the ring the writer
+// fills the rest with a Padding frame, or skips it silently when less than a
+// frame header is left. On Linux a blocked side sleeps on a futex in the
+// header; elsewhere it polls.
+constexpr uint32_t SHARED_RING_MAGIC = 0x52565255; // "URVR" read as little-endian
+constexpr uint32_t SHARED_RING_VERSION = 1;
+constexpr size_t SHARED_RING_DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+struct SharedRingHeader;
+
+class SharedRingMapping {
+public:
+    SharedRingMapping() = default;
+    ~SharedRingMapping();
+
+    SharedRingMapping(const SharedRingMapping&) = delete;
+    SharedRingMapping& operator=(const SharedRingMapping&) = delete;
+
+    bool IsOpen() const { return header_ != nullptr; }
+
+protected:
+    // create: make a fresh region of the given capacity, replacing any left
+    // behind by an earlier writer. Otherwise attach to an existing one.
+    bool Map(const std::string& name, bool create, size_t capacity, std::string& error);
+    void Unmap();
+
+    SharedRingHeader* header_ = nullptr;
+    char* ring_ = nullptr;
+    uint64_t mask_ = 0;
+    size_t mappedSize_ = 0;
+    std::string name_;
+    bool owner_ = false;
+#ifdef _WIN32
+    HANDLE mapping_ = NULL;
+#endif
+};
+
+// Producer side. Used as the local stand-in for the game process by the
+// benchmark; the mod itself writes to the pipe.
+class SharedRingWriter : public SharedRingMapping {
+public:
+    ~SharedRingWriter();
+
+    // capacity is rounded up to a power of two of at least 16 MB, room for four
+    // of the largest frames
+    bool Create(const std::string& name, size_t capacity, std::string& error);
+
+    // Marks the stream finished so the reader sees end of data, and unmaps
+    void Close();
+
+    // Writes data as one framed message, blocking while the ring is full.
+    // False if the reader went away.
+    bool WriteMessage(MessageKind kind, uint32_t messageId, const char* data, size_t size,
+                      size_t chunkSize = FRAME_CHUNK_SIZE);
+
+private:
+    bool WriteFrame(FrameType type, MessageKind kind, uint32_t messageId, uint64_t offset,
+                    const char* payload, size_t size);
+    bool WaitForSpace(size_t size);
+    void Publish(uint64_t head);
+};
+
+class SharedRingReader : public SharedRingMapping {
+public:
+    bool Open(const std::string& name, std::string& error);
+    void Close();
+
+    // Waits for the next frame and points payload at it inside the mapping. It
+    // stays valid until the next call, which frees it. False once the writer
+    // has closed (or exited) and everything is read, or if the ring holds a
+    // frame header that does not decode.
+    bool NextFrame(FrameHeader& header, const char*& payload);
+
+    // Makes a blocked NextFrame return false within one wait slice, from any
+    // thread, until ClearInterrupt
+    void Interrupt() { interrupted_ = true; }
+    void ClearInterrupt() { interrupted_ = false; }
+
+private:
+    bool WaitForData(uint64_t tail);
+    void Release(uint64_t tail);
+
+    uint64_t pendingTail_ = 0;
+    bool holding_ = false;
+    std::atomic<bool> interrupted_{false};
+};
+
+} // namespace UnityReflection
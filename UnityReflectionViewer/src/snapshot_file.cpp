@@ -0,0 +1,471 @@
+#include "snapshot_file.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace UnityReflection {
+
+namespace {
+
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint64_t SECTION_ALIGNMENT = 8;
+
+static_assert(sizeof(SnapshotFileHeader) % SECTION_ALIGNMENT == 0, "sections start aligned");
+
+uint64_t RotateLeft(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t Load64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t AlignUp(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+uint32_t TypeFlags(const TypeInfo& type) {
+    return (type.isClass ? SNAPSHOT_CLASS : 0u) | (type.isStruct ? SNAPSHOT_STRUCT : 0u) |
+           (type.isEnum ? SNAPSHOT_ENUM : 0u) | (type.isInterface ? SNAPSHOT_INTERFACE : 0u);
+}
+
+// True if [offset, offset + count * elementSize) lies inside the file and is
+// aligned for 4-byte reads
+bool SectionFits(const SnapshotSection& section, size_t elementSize, size_t fileSize) {
+    if (section.offset % 4 != 0 || section.offset > fileSize) return false;
+    return section.count <= (fileSize - section.offset) / elementSize;
+}
+
+bool RangeFits(uint32_t first, uint32_t count, uint64_t total) {
+    return static_cast<uint64_t>(first) + count <= total;
+}
+
+// Writes to a temporary file next to path and renames it over path
+bool ReplaceFile(const std::string& path, const char* data, size_t size) {
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(data, static_cast<std::streamsize>(size));
+        if (!out) return false;
+    }
+
+#ifdef _WIN32
+    return MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+} // namespace
+
+uint64_t SnapshotChecksum(const char* data, size_t size) {
+    constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+
+    // Four independent lanes keep the multipliers busy
+    uint64_t lanes[4] = {PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; lane++) {
+            lanes[lane] = RotateLeft(lanes[lane] + Load64(data + i + lane * 8) * PRIME2, 31) * PRIME1;
+        }
+    }
+
+    uint64_t hash = static_cast<uint64_t>(size);
+    for (int lane = 0; lane < 4; lane++) {
+        hash = RotateLeft(hash ^ lanes[lane], 27) * PRIME1 + PRIME2;
+    }
+    for (; i < size; i++) {
+        hash = RotateLeft(hash ^ static_cast<unsigned char>(data[i]) * PRIME1, 11) * PRIME2;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+void SnapshotWriter::Clear() {
+    assemblyName_ = timestamp_ = snapshotId_ = moduleVersionId_ = SymbolTable::EMPTY;
+    strings_.Clear();
+    types_.clear();
+    fields_.clear();
+    methods_.clear();
+    parameters_.clear();
+    properties_.clear();
+}
+
+void SnapshotWriter::SetHeader(const AssemblyData& header) {
+    assemblyName_ = strings_.Intern(header.assemblyName);
+    timestamp_ = strings_.Intern(header.timestamp);
+    snapshotId_ = strings_.Intern(header.snapshotId);
+    moduleVersionId_ = strings_.Intern(header.moduleVersionId);
+}
+
+void SnapshotWriter::AddType(const TypeInfo& type, const SymbolTable& symbols) {
+    SnapshotTypeRecord& record = types_.emplace_back();
+    record.name = strings_.Intern(type.name);
+    record.fullName = strings_.Intern(type.fullName);
+    record.namespaceName = strings_.Intern(type.namespaceName);
+    record.baseType = strings_.Intern(symbols.Name(type.baseType));
+    record.flags = TypeFlags(type);
+
+    record.firstField = static_cast<uint32_t>(fields_.size());
+    record.fieldCount = static_cast<uint32_t>(type.fields.size());
+    for (const FieldInfo& field : type.fields) {
+        fields_.push_back({strings_.Intern(field.name), strings_.Intern(symbols.Name(field.fieldType)),
+                           (field.isPublic ? SNAPSHOT_PUBLIC : 0u) | (field.isStatic ? SNAPSHOT_STATIC : 0u) |
+                               (field.isReadOnly ? SNAPSHOT_READ_ONLY : 0u)});
+    }
+
+    record.firstMethod = static_cast<uint32_t>(methods_.size());
+    record.methodCount = static_cast<uint32_t>(type.methods.size());
+    for (const MethodInfo& method : type.methods) {
+        methods_.push_back({strings_.Intern(method.name), strings_.Intern(symbols.Name(method.returnType)),
+                            (method.isPublic ? SNAPSHOT_PUBLIC : 0u) | (method.isStatic ? SNAPSHOT_STATIC : 0u),
+                            static_cast<uint32_t>(parameters_.size()),
+                            static_cast<uint32_t>(method.parameters.size())});
+        for (const ParameterInfo& param : method.parameters) {
+            parameters_.push_back({strings_.Intern(param.name), strings_.Intern(symbols.Name(param.parameterType))});
+        }
+    }
+
+    record.firstProperty = static_cast<uint32_t>(properties_.size());
+    record.propertyCount = static_cast<uint32_t>(type.properties.size());
+    for (const PropertyInfo& prop : type.properties) {
+        properties_.push_back({strings_.Intern(prop.name), strings_.Intern(symbols.Name(prop.propertyType)),
+                               (prop.canRead ? SNAPSHOT_CAN_READ : 0u) | (prop.canWrite ? SNAPSHOT_CAN_WRITE : 0u)});
+    }
+}
+
+void SnapshotWriter::AddAssemblyData(const AssemblyData& data) {
+    SetHeader(data);
+    for (const TypeInfo& type : data.types) {
+        AddType(type, data.symbols);
+    }
+}
+
+void SnapshotWriter::Serialize(std::string& out) const {
+    SnapshotFileHeader header = {};
+    memcpy(header.magic, SNAPSHOT_FILE_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_FILE_VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.assemblyName = assemblyName_;
+    header.timestamp = timestamp_;
+    header.snapshotId = snapshotId_;
+    header.moduleVersionId = moduleVersionId_;
+
+    const std::vector<uint32_t>& offsets = strings_.Offsets();
+    const std::string_view chars = strings_.Chars();
+
+    uint64_t offset = sizeof(SnapshotFileHeader);
+    auto place = [&offset](SnapshotSection& section, size_t count, size_t elementSize) {
+        offset = AlignUp(offset);
+        section.offset = offset;
+        section.count = count;
+        offset += count * elementSize;
+    };
+    place(header.stringOffsets, offsets.size(), sizeof(uint32_t));
+    place(header.stringChars, chars.size(), 1);
+    place(header.types, types_.size(), sizeof(SnapshotTypeRecord));
+    place(header.fields, fields_.size(), sizeof(SnapshotFieldRecord));
+    place(header.methods, methods_.size(), sizeof(SnapshotMethodRecord));
+    place(header.parameters, parameters_.size(), sizeof(SnapshotParameterRecord));
+    place(header.properties, properties_.size(), sizeof(SnapshotPropertyRecord));
+    header.fileSize = offset;
+
+    const size_t start = out.size();
+    out.resize(start + offset, '\0');
+    char* file = &out[start];
+    auto copy = [file](const SnapshotSection& section, const void* data, size_t bytes) {
+        if (bytes > 0) memcpy(file + section.offset, data, bytes);
+    };
+    copy(header.stringOffsets, offsets.data(), offsets.size() * sizeof(uint32_t));
+    copy(header.stringChars, chars.data(), chars.size());
+    copy(header.types, types_.data(), types_.size() * sizeof(SnapshotTypeRecord));
+    copy(header.fields, fields_.data(), fields_.size() * sizeof(SnapshotFieldRecord));
+    copy(header.methods, methods_.data(), methods_.size() * sizeof(SnapshotMethodRecord));
+    copy(header.parameters, parameters_.data(), parameters_.size() * sizeof(SnapshotParameterRecord));
+    copy(header.properties, properties_.data(), properties_.size() * sizeof(SnapshotPropertyRecord));
+
+    header.checksum = SnapshotChecksum(file + sizeof(header), offset - sizeof(header));
+    memcpy(file, &header, sizeof(header));
+}
+
+bool SnapshotWriter::Save(const std::string& path) const {
+    std::string file;
+    Serialize(file);
+    return ReplaceFile(path, file.data(), file.size());
+}
+
+MappedSnapshot::~MappedSnapshot() {
+    Close();
+}
+
+bool MappedSnapshot::Open(const std::string& path, bool verifyChecksum) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(SnapshotFileHeader))) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The view keeps the mapping alive once both handles are closed
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) return false;
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == NULL) return false;
+
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SnapshotFileHeader))) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<size_t>(info.st_size);
+#endif
+
+    if (!Validate(verifyChecksum)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedSnapshot::Load(std::string bytes, bool verifyChecksum) {
+    Close();
+
+    if (bytes.size() < sizeof(SnapshotFileHeader) ||
+        reinterpret_cast<uintptr_t>(bytes.data()) % alignof(SnapshotFileHeader) != 0) {
+        return false;
+    }
+
+    buffer_ = std::move(bytes);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+
+    if (!Validate(verifyChecksum)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedSnapshot::Save(const std::string& path) const {
+    return data_ != nullptr && ReplaceFile(path, data_, size_);
+}
+
+void MappedSnapshot::Close() {
+    if (!buffer_.empty()) {
+        buffer_ = std::string();
+    } else if (data_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    offsets_ = nullptr;
+    chars_ = nullptr;
+    stringCount_ = 0;
+    types_ = {};
+    fields_ = nullptr;
+    methods_ = nullptr;
+    parameters_ = nullptr;
+    properties_ = nullptr;
+}
+
+// Checks everything an accessor relies on, so a truncated, stale or corrupted
+// file is rejected here instead of being read out of bounds later
+bool MappedSnapshot::Validate(bool verifyChecksum) {
+    header_ = reinterpret_cast<const SnapshotFileHeader*>(data_);
+    const SnapshotFileHeader& h = *header_;
+
+    if (memcmp(h.magic, SNAPSHOT_FILE_MAGIC, sizeof(h.magic)) != 0) return false;
+    if (h.version != SNAPSHOT_FILE_VERSION || h.byteOrderMark != BYTE_ORDER_MARK) return false;
+    if (h.fileSize != size_) return false;
+
+    if (!SectionFits(h.stringOffsets, sizeof(uint32_t), size_) || !SectionFits(h.stringChars, 1, size_) ||
+        !SectionFits(h.types, sizeof(SnapshotTypeRecord), size_) ||
+        !SectionFits(h.fields, sizeof(SnapshotFieldRecord), size_) ||
+        !SectionFits(h.methods, sizeof(SnapshotMethodRecord), size_) ||
+        !SectionFits(h.parameters, sizeof(SnapshotParameterRecord), size_) ||
+        !SectionFits(h.properties, sizeof(SnapshotPropertyRecord), size_) ||
+        h.stringOffsets.count == 0 || h.types.count > UINT32_MAX) {
+        return false;
+    }
+
+    if (verifyChecksum &&
+        SnapshotChecksum(data_ + sizeof(SnapshotFileHeader), size_ - sizeof(SnapshotFileHeader)) != h.checksum) {
+        return false;
+    }
+
+    offsets_ = reinterpret_cast<const uint32_t*>(data_ + h.stringOffsets.offset);
+    chars_ = data_ + h.stringChars.offset;
+    stringCount_ = static_cast<size_t>(h.stringOffsets.count - 1);
+    types_ = ArenaArray<SnapshotTypeRecord>(reinterpret_cast<const SnapshotTypeRecord*>(data_ + h.types.offset),
+                                            static_cast<uint32_t>(h.types.count));
+    fields_ = reinterpret_cast<const SnapshotFieldRecord*>(data_ + h.fields.offset);
+    methods_ = reinterpret_cast<const SnapshotMethodRecord*>(data_ + h.methods.offset);
+    parameters_ = reinterpret_cast<const SnapshotParameterRecord*>(data_ + h.parameters.offset);
+    properties_ = reinterpret_cast<const SnapshotPropertyRecord*>(data_ + h.properties.offset);
+
+    // Every string must end in its terminator inside the chars section. The
+    // offsets are all checked before any character is read through them: the
+    // checksum only proves the image was not damaged after it was written.
+    if (offsets_[0] != 0 || offsets_[stringCount_] != h.stringChars.count) return false;
+    for (size_t i = 0; i < stringCount_; i++) {
+        if (offsets_[i + 1] <= offsets_[i] || offsets_[i + 1] > h.stringChars.count) return false;
+    }
+    for (size_t i = 0; i < stringCount_; i++) {
+        if (chars_[offsets_[i + 1] - 1] != '\0') return false;
+    }
+
+    auto isString = [this](uint32_t id) { return id < stringCount_; };
+    if (!isString(h.assemblyName) || !isString(h.timestamp) || !isString(h.snapshotId) ||
+        !isString(h.moduleVersionId)) {
+        return false;
+    }
+
+    for (const SnapshotTypeRecord& type : types_) {
+        if (!isString(type.name) || !isString(type.fullName) || !isString(type.namespaceName) ||
+            !isString(type.baseType) || !RangeFits(type.firstField, type.fieldCount, h.fields.count) ||
+            !RangeFits(type.firstMethod, type.methodCount, h.methods.count) ||
+            !RangeFits(type.firstProperty, type.propertyCount, h.properties.count)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < h.fields.count; i++) {
+        if (!isString(fields_[i].name) || !isString(fields_[i].fieldType)) return false;
+    }
+    for (size_t i = 0; i < h.methods.count; i++) {
+        const SnapshotMethodRecord& method = methods_[i];
+        if (!isString(method.name) || !isString(method.returnType) ||
+            !RangeFits(method.firstParameter, method.parameterCount, h.parameters.count)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < h.parameters.count; i++) {
+        if (!isString(parameters_[i].name) || !isString(parameters_[i].parameterType)) return false;
+    }
+    for (size_t i = 0; i < h.properties.count; i++) {
+        if (!isString(properties_[i].name) || !isString(properties_[i].propertyType)) return false;
+    }
+
+    return true;
+}
+
+ArenaArray<SnapshotFieldRecord> MappedSnapshot::Fields(const SnapshotTypeRecord& type) const {
+    return ArenaArray<SnapshotFieldRecord>(fields_ + type.firstField, type.fieldCount);
+}
+
+ArenaArray<SnapshotMethodRecord> MappedSnapshot::Methods(const SnapshotTypeRecord& type) const {
+    return ArenaArray<SnapshotMethodRecord>(methods_ + type.firstMethod, type.methodCount);
+}
+
+ArenaArray<SnapshotPropertyRecord> MappedSnapshot::Properties(const SnapshotTypeRecord& type) const {
+    return ArenaArray<SnapshotPropertyRecord>(properties_ + type.firstProperty, type.propertyCount);
+}
+
+ArenaArray<SnapshotParameterRecord> MappedSnapshot::Parameters(const SnapshotMethodRecord& method) const {
+    return ArenaArray<SnapshotParameterRecord>(parameters_ + method.firstParameter, method.parameterCount);
+}
+
+void MappedSnapshot::ToAssemblyData(AssemblyData& data) const {
+    data.assemblyName.assign(AssemblyName());
+    data.timestamp.assign(Timestamp());
+    data.snapshotId.assign(SnapshotId());
+    data.moduleVersionId.assign(ModuleVersionId());
+    data.types.reserve(data.types.size() + types_.size());
+
+    // Type names are interned on first use; names are plain copies
+    std::vector<SymbolId> symbolOf(stringCount_, SymbolTable::NOT_FOUND);
+    auto symbol = [&](uint32_t id) {
+        if (symbolOf[id] == SymbolTable::NOT_FOUND) symbolOf[id] = data.symbols.Intern(String(id));
+        return symbolOf[id];
+    };
+
+    for (const SnapshotTypeRecord& record : types_) {
+        TypeInfo& type = data.types.emplace_back();
+        type.name.assign(String(record.name));
+        type.fullName.assign(String(record.fullName));
+        type.namespaceName.assign(String(record.namespaceName));
+        type.baseType = symbol(record.baseType);
+        type.isClass = (record.flags & SNAPSHOT_CLASS) != 0;
+        type.isStruct = (record.flags & SNAPSHOT_STRUCT) != 0;
+        type.isEnum = (record.flags & SNAPSHOT_ENUM) != 0;
+        type.isInterface = (record.flags & SNAPSHOT_INTERFACE) != 0;
+
+        type.fields.reserve(record.fieldCount);
+        for (const SnapshotFieldRecord& f : Fields(record)) {
+            FieldInfo& field = type.fields.emplace_back();
+            field.name.assign(String(f.name));
+            field.fieldType = symbol(f.fieldType);
+            field.isPublic = (f.flags & SNAPSHOT_PUBLIC) != 0;
+            field.isStatic = (f.flags & SNAPSHOT_STATIC) != 0;
+            field.isReadOnly = (f.flags & SNAPSHOT_READ_ONLY) != 0;
+        }
+
+        type.methods.reserve(record.methodCount);
+        for (const SnapshotMethodRecord& m : Methods(record)) {
+            MethodInfo& method = type.methods.emplace_back();
+            method.name.assign(String(m.name));
+            method.returnType = symbol(m.returnType);
+            method.isPublic = (m.flags & SNAPSHOT_PUBLIC) != 0;
+            method.isStatic = (m.flags & SNAPSHOT_STATIC) != 0;
+            method.parameters.reserve(m.parameterCount);
+            for (const SnapshotParameterRecord& p : Parameters(m)) {
+                ParameterInfo& param = method.parameters.emplace_back();
+                param.name.assign(String(p.name));
+                param.parameterType = symbol(p.parameterType);
+            }
+        }
+
+        type.properties.reserve(record.propertyCount);
+        for (const SnapshotPropertyRecord& p : Properties(record)) {
+            PropertyInfo& prop = type.properties.emplace_back();
+            prop.name.assign(String(p.name));
+            prop.propertyType = symbol(p.propertyType);
+            prop.canRead = (p.flags & SNAPSHOT_CAN_READ) != 0;
+            prop.canWrite = (p.flags & SNAPSHOT_CAN_WRITE) != 0;
+        }
+    }
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "arena.h"
+#include "reflection_data.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UnityReflection {
+
+// On-disk snapshot of an AssemblyData, laid out so it can be mapped and read in
+// place. Everything after the header is a flat array of 4-byte fields addressed
+// by offsets from the start of the file, so the file is position independent.
+// Every string (names and type names) is stored once in the string table and
+// referenced by its index; member records refer to their ranges in the global
+// member arrays. Little-endian only.
+//
+// The mod sends the same image over the pipe (MessageKind::AssemblyBinary), so
+// a received snapshot is read where it lands and saved as the cache unchanged.
+//
+//   header | string offsets | string chars | types | fields | methods | parameters | properties
+
+constexpr char SNAPSHOT_FILE_MAGIC[8] = {'U', 'R', 'V', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t SNAPSHOT_FILE_VERSION = 3; // 2: snapshotId, 3: moduleVersionId
+
+// Bits of the records' flags fields
+constexpr uint32_t SNAPSHOT_PUBLIC = 1u << 0;
+constexpr uint32_t SNAPSHOT_STATIC = 1u << 1;
+constexpr uint32_t SNAPSHOT_READ_ONLY = 1u << 2;
+constexpr uint32_t SNAPSHOT_CAN_READ = 1u << 3;
+constexpr uint32_t SNAPSHOT_CAN_WRITE = 1u << 4;
+constexpr uint32_t SNAPSHOT_CLASS = 1u << 5;
+constexpr uint32_t SNAPSHOT_STRUCT = 1u << 6;
+constexpr uint32_t SNAPSHOT_ENUM = 1u << 7;
+constexpr uint32_t SNAPSHOT_INTERFACE = 1u << 8;
+
+struct SnapshotSection {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct SnapshotFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark; // 0x01020304 as written by the host
+    uint64_t fileSize;
+    uint64_t checksum;      // SnapshotChecksum of everything after the header
+    uint32_t assemblyName;  // string ids
+    uint32_t timestamp;
+    uint32_t snapshotId;
+    uint32_t moduleVersionId;
+    SnapshotSection stringOffsets; // count = strings + 1; string i is [offset i, offset i+1 - 1)
+    SnapshotSection stringChars;   // each string followed by '\0'
+    SnapshotSection types;
+    SnapshotSection fields;
+    SnapshotSection methods;
+    SnapshotSection parameters;
+    SnapshotSection properties;
+};
+
+struct SnapshotTypeRecord {
+    uint32_t name;
+    uint32_t fullName;
+    uint32_t namespaceName;
+    uint32_t baseType;
+    uint32_t flags;
+    uint32_t firstField;
+    uint32_t fieldCount;
+    uint32_t firstMethod;
+    uint32_t methodCount;
+    uint32_t firstProperty;
+    uint32_t propertyCount;
+};
+
+struct SnapshotFieldRecord {
+    uint32_t name;
+    uint32_t fieldType;
+    uint32_t flags;
+};
+
+struct SnapshotMethodRecord {
+    uint32_t name;
+    uint32_t returnType;
+    uint32_t flags;
+    uint32_t firstParameter;
+    uint32_t parameterCount;
+};
+
+struct SnapshotParameterRecord {
+    uint32_t name;
+    uint32_t parameterType;
+};
+
+struct SnapshotPropertyRecord {
+    uint32_t name;
+    uint32_t propertyType;
+    uint32_t flags;
+};
+
+// Word-at-a-time hash used for the header checksum; fast enough to verify a
+// large snapshot on every open
+uint64_t SnapshotChecksum(const char* data, size_t size);
+
+// Builds the file incrementally, so types can be added as they are parsed and
+// dropped by the caller afterwards. Holds only the compact records.
+class SnapshotWriter {
+public:
+    void Clear();
+    // The assembly name, timestamp and ids of header; its types are not added
+    void SetHeader(const AssemblyData& header);
+
+    // symbols is the table the type's SymbolIds refer to
+    void AddType(const TypeInfo& type, const SymbolTable& symbols);
+    void AddAssemblyData(const AssemblyData& data);
+
+    // Appends the file image to out
+    void Serialize(std::string& out) const;
+
+    // Writes to a temporary file next to path and renames it over path, so a
+    // reader never sees a half-written snapshot
+    bool Save(const std::string& path) const;
+
+    size_t TypeCount() const { return types_.size(); }
+
+private:
+    uint32_t assemblyName_ = SymbolTable::EMPTY;
+    uint32_t timestamp_ = SymbolTable::EMPTY;
+    uint32_t snapshotId_ = SymbolTable::EMPTY;
+    uint32_t moduleVersionId_ = SymbolTable::EMPTY;
+    SymbolTable strings_;
+    std::vector<SnapshotTypeRecord> types_;
+    std::vector<SnapshotFieldRecord> fields_;
+    std::vector<SnapshotMethodRecord> methods_;
+    std::vector<SnapshotParameterRecord> parameters_;
+    std::vector<SnapshotPropertyRecord> properties_;
+};
+
+// Read-only view of a snapshot file mapped into memory, or of a snapshot received
+// over the pipe. Open() and Load() check the header, section bounds and checksum;
+// nothing is copied or converted, so accessors read straight from the bytes.
+class MappedSnapshot {
+public:
+    MappedSnapshot() = default;
+    ~MappedSnapshot();
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    bool Open(const std::string& path, bool verifyChecksum = true);
+
+    // Takes over a file image held in memory. Its data must be 8-byte aligned,
+    // as heap allocations are. Every index is bounds-checked whether or not the
+    // checksum is, so a bad image is rejected rather than read out of bounds.
+    bool Load(std::string bytes, bool verifyChecksum = true);
+
+    void Close();
+    bool IsOpen() const { return data_ != nullptr; }
+
+    std::string_view String(uint32_t id) const {
+        return std::string_view(chars_ + offsets_[id], offsets_[id + 1] - offsets_[id] - 1);
+    }
+    size_t StringCount() const { return stringCount_; }
+
+    std::string_view AssemblyName() const { return String(header_->assemblyName); }
+    std::string_view Timestamp() const { return String(header_->timestamp); }
+    std::string_view SnapshotId() const { return String(header_->snapshotId); }
+    std::string_view ModuleVersionId() const { return String(header_->moduleVersionId); }
+
+    ArenaArray<SnapshotTypeRecord> Types() const { return types_; }
+    ArenaArray<SnapshotFieldRecord> Fields(const SnapshotTypeRecord& type) const;
+    ArenaArray<SnapshotMethodRecord> Methods(const SnapshotTypeRecord& type) const;
+    ArenaArray<SnapshotPropertyRecord> Properties(const SnapshotTypeRecord& type) const;
+    ArenaArray<SnapshotParameterRecord> Parameters(const SnapshotMethodRecord& method) const;
+
+    // Owning copy for the UI, which patches its data with deltas and builds its
+    // indexes from it; type names are interned into data.symbols
+    void ToAssemblyData(AssemblyData& data) const;
+
+    size_t FileBytes() const { return size_; }
+
+    // Writes the bytes as they are, the way SnapshotWriter::Save does
+    bool Save(const std::string& path) const;
+
+private:
+    bool Validate(bool verifyChecksum);
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::string buffer_; // owns data_ after Load(); otherwise data_ is a mapping
+
+    const SnapshotFileHeader* header_ = nullptr;
+    const uint32_t* offsets_ = nullptr;
+    const char* chars_ = nullptr;
+    size_t stringCount_ = 0;
+    ArenaArray<SnapshotTypeRecord> types_;
+    const SnapshotFieldRecord* fields_ = nullptr;
+    const SnapshotMethodRecord* methods_ = nullptr;
+    const SnapshotParameterRecord* parameters_ = nullptr;
+    const SnapshotPropertyRecord* properties_ = nullptr;
+};
+
+} // namespace UnityReflection
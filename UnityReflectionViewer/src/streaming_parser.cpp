@@ -0,0 +1,183 @@
+#include "streaming_parser.h"
+#include <algorithm>
+
+namespace UnityReflection {
+
+StreamingParser::StreamingParser(TypeCallback onType) : onType_(std::move(onType)) {
+}
+
+void StreamingParser::Reset() {
+    mode_ = Mode::Header;
+    brackets_.clear();
+    inString_ = false;
+    escaped_ = false;
+    commaAllowed_ = false;
+    failed_ = false;
+    typesArrays_ = 0;
+    header_.clear();
+    element_.clear();
+    symbols_.Clear();
+    typesParsed_ = 0;
+    peakBufferBytes_ = 0;
+}
+
+bool StreamingParser::Feed(const char* data, size_t size) {
+    if (failed_) return false;
+
+    // Bytes from runStart on still have to be copied to header_ or element_
+    size_t runStart = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        const char c = data[i];
+
+        if (inString_) {
+            if (escaped_) escaped_ = false;
+            else if (c == '\\') escaped_ = true;
+            else if (c == '"') inString_ = false;
+            continue;
+        }
+
+        switch (mode_) {
+            case Mode::Header:
+                if (c == '"') {
+                    inString_ = true;
+                } else if (c == '{' || c == '[') {
+                    brackets_ += c;
+                    if (c == '[' && brackets_.size() == 2) {
+                        Flush(data, runStart, i);
+                        runStart = i;
+                        if (IsTypesArrayOpening()) {
+                            // The header keeps a placeholder array of one empty type,
+                            // which Finish uses to check the full parser would have
+                            // read this array as "types"; elements go to the callback
+                            header_ += "[{}]";
+                            typesArrays_++;
+                            runStart = i + 1;
+                            mode_ = Mode::Between;
+                            commaAllowed_ = false;
+                        }
+                    }
+                } else if (c == '}' || c == ']') {
+                    if (!Close(c)) return false;
+                    if (brackets_.empty()) {
+                        Flush(data, runStart, i + 1);
+                        runStart = i + 1;
+                        mode_ = Mode::Done;
+                    }
+                }
+                break;
+
+            // Mirrors the element loop of ParseTypesArray: whitespace, at most one
+            // comma after each element, and ']' at any point
+            case Mode::Between:
+                if (c == '{') {
+                    brackets_ += c;
+                    runStart = i;
+                    mode_ = Mode::Element;
+                } else if (c == ']') {
+                    brackets_.pop_back();
+                    runStart = i + 1;
+                    mode_ = Mode::Header;
+                } else if (c == ',' && commaAllowed_) {
+                    commaAllowed_ = false;
+                } else if (!IsSpace(c)) {
+                    failed_ = true;
+                    return false;
+                }
+                break;
+
+            case Mode::Element:
+                if (c == '"') {
+                    inString_ = true;
+                } else if (c == '{' || c == '[') {
+                    brackets_ += c;
+                } else if (c == '}' || c == ']') {
+                    if (!Close(c)) return false;
+                    if (brackets_.size() == 2) {
+                        Flush(data, runStart, i + 1);
+                        runStart = i + 1;
+                        if (!EmitElement()) {
+                            failed_ = true;
+                            return false;
+                        }
+                        mode_ = Mode::Between;
+                        commaAllowed_ = true;
+                    }
+                }
+                break;
+
+            // Only whitespace may follow the top-level object
+            case Mode::Done:
+                if (!IsSpace(c)) {
+                    failed_ = true;
+                    return false;
+                }
+                break;
+        }
+    }
+
+    Flush(data, runStart, size);
+    return true;
+}
+
+bool StreamingParser::Finish(AssemblyData& header) {
+    if (failed_ || mode_ != Mode::Done) return false;
+
+    // header_ parses exactly as the top-level object did in place, so one
+    // placeholder type per streamed array shows each was read as "types"
+    if (!ParseAssemblyDataExact(header_, header) || header.types.size() != typesArrays_) return false;
+    for (const TypeInfo& type : header.types) {
+        if (!type.fullName.empty() || !type.name.empty()) return false;
+    }
+    header.types.clear();
+    header.symbols = symbols_;
+    return true;
+}
+
+// A closing bracket must match the innermost opener
+bool StreamingParser::Close(char c) {
+    if (brackets_.empty() || brackets_.back() != (c == '}' ? '{' : '[')) {
+        failed_ = true;
+        return false;
+    }
+    brackets_.pop_back();
+    return true;
+}
+
+// True if header_ ends with the key "types" followed by a colon
+bool StreamingParser::IsTypesArrayOpening() const {
+    static const std::string key = "\"types\"";
+
+    size_t end = header_.size();
+    while (end > 0 && IsSpace(header_[end - 1])) end--;
+    if (end == 0 || header_[end - 1] != ':') return false;
+    end--;
+    while (end > 0 && IsSpace(header_[end - 1])) end--;
+
+    return end >= key.size() && header_.compare(end - key.size(), key.size(), key) == 0;
+}
+
+bool StreamingParser::EmitElement() {
+    elementIndex_.Build(element_.data(), element_.size());
+
+    TypeInfo type;
+    if (!ParseTypeInfo(element_, elementIndex_, symbols_, type)) return false;
+
+    element_.clear();
+    typesParsed_++;
+    if (onType_) onType_(std::move(type));
+    return true;
+}
+
+void StreamingParser::Flush(const char* data, size_t begin, size_t end) {
+    if (begin >= end) return;
+
+    if (mode_ == Mode::Header) {
+        header_.append(data + begin, end - begin);
+    } else if (mode_ == Mode::Element) {
+        element_.append(data + begin, end - begin);
+    }
+    peakBufferBytes_ = std::max(peakBufferBytes_, header_.capacity() + element_.capacity());
+}
+
+} // namespace UnityReflection
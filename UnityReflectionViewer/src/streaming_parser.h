@@ -0,0 +1,72 @@
+#pragma once
+
+#include "json_scanner.h"
+#include "reflection_data.h"
+#include <functional>
+#include <string>
+
+namespace UnityReflection {
+
+// Resumable parser fed with the payload in arbitrary chunks as it comes off the
+// pipe. Each element of the "types" array is parsed and handed to the callback as
+// soon as its closing brace arrives, so only the current element and the small
+// top-level object are ever buffered.
+class StreamingParser {
+public:
+    using TypeCallback = std::function<void(TypeInfo&& type)>;
+
+    explicit StreamingParser(TypeCallback onType);
+
+    // Returns false once the input is known to be malformed: a bracket that does
+    // not close its opener, an element that does not parse on its own, or
+    // anything but whitespace after the top-level object. Later calls are ignored.
+    bool Feed(const char* data, size_t size);
+
+    // Call after the last chunk. Fills assemblyName, timestamp and symbols (types were
+    // already delivered through the callback) and fails if the payload was incomplete.
+    // Succeeds only where ParseAssemblyData would, with the same result.
+    bool Finish(AssemblyData& header);
+
+    void Reset();
+
+    // Type names of the delivered types are ids into this table. It only grows, so
+    // the ids stay valid and new names are always appended at the end.
+    const SymbolTable& Symbols() const { return symbols_; }
+
+    size_t TypesParsed() const { return typesParsed_; }
+    size_t PeakBufferBytes() const { return peakBufferBytes_; }
+
+private:
+    enum class Mode {
+        Header,  // top-level object, copied to header_
+        Between, // inside "types", between elements
+        Element, // inside a type object, copied to element_
+        Done
+    };
+
+    static bool IsSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    bool IsTypesArrayOpening() const;
+    bool Close(char c);
+    bool EmitElement();
+    void Flush(const char* data, size_t begin, size_t end);
+
+    TypeCallback onType_;
+    Mode mode_ = Mode::Header;
+    std::string brackets_; // openers of the containers the input is inside
+    bool inString_ = false;
+    bool escaped_ = false;
+    bool commaAllowed_ = false;
+    bool failed_ = false;
+    size_t typesArrays_ = 0; // "types" arrays streamed, each a placeholder in header_
+
+    std::string header_;
+    std::string element_;
+    StructuralIndex elementIndex_;
+    SymbolTable symbols_;
+
+    size_t typesParsed_ = 0;
+    size_t peakBufferBytes_ = 0;
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,78 @@
+#include "symbol_table.h"
+#include <functional>
+
+namespace UnityReflection {
+
+namespace {
+
+constexpr size_t INITIAL_SLOTS = 1024;
+
+size_t HashOf(std::string_view s) {
+    return std::hash<std::string_view>()(s);
+}
+
+} // namespace
+
+SymbolTable::SymbolTable() {
+    Clear();
+}
+
+void SymbolTable::Clear() {
+    chars_.assign(1, '\0');
+    offsets_.assign({0, 1});
+    slots_.assign(INITIAL_SLOTS, Slot());
+    const size_t hash = HashOf(std::string_view());
+    slots_[FindSlot(std::string_view(), hash)] = {EMPTY, static_cast<uint32_t>(hash)};
+}
+
+// Slot holding s, or the free slot where it would go
+size_t SymbolTable::FindSlot(std::string_view s, size_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const Slot& entry = slots_[slot];
+        if (entry.id == NOT_FOUND) return slot;
+        if (entry.hash == static_cast<uint32_t>(hash) && Name(entry.id) == s) return slot;
+    }
+}
+
+SymbolId SymbolTable::Find(std::string_view s) const {
+    return slots_[FindSlot(s, HashOf(s))].id;
+}
+
+SymbolId SymbolTable::Intern(std::string_view s) {
+    const size_t hash = HashOf(s);
+    size_t slot = FindSlot(s, hash);
+    if (slots_[slot].id != NOT_FOUND) return slots_[slot].id;
+
+    const SymbolId id = static_cast<SymbolId>(Size());
+    chars_.append(s.data(), s.size());
+    chars_.push_back('\0');
+    offsets_.push_back(static_cast<uint32_t>(chars_.size()));
+
+    // Keep the load factor at or below one half
+    if ((Size() + 1) * 2 > slots_.size()) {
+        Grow();
+        slot = FindSlot(s, hash);
+    }
+    slots_[slot] = {id, static_cast<uint32_t>(hash)};
+    return id;
+}
+
+void SymbolTable::Grow() {
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    const size_t mask = slots_.size() - 1;
+    // The stored low 32 hash bits cover any realistic mask, so nothing is rehashed
+    for (const Slot& entry : old) {
+        if (entry.id == NOT_FOUND) continue;
+        size_t slot = entry.hash & mask;
+        while (slots_[slot].id != NOT_FOUND) slot = (slot + 1) & mask;
+        slots_[slot] = entry;
+    }
+}
+
+size_t SymbolTable::BytesUsed() const {
+    return chars_.capacity() + offsets_.capacity() * sizeof(uint32_t) + slots_.capacity() * sizeof(Slot);
+}
+
+} // namespace UnityReflection
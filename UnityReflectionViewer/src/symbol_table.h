@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UnityReflection {
+
+using SymbolId = uint32_t;
+
+// Interned strings of one snapshot, numbered densely in the order they were first
+// seen. All characters live in one buffer (each followed by a terminator, so
+// CStr() can go straight to ImGui) and the hash slots hold ids rather than
+// pointers, which keeps the table trivially copyable along with AssemblyData.
+// Id 0 is always the empty string, so default-initialized members read as "".
+class SymbolTable {
+public:
+    static constexpr SymbolId EMPTY = 0;
+    static constexpr SymbolId NOT_FOUND = UINT32_MAX;
+
+    SymbolTable();
+
+    // Id of s, adding it if it is new
+    SymbolId Intern(std::string_view s);
+
+    // Id of s, or NOT_FOUND; never adds
+    SymbolId Find(std::string_view s) const;
+
+    std::string_view Name(SymbolId id) const {
+        return std::string_view(chars_.data() + offsets_[id], offsets_[id + 1] - offsets_[id] - 1);
+    }
+    const char* CStr(SymbolId id) const { return chars_.data() + offsets_[id]; }
+
+    size_t Size() const { return offsets_.size() - 1; }
+
+    // Raw storage for serializers: every string followed by '\0', and Size() + 1
+    // offsets where symbol i spans [Offsets()[i], Offsets()[i + 1] - 1)
+    std::string_view Chars() const { return chars_; }
+    const std::vector<uint32_t>& Offsets() const { return offsets_; }
+
+    size_t BytesUsed() const;
+
+    void Clear();
+
+private:
+    // A slot keeps the low bits of its symbol's hash next to the id, so a probe
+    // only reads the symbol's characters when they are likely to match
+    struct Slot {
+        SymbolId id = NOT_FOUND; // NOT_FOUND marks a free slot
+        uint32_t hash = 0;
+    };
+
+    size_t FindSlot(std::string_view s, size_t hash) const;
+    void Grow();
+
+    std::string chars_;
+    std::vector<uint32_t> offsets_; // Size() + 1 entries; symbol i is [offsets_[i], offsets_[i + 1] - 1)
+    std::vector<Slot> slots_;       // open addressing
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace UnityReflection {
+
+// Fixed set of worker threads fed from one FIFO queue
+class ThreadPool {
+public:
+    // 0 = one thread per hardware thread; the caller of ParallelFor counts as one
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that run ParallelFor bodies, including the calling thread
+    unsigned ThreadCount() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Runs task on a worker at some later point
+    void Submit(std::function<void()> task);
+
+    // Calls body(i) for every i in [0, count) across the workers and the calling
+    // thread, and returns once all calls have finished
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    // Process-wide pool sized to the machine
+    static ThreadPool& Shared();
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,322 @@
+#include "type_list_index.h"
+#include "fuzzy_matcher.h"
+#include "json_scanner.h"
+#include <algorithm>
+
+namespace UnityReflection {
+
+namespace {
+
+char FoldChar(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+uint8_t KindBits(const TypeInfo& type) {
+    return (type.isClass ? TYPE_KIND_CLASS : 0) | (type.isStruct ? TYPE_KIND_STRUCT : 0) |
+           (type.isEnum ? TYPE_KIND_ENUM : 0) | (type.isInterface ? TYPE_KIND_INTERFACE : 0);
+}
+
+uint16_t Bigram(const char* s) {
+    return static_cast<uint16_t>((CharClass(s[0]) << 6) | CharClass(s[1]));
+}
+
+uint32_t Trigram(const char* s) {
+    return (static_cast<uint32_t>(CharClass(s[0])) << 12) | (static_cast<uint32_t>(CharClass(s[1])) << 6) |
+           CharClass(s[2]);
+}
+
+// Whether equal classes mean equal characters throughout folded text
+bool HasOwnClasses(std::string_view text) {
+    for (char c : text) {
+        if (CharClass(c) == 0) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void TypeListIndex::Clear() {
+    chars_.clear();
+    cased_.clear();
+    names_.clear();
+    kinds_.clear();
+    masks_.clear();
+    tails_.clear();
+    typeOfSlot_.clear();
+    slotOfType_.clear();
+    postings_.clear();
+    reordered_ = false;
+    Changed();
+}
+
+void TypeListIndex::Build(const AssemblyData& data) {
+    Clear();
+    const size_t count = data.types.size();
+    slotOfType_.resize(count);
+    size_t nameBytes = 0;
+    for (const TypeInfo& type : data.types) nameBytes += type.fullName.size() + 1;
+    chars_.reserve(nameBytes);
+    cased_.reserve(nameBytes);
+    names_.reserve(count);
+    kinds_.reserve(count);
+    masks_.reserve(count);
+    tails_.reserve(count);
+    typeOfSlot_.reserve(count);
+    for (size_t t = 0; t < count; t++) {
+        slotOfType_[t] = AddName(data.types[t], static_cast<uint32_t>(t));
+    }
+
+    // Counted first, as AddTrigrams lists them, so no list grows twice its size
+    std::vector<uint32_t> sizes(TRIGRAM_COUNT, 0);
+    std::vector<uint32_t> lastSlot(TRIGRAM_COUNT, NO_TYPE);
+    for (uint32_t slot = 0; slot < names_.size(); slot++) {
+        const std::string_view name = SlotName(slot);
+        for (size_t i = 0; i + 3 <= name.size(); i++) {
+            const uint32_t trigram = Trigram(name.data() + i);
+            if (lastSlot[trigram] != slot) {
+                lastSlot[trigram] = slot;
+                sizes[trigram]++;
+            }
+        }
+    }
+    postings_.resize(TRIGRAM_COUNT);
+    for (uint32_t trigram = 0; trigram < TRIGRAM_COUNT; trigram++) {
+        postings_[trigram].reserve(sizes[trigram]);
+    }
+    for (uint32_t slot = 0; slot < names_.size(); slot++) {
+        AddTrigrams(slot);
+    }
+    Changed();
+}
+
+void TypeListIndex::AppendTypes(const AssemblyData& data, size_t firstType) {
+    const size_t count = data.types.size();
+    slotOfType_.resize(count);
+    for (size_t t = firstType; t < count; t++) {
+        slotOfType_[t] = AddName(data.types[t], static_cast<uint32_t>(t));
+        AddTrigrams(slotOfType_[t]);
+    }
+    Changed();
+}
+
+void TypeListIndex::UpdateType(const AssemblyData& data, size_t typeIndex) {
+    if (typeIndex >= slotOfType_.size()) return;
+
+    // Deltas match types by full name, so the name is normally unchanged and
+    // only the kind is read again
+    const TypeInfo& type = data.types[typeIndex];
+    const uint32_t slot = slotOfType_[typeIndex];
+    const std::string_view name = SlotName(slot);
+    bool sameName = name.size() == type.fullName.size();
+    for (size_t i = 0; sameName && i < name.size(); i++) {
+        sameName = name[i] == FoldChar(type.fullName[i]);
+    }
+
+    if (sameName) {
+        kinds_[slot] = KindBits(type);
+    } else {
+        typeOfSlot_[slot] = NO_TYPE;
+        slotOfType_[typeIndex] = AddName(type, static_cast<uint32_t>(typeIndex));
+        AddTrigrams(slotOfType_[typeIndex]);
+        reordered_ = true;
+    }
+    Changed();
+}
+
+void TypeListIndex::RemoveType(size_t typeIndex, size_t movedFrom) {
+    if (movedFrom >= slotOfType_.size() || typeIndex > movedFrom) return;
+
+    typeOfSlot_[slotOfType_[typeIndex]] = NO_TYPE;
+    if (typeIndex != movedFrom) {
+        const uint32_t slot = slotOfType_[movedFrom];
+        typeOfSlot_[slot] = static_cast<uint32_t>(typeIndex);
+        slotOfType_[typeIndex] = slot;
+        reordered_ = true;
+    }
+    slotOfType_.pop_back();
+    Changed();
+}
+
+void TypeListIndex::Filter(std::string_view foldedQuery, uint8_t requiredKinds, std::vector<uint32_t>& out) {
+    out.clear();
+    if (foldedQuery.empty()) {
+        for (size_t t = 0; t < slotOfType_.size(); t++) {
+            if ((kinds_[slotOfType_[t]] & requiredKinds) == requiredKinds) out.push_back(static_cast<uint32_t>(t));
+        }
+        lastValid_ = false;
+        return;
+    }
+
+    // Every name containing the query contains any part of it, so the last
+    // query's matches hold all of this one's when it extends the last query.
+    // A one-character query, or three in a single trigram, is decided by the
+    // mask or the trigram list alone when its characters have classes of their own.
+    const bool narrow = lastValid_ && foldedQuery.find(lastQuery_) != std::string_view::npos;
+    const bool ownClasses = HasOwnClasses(foldedQuery);
+    scratch_.clear();
+    if (foldedQuery.size() >= 3) {
+        FindTrigrams(foldedQuery, narrow ? &lastSlots_ : nullptr, candidates_);
+        Check(foldedQuery, candidates_, ownClasses && foldedQuery.size() == 3, scratch_);
+    } else if (foldedQuery.size() == 2 && !(narrow && lastSlots_.size() < names_.size() / 8)) {
+        FindBigram(foldedQuery, candidates_);
+        Check(foldedQuery, candidates_, ownClasses, scratch_);
+    } else if (narrow) {
+        Check(foldedQuery, lastSlots_, ownClasses && foldedQuery.size() == 1, scratch_);
+    } else {
+        Scan(foldedQuery, scratch_);
+    }
+    lastQuery_.assign(foldedQuery.data(), foldedQuery.size());
+    lastSlots_.swap(scratch_);
+    lastValid_ = true;
+
+    for (uint32_t slot : lastSlots_) {
+        if ((kinds_[slot] & requiredKinds) == requiredKinds) out.push_back(typeOfSlot_[slot]);
+    }
+    if (reordered_) std::sort(out.begin(), out.end());
+}
+
+size_t TypeListIndex::FilterFuzzy(std::string_view query, uint8_t requiredKinds, size_t limit,
+                                  std::vector<uint32_t>& out, ThreadPool* pool) const {
+    out.clear();
+    const FuzzyMatcher matcher(query);
+    std::vector<FuzzyMatch> best;
+    const size_t matched = matcher.Rank(
+        masks_.data(), names_.size(),
+        [&](uint32_t slot) {
+            return typeOfSlot_[slot] != NO_TYPE && (kinds_[slot] & requiredKinds) == requiredKinds;
+        },
+        [&](uint32_t slot) { return std::string_view(cased_.data() + names_[slot].offset, names_[slot].length); },
+        limit, best, pool);
+    out.reserve(best.size());
+    for (const FuzzyMatch& match : best) out.push_back(typeOfSlot_[match.index]);
+    return matched;
+}
+
+size_t TypeListIndex::BytesUsed() const {
+    size_t bytes = chars_.capacity() + cased_.capacity() + names_.capacity() * sizeof(NameSpan) + kinds_.capacity() +
+                   masks_.capacity() * sizeof(uint64_t) + tails_.capacity() * sizeof(uint16_t) +
+                   bits_.capacity() * sizeof(uint64_t) +
+                   (typeOfSlot_.capacity() + slotOfType_.capacity()) * sizeof(uint32_t) +
+                   postings_.capacity() * sizeof(std::vector<uint32_t>);
+    for (const auto& list : postings_) bytes += list.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+void TypeListIndex::Fold(std::string_view text, std::string& out) {
+    out.resize(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        out[i] = FoldChar(text[i]);
+    }
+}
+
+uint32_t TypeListIndex::AddName(const TypeInfo& type, uint32_t typeIndex) {
+    const uint32_t slot = static_cast<uint32_t>(names_.size());
+    NameSpan span;
+    span.offset = static_cast<uint32_t>(chars_.size());
+    span.length = static_cast<uint32_t>(type.fullName.size());
+    names_.push_back(span);
+    kinds_.push_back(KindBits(type));
+    typeOfSlot_.push_back(typeIndex);
+
+    chars_ += type.fullName;
+    for (size_t i = span.offset; i < chars_.size(); i++) {
+        chars_[i] = FoldChar(chars_[i]);
+    }
+    chars_ += '\0';
+    cased_ += type.fullName;
+    cased_ += '\0';
+    masks_.push_back(CharMask(SlotName(slot)));
+    tails_.push_back(span.length >= 2 ? Bigram(chars_.data() + span.offset + span.length - 2) : NO_BIGRAM);
+    return slot;
+}
+
+void TypeListIndex::AddTrigrams(uint32_t slot) {
+    // A trigram the name has twice is listed once
+    if (postings_.empty()) postings_.resize(TRIGRAM_COUNT);
+    const std::string_view name = SlotName(slot);
+    for (size_t i = 0; i + 3 <= name.size(); i++) {
+        std::vector<uint32_t>& list = postings_[Trigram(name.data() + i)];
+        if (list.empty() || list.back() != slot) list.push_back(slot);
+    }
+}
+
+void TypeListIndex::Changed() {
+    lastValid_ = false;
+}
+
+void TypeListIndex::FindTrigrams(std::string_view foldedQuery, const std::vector<uint32_t>* within,
+                                 std::vector<uint32_t>& slots) const {
+    slots.clear();
+    if (postings_.empty()) return;
+
+    // Intersected shortest first, so the running result only shrinks from
+    // the smallest list
+    const std::vector<uint32_t>* lists[MAX_QUERY_TRIGRAMS + 1];
+    size_t listCount = 0;
+    if (within) lists[listCount++] = within;
+    for (size_t i = 0; i + 3 <= foldedQuery.size() && listCount < MAX_QUERY_TRIGRAMS; i++) {
+        const std::vector<uint32_t>* list = &postings_[Trigram(foldedQuery.data() + i)];
+        if (std::find(lists, lists + listCount, list) == lists + listCount) lists[listCount++] = list;
+    }
+    if (listCount == 0) return;
+    std::sort(lists, lists + listCount, [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+    slots = *lists[0];
+    for (size_t l = 1; l < listCount && !slots.empty(); l++) {
+        const std::vector<uint32_t>& list = *lists[l];
+        auto from = list.begin();
+        size_t kept = 0;
+        for (uint32_t slot : slots) {
+            // Galloping: lists of similar size are walked nearly in step, and a
+            // much longer one is skipped through in doubling strides
+            size_t step = 1;
+            while (step < static_cast<size_t>(list.end() - from) && from[step] < slot) step *= 2;
+            from = std::lower_bound(from + step / 2, from + std::min(step + 1, static_cast<size_t>(list.end() - from)), slot);
+            if (from == list.end()) break;
+            if (*from == slot) slots[kept++] = slot;
+        }
+        slots.resize(kept);
+    }
+}
+
+void TypeListIndex::FindBigram(std::string_view foldedQuery, std::vector<uint32_t>& slots) {
+    slots.clear();
+    if (postings_.empty()) return;
+
+    // The lists hold a name once per trigram, so they are merged through a
+    // bit per slot rather than a sort
+    const uint16_t bigram = Bigram(foldedQuery.data());
+    bits_.assign((names_.size() + 63) / 64, 0);
+    for (uint32_t next = 0; next < 64; next++) {
+        for (uint32_t slot : postings_[(static_cast<uint32_t>(bigram) << 6) | next]) {
+            bits_[slot / 64] |= uint64_t(1) << (slot % 64);
+        }
+    }
+    for (uint32_t slot = 0; slot < tails_.size(); slot++) {
+        if (tails_[slot] == bigram) bits_[slot / 64] |= uint64_t(1) << (slot % 64);
+    }
+
+    for (size_t word = 0; word < bits_.size(); word++) {
+        for (uint64_t bits = bits_[word]; bits != 0; bits &= bits - 1) {
+            slots.push_back(static_cast<uint32_t>(word * 64 + CountTrailingZeros(bits)));
+        }
+    }
+}
+
+void TypeListIndex::Scan(std::string_view foldedQuery, std::vector<uint32_t>& slots) const {
+    const uint64_t queryMask = CharMask(foldedQuery);
+    const bool exact = foldedQuery.size() == 1 && HasOwnClasses(foldedQuery);
+    for (uint32_t slot = 0; slot < names_.size(); slot++) {
+        if (Matches(slot, foldedQuery, queryMask, exact)) slots.push_back(slot);
+    }
+}
+
+void TypeListIndex::Check(std::string_view foldedQuery, const std::vector<uint32_t>& candidates, bool exact,
+                          std::vector<uint32_t>& slots) const {
+    const uint64_t queryMask = CharMask(foldedQuery);
+    for (uint32_t slot : candidates) {
+        if (Matches(slot, foldedQuery, queryMask, exact)) slots.push_back(slot);
+    }
+}
+
+} // namespace UnityReflection
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "reflection_data.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UnityReflection {
+
+// Bits of a type's kind, for TypeListIndex::Filter
+constexpr uint8_t TYPE_KIND_CLASS = 1u << 0;
+constexpr uint8_t TYPE_KIND_STRUCT = 1u << 1;
+constexpr uint8_t TYPE_KIND_ENUM = 1u << 2;
+constexpr uint8_t TYPE_KIND_INTERFACE = 1u << 3;
+
+// What the type list filters on, kept apart from the TypeInfos: each type's
+// full name lowercased (ASCII) and its kind bits, plus a trigram index over
+// the names. Built once per snapshot and kept in step with progressive loads
+// and deltas like MemberStore, so the list is filtered without folding a name
+// or touching a TypeInfo.
+//
+// Names live in slots, numbered in the order they were added, and the index
+// maps each trigram to the ascending slots whose name has it. A query of three
+// characters or more is answered by intersecting its trigrams' lists and
+// checking the few candidates. Two characters are found in the lists of the
+// trigrams that start with them, plus each name's last two characters; one by
+// a mask per name of the characters it has. A delta moves types between slots
+// only through the slot/type maps, so the lists never need rebuilding.
+class TypeListIndex {
+public:
+    void Clear();
+
+    // Sizes every trigram list exactly before filling it
+    void Build(const AssemblyData& data);
+
+    // Adds data.types[firstType..], which must directly follow the types added so far
+    void AppendTypes(const AssemblyData& data, size_t firstType);
+
+    // Re-reads a type a delta replaced. A renamed type gets a new slot; the
+    // old one stays behind unreferenced.
+    void UpdateType(const AssemblyData& data, size_t typeIndex);
+
+    // Follows a swap-and-pop removal from AssemblyData::types
+    void RemoveType(size_t typeIndex, size_t movedFrom);
+
+    // Replaces out with the indices, in type order, of the types that have
+    // every kind bit in requiredKinds and whose folded name contains
+    // foldedQuery (everything when it is empty). The matches of the last query
+    // are kept until the types change, so a query that extends it (the user
+    // typing on) only checks those.
+    void Filter(std::string_view foldedQuery, uint8_t requiredKinds, std::vector<uint32_t>& out);
+
+    // Replaces out with the indices of the limit types with every kind bit in
+    // requiredKinds whose names best match query as a FuzzyMatcher, best
+    // first, and returns how many matched in all. Names are ranked on pool
+    // when one is given.
+    size_t FilterFuzzy(std::string_view query, uint8_t requiredKinds, size_t limit, std::vector<uint32_t>& out,
+                       ThreadPool* pool) const;
+
+    std::string_view FoldedName(size_t typeIndex) const { return SlotName(slotOfType_[typeIndex]); }
+
+    size_t TypeCount() const { return slotOfType_.size(); }
+    size_t BytesUsed() const;
+
+    // ASCII lowercase, as names are folded
+    static void Fold(std::string_view text, std::string& out);
+
+private:
+    static constexpr uint32_t NO_TYPE = UINT32_MAX;
+    static constexpr uint32_t TRIGRAM_COUNT = 64 * 64 * 64; // 6 bits per character class
+    static constexpr uint16_t NO_BIGRAM = UINT16_MAX;
+    static constexpr size_t MAX_QUERY_TRIGRAMS = 16; // enough to narrow; the rest is checked
+
+    struct NameSpan {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    std::string_view SlotName(uint32_t slot) const {
+        return std::string_view(chars_.data() + names_[slot].offset, names_[slot].length);
+    }
+
+    // A slot is added in two steps so Build can size the lists in between
+    uint32_t AddName(const TypeInfo& type, uint32_t typeIndex);
+    void AddTrigrams(uint32_t slot);
+    void Changed();
+
+    // Whether a live slot's name contains foldedQuery, whose character
+    // classes are queryMask; exact when they alone decide it
+    bool Matches(uint32_t slot, std::string_view foldedQuery, uint64_t queryMask, bool exact) const {
+        if (typeOfSlot_[slot] == NO_TYPE || (masks_[slot] & queryMask) != queryMask) return false;
+        return exact || SlotName(slot).find(foldedQuery) != std::string_view::npos;
+    }
+
+    // Slots that have every trigram of foldedQuery (at least three
+    // characters), ascending, and are in within when it is not null. Empty
+    // when there is neither a trigram nor within to narrow down.
+    void FindTrigrams(std::string_view foldedQuery, const std::vector<uint32_t>* within,
+                      std::vector<uint32_t>& slots) const;
+
+    // Slots that have the two characters of foldedQuery in a row, ascending
+    void FindBigram(std::string_view foldedQuery, std::vector<uint32_t>& slots);
+
+    // Live slots whose name contains foldedQuery, ascending: over every name,
+    // or over candidates. exact is for candidates known to hold the query.
+    void Scan(std::string_view foldedQuery, std::vector<uint32_t>& slots) const;
+    void Check(std::string_view foldedQuery, const std::vector<uint32_t>& candidates, bool exact,
+               std::vector<uint32_t>& slots) const;
+
+    std::string chars_;                 // folded names, each followed by '\0'
+    std::string cased_;                 // the same names as written, for fuzzy scoring
+    std::vector<NameSpan> names_;       // by slot
+    std::vector<uint8_t> kinds_;        // by slot
+    std::vector<uint64_t> masks_;       // by slot, a bit per character class in the name
+    std::vector<uint16_t> tails_;       // by slot, the bigram the name ends with (NO_BIGRAM if none)
+    std::vector<uint32_t> typeOfSlot_;  // NO_TYPE once the slot's type is gone
+    std::vector<uint32_t> slotOfType_;
+    std::vector<std::vector<uint32_t>> postings_; // by trigram, TRIGRAM_COUNT once a name is added
+    bool reordered_ = false; // a delta moved types, so slot order is not type order
+
+    // The last query's matching slots, for narrowing
+    std::string lastQuery_;
+    std::vector<uint32_t> lastSlots_;
+    bool lastValid_ = false;
+    std::vector<uint32_t> scratch_;
+    std::vector<uint32_t> candidates_;
+    std::vector<uint64_t> bits_; // a bit per slot, for FindBigram
+};
+
+} // namespace UnityReflection
@@ -1,19 +1,71 @@
 #include "main_window.h"
+#include "../thread_pool.h"
 #include <imgui.h>
 #include <algorithm>
+#include <climits>
 #include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
 
 namespace UnityReflection {
 namespace UI {
 
+namespace {
+
+// The details pane's member tabs, as currentTab_ numbers them. Flag columns
+// follow MemberTable's for the kind.
+struct MemberTabLayout {
+    const char* table;
+    MemberKind kind;
+    const char* textColumn;
+    ImVec4 textColor;
+    const char* flagColumns[3];
+    float flagWidths[3];
+};
+
+const MemberTabLayout MEMBER_TABS[] = {
+    {"FieldsTable", MemberKind::Field, "Type", ImVec4(0.6f, 0.6f, 1.0f, 1.0f),
+     {"Public", "Static", "ReadOnly"}, {60.0f, 60.0f, 70.0f}},
+    {"MethodsTable", MemberKind::Method, "Signature", ImVec4(0.8f, 0.8f, 0.6f, 1.0f),
+     {"Public", "Static"}, {60.0f, 60.0f}},
+    {"PropertiesTable", MemberKind::Property, "Type", ImVec4(0.6f, 1.0f, 0.6f, 1.0f),
+     {"Get", "Set"}, {50.0f, 50.0f}},
+};
+
+} // namespace
+
 MainWindow::MainWindow() {
+    fetcher_.SetSender([this](const std::string& payload) {
+        return ipcClient_ && ipcClient_->Send(MessageKind::MemberRequest, payload);
+    });
 }
 
 MainWindow::~MainWindow() {
+    // A member search build publishes to updates_ when it finishes, and a
+    // reclaim frees its retired updates
+    while (memberSearchBuilding_.load(std::memory_order_acquire) ||
+           reclaimTasks_.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void MainWindow::SetAssemblyData(AssemblyData data) {
+    Update update;
+    update.kind = Update::Kind::Snapshot;
+    update.data = std::move(data);
+    update.typeList.Build(update.data);
+    update.members.Build(update.data);
+    updates_.Publish(std::move(update));
 }
 
-void MainWindow::SetAssemblyData(const AssemblyData& data) {
-    assemblyData_ = data;
+void MainWindow::ResetViews() {
+    typeListStale_ = true;
+    membersGeneration_++;
+    memberSearchReady_ = false;
+    memberSearchStale_ = true;
+    memberSearchResult_.Clear();
+    deltaApplier_.Reset();
     selectedTypeIndex_ = -1;
 
     // Calculate stats
@@ -23,14 +75,289 @@ void MainWindow::SetAssemblyData(const AssemblyData& data) {
     totalInterfaces_ = 0;
 
     for (const auto& type : assemblyData_.types) {
-        if (type.isClass) totalClasses_++;
-        if (type.isStruct) totalStructs_++;
-        if (type.isEnum) totalEnums_++;
-        if (type.isInterface) totalInterfaces_++;
+        CountType(type);
     }
 }
 
+void MainWindow::BeginAssemblyData(size_t expectedTypes) {
+    Update update;
+    update.kind = Update::Kind::Begin;
+    update.progress.typesTotal = static_cast<uint32_t>(expectedTypes);
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::AppendTypes(std::vector<TypeInfo> types, std::vector<std::string> newSymbols) {
+    Update update;
+    update.kind = Update::Kind::Types;
+    update.types = std::move(types);
+    update.symbols = std::move(newSymbols);
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::EndAssemblyData(const AssemblyData& header) {
+    Update update;
+    update.kind = Update::Kind::End;
+    update.data.assemblyName = header.assemblyName;
+    update.data.timestamp = header.timestamp;
+    update.data.moduleVersionId = header.moduleVersionId;
+    update.data.snapshotId = header.snapshotId;
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::FailAssemblyData() {
+    Update update;
+    update.kind = Update::Kind::Failed;
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::SetLazyAssembly(LazyAssembly lazy, AssemblyData headers) {
+    Update update;
+    update.kind = Update::Kind::Snapshot;
+    update.data = std::move(headers);
+    update.lazy = std::move(lazy);
+    update.typeList.Build(update.data);
+    update.members.Build(update.data);
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::SetQueryHeaders(AssemblyData headers) {
+    Update update;
+    update.kind = Update::Kind::Snapshot;
+    update.data = std::move(headers);
+    update.typeList.Build(update.data);
+    update.members.Build(update.data);
+    update.query = true;
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::ApplyMembers(MemberResponse response) {
+    Update update;
+    update.kind = Update::Kind::Members;
+    update.response = std::move(response);
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::ApplyDelta(AssemblyDelta delta) {
+    Update update;
+    update.kind = Update::Kind::Delta;
+    update.delta = std::move(delta);
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::SetReflectionProgress(ReflectionProgress progress) {
+    Update update;
+    update.kind = Update::Kind::Progress;
+    update.progress = progress;
+    updates_.Publish(std::move(update));
+}
+
+void MainWindow::SetIPCClient(IPCClient* client) {
+    ipcClient_ = client;
+}
+
+// Frees retired updates on a worker. Publish frees them as well, but only
+// when the next update arrives, which may be much later. With no workers
+// Submit runs it inline here.
+void MainWindow::ReclaimOnWorker() {
+    reclaimTasks_.fetch_add(1, std::memory_order_relaxed);
+    ThreadPool::Shared().Submit([this]() {
+        updates_.Reclaim();
+        reclaimTasks_.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+void MainWindow::ApplyPendingData() {
+    // Take retires the updates of the last frame, and with them the snapshot
+    // a Snapshot or Begin among them replaced, which is worth freeing at once
+    const std::vector<Update*>& updates = updates_.Take();
+    if (replacedData_) {
+        replacedData_ = false;
+        ReclaimOnWorker();
+    }
+
+    // Whatever came before the last snapshot, load or failed load is replaced
+    // by it anyway
+    size_t first = 0;
+    for (size_t i = 0; i < updates.size(); i++) {
+        const Update::Kind kind = updates[i]->kind;
+        if (kind == Update::Kind::Snapshot || kind == Update::Kind::Begin || kind == Update::Kind::Failed) {
+            first = i;
+            replacedData_ = true;
+        }
+    }
+
+    for (size_t i = first; i < updates.size(); i++) {
+        ApplyUpdate(*updates[i]);
+    }
+}
+
+// The data an update replaces is swapped into it rather than destroyed here,
+// so it is freed on the thread that reclaims the update
+void MainWindow::ApplyUpdate(Update& update) {
+    switch (update.kind) {
+        case Update::Kind::Snapshot:
+            std::swap(assemblyData_, update.data);
+            std::swap(lazy_, update.lazy);
+            std::swap(typeList_, update.typeList);
+            std::swap(members_, update.members);
+            if (update.query) {
+                fetcher_.Reset(assemblyData_.types.size());
+            } else {
+                fetcher_.Clear();
+            }
+            ResetViews();
+            loading_ = false;
+            loadFailed_ = false;
+            progress_ = ReflectionProgress();
+            break;
+
+        case Update::Kind::Begin:
+            std::swap(assemblyData_, update.data);
+            std::swap(lazy_, update.lazy);
+            std::swap(typeList_, update.typeList);
+            std::swap(members_, update.members);
+            fetcher_.Clear();
+            ResetViews();
+            loading_ = true;
+            loadFailed_ = false;
+            progress_ = update.progress;
+            break;
+
+        case Update::Kind::Types: {
+            // The parser's table only grows, so appending its new names in
+            // order reproduces its ids here
+            for (const auto& symbol : update.symbols) {
+                assemblyData_.symbols.Intern(symbol);
+            }
+            const size_t firstNew = assemblyData_.types.size();
+            if (firstNew == 0) {
+                std::swap(assemblyData_.types, update.types);
+                for (const auto& type : assemblyData_.types) CountType(type);
+            } else {
+                for (auto& type : update.types) {
+                    CountType(type);
+                    assemblyData_.types.push_back(std::move(type));
+                }
+            }
+            members_.AppendTypes(assemblyData_, firstNew);
+            typeList_.AppendTypes(assemblyData_, firstNew);
+            typeListStale_ = true;
+            memberSearchStale_ = true;
+            break;
+        }
+
+        case Update::Kind::End:
+            assemblyData_.assemblyName = std::move(update.data.assemblyName);
+            assemblyData_.timestamp = std::move(update.data.timestamp);
+            assemblyData_.moduleVersionId = std::move(update.data.moduleVersionId);
+            assemblyData_.snapshotId = std::move(update.data.snapshotId);
+            loading_ = false;
+            progress_ = ReflectionProgress();
+            break;
+
+        case Update::Kind::Failed:
+            // The partial types would pass for a snapshot, one without a name or id
+            std::swap(assemblyData_, update.data);
+            std::swap(typeList_, update.typeList);
+            std::swap(members_, update.members);
+            ResetViews();
+            loading_ = false;
+            loadFailed_ = true;
+            progress_ = ReflectionProgress();
+            break;
+
+        case Update::Kind::Delta:
+            // Made against the snapshot before it; one still loading is not it.
+            // Query-mode headers carry no snapshot id, so none applies to them.
+            progress_ = ReflectionProgress();
+            if (loading_ || fetcher_.IsActive()) break;
+            changes_.clear();
+            if (deltaApplier_.Apply(std::move(update.delta), assemblyData_, changes_)) {
+                ApplyChanges(changes_);
+            }
+            changes_.clear();
+            break;
+
+        case Update::Kind::Members:
+            fetched_.clear();
+            fetcher_.Apply(update.response, assemblyData_, fetched_);
+            for (uint32_t index : fetched_) members_.UpdateType(assemblyData_, index);
+            memberSearchStale_ = memberSearchStale_ || !fetched_.empty();
+            break;
+
+        case Update::Kind::Progress:
+            progress_ = update.progress;
+            break;
+
+        case Update::Kind::MemberSearch:
+            // One built before members_ was last rebuilt names rows it no longer has
+            if (update.generation != membersGeneration_) break;
+            std::swap(memberSearch_, update.memberSearch);
+            memberSearchReady_ = true;
+            memberSearchResultStale_ = true;
+            break;
+    }
+}
+
+// Brings the member store, lazy state, stats and selection in line with the
+// steps DeltaApplier took; only changed types are touched
+void MainWindow::ApplyChanges(const std::vector<TypeChange>& changes) {
+    size_t firstAdded = assemblyData_.types.size();
+    for (const TypeChange& change : changes) {
+        switch (change.kind) {
+            case TypeChange::Kind::Removed:
+                CountType(change.previous, -1);
+                members_.RemoveType(change.index, change.movedFrom);
+                typeList_.RemoveType(change.index, change.movedFrom);
+                lazy_.RemoveType(change.index, change.movedFrom);
+                if (selectedTypeIndex_ == static_cast<int>(change.index)) {
+                    selectedTypeIndex_ = -1;
+                } else if (selectedTypeIndex_ == static_cast<int>(change.movedFrom)) {
+                    selectedTypeIndex_ = static_cast<int>(change.index);
+                }
+                break;
+
+            case TypeChange::Kind::Replaced:
+                CountType(change.previous, -1);
+                CountType(assemblyData_.types[change.index]);
+                lazy_.MarkReplaced(change.index);
+                members_.UpdateType(assemblyData_, change.index);
+                typeList_.UpdateType(assemblyData_, change.index);
+                break;
+
+            case TypeChange::Kind::Added:
+                CountType(assemblyData_.types[change.index]);
+                firstAdded = std::min<size_t>(firstAdded, change.index);
+                break;
+        }
+    }
+    members_.AppendTypes(assemblyData_, firstAdded);
+    typeList_.AppendTypes(assemblyData_, firstAdded);
+    typeListStale_ = true;
+    memberSearchStale_ = true;
+}
+
+void MainWindow::EnsureMembers(size_t typeIndex) {
+    if (fetcher_.IsActive()) {
+        fetcher_.Request(typeIndex);
+        return;
+    }
+    if (lazy_.Materialize(typeIndex, assemblyData_)) {
+        members_.UpdateType(assemblyData_, typeIndex);
+        memberSearchStale_ = true;
+    }
+}
+
+void MainWindow::CountType(const TypeInfo& type, int step) {
+    if (type.isClass) totalClasses_ += step;
+    if (type.isStruct) totalStructs_ += step;
+    if (type.isEnum) totalEnums_ += step;
+    if (type.isInterface) totalInterfaces_ += step;
+}
+
 void MainWindow::Render() {
+    ApplyPendingData();
+
     ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowSize(ImVec2(1280, 720), ImGuiCond_FirstUseEver);
 
@@ -45,6 +372,8 @@ void MainWindow::Render() {
             if (ImGui::BeginMenu("View")) {
                 ImGui::MenuItem("Show Public Only", nullptr, &showPublicOnly_);
                 ImGui::MenuItem("Show Inherited Members", nullptr, &showInheritedMembers_);
+                ImGui::Separator();
+                ImGui::MenuItem("Member Search", nullptr, &showMemberSearch_);
                 ImGui::EndMenu();
             }
             ImGui::EndMenuBar();
@@ -64,6 +393,11 @@ void MainWindow::Render() {
         ImGui::EndChild();
     }
     ImGui::End();
+
+    if (showMemberSearch_) RenderMemberSearch();
+
+    // Whatever this frame asked for goes out in one batch
+    fetcher_.Flush(MemberFetcher::Clock::now());
 }
 
 void MainWindow::RenderConnectionStatus() {
@@ -80,6 +414,68 @@ void MainWindow::RenderConnectionStatus() {
         ImGui::Text("| Last update: %s", assemblyData_.timestamp.c_str());
     }
 
+    if (loading_ && progress_.typesTotal > 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "| Loading... %zu/%u types", assemblyData_.types.size(),
+                           progress_.typesTotal);
+    } else if (loading_) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "| Loading...");
+    } else if (progress_.typesTotal > 0 && ipcClient_ && ipcClient_->IsConnected()) {
+        // Building a binary snapshot or a delta, which arrives whole
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "| Game reflecting: %u/%u types", progress_.typesDone,
+                           progress_.typesTotal);
+    }
+
+    if (loadFailed_) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "| Load failed: the snapshot did not arrive whole");
+    }
+
+    if (lazy_.IsLoaded()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("| Members decoded: %zu/%zu", lazy_.MaterializedCount(), assemblyData_.types.size());
+    }
+    if (lazy_.MalformedCount() > 0) {
+        // The headers parsed but these types' members did not, so the payload
+        // is damaged and may not parse in full
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "| Malformed members in %zu types",
+                           lazy_.MalformedCount());
+    }
+
+    if (fetcher_.IsActive()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("| Members fetched: %zu/%zu (%zu requests in flight)", fetcher_.FetchedCount(),
+                            assemblyData_.types.size(), fetcher_.InFlightCount());
+    }
+
+    if (ipcClient_) {
+        const ConnectionState state = ipcClient_->GetState();
+        const ImVec4 color = state == ConnectionState::Streaming  ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f)
+                             : state == ConnectionState::Connecting ? ImVec4(1.0f, 0.8f, 0.0f, 1.0f)
+                                                                    : ImVec4(1.0f, 0.4f, 0.4f, 1.0f);
+        ImGui::TextColored(color, "Pipe: %s", ConnectionStateName(state));
+
+        const IPCMetrics metrics = ipcClient_->GetMetrics();
+        if (metrics.connectToFirstByteMs >= 0.0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("| Connect to first byte: %.1f ms", metrics.connectToFirstByteMs);
+        }
+        if (metrics.firstByteToParsedMs >= 0.0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("| First byte to parsed: %.1f ms", metrics.firstByteToParsedMs);
+        }
+        if (metrics.lastWireBytes > 0 && metrics.lastWireBytes < metrics.lastPayloadBytes) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("| LZ4 %.1fx", static_cast<double>(metrics.lastPayloadBytes) / metrics.lastWireBytes);
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("| Payloads: %llu (dropped %llu)", static_cast<unsigned long long>(metrics.payloads),
+                            static_cast<unsigned long long>(metrics.droppedPayloads));
+    }
+
     ImGui::Separator();
 }
 
@@ -94,84 +490,114 @@ void MainWindow::RenderTypeList() {
     ImGui::Separator();
 
     // Filter buttons
-    static bool filterClasses = false;
-    static bool filterStructs = false;
-    static bool filterEnums = false;
-    static bool filterInterfaces = false;
-
-    ImGui::Checkbox("Classes", &filterClasses); ImGui::SameLine();
-    ImGui::Checkbox("Structs", &filterStructs); ImGui::SameLine();
-    ImGui::Checkbox("Enums", &filterEnums); ImGui::SameLine();
-    ImGui::Checkbox("Interfaces", &filterInterfaces);
+    ImGui::Checkbox("Classes", &filterClasses_); ImGui::SameLine();
+    ImGui::Checkbox("Structs", &filterStructs_); ImGui::SameLine();
+    ImGui::Checkbox("Enums", &filterEnums_); ImGui::SameLine();
+    ImGui::Checkbox("Interfaces", &filterInterfaces_); ImGui::SameLine();
+    ImGui::Checkbox("Fuzzy", &fuzzySearch_);
+
+    // Filtered again only when the search, the filters or the data change.
+    // A fuzzy search lists its best matches, best first.
+    TypeListIndex::Fold(searchBuffer_, foldedSearch_);
+    const uint8_t kinds = (filterClasses_ ? TYPE_KIND_CLASS : 0) | (filterStructs_ ? TYPE_KIND_STRUCT : 0) |
+                          (filterEnums_ ? TYPE_KIND_ENUM : 0) | (filterInterfaces_ ? TYPE_KIND_INTERFACE : 0);
+    const bool fuzzy = fuzzySearch_ && !foldedSearch_.empty();
+    if (typeListStale_ || kinds != filteredKinds_ || foldedSearch_ != filteredQuery_ || fuzzy != filteredFuzzy_) {
+        if (fuzzy) {
+            fuzzyMatched_ = typeList_.FilterFuzzy(searchBuffer_, kinds, FUZZY_TYPE_LIMIT, visibleTypes_,
+                                                  &ThreadPool::Shared());
+        } else {
+            typeList_.Filter(foldedSearch_, kinds, visibleTypes_);
+        }
+        filteredQuery_ = foldedSearch_;
+        filteredKinds_ = kinds;
+        filteredFuzzy_ = fuzzy;
+        typeListStale_ = false;
+    }
+    if (fuzzy && fuzzyMatched_ > visibleTypes_.size()) {
+        ImGui::TextDisabled("Best %zu of %zu matches", visibleTypes_.size(), fuzzyMatched_);
+    }
 
     ImGui::Separator();
 
-    // Type list
+    // Type list; only the rows in view are submitted
     ImGui::BeginChild("TypeListScroll");
 
-    std::string searchStr = searchBuffer_;
-    std::transform(searchStr.begin(), searchStr.end(), searchStr.begin(), ::tolower);
-
-    for (size_t i = 0; i < assemblyData_.types.size(); i++) {
-        const auto& type = assemblyData_.types[i];
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(visibleTypes_.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            RenderTypeRow(visibleTypes_[row]);
+        }
+    }
+    clipper.End();
 
-        // Apply filters
-        if (filterClasses && !type.isClass) continue;
-        if (filterStructs && !type.isStruct) continue;
-        if (filterEnums && !type.isEnum) continue;
-        if (filterInterfaces && !type.isInterface) continue;
+    ImGui::EndChild();
 
-        // Apply search filter
-        if (!searchStr.empty()) {
-            std::string typeName = type.fullName;
-            std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::tolower);
-            if (typeName.find(searchStr) == std::string::npos) {
-                continue;
-            }
+    // Query mode: fetch the types around the selection, or the first matches of
+    // a search, before they are clicked. visibleTypes_ is in type order unless
+    // ranked by a fuzzy search, which keeps it short.
+    if (fetcher_.IsActive()) {
+        size_t selectedPosition = 0;
+        bool selectedVisible = false;
+        if (selectedTypeIndex_ >= 0) {
+            const uint32_t selected = static_cast<uint32_t>(selectedTypeIndex_);
+            auto it = filteredFuzzy_ ? std::find(visibleTypes_.begin(), visibleTypes_.end(), selected)
+                                     : std::lower_bound(visibleTypes_.begin(), visibleTypes_.end(), selected);
+            selectedVisible = it != visibleTypes_.end() && *it == selected;
+            if (selectedVisible) selectedPosition = static_cast<size_t>(it - visibleTypes_.begin());
         }
-
-        // Determine icon based on type
-        const char* icon = "?";
-        ImVec4 color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
-
-        if (type.isClass) {
-            icon = "C";
-            color = ImVec4(0.3f, 0.8f, 1.0f, 1.0f);
-        } else if (type.isStruct) {
-            icon = "S";
-            color = ImVec4(0.8f, 0.8f, 0.3f, 1.0f);
-        } else if (type.isEnum) {
-            icon = "E";
-            color = ImVec4(0.8f, 0.3f, 0.8f, 1.0f);
-        } else if (type.isInterface) {
-            icon = "I";
-            color = ImVec4(0.3f, 1.0f, 0.3f, 1.0f);
+        if (selectedVisible || !foldedSearch_.empty()) {
+            fetcher_.Prefetch(visibleTypes_, selectedPosition);
         }
+    }
+}
 
-        ImGui::PushStyleColor(ImGuiCol_Text, color);
-        ImGui::Text("[%s]", icon);
-        ImGui::PopStyleColor();
+void MainWindow::RenderTypeRow(uint32_t typeIndex) {
+    const auto& type = assemblyData_.types[typeIndex];
+
+    // Determine icon based on type
+    const char* icon = "?";
+    ImVec4 color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+
+    if (type.isClass) {
+        icon = "C";
+        color = ImVec4(0.3f, 0.8f, 1.0f, 1.0f);
+    } else if (type.isStruct) {
+        icon = "S";
+        color = ImVec4(0.8f, 0.8f, 0.3f, 1.0f);
+    } else if (type.isEnum) {
+        icon = "E";
+        color = ImVec4(0.8f, 0.3f, 0.8f, 1.0f);
+    } else if (type.isInterface) {
+        icon = "I";
+        color = ImVec4(0.3f, 1.0f, 0.3f, 1.0f);
+    }
 
-        ImGui::SameLine();
+    ImGui::PushID(static_cast<int>(typeIndex));
+    ImGui::PushStyleColor(ImGuiCol_Text, color);
+    ImGui::Text("[%s]", icon);
+    ImGui::PopStyleColor();
 
-        if (ImGui::Selectable(type.fullName.c_str(), selectedTypeIndex_ == static_cast<int>(i))) {
-            selectedTypeIndex_ = static_cast<int>(i);
-            currentTab_ = 0; // Reset to first tab
-        }
+    ImGui::SameLine();
 
-        // Tooltip with additional info
-        if (ImGui::IsItemHovered()) {
-            ImGui::BeginTooltip();
-            ImGui::Text("Name: %s", type.name.c_str());
-            ImGui::Text("Namespace: %s", type.namespaceName.c_str());
-            ImGui::Text("Base Type: %s", type.baseType.c_str());
-            ImGui::Text("Fields: %zu | Methods: %zu | Properties: %zu",
-                       type.fields.size(), type.methods.size(), type.properties.size());
-            ImGui::EndTooltip();
-        }
+    if (ImGui::Selectable(type.fullName.c_str(), selectedTypeIndex_ == static_cast<int>(typeIndex))) {
+        selectedTypeIndex_ = static_cast<int>(typeIndex);
+        currentTab_ = 0; // Reset to first tab
     }
 
-    ImGui::EndChild();
+    // Tooltip with additional info
+    if (ImGui::IsItemHovered()) {
+        EnsureMembers(typeIndex);
+        ImGui::BeginTooltip();
+        ImGui::Text("Name: %s", type.name.c_str());
+        ImGui::Text("Namespace: %s", type.namespaceName.c_str());
+        ImGui::Text("Base Type: %s", assemblyData_.symbols.CStr(type.baseType));
+        ImGui::Text("Fields: %zu | Methods: %zu | Properties: %zu",
+                   type.fields.size(), type.methods.size(), type.properties.size());
+        ImGui::EndTooltip();
+    }
+    ImGui::PopID();
 }
 
 void MainWindow::RenderTypeDetails() {
@@ -180,6 +606,7 @@ void MainWindow::RenderTypeDetails() {
         return;
     }
 
+    EnsureMembers(selectedTypeIndex_);
     const auto& type = assemblyData_.types[selectedTypeIndex_];
 
     // Type header
@@ -188,7 +615,7 @@ void MainWindow::RenderTypeDetails() {
 
     // Type info
     ImGui::Text("Namespace: %s", type.namespaceName.empty() ? "(global)" : type.namespaceName.c_str());
-    ImGui::Text("Base Type: %s", type.baseType.empty() ? "None" : type.baseType.c_str());
+    ImGui::Text("Base Type: %s", type.baseType == SymbolTable::EMPTY ? "None" : assemblyData_.symbols.CStr(type.baseType));
 
     ImGui::Text("Kind: ");
     ImGui::SameLine();
@@ -199,133 +626,266 @@ void MainWindow::RenderTypeDetails() {
 
     ImGui::Separator();
 
+    if (!fetcher_.IsFetched(selectedTypeIndex_)) {
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Fetching members...");
+    }
+
     // Tabs
+    // A member search result that was clicked opens its tab
+    auto tabFlags = [this](int tab) { return jumpToTab_ == tab ? ImGuiTabItemFlags_SetSelected : ImGuiTabItemFlags_None; };
     if (ImGui::BeginTabBar("MemberTabs")) {
-        if (ImGui::BeginTabItem("Fields")) {
+        if (ImGui::BeginTabItem("Fields", nullptr, tabFlags(0))) {
             currentTab_ = 0;
             RenderFieldsTab(type);
             ImGui::EndTabItem();
         }
-        if (ImGui::BeginTabItem("Methods")) {
+        if (ImGui::BeginTabItem("Methods", nullptr, tabFlags(1))) {
             currentTab_ = 1;
             RenderMethodsTab(type);
             ImGui::EndTabItem();
         }
-        if (ImGui::BeginTabItem("Properties")) {
+        if (ImGui::BeginTabItem("Properties", nullptr, tabFlags(2))) {
             currentTab_ = 2;
             RenderPropertiesTab(type);
             ImGui::EndTabItem();
         }
         ImGui::EndTabBar();
     }
+    jumpToTab_ = -1;
 }
 
 void MainWindow::RenderFieldsTab(const TypeInfo& type) {
     ImGui::Text("Fields (%zu)", type.fields.size());
     ImGui::Separator();
+    RenderMemberTable(0, members_.typeFields[selectedTypeIndex_], showPublicOnly_ ? MEMBER_PUBLIC : 0);
+}
 
-    if (ImGui::BeginTable("FieldsTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
-        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 200.0f);
-        ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthStretch);
-        ImGui::TableSetupColumn("Public", ImGuiTableColumnFlags_WidthFixed, 60.0f);
-        ImGui::TableSetupColumn("Static", ImGuiTableColumnFlags_WidthFixed, 60.0f);
-        ImGui::TableSetupColumn("ReadOnly", ImGuiTableColumnFlags_WidthFixed, 70.0f);
-        ImGui::TableHeadersRow();
+void MainWindow::RenderMethodsTab(const TypeInfo& type) {
+    ImGui::Text("Methods (%zu)", type.methods.size());
+    ImGui::Separator();
+    RenderMemberTable(1, members_.typeMethods[selectedTypeIndex_], showPublicOnly_ ? MEMBER_PUBLIC : 0);
+}
 
-        for (const auto& field : type.fields) {
-            if (showPublicOnly_ && !field.isPublic) continue;
+void MainWindow::RenderPropertiesTab(const TypeInfo& type) {
+    ImGui::Text("Properties (%zu)", type.properties.size());
+    ImGui::Separator();
+    RenderMemberTable(2, members_.typeProperties[selectedTypeIndex_], 0);
+}
+
+// The rows come from the tab's MemberTable, built when the selected type or
+// its members change; each frame only reads the sort specs and draws the
+// rows in view
+void MainWindow::RenderMemberTable(int tab, MemberRange range, uint8_t requiredFlags) {
+    const MemberTabLayout& layout = MEMBER_TABS[tab];
+    MemberTab& state = memberTabs_[tab];
+    MemberTable& table = state.table;
+    if (!table.Shows(layout.kind, range, membersGeneration_)) {
+        table.Build(members_, assemblyData_.symbols, layout.kind, range, membersGeneration_);
+    }
+
+    ImGui::SetNextItemWidth(-1);
+    ImGui::InputTextWithHint("##filter", "Filter by name or type...", state.filter, sizeof(state.filter));
 
-            ImGui::TableNextRow();
+    const int columns = table.ColumnCount();
+    if (ImGui::BeginTable(layout.table, columns, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+                                                     ImGuiTableFlags_Sortable | ImGuiTableFlags_SortTristate)) {
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 200.0f);
+        ImGui::TableSetupColumn(layout.textColumn, ImGuiTableColumnFlags_WidthStretch);
+        for (int c = MemberTable::COLUMN_TEXT + 1; c < columns; c++) {
+            const int flag = c - MemberTable::COLUMN_TEXT - 1;
+            ImGui::TableSetupColumn(layout.flagColumns[flag], ImGuiTableColumnFlags_WidthFixed, layout.flagWidths[flag]);
+        }
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableHeadersRow();
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", field.name.c_str());
+        // Unsorted (the third click on a header) lists members as declared
+        int sortColumn = MemberTable::NO_SORT;
+        bool descending = false;
+        const ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+        if (specs && specs->SpecsCount > 0) {
+            sortColumn = specs->Specs[0].ColumnIndex;
+            descending = specs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+        }
+        const std::vector<uint32_t>& rows = table.View(state.filter, requiredFlags, sortColumn, descending);
 
-            ImGui::TableNextColumn();
-            ImGui::TextColored(ImVec4(0.6f, 0.6f, 1.0f, 1.0f), "%s", field.fieldType.c_str());
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(rows.size()));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                const uint32_t row = rows[i];
+                ImGui::TableNextRow();
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", field.isPublic ? "Yes" : "No");
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", table.Name(row));
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", field.isStatic ? "Yes" : "No");
+                ImGui::TableNextColumn();
+                ImGui::TextColored(layout.textColor, "%s", table.Text(row));
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", field.isReadOnly ? "Yes" : "No");
+                for (int c = MemberTable::COLUMN_TEXT + 1; c < columns; c++) {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", (table.Flags(row) & table.ColumnFlag(c)) ? "Yes" : "No");
+                }
+            }
         }
+        clipper.End();
 
         ImGui::EndTable();
     }
 }
 
-void MainWindow::RenderMethodsTab(const TypeInfo& type) {
-    ImGui::Text("Methods (%zu)", type.methods.size());
-    ImGui::Separator();
-
-    if (ImGui::BeginTable("MethodsTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
-        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 200.0f);
-        ImGui::TableSetupColumn("Signature", ImGuiTableColumnFlags_WidthStretch);
-        ImGui::TableSetupColumn("Public", ImGuiTableColumnFlags_WidthFixed, 60.0f);
-        ImGui::TableSetupColumn("Static", ImGuiTableColumnFlags_WidthFixed, 60.0f);
-        ImGui::TableHeadersRow();
-
-        for (const auto& method : type.methods) {
-            if (showPublicOnly_ && !method.isPublic) continue;
+// Copies what the index needs from members_ here and builds it on a worker;
+// the index comes back as an update. One build runs at a time.
+void MainWindow::BuildMemberSearch() {
+    if (!memberSearchStale_ || memberSearchBuilding_.load(std::memory_order_acquire)) return;
+    memberSearchStale_ = false;
+    memberSearchBuilding_.store(true, std::memory_order_relaxed);
+
+    auto source = std::make_shared<MemberSearchIndex::Source>(MemberSearchIndex::Capture(members_, assemblyData_.symbols));
+    const uint64_t generation = membersGeneration_;
+    ThreadPool::Shared().Submit([this, source, generation]() {
+        Update update;
+        update.kind = Update::Kind::MemberSearch;
+        update.generation = generation;
+        update.memberSearch.Build(*source);
+        updates_.Publish(std::move(update));
+        memberSearchBuilding_.store(false, std::memory_order_release);
+    });
+}
 
-            ImGui::TableNextRow();
+void MainWindow::RenderMemberSearch() {
+    ImGui::SetNextWindowSize(ImVec2(900, 500), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Member Search", &showMemberSearch_)) {
+        ImGui::End();
+        return;
+    }
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", method.name.c_str());
+    // Lazy mode decodes a type's members when it is shown, so only those are
+    // searched until the rest are decoded too
+    if (lazy_.IsLoaded()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Searching the members of %zu/%zu decoded types.",
+                           lazy_.MaterializedCount(), assemblyData_.types.size());
+        ImGui::SameLine();
+        if (ImGui::Button("Decode All")) {
+            lazy_.MaterializeAll(assemblyData_);
+            members_.Build(assemblyData_);
+            membersGeneration_++;
+            memberSearchReady_ = false;
+            memberSearchStale_ = true;
+            memberSearchResult_.Clear();
+        }
+    } else if (fetcher_.IsActive()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Searching the members of the %zu/%zu types fetched so far.",
+                           fetcher_.FetchedCount(), assemblyData_.types.size());
+    }
 
-            ImGui::TableNextColumn();
-            // Build signature
-            std::string signature = method.returnType + " " + method.name + "(";
-            for (size_t i = 0; i < method.parameters.size(); i++) {
-                if (i > 0) signature += ", ";
-                signature += method.parameters[i].parameterType + " " + method.parameters[i].name;
-            }
-            signature += ")";
-            ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.6f, 1.0f), "%s", signature.c_str());
+    BuildMemberSearch();
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", method.isPublic ? "Yes" : "No");
+    ImGui::SetNextItemWidth(300.0f);
+    ImGui::InputTextWithHint("##memberSearch", "Search members...", memberSearchBuffer_, sizeof(memberSearchBuffer_));
+    ImGui::SameLine();
+    ImGui::RadioButton("By Name", &memberSearchTarget_, static_cast<int>(MemberSearchTarget::Name)); ImGui::SameLine();
+    ImGui::RadioButton("By Type", &memberSearchTarget_, static_cast<int>(MemberSearchTarget::Type)); ImGui::SameLine();
+    ImGui::Checkbox("Fields", &searchFields_); ImGui::SameLine();
+    ImGui::Checkbox("Methods", &searchMethods_); ImGui::SameLine();
+    ImGui::Checkbox("Properties", &searchProperties_); ImGui::SameLine();
+    ImGui::Checkbox("Parameters", &searchParameters_); ImGui::SameLine();
+    ImGui::Checkbox("Fuzzy", &memberSearchFuzzy_);
+
+    // Searched again only when the query, the options or the index change
+    const MemberSearchTarget target = static_cast<MemberSearchTarget>(memberSearchTarget_);
+    const MatchMode mode = memberSearchFuzzy_ ? MatchMode::Fuzzy : MatchMode::Substring;
+    const uint8_t kinds = (searchFields_ ? MemberKindBit(MemberKind::Field) : 0) |
+                          (searchMethods_ ? MemberKindBit(MemberKind::Method) : 0) |
+                          (searchProperties_ ? MemberKindBit(MemberKind::Property) : 0) |
+                          (searchParameters_ ? MemberKindBit(MemberKind::Parameter) : 0);
+    if (memberSearchReady_ && (memberSearchResultStale_ || kinds != memberSearchResult_.kinds ||
+                               target != memberSearchResult_.target || mode != memberSearchResult_.mode ||
+                               memberSearchQuery_ != memberSearchBuffer_)) {
+        memberSearch_.Search(memberSearchBuffer_, target, kinds, mode, memberSearchResult_, &ThreadPool::Shared());
+        memberSearchQuery_ = memberSearchBuffer_;
+        memberSearchResultStale_ = false;
+    }
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", method.isStatic ? "Yes" : "No");
+    if (!memberSearchReady_) {
+        ImGui::TextDisabled("Indexing members...");
+    } else {
+        ImGui::Text("%llu members under %zu matching names", static_cast<unsigned long long>(memberSearchResult_.Total()),
+                    memberSearchResult_.ids.size());
+        if (memberSearchResult_.matched > memberSearchResult_.ids.size()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(best of %zu)", memberSearchResult_.matched);
+        }
+        if (memberSearchBuilding_.load(std::memory_order_relaxed)) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("| updating index...");
         }
-
-        ImGui::EndTable();
     }
-}
 
-void MainWindow::RenderPropertiesTab(const TypeInfo& type) {
-    ImGui::Text("Properties (%zu)", type.properties.size());
     ImGui::Separator();
 
-    if (ImGui::BeginTable("PropertiesTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+    if (ImGui::BeginTable("MemberSearchTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
         ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 200.0f);
+        ImGui::TableSetupColumn("Kind", ImGuiTableColumnFlags_WidthFixed, 200.0f);
         ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthStretch);
-        ImGui::TableSetupColumn("Get", ImGuiTableColumnFlags_WidthFixed, 50.0f);
-        ImGui::TableSetupColumn("Set", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+        ImGui::TableSetupColumn("Declared In", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupScrollFreeze(0, 1);
         ImGui::TableHeadersRow();
 
-        for (const auto& prop : type.properties) {
-            ImGui::TableNextRow();
+        // Only the page of hits in view is read from the index
+        const uint64_t total = memberSearchReady_ ? memberSearchResult_.Total() : 0;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(std::min<uint64_t>(total, INT_MAX)));
+        while (clipper.Step()) {
+            memberSearch_.Fetch(memberSearchResult_, static_cast<uint64_t>(clipper.DisplayStart),
+                                static_cast<size_t>(clipper.DisplayEnd - clipper.DisplayStart), memberHits_);
+            for (size_t i = 0; i < memberHits_.size(); i++) {
+                ImGui::PushID(clipper.DisplayStart + static_cast<int>(i));
+                RenderMemberHit(memberHits_[i]);
+                ImGui::PopID();
+            }
+        }
+        clipper.End();
+
+        ImGui::EndTable();
+    }
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", prop.name.c_str());
+    ImGui::End();
+}
 
-            ImGui::TableNextColumn();
-            ImGui::TextColored(ImVec4(0.6f, 1.0f, 0.6f, 1.0f), "%s", prop.propertyType.c_str());
+void MainWindow::RenderMemberHit(const MemberHit& hit) {
+    const MemberColumns& columns = members_.Columns(hit.kind);
+    const SymbolTable& names = members_.names;
+    const uint32_t owner = members_.OwnerType(hit.kind, hit.row);
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", prop.canRead ? "Yes" : "No");
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    if (owner == MemberStore::NO_OWNER) {
+        // Replaced or removed by a delta since the index was built
+        ImGui::TextDisabled("%s (changed)", names.CStr(columns.name[hit.row]));
+        return;
+    }
 
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", prop.canWrite ? "Yes" : "No");
-        }
+    // Clicking a hit shows its type, on the tab that lists it
+    if (ImGui::Selectable(names.CStr(columns.name[hit.row]), false, ImGuiSelectableFlags_SpanAllColumns)) {
+        selectedTypeIndex_ = static_cast<int>(owner);
+        jumpToTab_ = hit.kind == MemberKind::Field ? 0 : hit.kind == MemberKind::Property ? 2 : 1;
+    }
 
-        ImGui::EndTable();
+    ImGui::TableNextColumn();
+    switch (hit.kind) {
+        case MemberKind::Field: ImGui::Text("Field"); break;
+        case MemberKind::Method: ImGui::Text("Method"); break;
+        case MemberKind::Property: ImGui::Text("Property"); break;
+        case MemberKind::Parameter:
+            ImGui::Text("Parameter of %s", names.CStr(members_.methods.name[columns.owner[hit.row]]));
+            break;
     }
+
+    ImGui::TableNextColumn();
+    ImGui::TextColored(ImVec4(0.6f, 0.6f, 1.0f, 1.0f), "%s", assemblyData_.symbols.CStr(columns.type[hit.row]));
+
+    ImGui::TableNextColumn();
+    ImGui::Text("%s", assemblyData_.types[owner].fullName.c_str());
 }
 
 } // namespace UI
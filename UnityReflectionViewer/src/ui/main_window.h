@@ -1,6 +1,16 @@
 #pragma once
 
+#include "../assembly_delta.h"
+#include "../ipc_client.h"
+#include "../lazy_assembly.h"
+#include "../member_fetcher.h"
+#include "../member_search_index.h"
+#include "../member_store.h"
+#include "../member_table.h"
 #include "../reflection_data.h"
+#include "../type_list_index.h"
+#include "../update_channel.h"
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -12,20 +22,149 @@ public:
     MainWindow();
     ~MainWindow();
 
-    void SetAssemblyData(const AssemblyData& data);
+    // Every call below may come from any thread. The data is handed to the
+    // render thread without locks and taken over at the start of the next frame
+    // without a copy; an update followed by a newer snapshot before that frame
+    // is skipped.
+    void SetAssemblyData(AssemblyData data);
     void Render();
 
+    // Progressive loading from the IPC thread: types show up as they are parsed.
+    // newSymbols are the names the parser's symbol table gained since the
+    // previous batch. expectedTypes (0 if unknown) is shown as the total.
+    void BeginAssemblyData(size_t expectedTypes = 0);
+    void AppendTypes(std::vector<TypeInfo> types, std::vector<std::string> newSymbols);
+    void EndAssemblyData(const AssemblyData& header);
+    // In place of EndAssemblyData when the load broke off or did not parse: the
+    // types shown so far are dropped and the window says the load failed
+    void FailAssemblyData();
+
+    // Lazy load mode, from the IPC thread: headers holds the types without their
+    // members, which lazy decodes when a type is first shown
+    void SetLazyAssembly(LazyAssembly lazy, AssemblyData headers);
+
+    // Query mode, from the IPC thread: headers holds the types without their
+    // members, which are fetched from the mod through the IPC client as types
+    // are shown; response is the mod's answer to one of those requests
+    void SetQueryHeaders(AssemblyData headers);
+    void ApplyMembers(MemberResponse response);
+
+    // A delta from the IPC thread, applied in place after the data queued
+    // before it. The selection stays on the same type unless it was removed.
+    void ApplyDelta(AssemblyDelta delta);
+
+    // The mod's reflection progress, shown until the snapshot or delta arrives
+    void SetReflectionProgress(ReflectionProgress progress);
+
+    // Shown in the status bar (connection state and latency metrics), and
+    // where query mode sends its member requests
+    void SetIPCClient(IPCClient* client);
+
 private:
+    static constexpr size_t FUZZY_TYPE_LIMIT = 2000; // rows a fuzzy type search lists
+
+    // One call above, queued for the render thread
+    struct Update {
+        enum class Kind {
+            Snapshot, // data (and lazy, in lazy mode) replace the window's; with
+                      // query set, data holds headers whose members are fetched
+            Begin,    // a progressive load starts from an empty window
+            Types,    // types and symbols to append
+            End,      // data holds the header of the finished load
+            Failed,   // the progressive load failed; empty data replaces its types
+            Delta,
+            Members,  // response fills in members of a query-mode snapshot
+            Progress,
+            MemberSearch // from a worker: memberSearch, built for the members of generation
+        };
+
+        Kind kind = Kind::Snapshot;
+        AssemblyData data;
+        LazyAssembly lazy;
+        TypeListIndex typeList; // built from data off the render thread
+        MemberStore members;    // likewise
+        std::vector<TypeInfo> types;
+        std::vector<std::string> symbols;
+        AssemblyDelta delta;
+        MemberResponse response;
+        ReflectionProgress progress; // Progress, and the expected total for Begin
+        bool query = false;
+        MemberSearchIndex memberSearch;
+        uint64_t generation = 0;
+    };
+
+    void ResetViews();
+    void ApplyPendingData();
+    void ReclaimOnWorker();
+    void ApplyUpdate(Update& update);
+    void ApplyChanges(const std::vector<TypeChange>& changes);
+    void EnsureMembers(size_t typeIndex);
+    void CountType(const TypeInfo& type, int step = 1);
     void RenderConnectionStatus();
     void RenderTypeList();
+    void RenderTypeRow(uint32_t typeIndex);
     void RenderTypeDetails();
     void RenderFieldsTab(const TypeInfo& type);
     void RenderMethodsTab(const TypeInfo& type);
     void RenderPropertiesTab(const TypeInfo& type);
+    void RenderMemberTable(int tab, MemberRange range, uint8_t requiredFlags);
+    void RenderMemberSearch();
+    void RenderMemberHit(const MemberHit& hit);
+    void BuildMemberSearch();
 
     AssemblyData assemblyData_;
+    IPCClient* ipcClient_ = nullptr;
+    LazyAssembly lazy_;
+    MemberFetcher fetcher_;
+    std::vector<uint32_t> fetched_;      // scratch for Members updates
+    std::vector<uint32_t> visibleTypes_; // the filtered type list, in type order or ranked by a fuzzy search
+    TypeListIndex typeList_;
+    bool typeListStale_ = true;  // the data changed since visibleTypes_ was filtered
+    std::string filteredQuery_;  // folded search visibleTypes_ was filtered with
+    uint8_t filteredKinds_ = 0;  // and its required TYPE_KIND_* bits
+    bool filteredFuzzy_ = false; // and whether it was ranked
+    size_t fuzzyMatched_ = 0;    // types the fuzzy search matched, of which visibleTypes_ holds the best
+    std::string foldedSearch_;   // scratch for RenderTypeList
+    MemberStore members_;
+    DeltaApplier deltaApplier_;
+    std::vector<TypeChange> changes_; // scratch for ApplyChanges
+
+    // The details pane's tabs: Fields, Methods, Properties, as currentTab_
+    // numbers them
+    struct MemberTab {
+        MemberTable table;
+        char filter[128] = {0};
+    };
+    MemberTab memberTabs_[3];
+
+    // Member search: the index is built on a worker from members_ as it was
+    // when the panel last asked, and rebuilt while the panel is open whenever
+    // members_ has changed since
+    MemberSearchIndex memberSearch_;
+    uint64_t membersGeneration_ = 0;       // bumped when members_ is rebuilt and its rows mean other members
+    bool memberSearchReady_ = false;       // memberSearch_ was built from members_ of this generation
+    bool memberSearchStale_ = true;        // members_ changed since the last build started
+    std::atomic<bool> memberSearchBuilding_{false};
+    bool memberSearchResultStale_ = true;  // memberSearch_ changed since memberSearchResult_ was searched
+    MemberSearchResult memberSearchResult_;
+    std::string memberSearchQuery_;        // what memberSearchResult_ was searched for
+    std::vector<MemberHit> memberHits_;    // scratch: the hits in view
+    char memberSearchBuffer_[256] = {0};
+    int memberSearchTarget_ = 0;           // a MemberSearchTarget
+    bool searchFields_ = true;
+    bool searchMethods_ = true;
+    bool searchProperties_ = true;
+    bool searchParameters_ = true;
+    bool memberSearchFuzzy_ = false;
+    bool showMemberSearch_ = false;
+    int jumpToTab_ = -1; // tab RenderTypeDetails opens on its next frame
     int selectedTypeIndex_ = -1;
     char searchBuffer_[256] = {0};
+    bool filterClasses_ = false;
+    bool filterStructs_ = false;
+    bool filterEnums_ = false;
+    bool filterInterfaces_ = false;
+    bool fuzzySearch_ = false;
     bool showPublicOnly_ = false;
     bool showInheritedMembers_ = false;
 
@@ -37,6 +176,13 @@ private:
     int totalStructs_ = 0;
     int totalEnums_ = 0;
     int totalInterfaces_ = 0;
+
+    UpdateChannel<Update> updates_;
+    bool replacedData_ = false;         // the updates taken this frame hold a snapshot they replaced
+    std::atomic<int> reclaimTasks_{0};  // ReclaimOnWorker calls still running
+    bool loading_ = false;
+    bool loadFailed_ = false; // the last progressive load failed and left the window empty
+    ReflectionProgress progress_; // typesTotal 0 when none is under way
 };
 
 } // namespace UI
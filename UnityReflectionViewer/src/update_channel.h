@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace UnityReflection {
+
+// Hands updates from the IPC thread to the render thread without locks or
+// copies. Producers push onto a lock-free list; once per frame the consumer
+// takes everything published since the last frame with a single exchange, so
+// several updates that arrive during one frame are seen together and the
+// consumer can skip the ones a later update supersedes.
+//
+// Nothing is destroyed on the consumer thread: taken updates, along with
+// whatever the consumer swapped into them (such as the data they replace), go
+// back on a retired list at the next Take. Producers free that list in
+// Publish, and any thread other than the consumer can free it in Reclaim.
+//
+// Any number of threads may publish; one thread consumes.
+template <typename T>
+class UpdateChannel {
+public:
+    UpdateChannel() = default;
+    UpdateChannel(const UpdateChannel&) = delete;
+    UpdateChannel& operator=(const UpdateChannel&) = delete;
+
+    ~UpdateChannel() {
+        Retire();
+        Free(published_.exchange(nullptr));
+        Free(retired_.exchange(nullptr));
+    }
+
+    void Publish(T update) {
+        Reclaim();
+        Push(published_, new Node{std::move(update), nullptr}, nullptr);
+    }
+
+    // Frees what the consumer has retired, on the calling thread
+    void Reclaim() { Free(retired_.exchange(nullptr, std::memory_order_acquire)); }
+
+    // Consumer: the updates published since the last Take, oldest first. They
+    // stay valid, and may be modified, until the next Take retires them.
+    const std::vector<T*>& Take() {
+        Retire();
+        Node* newest = published_.exchange(nullptr, std::memory_order_acquire);
+        for (Node* node = newest; node; node = node->next) taken_.push_back(&node->value);
+        std::reverse(taken_.begin(), taken_.end());
+        takenHead_ = newest;
+        return taken_;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    // Pushes the chain first..last, linked through next, in one step
+    static void Push(std::atomic<Node*>& list, Node* first, Node* last) {
+        if (!last) last = first;
+        Node* head = list.load(std::memory_order_relaxed);
+        do {
+            last->next = head;
+        } while (!list.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    static void Free(Node* node) {
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    // Hands the last batch Take returned to the producers to free
+    void Retire() {
+        if (!takenHead_) return;
+        Node* last = takenHead_;
+        while (last->next) last = last->next;
+        Push(retired_, takenHead_, last);
+        takenHead_ = nullptr;
+        taken_.clear();
+    }
+
+    std::atomic<Node*> published_{nullptr}; // newest first
+    std::atomic<Node*> retired_{nullptr};
+    Node* takenHead_ = nullptr; // consumer only
+    std::vector<T*> taken_;
+};
+
+} // namespace UnityReflection
@@ -0,0 +1,415 @@
+// Round trips of the wire and file formats: LZ4 blocks, frames, the binary
+// schema codec, snapshot images and deltas
+
+#include "assembly_delta.h"
+#include "frame_protocol.h"
+#include "lz4_block.h"
+#include "payload_generator.h"
+#include "reflection_data.h"
+#include "schema_codec.h"
+#include "snapshot_file.h"
+#include "test_harness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace UnityReflection;
+
+namespace {
+
+std::string Payload(size_t typeCount, uint64_t seed = 1) {
+    Bench::PayloadOptions options;
+    options.typeCount = typeCount;
+    options.seed = seed;
+    options.escapeRatio = 0.05;
+    return Bench::GeneratePayload(options);
+}
+
+std::string RandomBytes(size_t size, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::string bytes(size, '\0');
+    for (char& c : bytes) c = static_cast<char>(random());
+    return bytes;
+}
+
+// Messages a FrameDecoder hands on, with whether each completed
+struct Received {
+    std::vector<std::string> messages;
+    std::vector<bool> complete;
+    std::vector<MessageKind> kinds;
+};
+
+void Connect(FrameDecoder& decoder, Received& received) {
+    decoder.SetCallbacks(
+        [&received](MessageKind kind, uint64_t) {
+            received.kinds.push_back(kind);
+            received.messages.emplace_back();
+        },
+        [&received](const char* data, size_t size) {
+            received.messages.back().append(data, size);
+            return true;
+        },
+        [&received](bool complete) { received.complete.push_back(complete); });
+}
+
+void FeedInPieces(FrameDecoder& decoder, const std::string& stream, size_t piece) {
+    for (size_t pos = 0; pos < stream.size(); pos += piece) {
+        decoder.Feed(stream.data() + pos, std::min(piece, stream.size() - pos));
+    }
+}
+
+} // namespace
+
+URV_TEST(Lz4RoundTrip) {
+    std::vector<std::string> inputs = {
+        "",
+        "a",
+        "abcdefghijkl",
+        std::string(100000, 'x'),
+        RandomBytes(70000, 1),
+        Payload(200),
+    };
+    // Repeats further apart than the 64 KB window
+    inputs.push_back(RandomBytes(80000, 2) + inputs[4]);
+
+    for (const std::string& input : inputs) {
+        std::string block(Lz4CompressBound(input.size()), '\0');
+        block.resize(Lz4Compress(input.data(), input.size(), &block[0]));
+
+        std::string output(input.size(), '\0');
+        CHECK(Lz4Decompress(block.data(), block.size(), &output[0], output.size()));
+        CHECK(output == input);
+
+        // The size must come out exact
+        std::string larger(input.size() + 1, '\0');
+        CHECK(!Lz4Decompress(block.data(), block.size(), &larger[0], larger.size()));
+        if (!input.empty()) {
+            CHECK(!Lz4Decompress(block.data(), block.size(), &output[0], output.size() - 1));
+            CHECK(!Lz4Decompress(block.data(), block.size() - 1, &output[0], output.size()));
+        }
+    }
+}
+
+URV_TEST(Lz4RejectsGarbage) {
+    // Only staying inside the buffers is checked; some inputs decode
+    std::vector<char> output(4096);
+    for (uint32_t seed = 0; seed < 2000; seed++) {
+        const std::string block = RandomBytes(1 + seed % 300, seed);
+        Lz4Decompress(block.data(), block.size(), output.data(), seed % output.size());
+    }
+}
+
+URV_TEST(Crc32cKnownValue) {
+    CHECK(Crc32c("123456789", 9) == 0xE3069283u);
+    CHECK(Crc32c("56789", 5, Crc32c("1234", 4)) == 0xE3069283u);
+    CHECK(Crc32c(nullptr, 0) == 0);
+}
+
+URV_TEST(FrameHeaderRoundTrip) {
+    FrameHeader header;
+    header.type = FrameType::End;
+    header.kind = MessageKind::AssemblyBinary;
+    header.messageId = 42;
+    header.payloadSize = 1234;
+    header.offset = 0x123456789ull;
+    header.payloadCrc = 0xDEADBEEF;
+
+    uint8_t bytes[FRAME_HEADER_SIZE];
+    EncodeFrameHeader(header, bytes);
+    FrameHeader decoded;
+    REQUIRE(DecodeFrameHeader(bytes, decoded) == FrameStatus::Ok);
+    CHECK(decoded.type == header.type);
+    CHECK(decoded.kind == header.kind);
+    CHECK(decoded.messageId == header.messageId);
+    CHECK(decoded.payloadSize == header.payloadSize);
+    CHECK(decoded.offset == header.offset);
+    CHECK(decoded.payloadCrc == header.payloadCrc);
+
+    bytes[10] ^= 1;
+    CHECK(DecodeFrameHeader(bytes, decoded) == FrameStatus::BadChecksum);
+    bytes[10] ^= 1;
+    bytes[0] = 'X';
+    CHECK(DecodeFrameHeader(bytes, decoded) == FrameStatus::BadMagic);
+}
+
+URV_TEST(FramedMessagesReassemble) {
+    const std::string payload = Payload(100);
+    for (bool compress : {false, true}) {
+        std::string stream;
+        AppendMessage(stream, MessageKind::AssemblyJson, 1, payload.data(), payload.size(), 4096, compress);
+        AppendMessage(stream, MessageKind::Progress, 2, "{}", 2, 4096, compress);
+
+        for (size_t piece : {size_t(1), size_t(7), size_t(4096), stream.size()}) {
+            FrameDecoder decoder;
+            Received received;
+            Connect(decoder, received);
+            FeedInPieces(decoder, stream, piece);
+
+            REQUIRE(received.messages.size() == 2);
+            CHECK(received.messages[0] == payload);
+            CHECK(received.messages[1] == "{}");
+            CHECK(received.kinds[0] == MessageKind::AssemblyJson);
+            CHECK(received.kinds[1] == MessageKind::Progress);
+            CHECK(received.complete == std::vector<bool>({true, true}));
+            CHECK(decoder.MessageBytes() == 2);
+        }
+    }
+}
+
+URV_TEST(CorruptChunkAbandonsOnlyItsMessage) {
+    const std::string payload = Payload(50);
+    std::string stream;
+    AppendMessage(stream, MessageKind::AssemblyJson, 1, payload.data(), payload.size(), 4096);
+    const size_t second = stream.size();
+    AppendMessage(stream, MessageKind::AssemblyJson, 2, payload.data(), payload.size(), 4096);
+
+    // A payload byte of the first message's second chunk
+    stream[FRAME_HEADER_SIZE * 3 + 100] ^= 0x20;
+    // and garbage between the messages
+    stream.insert(second, "garbage");
+
+    FrameDecoder decoder;
+    Received received;
+    Connect(decoder, received);
+    std::vector<std::string> errors;
+    decoder.SetErrorCallback([&errors](const std::string& error) { errors.push_back(error); });
+    FeedInPieces(decoder, stream, 1000);
+
+    REQUIRE(received.messages.size() == 2);
+    CHECK(received.complete == std::vector<bool>({false, true}));
+    CHECK(received.messages[1] == payload);
+    CHECK(errors.size() >= 2);
+}
+
+URV_TEST(LegacyUnframedPayload) {
+    const std::string payload = Payload(20);
+    const uint32_t length = static_cast<uint32_t>(payload.size());
+    std::string stream(4, '\0');
+    for (int i = 0; i < 4; i++) stream[i] = static_cast<char>(length >> (8 * i));
+    stream += payload;
+
+    FrameDecoder decoder;
+    Received received;
+    Connect(decoder, received);
+    FeedInPieces(decoder, stream, 3);
+    REQUIRE(received.messages.size() == 1);
+    CHECK(received.messages[0] == payload);
+    CHECK(received.complete == std::vector<bool>({true}));
+
+    // Cut off by the connection closing
+    FrameDecoder cut;
+    Received partial;
+    Connect(cut, partial);
+    cut.Feed(stream.data(), stream.size() / 2);
+    cut.Finish();
+    CHECK(partial.complete == std::vector<bool>({false}));
+}
+
+URV_TEST(JsonEscapedStringsParseBack) {
+    // Ids as the hello carries them: quotes and backslashes must not end the
+    // string or start an escape the server reads differently
+    const std::string ids[] = {"plain", "quote\"d", "back\\slash\\", "tab\tcr\rlf\n", "\"},\"query\":true,\"x\":\""};
+    for (const std::string& id : ids) {
+        std::string json = "{\"snapshotId\":\"";
+        AppendJsonEscaped(json, id);
+        json += "\",\"moduleVersionId\":\"";
+        AppendJsonEscaped(json, id);
+        json += "\"}";
+
+        AssemblyData data;
+        REQUIRE(ParseAssemblyDataExact(json, data));
+        CHECK(data.snapshotId == id);
+        CHECK(data.moduleVersionId == id);
+    }
+}
+
+URV_TEST(BinaryCodecRoundTrip) {
+    const std::string payload = Payload(300);
+    AssemblyData data;
+    REQUIRE(ParseAssemblyData(payload, data));
+
+    std::string binary;
+    EncodeBinary(data, binary);
+    AssemblyData decoded;
+    REQUIRE(DecodeBinary(binary.data(), binary.size(), decoded));
+    std::string json;
+    EncodeJson(decoded, json);
+    CHECK(json == payload);
+
+    // Every cut is detected, and so is anything after the end
+    for (size_t size = 0; size < binary.size(); size += 1 + size / 16) {
+        CHECK(!DecodeBinary(binary.data(), size, decoded));
+    }
+    std::string longer = binary + '\0';
+    CHECK(!DecodeBinary(longer.data(), longer.size(), decoded));
+    std::string wrongMagic = binary;
+    wrongMagic[0] = 'X';
+    CHECK(!DecodeBinary(wrongMagic.data(), wrongMagic.size(), decoded));
+}
+
+URV_TEST(SnapshotRoundTrip) {
+    const std::string payload = Payload(300);
+    AssemblyData data;
+    REQUIRE(ParseAssemblyData(payload, data));
+
+    SnapshotWriter writer;
+    writer.AddAssemblyData(data);
+    std::string image;
+    writer.Serialize(image);
+
+    MappedSnapshot snapshot;
+    REQUIRE(snapshot.Load(image, true));
+    CHECK(snapshot.Types().size() == data.types.size());
+    CHECK(snapshot.AssemblyName() == data.assemblyName);
+    CHECK(snapshot.SnapshotId() == data.snapshotId);
+
+    AssemblyData decoded;
+    snapshot.ToAssemblyData(decoded);
+    std::string json;
+    EncodeJson(decoded, json);
+    CHECK(json == payload);
+
+    // The same through a file
+    const std::string path = "urv_tests_snapshot.bin";
+    REQUIRE(writer.Save(path));
+    MappedSnapshot mapped;
+    REQUIRE(mapped.Open(path, true));
+    AssemblyData reopened;
+    mapped.ToAssemblyData(reopened);
+    json.clear();
+    EncodeJson(reopened, json);
+    CHECK(json == payload);
+    mapped.Close();
+    std::remove(path.c_str());
+}
+
+URV_TEST(SnapshotRejectsDamage) {
+    AssemblyData data;
+    REQUIRE(ParseAssemblyData(Payload(50), data));
+    SnapshotWriter writer;
+    writer.AddAssemblyData(data);
+    std::string image;
+    writer.Serialize(image);
+
+    MappedSnapshot snapshot;
+    CHECK(!snapshot.Load(image.substr(0, image.size() - 4), true));
+    CHECK(!snapshot.Load(image.substr(0, sizeof(SnapshotFileHeader) - 1), true));
+
+    std::string flipped = image;
+    flipped[flipped.size() / 2] ^= 1;
+    CHECK(!snapshot.Load(flipped, true));
+
+    std::string wrongMagic = image;
+    wrongMagic[0] = 'X';
+    CHECK(!snapshot.Load(wrongMagic, true));
+}
+
+// What a broken encoder could send: the checksum matches, the contents do not
+URV_TEST(SnapshotRejectsBadContents) {
+    AssemblyData data;
+    REQUIRE(ParseAssemblyData(Payload(50), data));
+    SnapshotWriter writer;
+    writer.AddAssemblyData(data);
+    std::string image;
+    writer.Serialize(image);
+
+    auto rechecksum = [](std::string& bytes) {
+        SnapshotFileHeader header;
+        memcpy(&header, bytes.data(), sizeof(header));
+        header.checksum = SnapshotChecksum(bytes.data() + sizeof(header), bytes.size() - sizeof(header));
+        memcpy(&bytes[0], &header, sizeof(header));
+    };
+    SnapshotFileHeader header;
+    memcpy(&header, image.data(), sizeof(header));
+    REQUIRE(header.stringOffsets.count > 3);
+
+    // A string offset in the middle of the table far past the chars
+    std::string corrupt = image;
+    const uint32_t pastEnd = 0x7FFFFFF0;
+    memcpy(&corrupt[header.stringOffsets.offset + 4 * (header.stringOffsets.count / 2)], &pastEnd, 4);
+    rechecksum(corrupt);
+    MappedSnapshot snapshot;
+    CHECK(!snapshot.Load(corrupt, true));
+    CHECK(!snapshot.Load(corrupt, false));
+
+    // Any word after the header set to anything must not read out of bounds
+    std::mt19937 random(7);
+    for (int i = 0; i < 2000; i++) {
+        std::string mutated = image;
+        const size_t words = (image.size() - sizeof(SnapshotFileHeader)) / 4;
+        const uint32_t value = i % 2 ? static_cast<uint32_t>(random()) : static_cast<uint32_t>(random() % 1024);
+        memcpy(&mutated[sizeof(SnapshotFileHeader) + 4 * (random() % words)], &value, 4);
+        rechecksum(mutated);
+        if (snapshot.Load(mutated, true)) {
+            AssemblyData decoded;
+            snapshot.ToAssemblyData(decoded);
+        }
+    }
+}
+
+URV_TEST(DeltaApplies) {
+    AssemblyData base;
+    REQUIRE(ParseAssemblyData(Payload(40), base));
+    base.snapshotId = "base";
+
+    // The generator repeats full names; give every type its own
+    for (size_t i = 0; i < base.types.size(); i++) base.types[i].fullName += std::to_string(i);
+
+    AssemblyDelta delta;
+    delta.assemblyName = base.assemblyName;
+    delta.baseSnapshotId = "base";
+    delta.snapshotId = "next";
+    delta.symbols = base.symbols;
+    delta.removed.push_back({base.types[3].fullName});
+    delta.removed.push_back({base.types.back().fullName});
+    delta.types.push_back(base.types[10]);
+    delta.types.back().fields.emplace_back().name = "addedField";
+    delta.types.push_back(base.types[0]);
+    delta.types.back().fullName = "Brand.New";
+
+    // What the delta should leave, in some order
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < base.types.size(); i++) {
+        if (i == 3 || i + 1 == base.types.size()) continue;
+        const TypeInfo& type = i == 10 ? delta.types[0] : base.types[i];
+        std::string json;
+        EncodeJson(type, base.symbols, json);
+        expected.push_back(json);
+    }
+    expected.emplace_back();
+    EncodeJson(delta.types[1], base.symbols, expected.back());
+    std::sort(expected.begin(), expected.end());
+
+    // Sent as JSON, as the mod does
+    std::string deltaJson;
+    EncodeJson(delta, deltaJson);
+    AssemblyDelta received;
+    REQUIRE(ParseAssemblyDelta(deltaJson, received));
+
+    AssemblyDelta wrongBase = received;
+    wrongBase.baseSnapshotId = "other";
+    AssemblyData untouched = base;
+    DeltaApplier applier;
+    std::vector<TypeChange> changes;
+    CHECK(!applier.Apply(std::move(wrongBase), untouched, changes));
+    CHECK(untouched.types.size() == base.types.size());
+    CHECK(changes.empty());
+
+    AssemblyData data = base;
+    REQUIRE(applier.Apply(std::move(received), data, changes));
+    CHECK(data.snapshotId == "next");
+    CHECK(changes.size() == 4);
+
+    std::vector<std::string> actual;
+    for (const TypeInfo& type : data.types) {
+        actual.emplace_back();
+        EncodeJson(type, data.symbols, actual.back());
+    }
+    std::sort(actual.begin(), actual.end());
+    CHECK(actual == expected);
+}
@@ -0,0 +1,324 @@
+// The JSON parsers must agree: the sequential, parallel, headers-then-members
+// and streaming paths give the same AssemblyData for the same payload, and the
+// same as the original parser, whether the payload is valid or not
+
+#include "assembly_snapshot.h"
+#include "lazy_assembly.h"
+#include "payload_generator.h"
+#include "reference_parser.h"
+#include "reflection_data.h"
+#include "schema_codec.h"
+#include "streaming_parser.h"
+#include "test_harness.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace UnityReflection;
+
+namespace {
+
+std::vector<std::string> Payloads() {
+    std::vector<std::string> payloads;
+    for (uint64_t seed = 1; seed <= 3; seed++) {
+        Bench::PayloadOptions options;
+        options.typeCount = 20 + seed * 40;
+        options.seed = seed;
+        options.escapeRatio = 0.1 * static_cast<double>(seed);
+        payloads.push_back(Bench::GeneratePayload(options));
+    }
+    return payloads;
+}
+
+std::string Json(const AssemblyData& data) {
+    std::string json;
+    EncodeJson(data, json);
+    return json;
+}
+
+// Feeds json in pieces of chunkSize and collects what the parser hands on
+bool ParseStreaming(const std::string& json, size_t chunkSize, AssemblyData& data) {
+    std::vector<TypeInfo> types;
+    StreamingParser parser([&types](TypeInfo&& type) { types.push_back(std::move(type)); });
+    for (size_t pos = 0; pos < json.size(); pos += chunkSize) {
+        if (!parser.Feed(json.data() + pos, std::min(chunkSize, json.size() - pos))) return false;
+    }
+    if (!parser.Finish(data)) return false;
+    data.types = std::move(types);
+    return true;
+}
+
+// Damaged copies of payload: single bytes replaced with JSON punctuation,
+// dropped or doubled, as a broken encoder or a bad chunk would leave it
+std::vector<std::string> Mutations(const std::string& payload, size_t count, uint32_t seed) {
+    static const char PUNCTUATION[] = "\"{}[],:\\ x1";
+    std::mt19937 random(seed);
+    std::vector<std::string> mutations;
+    for (size_t i = 0; i < count; i++) {
+        std::string mutated = payload;
+        const size_t pos = random() % mutated.size();
+        switch (random() % 3) {
+            case 0: mutated[pos] = PUNCTUATION[random() % (sizeof(PUNCTUATION) - 1)]; break;
+            case 1: mutated.erase(pos, 1); break;
+            default: mutated.insert(pos, 1, mutated[pos]); break;
+        }
+        mutations.push_back(std::move(mutated));
+    }
+    return mutations;
+}
+
+// The streaming parser may reject what the full parser accepts, but never the
+// other way round, and whatever it accepts must come out the same
+void CheckStreamingAgrees(const std::string& json, const std::vector<size_t>& chunkSizes) {
+    AssemblyData full;
+    const bool fullOk = ParseAssemblyData(json, full);
+    for (size_t chunkSize : chunkSizes) {
+        AssemblyData streamed;
+        if (!ParseStreaming(json, chunkSize, streamed)) continue;
+        CHECK(fullOk);
+        CHECK(Json(streamed) == Json(full));
+    }
+}
+
+std::string SmallPayload(size_t typeCount) {
+    Bench::PayloadOptions options;
+    options.typeCount = typeCount;
+    options.escapeRatio = 0.2;
+    return Bench::GeneratePayload(options);
+}
+
+// Same success and same data, including what was read before a failure
+void CheckMatchesReference(const std::string& json, ThreadPool* pool = nullptr) {
+    AssemblyData expected;
+    const bool expectedOk = Test::ParseWithReference(json, expected);
+
+    AssemblyData data;
+    CHECK(ParseAssemblyData(json, data) == expectedOk);
+    CHECK(Json(data) == Json(expected));
+
+    if (pool) {
+        AssemblyData parallel;
+        CHECK(ParseAssemblyDataParallel(json, parallel, pool) == expectedOk);
+        CHECK(Json(parallel) == Json(expected));
+    }
+}
+
+// The zero-copy parser gives the same flag and, once copied out, the same data
+void CheckSnapshotMatches(const std::string& json) {
+    AssemblyData expected;
+    const bool expectedOk = ParseAssemblyData(json, expected);
+
+    AssemblySnapshot snapshot;
+    CHECK(ParseAssemblySnapshot(json, snapshot) == expectedOk);
+    AssemblyData data;
+    snapshot.ToAssemblyData(data);
+    CHECK(Json(data) == Json(expected));
+}
+
+} // namespace
+
+URV_TEST(ParserMatchesReference) {
+    for (const std::string& payload : Payloads()) CheckMatchesReference(payload);
+
+    // Whitespace, unknown keys of every kind and keys out of order
+    CheckMatchesReference(" {\n \"extra\" : [1, {\"a\":[]}, \"]\"] ,\"types\" : [ { \"fields\" : [ { \"name\" :"
+                          " \"f\\\"q\\\\\" , \"isPublic\" : true , \"n\": 12.5e3 } ] , \"name\":\"T\" } , ] ,"
+                          " \"assemblyName\" : \"A\\tB\" } trailing");
+    CheckMatchesReference("");
+    CheckMatchesReference("[]");
+    CheckMatchesReference("{\"types\":{}}");
+}
+
+URV_TEST(ParserMatchesReferenceOnDamage) {
+    const std::string payload = SmallPayload(12);
+    for (const std::string& mutated : Mutations(payload, 3000, 2)) CheckMatchesReference(mutated);
+    for (size_t size = 0; size < payload.size(); size += 5) CheckMatchesReference(payload.substr(0, size));
+
+    // Damage in a payload large enough that the parallel parser splits it
+    Bench::PayloadOptions options;
+    options.typeCount = 3000;
+    const std::string large = Bench::GeneratePayload(options);
+    ThreadPool pool(4);
+    for (const std::string& mutated : Mutations(large, 40, 3)) CheckMatchesReference(mutated, &pool);
+}
+
+URV_TEST(SnapshotParseMatchesFullParse) {
+    for (const std::string& payload : Payloads()) {
+        AssemblySnapshot snapshot;
+        REQUIRE(ParseAssemblySnapshot(payload, snapshot));
+        CHECK(!snapshot.moduleVersionId.empty());
+        CHECK(!snapshot.snapshotId.empty());
+        CheckSnapshotMatches(payload);
+    }
+
+    const std::string payload = SmallPayload(12);
+    for (const std::string& mutated : Mutations(payload, 3000, 5)) CheckSnapshotMatches(mutated);
+    for (size_t size = 0; size < payload.size(); size += 5) CheckSnapshotMatches(payload.substr(0, size));
+}
+
+URV_TEST(ParsedPayloadEncodesBack) {
+    for (const std::string& payload : Payloads()) {
+        AssemblyData data;
+        REQUIRE(ParseAssemblyData(payload, data));
+        CHECK(Json(data) == payload);
+    }
+}
+
+URV_TEST(ParallelParseMatchesSequential) {
+    // Large enough to be split between the threads
+    Bench::PayloadOptions options;
+    options.typeCount = 3000;
+    const std::string payload = Bench::GeneratePayload(options);
+
+    ThreadPool pool(4);
+    AssemblyData data;
+    REQUIRE(ParseAssemblyDataParallel(payload, data, &pool));
+    CHECK(data.types.size() == options.typeCount);
+    CHECK(Json(data) == payload);
+}
+
+URV_TEST(LazyLoadMatchesFullParse) {
+    for (const std::string& payload : Payloads()) {
+        LazyAssembly lazy;
+        AssemblyData data;
+        REQUIRE(lazy.Load(payload, data));
+        lazy.MaterializeAll(data);
+        CHECK(lazy.MaterializedCount() == data.types.size());
+        CHECK(Json(data) == payload);
+    }
+}
+
+// Lazy loading may reject damage the full parse lets through, and may find it
+// only when the members are decoded, but once every type decoded cleanly it
+// must have what the full parse gives
+URV_TEST(LazyLoadRejectsWhatFullParseRejects) {
+    const std::string payload = SmallPayload(12);
+    size_t caught = 0;
+    for (const std::string& mutated : Mutations(payload, 3000, 4)) {
+        AssemblyData full;
+        const bool fullOk = ParseAssemblyData(mutated, full);
+
+        LazyAssembly lazy;
+        AssemblyData data;
+        if (!lazy.Load(mutated, data)) continue;
+        lazy.MaterializeAll(data);
+        if (lazy.MalformedCount() > 0) {
+            if (!fullOk) caught++;
+            continue;
+        }
+        CHECK(fullOk);
+        CHECK(Json(data) == Json(full));
+    }
+    // Damage inside member arrays that only the decode notices
+    CHECK(caught > 0);
+
+    // A field array closed with a brace: the headers pass skips to the brace,
+    // the full parse stops at it
+    std::string mismatched = payload;
+    const size_t fields = mismatched.find("\"fields\":[{");
+    REQUIRE(fields != std::string::npos);
+    const size_t close = mismatched.find("}]", fields);
+    REQUIRE(close != std::string::npos);
+    mismatched[close + 1] = '}';
+
+    LazyAssembly lazy;
+    AssemblyData data;
+    if (lazy.Load(mismatched, data)) {
+        lazy.MaterializeAll(data);
+        CHECK(lazy.MalformedCount() > 0);
+    }
+}
+
+URV_TEST(StreamingParseMatchesFullParse) {
+    for (const std::string& payload : Payloads()) {
+        for (size_t chunkSize : {size_t(1), size_t(2), size_t(3), size_t(17), size_t(4096), payload.size()}) {
+            AssemblyData data;
+            REQUIRE(ParseStreaming(payload, chunkSize, data));
+            CHECK(Json(data) == payload);
+        }
+    }
+}
+
+URV_TEST(StreamingParseEveryChunkSize) {
+    const std::string payload = SmallPayload(4);
+    std::vector<size_t> chunkSizes;
+    for (size_t chunkSize = 1; chunkSize <= payload.size(); chunkSize++) chunkSizes.push_back(chunkSize);
+    for (size_t chunkSize : chunkSizes) {
+        AssemblyData data;
+        REQUIRE(ParseStreaming(payload, chunkSize, data));
+        CHECK(Json(data) == payload);
+    }
+
+    // A key whose opening quote was lost throws off where strings start
+    std::string damaged = SmallPayload(20);
+    const size_t key = damaged.find("\"returnType\":\"System.Void\",\"isPublic\"");
+    REQUIRE(key != std::string::npos);
+    damaged[key + std::string("\"returnType\":\"System.Void\",").size()] = ':';
+    CheckStreamingAgrees(damaged, chunkSizes);
+}
+
+// What the viewer does with a stream that breaks off: the types delivered so
+// far are dropped, and the next stream through the same parser starts clean
+URV_TEST(StreamingParseFailedStreamThenNext) {
+    const std::vector<std::string> payloads = Payloads();
+    const std::string& broken = payloads[0];
+    const std::string& next = payloads[1];
+
+    std::vector<TypeInfo> types;
+    StreamingParser parser([&types](TypeInfo&& type) { types.push_back(std::move(type)); });
+    CHECK(parser.Feed(broken.data(), broken.size() / 2));
+    CHECK(!types.empty());
+    AssemblyData header;
+    CHECK(!parser.Finish(header));
+
+    types.clear();
+    parser.Reset();
+    for (size_t pos = 0; pos < next.size(); pos += 64) {
+        REQUIRE(parser.Feed(next.data() + pos, std::min<size_t>(64, next.size() - pos)));
+    }
+    AssemblyData data;
+    REQUIRE(parser.Finish(data));
+    data.types = std::move(types);
+    CHECK(Json(data) == next);
+
+    // Malformed halfway rather than cut off
+    std::string damaged = broken;
+    const size_t parameters = damaged.find("\"parameters\":[]", broken.size() / 2);
+    REQUIRE(parameters != std::string::npos);
+    damaged[parameters + std::string("\"parameters\":[").size()] = '}';
+    types.clear();
+    parser.Reset();
+    CHECK(!parser.Feed(damaged.data(), damaged.size()));
+    CHECK(!types.empty());
+    CHECK(!parser.Finish(header));
+}
+
+URV_TEST(StreamingParseRejectsWhatFullParseRejects) {
+    const std::string payload = SmallPayload(12);
+    const std::vector<size_t> chunkSizes = {1, 3, 64, 1000, payload.size()};
+
+    for (const std::string& mutated : Mutations(payload, 1500, 1)) CheckStreamingAgrees(mutated, chunkSizes);
+
+    // Truncated anywhere
+    for (size_t size = 0; size < payload.size(); size += 7) {
+        AssemblyData data;
+        CHECK(!ParseStreaming(payload.substr(0, size), 64, data));
+    }
+
+    // Anything after the top-level object
+    AssemblyData data;
+    CHECK(ParseStreaming(payload + " \n", 5, data));
+    CHECK(!ParseStreaming(payload + "x", 5, data));
+    CHECK(!ParseStreaming(payload + "}", 5, data));
+    CHECK(!ParseStreaming(payload + "{}", 5, data));
+
+    // A member array closed with the wrong bracket
+    std::string mismatched = payload;
+    const size_t parameters = mismatched.find("\"parameters\":[]");
+    REQUIRE(parameters != std::string::npos);
+    mismatched[parameters + std::string("\"parameters\":[").size()] = '}';
+    CHECK(!ParseStreaming(mismatched, 5, data));
+}
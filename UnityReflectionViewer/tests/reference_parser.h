@@ -0,0 +1,14 @@
+#pragma once
+
+#include "reflection_data.h"
+#include <string>
+
+namespace UnityReflection {
+namespace Test {
+
+// The original scalar parser (reference_parser.cpp): what ParseAssemblyData
+// must return for any input, valid or not
+bool ParseWithReference(const std::string& json, AssemblyData& data);
+
+} // namespace Test
+} // namespace UnityReflection
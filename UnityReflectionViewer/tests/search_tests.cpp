@@ -0,0 +1,546 @@
+// The search indices must agree with a plain scan: the type list filter with
+// a substring search over every name, whatever the query, whatever was typed
+// before it and however the types have changed since the index was built; the
+// member search with one over every member row; the fuzzy matcher with a
+// subsequence check and a full sort; the member tables' views with a sort of
+// the members as declared
+
+#include "fuzzy_matcher.h"
+#include "member_search_index.h"
+#include "member_store.h"
+#include "member_table.h"
+#include "payload_generator.h"
+#include "reflection_data.h"
+#include "test_harness.h"
+#include "thread_pool.h"
+#include "type_list_index.h"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <string>
+#include <vector>
+
+using namespace UnityReflection;
+
+namespace {
+
+AssemblyData Assembly(size_t typeCount, uint64_t seed) {
+    Bench::PayloadOptions options;
+    options.typeCount = typeCount;
+    options.seed = seed;
+    AssemblyData data;
+    ParseAssemblyData(Bench::GeneratePayload(options), data);
+    return data;
+}
+
+std::string Lower(const std::string& text) {
+    std::string lower = text;
+    for (char& c : lower) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return lower;
+}
+
+uint8_t Kinds(const TypeInfo& type) {
+    return (type.isClass ? TYPE_KIND_CLASS : 0) | (type.isStruct ? TYPE_KIND_STRUCT : 0) |
+           (type.isEnum ? TYPE_KIND_ENUM : 0) | (type.isInterface ? TYPE_KIND_INTERFACE : 0);
+}
+
+// The types whose lowercased full name contains query, in type order
+std::vector<uint32_t> NaiveFilter(const AssemblyData& data, const std::string& foldedQuery, uint8_t requiredKinds) {
+    std::vector<uint32_t> out;
+    for (size_t i = 0; i < data.types.size(); i++) {
+        if ((Kinds(data.types[i]) & requiredKinds) != requiredKinds) continue;
+        if (Lower(data.types[i].fullName).find(foldedQuery) == std::string::npos) continue;
+        out.push_back(static_cast<uint32_t>(i));
+    }
+    return out;
+}
+
+void CheckFilter(TypeListIndex& index, const AssemblyData& data, const std::string& foldedQuery,
+                 uint8_t requiredKinds) {
+    std::vector<uint32_t> out;
+    index.Filter(foldedQuery, requiredKinds, out);
+    CHECK(out == NaiveFilter(data, foldedQuery, requiredKinds));
+}
+
+// Queries of every length from one to a whole name, taken from the names
+// themselves, plus characters and runs no name has
+std::vector<std::string> Queries(const AssemblyData& data, uint32_t seed) {
+    std::vector<std::string> queries = {"", "a", "e", ".", "_", "z", "q", "xq", "zz", "\xc3\xa9", "system.",
+                                        "nosuchtypename"};
+    std::mt19937 random(seed);
+    for (size_t i = 0; i < 200; i++) {
+        const std::string name = Lower(data.types[random() % data.types.size()].fullName);
+        if (name.empty()) continue;
+        const size_t length = 1 + random() % std::min<size_t>(name.size(), 12);
+        const size_t start = random() % (name.size() - length + 1);
+        queries.push_back(name.substr(start, length));
+    }
+    queries.push_back(Lower(data.types.front().fullName));
+    queries.push_back(Lower(data.types.back().fullName));
+    return queries;
+}
+
+bool IsWordChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Where a ranked member search puts a string holding query: whole matches,
+// then those where it starts a word, then the rest, shorter first in each
+uint32_t RankKey(const std::string& folded, const std::string& foldedQuery) {
+    uint32_t rank = 2;
+    if (folded == foldedQuery) {
+        rank = 0;
+    } else {
+        for (size_t pos = folded.find(foldedQuery); pos != std::string::npos; pos = folded.find(foldedQuery, pos + 1)) {
+            if (pos == 0 || !IsWordChar(folded[pos - 1])) rank = 1;
+        }
+    }
+    return rank * 64 + static_cast<uint32_t>(std::min<size_t>(folded.size(), 63));
+}
+
+// The string a member row has for target
+std::string RowString(const MemberStore& members, const SymbolTable& typeNames, MemberSearchTarget target,
+                      MemberKind kind, uint32_t row) {
+    const MemberColumns& columns = members.Columns(kind);
+    if (target == MemberSearchTarget::Name) return std::string(members.names.Name(columns.name[row]));
+    const SymbolId id = columns.type[row];
+    return id < typeNames.Size() ? std::string(typeNames.Name(id)) : std::string();
+}
+
+std::vector<std::pair<uint8_t, uint32_t>> Sorted(const std::vector<MemberHit>& hits) {
+    std::vector<std::pair<uint8_t, uint32_t>> sorted;
+    for (const MemberHit& hit : hits) sorted.emplace_back(static_cast<uint8_t>(hit.kind), hit.row);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+void CheckMemberSearch(const MemberSearchIndex& index, const MemberStore& members, const SymbolTable& typeNames,
+                       const std::string& query, MemberSearchTarget target, uint8_t kinds) {
+    MemberSearchResult result;
+    index.Search(query, target, kinds, MatchMode::Substring, result, nullptr);
+    const std::string folded = Lower(query);
+    const SymbolTable& strings = target == MemberSearchTarget::Name ? members.names : typeNames;
+
+    // Every row of the kinds whose string holds the query, and no other
+    std::vector<std::pair<uint8_t, uint32_t>> expected;
+    for (size_t k = 0; k < MEMBER_KIND_COUNT; k++) {
+        const MemberKind kind = static_cast<MemberKind>(k);
+        if (!(kinds & MemberKindBit(kind))) continue;
+        for (uint32_t row = 0; row < members.Columns(kind).Size(); row++) {
+            const std::string string = Lower(RowString(members, typeNames, target, kind, row));
+            if (!query.empty() && string.find(folded) != std::string::npos) {
+                expected.emplace_back(static_cast<uint8_t>(k), row);
+            }
+        }
+    }
+    std::vector<MemberHit> all;
+    index.Fetch(result, 0, static_cast<size_t>(result.Total()), all);
+    CHECK(result.Total() == expected.size());
+    CHECK(Sorted(all) == expected);
+
+    // Strings in rank order, ids ascending among equals, each with its rows
+    CHECK(result.matched == result.ids.size());
+    uint64_t first = 0;
+    for (size_t i = 0; i < result.ids.size(); i++) {
+        const std::string string = Lower(std::string(strings.Name(result.ids[i])));
+        CHECK(string.find(folded) != std::string::npos);
+        if (i > 0) {
+            const uint32_t before = RankKey(Lower(std::string(strings.Name(result.ids[i - 1]))), folded);
+            const uint32_t key = RankKey(string, folded);
+            CHECK(before < key || (before == key && result.ids[i - 1] < result.ids[i]));
+        }
+        for (uint64_t h = first; h < result.ends[i]; h++) {
+            CHECK(Lower(RowString(members, typeNames, target, all[h].kind, all[h].row)) == string);
+        }
+        first = result.ends[i];
+    }
+
+    // Read a page at a time, from anywhere, the same members come back
+    std::vector<MemberHit> page;
+    for (uint64_t start = 0; start < all.size(); start += 13) {
+        index.Fetch(result, start, 13, page);
+        for (size_t i = 0; i < page.size(); i++) {
+            CHECK(page[i].kind == all[start + i].kind && page[i].row == all[start + i].row);
+        }
+    }
+}
+
+// Whether name holds the characters of query in order, ignoring case
+bool IsSubsequence(const std::string& query, const std::string& name) {
+    const std::string foldedName = Lower(name);
+    size_t pos = 0;
+    for (char c : Lower(query)) {
+        pos = foldedName.find(c, pos);
+        if (pos == std::string::npos) return false;
+        pos++;
+    }
+    return true;
+}
+
+// Every type, member and member type name in data, many times over
+std::vector<std::string> Names(const AssemblyData& data, size_t count) {
+    MemberStore members;
+    members.Build(data);
+    std::vector<std::string> names;
+    for (size_t id = 1; id < members.names.Size() && names.size() < count; id++) {
+        names.emplace_back(members.names.Name(static_cast<SymbolId>(id)));
+    }
+    for (size_t id = 1; id < data.symbols.Size() && names.size() < count; id++) {
+        names.emplace_back(data.symbols.Name(static_cast<SymbolId>(id)));
+    }
+    for (size_t i = 0; names.size() < count; i++) names.push_back(names[i] + std::to_string(i % 7));
+    return names;
+}
+
+// A member table row as the type declares it
+struct TableRow {
+    std::string name;
+    std::string text;
+    uint8_t flags = 0;
+};
+
+std::vector<TableRow> DeclaredRows(const TypeInfo& type, const SymbolTable& symbols, MemberKind kind) {
+    std::vector<TableRow> rows;
+    if (kind == MemberKind::Field) {
+        for (const FieldInfo& field : type.fields) {
+            rows.push_back({field.name, std::string(symbols.Name(field.fieldType)),
+                            static_cast<uint8_t>((field.isPublic ? MEMBER_PUBLIC : 0) |
+                                                 (field.isStatic ? MEMBER_STATIC : 0) |
+                                                 (field.isReadOnly ? MEMBER_READ_ONLY : 0))});
+        }
+    } else if (kind == MemberKind::Method) {
+        for (const MethodInfo& method : type.methods) {
+            std::string signature = std::string(symbols.Name(method.returnType)) + " " + method.name + "(";
+            for (size_t p = 0; p < method.parameters.size(); p++) {
+                if (p > 0) signature += ", ";
+                signature += std::string(symbols.Name(method.parameters[p].parameterType)) + " " +
+                             method.parameters[p].name;
+            }
+            rows.push_back({method.name, signature + ")",
+                            static_cast<uint8_t>((method.isPublic ? MEMBER_PUBLIC : 0) |
+                                                 (method.isStatic ? MEMBER_STATIC : 0))});
+        }
+    } else {
+        for (const PropertyInfo& property : type.properties) {
+            rows.push_back({property.name, std::string(symbols.Name(property.propertyType)),
+                            static_cast<uint8_t>((property.canRead ? MEMBER_CAN_READ : 0) |
+                                                 (property.canWrite ? MEMBER_CAN_WRITE : 0))});
+        }
+    }
+    return rows;
+}
+
+// What View should return: rows sorted by column with ties by name and then
+// declaration order, reversed whole when descending, then filtered
+std::vector<uint32_t> ExpectedView(const MemberTable& table, const std::vector<TableRow>& rows,
+                                   const std::string& query, uint8_t requiredFlags, int column, bool descending) {
+    std::vector<uint32_t> order(rows.size());
+    for (uint32_t row = 0; row < rows.size(); row++) order[row] = row;
+    if (column != MemberTable::NO_SORT) {
+        auto key = [&](uint32_t row) {
+            std::string primary;
+            if (column == MemberTable::COLUMN_TEXT) {
+                primary = Lower(rows[row].text);
+            } else if (column != MemberTable::COLUMN_NAME) {
+                primary = (rows[row].flags & table.ColumnFlag(column)) ? "1" : "0";
+            }
+            return std::make_tuple(primary, Lower(rows[row].name), row);
+        };
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return key(a) < key(b); });
+        if (descending) std::reverse(order.begin(), order.end());
+    }
+
+    std::vector<uint32_t> view;
+    const std::string folded = Lower(query);
+    for (uint32_t row : order) {
+        if ((rows[row].flags & requiredFlags) != requiredFlags) continue;
+        if (Lower(rows[row].name).find(folded) == std::string::npos &&
+            Lower(rows[row].text).find(folded) == std::string::npos) {
+            continue;
+        }
+        view.push_back(row);
+    }
+    return view;
+}
+
+} // namespace
+
+URV_TEST(TypeListFilterMatchesScan) {
+    const AssemblyData data = Assembly(500, 3);
+    TypeListIndex index;
+    index.Build(data);
+    REQUIRE(index.TypeCount() == data.types.size());
+
+    const uint8_t kindSets[] = {0, TYPE_KIND_CLASS, TYPE_KIND_STRUCT, TYPE_KIND_ENUM, TYPE_KIND_INTERFACE};
+    for (const std::string& query : Queries(data, 1)) {
+        for (uint8_t kinds : kindSets) CheckFilter(index, data, query, kinds);
+    }
+
+    // Built whole or appended in batches, the index is the same
+    TypeListIndex appended;
+    AssemblyData partial;
+    partial.types.assign(data.types.begin(), data.types.begin() + 1);
+    appended.AppendTypes(partial, 0);
+    for (size_t end = 1; end < data.types.size();) {
+        const size_t next = std::min(data.types.size(), end + 1 + end / 2);
+        partial.types.assign(data.types.begin(), data.types.begin() + next);
+        appended.AppendTypes(partial, end);
+        CheckFilter(appended, partial, "ma", 0);
+        end = next;
+    }
+    for (const std::string& query : Queries(data, 2)) CheckFilter(appended, data, query, 0);
+}
+
+URV_TEST(TypeListFilterNarrowsLikeScan) {
+    const AssemblyData data = Assembly(400, 4);
+    TypeListIndex index;
+    index.Build(data);
+
+    // Typed a character at a time and deleted again, so each query extends or
+    // shortens the last; then typed on past every match and back
+    std::mt19937 random(7);
+    for (size_t i = 0; i < 60; i++) {
+        const std::string name = Lower(data.types[random() % data.types.size()].fullName);
+        const size_t start = random() % name.size();
+        const std::string typed = name.substr(start, 1 + random() % 10) + "zq";
+        for (size_t length = 1; length <= typed.size(); length++) {
+            CheckFilter(index, data, typed.substr(0, length), 0);
+        }
+        for (size_t length = typed.size(); length-- > 1;) {
+            CheckFilter(index, data, typed.substr(0, length), 0);
+        }
+        CheckFilter(index, data, typed.substr(0, 2), TYPE_KIND_CLASS);
+        CheckFilter(index, data, typed.substr(0, 4), TYPE_KIND_CLASS);
+        CheckFilter(index, data, typed.substr(0, 4), 0);
+    }
+}
+
+URV_TEST(TypeListFilterAfterDeltas) {
+    AssemblyData data = Assembly(300, 5);
+    const AssemblyData other = Assembly(100, 6);
+    TypeListIndex index;
+    index.Build(data);
+
+    // Removals, renames and additions as AssemblyDelta applies them; the
+    // removals move types to other slots, the renames give them new ones
+    std::mt19937 random(9);
+    std::string query = "se";
+    CheckFilter(index, data, query, 0);
+    for (size_t step = 0; step < 300; step++) {
+        const size_t typeIndex = random() % data.types.size();
+        switch (random() % 3) {
+            case 0: {
+                const size_t last = data.types.size() - 1;
+                if (typeIndex != last) data.types[typeIndex] = std::move(data.types[last]);
+                data.types.pop_back();
+                index.RemoveType(typeIndex, last);
+                break;
+            }
+            case 1:
+                data.types[typeIndex].fullName = other.types[random() % other.types.size()].fullName;
+                data.types[typeIndex].isEnum = !data.types[typeIndex].isEnum;
+                index.UpdateType(data, typeIndex);
+                break;
+            default:
+                data.types.push_back(other.types[random() % other.types.size()]);
+                index.AppendTypes(data, data.types.size() - 1);
+                break;
+        }
+        REQUIRE(index.TypeCount() == data.types.size());
+
+        // The matches kept from the query before the change are out of date
+        CheckFilter(index, data, query, 0);
+
+        const std::string name = Lower(data.types[random() % data.types.size()].fullName);
+        query = name.substr(random() % name.size(), 1 + random() % 6);
+        for (size_t length = 1; length <= query.size(); length++) {
+            CheckFilter(index, data, query.substr(0, length), 0);
+        }
+        CheckFilter(index, data, query, TYPE_KIND_ENUM);
+        CheckFilter(index, data, query, 0);
+    }
+    for (const std::string& q : Queries(data, 3)) CheckFilter(index, data, q, 0);
+}
+
+URV_TEST(MemberSearchMatchesScan) {
+    AssemblyData data = Assembly(300, 7);
+    MemberStore members;
+    members.Build(data);
+
+    // Rows UpdateType leaves behind are still listed by the index
+    for (size_t typeIndex = 0; typeIndex < data.types.size(); typeIndex += 17) {
+        if (!data.types[typeIndex].fields.empty()) data.types[typeIndex].fields.pop_back();
+        members.UpdateType(data, typeIndex);
+    }
+
+    MemberSearchIndex index;
+    index.Build(MemberSearchIndex::Capture(members, data.symbols));
+
+    std::vector<std::string> queries = {"", "a", "E", "_", "<", "nosuchmember", "System.", "Int32", "get", "On"};
+    std::mt19937 random(11);
+    for (size_t i = 0; i < 60; i++) {
+        const bool fromType = i % 2 == 1;
+        const SymbolTable& strings = fromType ? data.symbols : members.names;
+        const std::string string(strings.Name(static_cast<SymbolId>(1 + random() % (strings.Size() - 1))));
+        if (string.empty()) continue;
+        const size_t start = i % 3 == 0 ? 0 : random() % string.size();
+        queries.push_back(i % 5 == 0 ? string : string.substr(start, 1 + random() % 8));
+    }
+
+    const uint8_t kindSets[] = {MEMBER_KIND_ALL, MemberKindBit(MemberKind::Field),
+                                MemberKindBit(MemberKind::Method) | MemberKindBit(MemberKind::Parameter)};
+    for (const std::string& query : queries) {
+        for (uint8_t kinds : kindSets) {
+            CheckMemberSearch(index, members, data.symbols, query, MemberSearchTarget::Name, kinds);
+            CheckMemberSearch(index, members, data.symbols, query, MemberSearchTarget::Type, kinds);
+        }
+    }
+}
+
+URV_TEST(FuzzyScoreMatchesSubsequence) {
+    const std::vector<std::string> names = Names(Assembly(200, 8), 3000);
+    std::mt19937 random(13);
+
+    // Queries picked out of names in order, with the case changed, and ones
+    // that are probably in no name
+    std::vector<std::string> queries = {"a", "plyrctrlmgr", "Sys.Col.Gen", "xqzj", "<>", "i32", "_"};
+    for (size_t i = 0; i < 100; i++) {
+        const std::string& name = names[random() % names.size()];
+        std::string query;
+        for (char c : name) {
+            if (random() % 3 == 0) query += random() % 2 ? c : static_cast<char>(Lower(std::string(1, c))[0]);
+        }
+        if (!query.empty()) queries.push_back(query);
+    }
+
+    for (const std::string& query : queries) {
+        const FuzzyMatcher matcher(query);
+        for (size_t i = 0; i < names.size(); i += 3) {
+            const int32_t score = matcher.Score(names[i]);
+            CHECK((score != FuzzyMatcher::NO_MATCH) == IsSubsequence(query, names[i]));
+            // A name can only hold the query if its mask has all the query's bits
+            if (score != FuzzyMatcher::NO_MATCH) CHECK((CharMask(names[i]) & matcher.Mask()) == matcher.Mask());
+        }
+    }
+
+    // Runs and word starts beat the same characters spread out
+    const FuzzyMatcher player("player");
+    CHECK(player.Score("PlayerController") > player.Score("PxlxaxyxexrController"));
+    CHECK(player.Score("Game.Player") > player.Score("Game.Replayer"));
+    CHECK(FuzzyMatcher("PlyrCtrlMgr").Score("PlayerControllerManager") != FuzzyMatcher::NO_MATCH);
+    CHECK(FuzzyMatcher("").Score("Player") == FuzzyMatcher::NO_MATCH);
+}
+
+URV_TEST(FuzzyPrefilterMatchesScan) {
+    // Sparse masks so that a good share pass, at every start and end offset
+    // around the vector widths
+    std::mt19937_64 random(17);
+    std::vector<uint64_t> masks(300);
+    for (uint64_t& mask : masks) mask = random() & random() & random();
+    for (size_t trial = 0; trial < 400; trial++) {
+        const size_t begin = trial % 11;
+        const size_t end = std::max(begin, masks.size() - (trial / 11) % 13);
+        const uint64_t required = trial % 50 == 0 ? 0 : uint64_t(1) << (random() % 64) | uint64_t(1) << (random() % 64);
+        std::vector<uint32_t> out;
+        FuzzyMatcher::Prefilter(masks.data(), begin, end, required, out);
+        std::vector<uint32_t> expected;
+        for (size_t i = begin; i < end; i++) {
+            if ((masks[i] & required) == required) expected.push_back(static_cast<uint32_t>(i));
+        }
+        CHECK(out == expected);
+    }
+}
+
+URV_TEST(FuzzyRankMatchesFullSort) {
+    // More names than one pool task ranks, so chunks are merged
+    const std::vector<std::string> names = Names(Assembly(300, 9), 40000);
+    std::vector<uint64_t> masks;
+    for (const std::string& name : names) masks.push_back(CharMask(name));
+    auto accept = [](uint32_t i) { return i % 5 != 0; };
+    auto name = [&names](uint32_t i) { return std::string_view(names[i]); };
+
+    for (const char* query : {"get", "PlyrCtrl", "sy.co", "e", "zzzzqx"}) {
+        const FuzzyMatcher matcher(query);
+        std::vector<FuzzyMatch> expected;
+        for (uint32_t i = 0; i < names.size(); i++) {
+            const int32_t score = matcher.Score(names[i]);
+            if (accept(i) && score != FuzzyMatcher::NO_MATCH) {
+                expected.push_back({i, score, static_cast<uint32_t>(names[i].size())});
+            }
+        }
+        const size_t matched = expected.size();
+        std::sort(expected.begin(), expected.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+            if (a.score != b.score) return a.score > b.score;
+            if (a.length != b.length) return a.length < b.length;
+            return a.index < b.index;
+        });
+
+        for (size_t limit : {size_t(1), size_t(50), size_t(100000)}) {
+            for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &ThreadPool::Shared()}) {
+                std::vector<FuzzyMatch> best;
+                CHECK(matcher.Rank(masks.data(), masks.size(), accept, name, limit, best, pool) == matched);
+                REQUIRE(best.size() == std::min(limit, matched));
+                for (size_t i = 0; i < best.size(); i++) {
+                    CHECK(best[i].index == expected[i].index && best[i].score == expected[i].score);
+                }
+            }
+        }
+    }
+}
+
+URV_TEST(MemberTableSortsLikeStableSort) {
+    AssemblyData data = Assembly(150, 10);
+
+    // One type with the members of all the others, and again under names that
+    // differ only in case, so every column sorts many ties
+    TypeInfo big;
+    big.fullName = "Big";
+    for (const TypeInfo& type : data.types) {
+        big.fields.insert(big.fields.end(), type.fields.begin(), type.fields.end());
+        big.methods.insert(big.methods.end(), type.methods.begin(), type.methods.end());
+        big.properties.insert(big.properties.end(), type.properties.begin(), type.properties.end());
+    }
+    for (size_t i = 0, count = big.fields.size(); i < count; i += 4) {
+        FieldInfo field = big.fields[i];
+        field.name = Lower(field.name);
+        field.isStatic = !field.isStatic;
+        big.fields.push_back(field);
+    }
+    for (size_t i = 0, count = big.methods.size(); i < count; i += 4) big.methods.push_back(big.methods[i]);
+    data.types.push_back(big);
+
+    MemberStore members;
+    members.Build(data);
+    const size_t typeIndex = data.types.size() - 1;
+    const MemberRange ranges[] = {members.typeFields[typeIndex], members.typeMethods[typeIndex],
+                                  members.typeProperties[typeIndex]};
+    const MemberKind kinds[] = {MemberKind::Field, MemberKind::Method, MemberKind::Property};
+
+    for (size_t k = 0; k < 3; k++) {
+        const std::vector<TableRow> rows = DeclaredRows(data.types[typeIndex], data.symbols, kinds[k]);
+        MemberTable table;
+        table.Build(members, data.symbols, kinds[k], ranges[k], 1);
+        CHECK(table.Shows(kinds[k], ranges[k], 1));
+        REQUIRE(table.RowCount() == rows.size());
+        for (uint32_t row = 0; row < rows.size(); row++) {
+            CHECK(table.Name(row) == rows[row].name);
+            CHECK(table.Text(row) == rows[row].text);
+            CHECK(table.Flags(row) == rows[row].flags);
+        }
+
+        for (const char* query : {"", "m", "Int", "VALUE", "(", "zzqx"}) {
+            for (uint8_t requiredFlags : {uint8_t(0), table.ColumnFlag(MemberTable::COLUMN_TEXT + 1)}) {
+                for (int column = MemberTable::NO_SORT; column < table.ColumnCount(); column++) {
+                    for (bool descending : {false, true}) {
+                        const std::vector<uint32_t> expected =
+                            ExpectedView(table, rows, query, requiredFlags, column, descending && column >= 0);
+                        CHECK(table.View(query, requiredFlags, column, descending) == expected);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Just enough of a test framework for urv_tests: URV_TEST defines a case and
+// registers it, CHECK reports a failed condition and carries on, REQUIRE
+// reports it and leaves the case.
+
+namespace UnityReflection {
+namespace Test {
+
+struct TestCase {
+    const char* name;
+    void (*body)();
+};
+
+std::vector<TestCase>& Registry();
+void ReportFailure(const char* file, int line, const char* condition);
+
+struct Registrar {
+    Registrar(const char* name, void (*body)()) { Registry().push_back({name, body}); }
+};
+
+} // namespace Test
+} // namespace UnityReflection
+
+#define URV_TEST(name)                                                              \
+    static void name();                                                             \
+    static const ::UnityReflection::Test::Registrar name##Registrar(#name, name);   \
+    static void name()
+
+#define CHECK(condition)                                                                 \
+    do {                                                                                 \
+        if (!(condition)) ::UnityReflection::Test::ReportFailure(__FILE__, __LINE__, #condition); \
+    } while (0)
+
+#define REQUIRE(condition)                                                               \
+    do {                                                                                 \
+        if (!(condition)) {                                                              \
+            ::UnityReflection::Test::ReportFailure(__FILE__, __LINE__, #condition);      \
+            return;                                                                      \
+        }                                                                                \
+    } while (0)
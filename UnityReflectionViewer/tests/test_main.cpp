@@ -0,0 +1,55 @@
+// Round-trip and equivalence tests of the parsers, codecs and wire formats.
+// Needs no window, the mod or a pipe; run through ctest or directly:
+//
+//   urv_tests [--filter name]
+
+#include "test_harness.h"
+
+#include <cstring>
+#include <string>
+
+namespace UnityReflection {
+namespace Test {
+
+namespace {
+
+size_t g_failures = 0;
+
+} // namespace
+
+std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+void ReportFailure(const char* file, int line, const char* condition) {
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, condition);
+    g_failures++;
+}
+
+} // namespace Test
+} // namespace UnityReflection
+
+int main(int argc, char** argv) {
+    using namespace UnityReflection::Test;
+
+    std::string filter;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+    }
+
+    size_t run = 0;
+    size_t failed = 0;
+    for (const TestCase& test : Registry()) {
+        if (!filter.empty() && std::string(test.name).find(filter) == std::string::npos) continue;
+        const size_t before = g_failures;
+        test.body();
+        run++;
+        const bool passed = g_failures == before;
+        if (!passed) failed++;
+        printf("%-40s %s\n", test.name, passed ? "ok" : "FAILED");
+    }
+
+    printf("%zu of %zu tests passed\n", run - failed, run);
+    return failed == 0 && run > 0 ? 0 : 1;
+}